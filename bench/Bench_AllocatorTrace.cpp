@@ -0,0 +1,611 @@
+#include "Benchmark.hpp"
+
+#include <InlineLib/Memory/AllocationTrace.hpp>
+#include <InlineLib/Memory/BuddyAllocationEngine.hpp>
+#include <InlineLib/Memory/RingAllocationEngine.hpp>
+#include <InlineLib/Memory/SlabPoolResource.hpp>
+#include <InlineLib/Memory/TlsfResource.hpp>
+
+#ifdef INL_USE_LTALLOC
+#include <InlineLib/GlobalAlloc/ltalloc.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#include <Psapi.h>
+#elif defined(__linux__)
+#include <unistd.h>
+#endif
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define INL_BENCH_HAS_MALLINFO2
+#endif
+
+
+using namespace inl;
+using namespace inl::bench;
+using Clock = std::chrono::high_resolution_clock;
+
+
+// Replays allocation traces against the allocators of the library and the system allocator.
+// The traces are synthetic patterns, plus a recorded trace if INL_BENCH_ALLOCATION_TRACE is set
+// to a file written by AllocationTraceRecorder (see INL_ALLOCATION_TRACE).
+// Each replay thread replays the whole trace with its own allocator, or with its view of a shared one.
+
+
+namespace {
+
+
+//------------------------------------------------------------------------------
+// Traces
+//------------------------------------------------------------------------------
+
+class TraceBuilder {
+public:
+	uint64_t Allocate(size_t size) {
+		trace.events.push_back({ eAllocationOp::ALLOCATE, 0, nextId, size });
+		sizes.push_back(size);
+		return nextId++;
+	}
+
+	void Deallocate(uint64_t id) {
+		trace.events.push_back({ eAllocationOp::DEALLOCATE, 0, id, sizes[id] });
+	}
+
+	AllocationTrace trace;
+
+private:
+	uint64_t nextId = 0;
+	std::vector<size_t> sizes;
+};
+
+
+// Sizes in real programs are closer to log-uniform than uniform.
+size_t RandomSize(std::mt19937& rne, size_t min, size_t max) {
+	std::uniform_real_distribution<double> distribution(std::log(double(min)), std::log(double(max)));
+	return size_t(std::exp(distribution(rne)));
+}
+
+
+// Messages passed through a queue, freed in allocation order.
+AllocationTrace GenerateFifo() {
+	std::mt19937 rne(1);
+	TraceBuilder builder;
+	std::vector<uint64_t> queue;
+	size_t head = 0;
+	for (int i = 0; i < 100000; ++i) {
+		if (queue.size() - head == 1000) {
+			builder.Deallocate(queue[head++]);
+		}
+		queue.push_back(builder.Allocate(RandomSize(rne, 32, 2048)));
+	}
+	while (head < queue.size()) {
+		builder.Deallocate(queue[head++]);
+	}
+	return std::move(builder.trace);
+}
+
+
+// Temporaries of nested scopes, freed in reverse allocation order.
+AllocationTrace GenerateLifo() {
+	std::mt19937 rne(2);
+	TraceBuilder builder;
+	std::vector<uint64_t> stack;
+	for (int i = 0; i < 100000; ++i) {
+		if (!stack.empty() && (stack.size() >= 256 || rne() % 2 == 0)) {
+			builder.Deallocate(stack.back());
+			stack.pop_back();
+		}
+		else {
+			stack.push_back(builder.Allocate(RandomSize(rne, 16, 4096)));
+		}
+	}
+	while (!stack.empty()) {
+		builder.Deallocate(stack.back());
+		stack.pop_back();
+	}
+	return std::move(builder.trace);
+}
+
+
+// Objects with random lifetimes around a steady live set.
+AllocationTrace GenerateRandom() {
+	std::mt19937 rne(3);
+	TraceBuilder builder;
+	std::vector<uint64_t> live;
+	for (int i = 0; i < 4000; ++i) {
+		live.push_back(builder.Allocate(RandomSize(rne, 16, 16384)));
+	}
+	for (int i = 0; i < 100000; ++i) {
+		size_t pick = rne() % live.size();
+		builder.Deallocate(live[pick]);
+		live[pick] = builder.Allocate(RandomSize(rne, 16, 16384));
+	}
+	for (uint64_t id : live) {
+		builder.Deallocate(id);
+	}
+	return std::move(builder.trace);
+}
+
+
+// Many small objects are created, most of them are freed at random, then large blocks are
+// allocated in the holes. Allocators that can't reuse the holes for large blocks grow.
+AllocationTrace GeneratePhased() {
+	std::mt19937 rne(4);
+	TraceBuilder builder;
+	std::vector<uint64_t> survivors;
+	for (int round = 0; round < 5; ++round) {
+		std::vector<uint64_t> small;
+		for (int i = 0; i < 20000; ++i) {
+			small.push_back(builder.Allocate(RandomSize(rne, 16, 256)));
+		}
+		std::shuffle(small.begin(), small.end(), rne);
+		for (size_t i = 0; i < small.size(); ++i) {
+			if (i % 10 == 0) {
+				survivors.push_back(small[i]);
+			}
+			else {
+				builder.Deallocate(small[i]);
+			}
+		}
+		std::vector<uint64_t> large;
+		for (int i = 0; i < 500; ++i) {
+			large.push_back(builder.Allocate(RandomSize(rne, 4096, 65536)));
+		}
+		for (uint64_t id : large) {
+			builder.Deallocate(id);
+		}
+	}
+	for (uint64_t id : survivors) {
+		builder.Deallocate(id);
+	}
+	return std::move(builder.trace);
+}
+
+
+struct NamedTrace {
+	std::string name;
+	AllocationTrace trace;
+	size_t allocationCount = 0;
+};
+
+
+const std::vector<NamedTrace>& GetTraces() {
+	static const std::vector<NamedTrace> traces = [] {
+		std::vector<NamedTrace> traces;
+		traces.push_back({ "fifo", GenerateFifo() });
+		traces.push_back({ "lifo", GenerateLifo() });
+		traces.push_back({ "random", GenerateRandom() });
+		traces.push_back({ "phased", GeneratePhased() });
+		if (const char* path = std::getenv("INL_BENCH_ALLOCATION_TRACE")) {
+			std::ifstream file(path);
+			if (file.is_open()) {
+				traces.push_back({ "recorded", AllocationTrace::Read(file) });
+			}
+			else {
+				std::cerr << "Could not open allocation trace: " << path << std::endl;
+			}
+		}
+		for (auto& trace : traces) {
+			trace.allocationCount = trace.trace.AllocationCount();
+		}
+		return traces;
+	}();
+	return traces;
+}
+
+
+//------------------------------------------------------------------------------
+// Allocators
+//------------------------------------------------------------------------------
+
+size_t ResidentBytes() {
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+#elif defined(__linux__)
+	size_t pages = 0;
+	if (std::FILE* file = std::fopen("/proc/self/statm", "r")) {
+		if (std::fscanf(file, "%*s %zu", &pages) != 1) {
+			pages = 0;
+		}
+		std::fclose(file);
+	}
+	return pages * size_t(sysconf(_SC_PAGESIZE));
+#else
+	return 0;
+#endif
+}
+
+
+/// <summary> The view of an allocator that a single replay thread uses. </summary>
+class ReplayAllocator {
+public:
+	virtual ~ReplayAllocator() = default;
+	/// <summary> Returns null if the allocator ran out of memory. </summary>
+	virtual void* Allocate(size_t size) = 0;
+	virtual void Deallocate(void* ptr, size_t size) = 0;
+	/// <summary> Called right before the first event, after the replay's own allocations. </summary>
+	virtual void StartMeasuring() {}
+	/// <summary> The memory held to serve the live allocations, or nullopt if the allocator can't tell,
+	///		then the growth of the resident set is used. </summary>
+	/// <param name="highestEnd"> The end of the live allocation with the highest address. </param>
+	virtual std::optional<size_t> Footprint([[maybe_unused]] const std::byte* highestEnd) const { return std::nullopt; }
+};
+
+
+class MallocAllocator : public ReplayAllocator {
+public:
+	void* Allocate(size_t size) override { return std::malloc(size); }
+	void Deallocate(void* ptr, size_t) override { std::free(ptr); }
+#ifdef INL_BENCH_HAS_MALLINFO2
+	// Everything glibc holds, including free chunks, except what others had in use before the replay.
+	void StartMeasuring() override {
+		struct mallinfo2 info = mallinfo2();
+		m_baseline = info.uordblks + info.hblkhd;
+	}
+	std::optional<size_t> Footprint(const std::byte*) const override {
+		struct mallinfo2 info = mallinfo2();
+		size_t held = info.arena + info.hblkhd;
+		return held > m_baseline ? held - m_baseline : 0;
+	}
+
+private:
+	size_t m_baseline = 0;
+#endif
+};
+
+
+#ifdef INL_USE_LTALLOC
+class LtallocAllocator : public ReplayAllocator {
+public:
+	void* Allocate(size_t size) override { return ltmalloc(size); }
+	void Deallocate(void* ptr, size_t) override { ltfree(ptr); }
+};
+#endif
+
+
+// Counts what the slab pool holds from upstream, chunks and large allocations.
+class CountingResource : public std::pmr::memory_resource {
+public:
+	size_t heldBytes = 0;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		heldBytes += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		heldBytes -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+
+class SlabPoolAllocator : public ReplayAllocator {
+public:
+	SlabPoolAllocator() : m_pool(1024, &m_upstream) {}
+	void* Allocate(size_t size) override { return m_pool.allocate(size); }
+	void Deallocate(void* ptr, size_t size) override { m_pool.deallocate(ptr, size); }
+	std::optional<size_t> Footprint(const std::byte*) const override { return m_upstream.heldBytes; }
+
+private:
+	CountingResource m_upstream;
+	SlabPoolResource m_pool;
+};
+
+
+constexpr size_t RegionSize = 64 * 1024 * 1024; // Per thread, pages are only touched when allocated.
+
+
+// All replay threads share the resource, each gets its own heap.
+class TlsfAllocator : public ReplayAllocator {
+public:
+	struct Shared {
+		Shared(int threadCount)
+			: region(new std::byte[threadCount * RegionSize]),
+			  resource(region.get(), threadCount * RegionSize, RegionSize) {}
+		std::unique_ptr<std::byte[]> region;
+		ThreadLocalTlsfResource resource;
+	};
+
+	TlsfAllocator(std::shared_ptr<Shared> shared) : m_shared(std::move(shared)) {}
+
+	void* Allocate(size_t size) override {
+		try {
+			return m_shared->resource.allocate(size);
+		}
+		catch (std::bad_alloc&) {
+			return nullptr;
+		}
+	}
+	void Deallocate(void* ptr, size_t size) override { m_shared->resource.deallocate(ptr, size); }
+	std::optional<size_t> Footprint(const std::byte* highestEnd) const override {
+		// Only meaningful with one thread, the first heap starts at the beginning of the region.
+		return highestEnd ? size_t(highestEnd - m_shared->region.get()) : 0;
+	}
+
+private:
+	std::shared_ptr<Shared> m_shared;
+};
+
+
+// Index engines sub-allocating a region of 16 byte slots.
+template <class Engine>
+class SlotEngineAllocator : public ReplayAllocator {
+public:
+	static constexpr size_t SlotSize = 16;
+
+	SlotEngineAllocator() : m_region(new std::byte[RegionSize]), m_engine(RegionSize / SlotSize) {}
+
+	void* Allocate(size_t size) override {
+		try {
+			return m_region.get() + m_engine.Allocate((size + SlotSize - 1) / SlotSize) * SlotSize;
+		}
+		catch (std::bad_alloc&) {
+			return nullptr;
+		}
+	}
+	void Deallocate(void* ptr, size_t) override {
+		m_engine.Deallocate(size_t(static_cast<std::byte*>(ptr) - m_region.get()) / SlotSize);
+	}
+	std::optional<size_t> Footprint(const std::byte* highestEnd) const override {
+		return highestEnd ? size_t(highestEnd - m_region.get()) : 0;
+	}
+
+private:
+	std::unique_ptr<std::byte[]> m_region;
+	Engine m_engine;
+};
+
+
+struct AllocatorFactory {
+	std::string name;
+	std::function<std::vector<std::unique_ptr<ReplayAllocator>>(int threadCount)> create; // One view per thread.
+};
+
+
+template <class Allocator>
+std::vector<std::unique_ptr<ReplayAllocator>> CreatePerThread(int threadCount) {
+	std::vector<std::unique_ptr<ReplayAllocator>> allocators;
+	for (int i = 0; i < threadCount; ++i) {
+		allocators.push_back(std::make_unique<Allocator>());
+	}
+	return allocators;
+}
+
+
+const std::vector<AllocatorFactory>& GetAllocators() {
+	static const std::vector<AllocatorFactory> factories = {
+		{ "malloc", &CreatePerThread<MallocAllocator> },
+#ifdef INL_USE_LTALLOC
+		{ "ltalloc", &CreatePerThread<LtallocAllocator> },
+#endif
+		{ "slab_pool", &CreatePerThread<SlabPoolAllocator> },
+		{ "tlsf", [](int threadCount) {
+			 auto shared = std::make_shared<TlsfAllocator::Shared>(threadCount);
+			 std::vector<std::unique_ptr<ReplayAllocator>> allocators;
+			 for (int i = 0; i < threadCount; ++i) {
+				 allocators.push_back(std::make_unique<TlsfAllocator>(shared));
+			 }
+			 return allocators;
+		 } },
+		{ "buddy", &CreatePerThread<SlotEngineAllocator<BuddyAllocationEngine>> },
+		{ "ring", &CreatePerThread<SlotEngineAllocator<RingAllocationEngine>> },
+	};
+	return factories;
+}
+
+
+//------------------------------------------------------------------------------
+// Replay
+//------------------------------------------------------------------------------
+
+struct FragmentationSample {
+	size_t liveBytes; // Sum of the requested sizes.
+	size_t footprint;
+};
+
+
+struct ReplayResult {
+	double nanoseconds = 0;
+	size_t failedAllocations = 0;
+	std::vector<double> latencies; // Of each event, if requested.
+	std::vector<FragmentationSample> fragmentation;
+};
+
+
+// Writes a byte to every page, like a program using the memory would, so that it becomes resident.
+void Touch(void* ptr, size_t size) {
+	auto bytes = static_cast<volatile std::byte*>(ptr);
+	for (size_t offset = 0; offset < size; offset += 4096) {
+		bytes[offset] = std::byte(1);
+	}
+}
+
+
+ReplayResult Replay(const NamedTrace& trace, ReplayAllocator& allocator, bool measureLatency, size_t sampleCount) {
+	ReplayResult result;
+	std::vector<std::byte*> pointers(trace.allocationCount, nullptr);
+	if (measureLatency) {
+		result.latencies.reserve(trace.trace.events.size());
+	}
+	size_t sampleInterval = sampleCount != 0 ? std::max(trace.trace.events.size() / sampleCount, size_t(1)) : SIZE_MAX;
+	size_t liveBytes = 0;
+	size_t residentBaseline = sampleCount != 0 ? ResidentBytes() : 0;
+	allocator.StartMeasuring();
+
+	auto start = Clock::now();
+	for (size_t i = 0; i < trace.trace.events.size(); ++i) {
+		const AllocationTraceEvent& event = trace.trace.events[i];
+		auto opStart = measureLatency ? Clock::now() : Clock::time_point{};
+		if (event.op == eAllocationOp::ALLOCATE) {
+			pointers[event.id] = static_cast<std::byte*>(allocator.Allocate(size_t(event.size)));
+		}
+		else if (pointers[event.id]) {
+			allocator.Deallocate(pointers[event.id], size_t(event.size));
+		}
+		if (measureLatency) {
+			result.latencies.push_back(Nanoseconds(opStart, Clock::now()));
+		}
+
+		if (event.op == eAllocationOp::ALLOCATE) {
+			if (pointers[event.id]) {
+				Touch(pointers[event.id], size_t(event.size));
+				liveBytes += event.size;
+			}
+			else {
+				++result.failedAllocations;
+			}
+		}
+		else if (pointers[event.id]) {
+			pointers[event.id] = nullptr;
+			liveBytes -= event.size;
+		}
+
+		if ((i + 1) % sampleInterval == 0) {
+			const std::byte* highestEnd = nullptr;
+			for (const AllocationTraceEvent& live : trace.trace.events) {
+				if (live.op == eAllocationOp::ALLOCATE && pointers[live.id]) {
+					highestEnd = std::max<const std::byte*>(highestEnd, pointers[live.id] + live.size);
+				}
+			}
+			size_t footprint = allocator.Footprint(highestEnd).value_or(std::max(ResidentBytes(), residentBaseline) - residentBaseline);
+			result.fragmentation.push_back({ liveBytes, footprint });
+		}
+	}
+	result.nanoseconds = Nanoseconds(start, Clock::now());
+
+	// Allocations the trace didn't free.
+	for (const AllocationTraceEvent& event : trace.trace.events) {
+		if (event.op == eAllocationOp::ALLOCATE && pointers[event.id]) {
+			allocator.Deallocate(pointers[event.id], size_t(event.size));
+			pointers[event.id] = nullptr;
+		}
+	}
+	return result;
+}
+
+
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Benchmarks
+//------------------------------------------------------------------------------
+
+// Every thread replays the trace concurrently. A monitor thread samples the resident set for the peak.
+static void AllocatorTraceThroughput(std::vector<BenchmarkResult>& results) {
+	for (const NamedTrace& trace : GetTraces()) {
+		for (const AllocatorFactory& factory : GetAllocators()) {
+			for (int threadCount : { 1, 2, 4, 8 }) {
+				auto allocators = factory.create(threadCount);
+				std::vector<ReplayResult> replays(threadCount);
+
+				std::atomic_bool done = false;
+				size_t residentBaseline = ResidentBytes();
+				size_t residentPeak = residentBaseline;
+				std::thread monitor([&] {
+					while (!done.load()) {
+						residentPeak = std::max(residentPeak, ResidentBytes());
+						std::this_thread::sleep_for(std::chrono::milliseconds(1));
+					}
+				});
+
+				std::atomic_int ready = 0;
+				std::vector<std::thread> threads;
+				for (int i = 0; i < threadCount; ++i) {
+					threads.emplace_back([&, i] {
+						ready.fetch_add(1);
+						while (ready.load() < threadCount) {
+						}
+						replays[i] = Replay(trace, *allocators[i], false, 0);
+					});
+				}
+				auto start = Clock::now();
+				for (auto& thread : threads) {
+					thread.join();
+				}
+				auto end = Clock::now();
+				done = true;
+				monitor.join();
+
+				size_t failedAllocations = 0;
+				for (auto& replay : replays) {
+					failedAllocations += replay.failedAllocations;
+				}
+				double events = double(trace.trace.events.size()) * threadCount;
+				results.push_back({ "Allocator trace throughput",
+									{ { "trace", trace.name }, { "allocator", factory.name }, { "threads", std::to_string(threadCount) } },
+									{ { "ops_per_sec", events / (Nanoseconds(start, end) * 1e-9) },
+									  { "peak_rss_mb", double(residentPeak - residentBaseline) / (1024.0 * 1024.0) },
+									  { "failed_allocs", double(failedAllocations) } } });
+			}
+		}
+	}
+}
+
+
+// Latency of every single call on one thread.
+static void AllocatorTraceLatency(std::vector<BenchmarkResult>& results) {
+	for (const NamedTrace& trace : GetTraces()) {
+		for (const AllocatorFactory& factory : GetAllocators()) {
+			auto allocators = factory.create(1);
+			ReplayResult replay = Replay(trace, *allocators[0], true, 0);
+			double max = *std::max_element(replay.latencies.begin(), replay.latencies.end());
+			results.push_back({ "Allocator trace latency",
+								{ { "trace", trace.name }, { "allocator", factory.name } },
+								{ { "p50_ns", Percentile(replay.latencies, 0.5) },
+								  { "p99_ns", Percentile(replay.latencies, 0.99) },
+								  { "p99_9_ns", Percentile(replay.latencies, 0.999) },
+								  { "max_ns", max } } });
+		}
+	}
+}
+
+
+// Live bytes against the memory the allocator needs for them, at evenly spaced points of the trace.
+// For the system allocators, the footprint comes from glibc's statistics if available, otherwise it's
+// the growth of the resident set, which misses memory the allocator held before the replay.
+static void AllocatorTraceFragmentation(std::vector<BenchmarkResult>& results) {
+	constexpr size_t sampleCount = 20;
+	for (const NamedTrace& trace : GetTraces()) {
+		for (const AllocatorFactory& factory : GetAllocators()) {
+			auto allocators = factory.create(1);
+			ReplayResult replay = Replay(trace, *allocators[0], false, sampleCount);
+			for (size_t i = 0; i < replay.fragmentation.size(); ++i) {
+				const FragmentationSample& sample = replay.fragmentation[i];
+				double fragmentation = sample.footprint > sample.liveBytes ? 1.0 - double(sample.liveBytes) / double(sample.footprint) : 0.0;
+				results.push_back({ "Allocator trace fragmentation",
+									{ { "trace", trace.name }, { "allocator", factory.name }, { "progress", std::to_string((i + 1) * 100 / replay.fragmentation.size()) + "%" } },
+									{ { "live_kb", double(sample.liveBytes) / 1024.0 },
+									  { "footprint_kb", double(sample.footprint) / 1024.0 },
+									  { "fragmentation", fragmentation } } });
+			}
+		}
+	}
+}
+
+
+static BenchmarkRegistrar allocatorTraceThroughput("Allocator trace throughput", &AllocatorTraceThroughput);
+static BenchmarkRegistrar allocatorTraceLatency("Allocator trace latency", &AllocatorTraceLatency);
+static BenchmarkRegistrar allocatorTraceFragmentation("Allocator trace fragmentation", &AllocatorTraceFragmentation);
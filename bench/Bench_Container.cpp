@@ -0,0 +1,116 @@
+#include "Benchmark.hpp"
+
+#include <InlineLib/Container/BucketedPolymorphicVector.hpp>
+#include <InlineLib/Container/ContiguousPolymorphicVector.hpp>
+#include <InlineLib/Container/PolymorphicVector.hpp>
+
+#include <random>
+#include <string>
+
+
+using namespace inl;
+using namespace inl::bench;
+using Clock = std::chrono::high_resolution_clock;
+
+
+namespace {
+
+class Component {
+public:
+	virtual ~Component() = default;
+	virtual void Update(float dt) = 0;
+	float value = 0.0f;
+};
+
+class Position final : public Component {
+public:
+	void Update(float dt) override { value += velocity * dt; }
+	float velocity = 1.0f;
+};
+
+class Rotation final : public Component {
+public:
+	void Update(float dt) override { value = value * 0.99f + angularVelocity * dt; }
+	float angularVelocity = 2.0f;
+	float axis[3] = { 0.0f, 1.0f, 0.0f };
+};
+
+class Cooldown final : public Component {
+public:
+	void Update(float dt) override { value = remaining -= dt; }
+	double remaining = 1e9;
+	double history[4] = {};
+};
+
+} // namespace
+
+
+// Virtual update over a mix of component types, stored behind pointers vs. inline.
+template <class Vector>
+static double UpdateAll(Vector& components, int repetitions) {
+	auto start = Clock::now();
+	for (int r = 0; r < repetitions; ++r) {
+		for (auto& component : components) {
+			component.Update(0.016f);
+		}
+	}
+	return Nanoseconds(start, Clock::now()) / (double(repetitions) * components.size());
+}
+
+
+template <class Vector>
+static void Fill(Vector& components, size_t count) {
+	std::mt19937 rne(42);
+	std::uniform_int_distribution<int> typeDist(0, 2);
+	for (size_t i = 0; i < count; ++i) {
+		switch (typeDist(rne)) {
+			case 0: components.emplace_back(std::in_place_type<Position>); break;
+			case 1: components.emplace_back(std::in_place_type<Rotation>); break;
+			case 2: components.emplace_back(std::in_place_type<Cooldown>); break;
+		}
+	}
+}
+
+
+static void PolymorphicIteration(std::vector<BenchmarkResult>& results) {
+	for (size_t count : { size_t(1) << 10, size_t(1) << 16, size_t(1) << 20 }) {
+		int repetitions = int(std::max(size_t(1), (size_t(1) << 24) / count));
+
+		PolymorphicVector<Component> pointers;
+		Fill(pointers, count);
+		double pointerTime = UpdateAll(pointers, repetitions);
+
+		ContiguousPolymorphicVector<Component> contiguous;
+		Fill(contiguous, count);
+		double contiguousTime = UpdateAll(contiguous, repetitions);
+
+		BucketedPolymorphicVector<Component> bucketed;
+		Fill(bucketed, count);
+		double bucketedTime = UpdateAll(bucketed, repetitions);
+
+		// The component types are final, so the calls are devirtualized and inlined.
+		auto start = Clock::now();
+		for (int r = 0; r < repetitions; ++r) {
+			bucketed.ForEachByType<Position, Rotation, Cooldown>([](auto& component) {
+				component.Update(0.016f);
+			});
+		}
+		double byTypeTime = Nanoseconds(start, Clock::now()) / (double(repetitions) * count);
+
+		results.push_back({ "Polymorphic iteration",
+							{ { "container", "PolymorphicVector" }, { "elements", std::to_string(count) } },
+							{ { "ns_per_element", pointerTime } } });
+		results.push_back({ "Polymorphic iteration",
+							{ { "container", "ContiguousPolymorphicVector" }, { "elements", std::to_string(count) } },
+							{ { "ns_per_element", contiguousTime } } });
+		results.push_back({ "Polymorphic iteration",
+							{ { "container", "BucketedPolymorphicVector" }, { "elements", std::to_string(count) } },
+							{ { "ns_per_element", bucketedTime } } });
+		results.push_back({ "Polymorphic iteration",
+							{ { "container", "BucketedPolymorphicVector, by type" }, { "elements", std::to_string(count) } },
+							{ { "ns_per_element", byTypeTime } } });
+	}
+}
+
+
+static BenchmarkRegistrar polymorphicIteration("Polymorphic iteration", &PolymorphicIteration);
@@ -0,0 +1,297 @@
+#include "Benchmark.hpp"
+
+#include <InlineLib/JobSystem/ConditionVariable.hpp>
+#include <InlineLib/JobSystem/Fence.hpp>
+#include <InlineLib/JobSystem/Mutex.hpp>
+#include <InlineLib/JobSystem/SharedFuture.hpp>
+#include <InlineLib/JobSystem/TaskGroup.hpp>
+#include <InlineLib/JobSystem/ThreadpoolScheduler.hpp>
+
+#include <string>
+
+
+using namespace inl::jobs;
+using namespace inl::bench;
+using Clock = std::chrono::high_resolution_clock;
+
+
+// Enqueues an empty task and waits for it, one at a time.
+// Reports the cost of the Enqueue call and the time until the result is available.
+static void EmptyTaskLatency(std::vector<BenchmarkResult>& results) {
+	constexpr int iterations = 10000;
+
+	ThreadpoolScheduler scheduler(4);
+	std::vector<double> enqueueLatencies;
+	std::vector<double> completeLatencies;
+	enqueueLatencies.reserve(iterations);
+	completeLatencies.reserve(iterations);
+
+	for (int i = 0; i < iterations; ++i) {
+		auto start = Clock::now();
+		auto future = scheduler.Enqueue([] {});
+		auto enqueued = Clock::now();
+		future.get();
+		auto completed = Clock::now();
+
+		enqueueLatencies.push_back(Nanoseconds(start, enqueued));
+		completeLatencies.push_back(Nanoseconds(start, completed));
+	}
+
+	results.push_back({ "Empty task",
+						{ { "threads", "4" } },
+						{ { "enqueue_p50_ns", Percentile(enqueueLatencies, 0.50) },
+						  { "enqueue_p99_ns", Percentile(enqueueLatencies, 0.99) },
+						  { "complete_p50_ns", Percentile(completeLatencies, 0.50) },
+						  { "complete_p99_ns", Percentile(completeLatencies, 0.99) } } });
+}
+
+
+// A root task spawns many small children and awaits all of them.
+static void FanOutFanIn(std::vector<BenchmarkResult>& results) {
+	constexpr int childCount = 20000;
+
+	for (int workerCount : { 1, 2, 4, 8, 16, 32, 64 }) {
+		ThreadpoolScheduler scheduler(workerCount);
+
+		auto child = [](int value) {
+			volatile int sink = value * value;
+			(void)sink;
+		};
+		auto root = [&scheduler, &child]() -> SharedFuture<void> {
+			std::vector<SharedFuture<void>> children;
+			children.reserve(childCount);
+			for (int i = 0; i < childCount; ++i) {
+				children.push_back(scheduler.Enqueue(child, i));
+			}
+			for (auto& c : children) {
+				co_await c;
+			}
+		};
+
+		auto start = Clock::now();
+		scheduler.Enqueue(root).get();
+		auto end = Clock::now();
+
+		double elapsed = Nanoseconds(start, end);
+		results.push_back({ "Fan-out fan-in",
+							{ { "workers", std::to_string(workerCount) },
+							  { "children", std::to_string(childCount) } },
+							{ { "total_ns", elapsed },
+							  { "tasks_per_sec", childCount / (elapsed * 1e-9) } } });
+	}
+}
+
+
+
+// A root task spawns many small children into a task group and joins them.
+// Function children cost the group's child frame, coroutine children also cost their own frame and shared state.
+static void TaskGroupSpawn(std::vector<BenchmarkResult>& results) {
+	constexpr int childCount = 20000;
+
+	for (bool coroutineChildren : { false, true }) {
+		ThreadpoolScheduler scheduler(4);
+
+		auto functionChild = [](int value) {
+			volatile int sink = value * value;
+			(void)sink;
+		};
+		auto coroutineChild = [](int value) -> SharedFuture<void> {
+			volatile int sink = value * value;
+			(void)sink;
+			co_return;
+		};
+		auto root = [&]() -> SharedFuture<void> {
+			TaskGroup group;
+			for (int i = 0; i < childCount; ++i) {
+				if (coroutineChildren) {
+					group.Spawn(scheduler, coroutineChild, i);
+				}
+				else {
+					group.Spawn(scheduler, functionChild, i);
+				}
+			}
+			co_await group.Join();
+		};
+
+		auto start = Clock::now();
+		scheduler.Enqueue(root).get();
+		auto end = Clock::now();
+
+		double elapsed = Nanoseconds(start, end);
+		results.push_back({ "Task group spawn",
+							{ { "children", std::to_string(childCount) },
+							  { "child", coroutineChildren ? "coroutine" : "function" } },
+							{ { "total_ns", elapsed },
+							  { "per_child_ns", elapsed / childCount } } });
+	}
+}
+
+// Cost of a single Signal depending on how many coroutines wait on the fence.
+// Half of the waiters are not satisfied by the signal, so putting back waiters is measured as well.
+static void FenceSignal(std::vector<BenchmarkResult>& results) {
+	constexpr int repeats = 20;
+
+	for (int waiterCount : { 1, 16, 256, 4096 }) {
+		std::vector<double> signalTimes;
+		for (int repeat = 0; repeat < repeats; ++repeat) {
+			Fence fence{ 0 };
+			auto waiter = [&fence](uint64_t value) -> SharedFuture<void> {
+				co_await fence.Wait(value);
+			};
+
+			// Without a scheduler, the waiters run inline until they suspend on the fence.
+			std::vector<SharedFuture<void>> waiters;
+			waiters.reserve(waiterCount);
+			for (int i = 0; i < waiterCount; ++i) {
+				waiters.push_back(waiter(i % 2 + 1));
+				waiters.back().Run();
+			}
+
+			auto start = Clock::now();
+			fence.Signal(1);
+			auto end = Clock::now();
+			signalTimes.push_back(Nanoseconds(start, end));
+
+			fence.Signal(2);
+			for (auto& w : waiters) {
+				w.get();
+			}
+		}
+
+		double median = Percentile(signalTimes, 0.5);
+		results.push_back({ "Fence signal",
+							{ { "waiters", std::to_string(waiterCount) } },
+							{ { "signal_ns", median },
+							  { "per_waiter_ns", median / waiterCount } } });
+	}
+}
+
+
+// Many tasks repeatedly lock the same mutex for a very short critical section.
+// Reports the time between starting to wait for the lock and getting it.
+static void MutexContention(std::vector<BenchmarkResult>& results) {
+	constexpr int taskCount = 16;
+	constexpr int iterations = 2000;
+
+	for (int threadCount : { 2, 4, 8 }) {
+		for (eMutexPolicy policy : { eMutexPolicy::FIFO, eMutexPolicy::BARGING }) {
+			ThreadpoolScheduler scheduler(threadCount);
+			Mutex mutex{ policy };
+			size_t counter = 0;
+
+			auto task = [&mutex, &counter](std::vector<double>* latencies) -> SharedFuture<void> {
+				for (int i = 0; i < iterations; ++i) {
+					auto start = Clock::now();
+					co_await mutex.Lock();
+					auto acquired = Clock::now();
+					++counter;
+					mutex.Unlock();
+					latencies->push_back(Nanoseconds(start, acquired));
+				}
+			};
+
+			std::vector<std::vector<double>> taskLatencies(taskCount);
+			std::vector<SharedFuture<void>> futures;
+			auto start = Clock::now();
+			for (auto& latencies : taskLatencies) {
+				latencies.reserve(iterations);
+				futures.push_back(scheduler.Enqueue(task, &latencies));
+			}
+			for (auto& future : futures) {
+				future.get();
+			}
+			auto end = Clock::now();
+
+			std::vector<double> latencies;
+			for (auto& taskLatency : taskLatencies) {
+				latencies.insert(latencies.end(), taskLatency.begin(), taskLatency.end());
+			}
+
+			results.push_back({ "Mutex contention",
+								{ { "policy", policy == eMutexPolicy::FIFO ? "fifo" : "barging" },
+								  { "threads", std::to_string(threadCount) },
+								  { "tasks", std::to_string(taskCount) } },
+								{ { "p50_ns", Percentile(latencies, 0.50) },
+								  { "p99_ns", Percentile(latencies, 0.99) },
+								  { "locks_per_sec", counter / (Nanoseconds(start, end) * 1e-9) } } });
+		}
+	}
+}
+
+
+// Two tasks take turns through a condition variable.
+static void ConditionVariablePingPong(std::vector<BenchmarkResult>& results) {
+	constexpr int rounds = 10000;
+
+	ThreadpoolScheduler scheduler(2);
+	Mutex mutex;
+	ConditionVariable cvar;
+	int turn = 0;
+
+	auto player = [&](int me) -> SharedFuture<void> {
+		UniqueLock lk(mutex);
+		for (int i = 0; i < rounds; ++i) {
+			co_await lk.Lock();
+			while (turn != me) {
+				co_await cvar.Wait(lk);
+			}
+			turn = 1 - me;
+			lk.Unlock();
+			cvar.NotifyOne();
+		}
+	};
+
+	auto start = Clock::now();
+	auto ping = scheduler.Enqueue(player, 0);
+	auto pong = scheduler.Enqueue(player, 1);
+	ping.get();
+	pong.get();
+	auto end = Clock::now();
+
+	double elapsed = Nanoseconds(start, end);
+	results.push_back({ "Condvar ping-pong",
+						{ { "rounds", std::to_string(rounds) } },
+						{ { "total_ns", elapsed },
+						  { "round_trip_ns", elapsed / rounds } } });
+}
+
+
+// Each level awaits the next one until the given depth.
+static SharedFuture<int> AwaitChain(int depth) {
+	if (depth == 0) {
+		co_return 0;
+	}
+	co_return co_await AwaitChain(depth - 1) + 1;
+}
+
+static void DeepAwaitChain(std::vector<BenchmarkResult>& results) {
+	constexpr int repeats = 100;
+
+	for (int depth : { 16, 256, 1024 }) {
+		std::vector<double> times;
+		for (int repeat = 0; repeat < repeats; ++repeat) {
+			auto start = Clock::now();
+			int result = AwaitChain(depth).get();
+			auto end = Clock::now();
+			if (result != depth) {
+				throw std::logic_error("Await chain returned wrong result.");
+			}
+			times.push_back(Nanoseconds(start, end));
+		}
+
+		double median = Percentile(times, 0.5);
+		results.push_back({ "Await chain",
+							{ { "depth", std::to_string(depth) } },
+							{ { "total_ns", median },
+							  { "per_level_ns", median / depth } } });
+	}
+}
+
+
+static BenchmarkRegistrar emptyTaskLatency("Empty task", &EmptyTaskLatency);
+static BenchmarkRegistrar fanOutFanIn("Fan-out fan-in", &FanOutFanIn);
+static BenchmarkRegistrar taskGroupSpawn("Task group spawn", &TaskGroupSpawn);
+static BenchmarkRegistrar fenceSignal("Fence signal", &FenceSignal);
+static BenchmarkRegistrar mutexContention("Mutex contention", &MutexContention);
+static BenchmarkRegistrar conditionVariablePingPong("Condvar ping-pong", &ConditionVariablePingPong);
+static BenchmarkRegistrar deepAwaitChain("Await chain", &DeepAwaitChain);
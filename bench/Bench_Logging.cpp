@@ -0,0 +1,128 @@
+#include "Benchmark.hpp"
+
+#include <InlineLib/Logging/Logger.hpp>
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+
+
+using namespace inl;
+using namespace inl::bench;
+using Clock = std::chrono::high_resolution_clock;
+
+
+namespace {
+
+// Formats everything but discards the output, so that the disk doesn't skew the results.
+class NullBuffer : public std::streambuf {
+public:
+	size_t size = 0;
+
+protected:
+	int overflow(int c) override {
+		++size;
+		return c;
+	}
+	std::streamsize xsputn(const char*, std::streamsize count) override {
+		size += size_t(count);
+		return count;
+	}
+};
+
+const char* PolicyName(eLogOverflowPolicy policy) {
+	switch (policy) {
+		case eLogOverflowPolicy::BLOCK: return "block";
+		case eLogOverflowPolicy::DROP_NEWEST: return "drop_newest";
+		case eLogOverflowPolicy::DROP_OLDEST: return "drop_oldest";
+		case eLogOverflowPolicy::GROW: return "grow";
+	}
+	return "";
+}
+
+} // namespace
+
+
+// Each thread logs into its own stream as fast as it can.
+// Reports the time a thread spends in LogStream::Event, including building the event.
+static void LogEventCost(std::vector<BenchmarkResult>& results) {
+	constexpr int eventCount = 200000;
+
+	for (eLogOverflowPolicy policy : { eLogOverflowPolicy::GROW, eLogOverflowPolicy::BLOCK, eLogOverflowPolicy::DROP_NEWEST, eLogOverflowPolicy::DROP_OLDEST }) {
+		for (int threadCount : { 1, 2, 4, 8 }) {
+			NullBuffer buffer;
+			std::ostream output(&buffer);
+			Logger logger(std::pmr::get_default_resource(), policy);
+			logger.OpenStream(&output);
+
+			std::vector<double> times(threadCount);
+			std::vector<std::thread> threads;
+			for (int t = 0; t < threadCount; ++t) {
+				threads.emplace_back([&, t] {
+					LogStream stream = logger.CreateLogStream("thread" + std::to_string(t));
+					auto start = Clock::now();
+					for (int i = 0; i < eventCount; ++i) {
+						stream.Event(LogEvent("Frame finished", EventParameterInt("frame", i)));
+					}
+					times[t] = Nanoseconds(start, Clock::now()) / eventCount;
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+
+			results.push_back({ "Log event",
+								{ { "policy", PolicyName(policy) }, { "threads", std::to_string(threadCount) } },
+								{ { "ns_per_event", Percentile(times, 0.5) },
+								  { "dropped", double(logger.GetDroppedEventCount()) } } });
+		}
+	}
+}
+
+
+// Many threads log into their own streams, staying below the flush threshold, then a single flush writes it all.
+// Reports the writer's time per event, merging the threads' queues and formatting, and the output size.
+static void LogFlushCost(std::vector<BenchmarkResult>& results) {
+	constexpr int eventCount = 900;
+
+	for (eLogFormat format : { eLogFormat::TEXT, eLogFormat::BINARY }) {
+		for (int threadCount : { 4, 32, 256 }) {
+			NullBuffer buffer;
+			std::ostream output(&buffer);
+			Logger logger;
+			logger.SetFlushInterval(std::chrono::hours(1));
+			logger.OpenStream(&output, format);
+
+			std::vector<LogStream> streams;
+			for (int t = 0; t < threadCount; ++t) {
+				streams.push_back(logger.CreateLogStream("thread" + std::to_string(t)));
+			}
+			std::vector<std::thread> threads;
+			for (int t = 0; t < threadCount; ++t) {
+				threads.emplace_back([&, t] {
+					for (int i = 0; i < eventCount; ++i) {
+						streams[t].Event(LogEvent("Frame finished", EventParameterInt("frame", i), EventParameterFloat("time", i * 0.016f)));
+					}
+				});
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+
+			auto start = Clock::now();
+			logger.Flush();
+			double elapsed = Nanoseconds(start, Clock::now());
+			streams.clear();
+
+			results.push_back({ "Log flush",
+								{ { "format", format == eLogFormat::TEXT ? "text" : "binary" }, { "threads", std::to_string(threadCount) } },
+								{ { "ns_per_event", elapsed / (threadCount * eventCount) },
+								  { "bytes_per_event", double(buffer.size) / (threadCount * eventCount) } } });
+		}
+	}
+}
+
+
+static BenchmarkRegistrar logEventCost("Log event", &LogEventCost);
+static BenchmarkRegistrar logFlushCost("Log flush", &LogFlushCost);
@@ -0,0 +1,290 @@
+#include "Benchmark.hpp"
+
+#include <InlineLib/Memory/BuddyAllocationEngine.hpp>
+#include <InlineLib/Memory/ConcurrentSlabAllocatorEngine.hpp>
+#include <InlineLib/Memory/HeapProfiler.hpp>
+#include <InlineLib/Memory/MultiInstanceTLS.hpp>
+#include <InlineLib/Memory/RingAllocationEngine.hpp>
+#include <InlineLib/Memory/SlabAllocatorEngine.hpp>
+#include <InlineLib/Memory/TlsfAllocationEngine.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+
+using namespace inl;
+using namespace inl::bench;
+using Clock = std::chrono::high_resolution_clock;
+
+
+// Every thread allocates a handful of slots and frees them again, over and over.
+// The single-threaded engine is protected by a mutex for comparison.
+template <class AllocateFunc, class DeallocateFunc>
+static double SlabChurn(int threadCount, AllocateFunc allocate, DeallocateFunc deallocate) {
+	constexpr int iterations = 100000;
+	constexpr int batchSize = 16;
+
+	auto threadFunc = [&] {
+		size_t indices[batchSize];
+		for (int i = 0; i < iterations; i += batchSize) {
+			for (auto& index : indices) {
+				index = allocate();
+			}
+			for (auto& index : indices) {
+				deallocate(index);
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	auto start = Clock::now();
+	for (int i = 0; i < threadCount; ++i) {
+		threads.emplace_back(threadFunc);
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	auto end = Clock::now();
+
+	return double(threadCount) * iterations / (Nanoseconds(start, end) * 1e-9);
+}
+
+
+static void SlabAllocatorScaling(std::vector<BenchmarkResult>& results) {
+	constexpr size_t poolSize = 64 * 1024;
+
+	for (int threadCount : { 1, 2, 4, 8, 16, 32 }) {
+		SlabAllocatorEngine engine(poolSize);
+		std::mutex mtx;
+		double locked = SlabChurn(
+			threadCount,
+			[&] { std::lock_guard<std::mutex> lk(mtx); return engine.Allocate(); },
+			[&](size_t index) { std::lock_guard<std::mutex> lk(mtx); engine.Deallocate(index); });
+
+		ConcurrentSlabAllocatorEngine concurrentEngine(poolSize);
+		double concurrent = SlabChurn(
+			threadCount,
+			[&] { return concurrentEngine.Allocate(); },
+			[&](size_t index) { concurrentEngine.Deallocate(index); });
+
+		results.push_back({ "Slab allocator scaling",
+							{ { "engine", "mutex" }, { "threads", std::to_string(threadCount) } },
+							{ { "allocs_per_sec", locked } } });
+		results.push_back({ "Slab allocator scaling",
+							{ { "engine", "concurrent" }, { "threads", std::to_string(threadCount) } },
+							{ { "allocs_per_sec", concurrent } } });
+	}
+}
+
+
+// Per-frame upload pattern: ranges are freed in the order they were allocated.
+static void RingAllocatorFifo(std::vector<BenchmarkResult>& results) {
+	constexpr int iterations = 200000;
+
+	for (size_t poolSize : { 1024, 65536, 1048576 }) {
+		for (size_t allocationSize : { 1, 16, 256 }) {
+			// Half of the pool is in flight, so the allocations don't run out of space.
+			RingAllocationEngine engine(poolSize);
+			std::deque<size_t> allocations;
+			size_t maxInFlight = std::max(poolSize / allocationSize / 2, size_t(1));
+
+			auto start = Clock::now();
+			for (int i = 0; i < iterations; ++i) {
+				if (allocations.size() == maxInFlight) {
+					engine.Deallocate(allocations.front());
+					allocations.pop_front();
+				}
+				allocations.push_back(engine.Allocate(allocationSize));
+			}
+			auto end = Clock::now();
+
+			results.push_back({ "Ring allocator FIFO",
+								{ { "pool", std::to_string(poolSize) }, { "size", std::to_string(allocationSize) } },
+								{ { "ns_per_alloc", Nanoseconds(start, end) / iterations } } });
+		}
+	}
+}
+
+
+// Variable-size blobs with random lifetimes, sub-allocated from a buffer of 64 byte slots vs. malloc.
+static void BuddyAllocatorChurn(std::vector<BenchmarkResult>& results) {
+	constexpr int iterations = 1000000;
+	constexpr size_t slotSize = 64;
+
+	for (size_t liveCount : { 64, 4096, 65536 }) {
+		auto run = [&](auto allocate, auto deallocate) {
+			std::mt19937 rne(42);
+			std::vector<decltype(allocate(size_t(1)))> live;
+			for (size_t i = 0; i < liveCount; ++i) {
+				live.push_back(allocate(1 + rne() % 32));
+			}
+			auto start = Clock::now();
+			for (int i = 0; i < iterations; ++i) {
+				size_t pick = rne() % live.size();
+				deallocate(live[pick]);
+				live[pick] = allocate(1 + rne() % 32);
+			}
+			auto end = Clock::now();
+			for (auto allocation : live) {
+				deallocate(allocation);
+			}
+			return Nanoseconds(start, end) / iterations;
+		};
+
+		// Average block is about 20 slots after rounding, leave room for fragmentation.
+		BuddyAllocationEngine engine(liveCount * 64);
+		double buddyTime = run([&](size_t size) { return engine.Allocate(size); },
+							   [&](size_t index) { engine.Deallocate(index); });
+		double mallocTime = run([&](size_t size) { return std::malloc(size * slotSize); },
+								[&](void* ptr) { std::free(ptr); });
+
+		results.push_back({ "Buddy allocator churn",
+							{ { "allocator", "buddy" }, { "live", std::to_string(liveCount) } },
+							{ { "ns_per_alloc_free", buddyTime } } });
+		results.push_back({ "Buddy allocator churn",
+							{ { "allocator", "malloc" }, { "live", std::to_string(liveCount) } },
+							{ { "ns_per_alloc_free", mallocTime } } });
+	}
+}
+
+
+// Latency of single allocations and frees with random sizes. TLSF is bounded, malloc's tail
+// is not, e.g. when it has to consolidate free chunks or map more memory.
+static void TlsfAllocatorLatency(std::vector<BenchmarkResult>& results) {
+	constexpr int iterations = 200000;
+	constexpr size_t liveCount = 4096;
+
+	auto run = [&](const char* name, auto allocate, auto deallocate) {
+		std::mt19937 rne(42);
+		std::vector<void*> live;
+		for (size_t i = 0; i < liveCount; ++i) {
+			live.push_back(allocate(16 + rne() % 2048));
+		}
+		std::vector<double> samples;
+		samples.reserve(iterations);
+		for (int i = 0; i < iterations; ++i) {
+			size_t pick = rne() % live.size();
+			size_t size = 16 + rne() % 2048;
+			auto start = Clock::now();
+			deallocate(live[pick]);
+			live[pick] = allocate(size);
+			auto end = Clock::now();
+			samples.push_back(Nanoseconds(start, end));
+		}
+		for (void* ptr : live) {
+			deallocate(ptr);
+		}
+
+		results.push_back({ "TLSF allocator latency",
+							{ { "allocator", name } },
+							{ { "p50_ns", Percentile(samples, 0.5) },
+							  { "p99_9_ns", Percentile(samples, 0.999) },
+							  { "max_ns", *std::max_element(samples.begin(), samples.end()) } } });
+	};
+
+	std::vector<std::byte> region(64 * 1024 * 1024);
+	TlsfAllocationEngine engine(region.data(), region.size());
+	run("tlsf", [&](size_t size) { return engine.Allocate(size); }, [&](void* ptr) { engine.Deallocate(ptr); });
+	run("malloc", [](size_t size) { return std::malloc(size); }, [](void* ptr) { std::free(ptr); });
+}
+
+
+// Every thread bumps a shared counter in a tight loop, then the totals are summed.
+static void ThreadLocalCounter(std::vector<BenchmarkResult>& results) {
+	constexpr int iterations = 1000000;
+
+	for (int threadCount : { 1, 2, 4, 8 }) {
+		auto run = [&](auto threadFunc) {
+			std::vector<std::thread> threads;
+			auto start = Clock::now();
+			for (int i = 0; i < threadCount; ++i) {
+				threads.emplace_back(threadFunc);
+			}
+			for (auto& thread : threads) {
+				thread.join();
+			}
+			return Nanoseconds(start, Clock::now()) / iterations;
+		};
+
+		std::atomic_int64_t atomicCounter = 0;
+		double atomicTime = run([&] {
+			for (int i = 0; i < iterations; ++i) {
+				atomicCounter.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+
+		mi_tls<int64_t> tlsCounter(0);
+		double tlsTime = run([&] {
+			for (int i = 0; i < iterations; ++i) {
+				++tlsCounter.GetRef();
+			}
+		});
+		int64_t total = tlsCounter.Combine([](int64_t a, int64_t b) { return a + b; });
+		if (total != atomicCounter.load()) {
+			throw std::logic_error("Counters don't match.");
+		}
+
+		results.push_back({ "Thread-local counter",
+							{ { "counter", "atomic" }, { "threads", std::to_string(threadCount) } },
+							{ { "ns_per_increment", atomicTime } } });
+		results.push_back({ "Thread-local counter",
+							{ { "counter", "mi_tls" }, { "threads", std::to_string(threadCount) } },
+							{ { "ns_per_increment", tlsTime } } });
+	}
+}
+
+
+// Small allocations freed in batches, reported to the heap profiler like its operator new hooks do.
+static void HeapProfilerOverhead(std::vector<BenchmarkResult>& results) {
+	constexpr int iterations = 1000000;
+	constexpr int batchSize = 64;
+
+	auto run = [&](bool report) {
+		void* pointers[batchSize];
+		auto start = Clock::now();
+		for (int i = 0; i < iterations; i += batchSize) {
+			for (size_t j = 0; j < batchSize; ++j) {
+				pointers[j] = std::malloc(16 + 16 * (j % 8));
+				if (report) {
+					HeapProfiler::OnAllocation(pointers[j], 16 + 16 * (j % 8));
+				}
+			}
+			for (auto ptr : pointers) {
+				if (report) {
+					HeapProfiler::OnDeallocation(ptr);
+				}
+				std::free(ptr);
+			}
+		}
+		return Nanoseconds(start, Clock::now()) / iterations;
+	};
+
+	bool wasRunning = HeapProfiler::IsRunning();
+	HeapProfiler::Stop();
+	double baseline = run(false);
+	double stopped = run(true);
+	HeapProfiler::Start();
+	double running = run(true);
+	if (!wasRunning) {
+		HeapProfiler::Stop();
+	}
+
+	results.push_back({ "Heap profiler overhead", { { "profiler", "none" } }, { { "ns_per_allocation", baseline } } });
+	results.push_back({ "Heap profiler overhead", { { "profiler", "stopped" } }, { { "ns_per_allocation", stopped } } });
+	results.push_back({ "Heap profiler overhead", { { "profiler", "running" } }, { { "ns_per_allocation", running } } });
+}
+
+
+static BenchmarkRegistrar slabAllocatorScaling("Slab allocator scaling", &SlabAllocatorScaling);
+static BenchmarkRegistrar ringAllocatorFifo("Ring allocator FIFO", &RingAllocatorFifo);
+static BenchmarkRegistrar buddyAllocatorChurn("Buddy allocator churn", &BuddyAllocatorChurn);
+static BenchmarkRegistrar tlsfAllocatorLatency("TLSF allocator latency", &TlsfAllocatorLatency);
+static BenchmarkRegistrar threadLocalCounter("Thread-local counter", &ThreadLocalCounter);
+static BenchmarkRegistrar heapProfilerOverhead("Heap profiler overhead", &HeapProfilerOverhead);
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace inl::bench {
+
+
+/// <summary> Measurements of a single benchmark run with a specific set of parameters. </summary>
+struct BenchmarkResult {
+	std::string name;
+	std::vector<std::pair<std::string, std::string>> parameters;
+	std::vector<std::pair<std::string, double>> metrics;
+};
+
+
+using BenchmarkFunc = void (*)(std::vector<BenchmarkResult>& results);
+
+
+/// <summary> Global list of benchmarks, filled by static <see cref="BenchmarkRegistrar"/> objects. </summary>
+struct BenchmarkEntry {
+	std::string name;
+	BenchmarkFunc func;
+};
+
+inline std::vector<BenchmarkEntry>& GetBenchmarks() {
+	static std::vector<BenchmarkEntry> benchmarks;
+	return benchmarks;
+}
+
+
+/// <summary> Create a static instance to register a benchmark. </summary>
+class BenchmarkRegistrar {
+public:
+	BenchmarkRegistrar(std::string name, BenchmarkFunc func) {
+		GetBenchmarks().push_back({ std::move(name), func });
+	}
+};
+
+
+/// <summary> Writes results in a specific format. </summary>
+class BenchmarkReporter {
+public:
+	virtual ~BenchmarkReporter() = default;
+	virtual void Begin(std::ostream&) {}
+	virtual void Report(std::ostream& os, const BenchmarkResult& result) = 0;
+	virtual void End(std::ostream&) {}
+};
+
+
+/// <summary> One human readable line per result. </summary>
+class TextReporter : public BenchmarkReporter {
+public:
+	void Report(std::ostream& os, const BenchmarkResult& result) override {
+		os << result.name;
+		for (const auto& [param, value] : result.parameters) {
+			os << " " << param << "=" << value;
+		}
+		os << ":";
+		for (const auto& [metric, value] : result.metrics) {
+			os << " " << metric << "=" << value;
+		}
+		os << "\n";
+	}
+};
+
+
+/// <summary> One row per metric, parameters are joined into a single column so that rows have the same shape. </summary>
+class CsvReporter : public BenchmarkReporter {
+public:
+	void Begin(std::ostream& os) override {
+		os << "benchmark,parameters,metric,value\n";
+	}
+	void Report(std::ostream& os, const BenchmarkResult& result) override {
+		std::string parameters;
+		for (const auto& [param, value] : result.parameters) {
+			parameters += (parameters.empty() ? "" : ";") + param + "=" + value;
+		}
+		for (const auto& [metric, value] : result.metrics) {
+			os << result.name << "," << parameters << "," << metric << "," << value << "\n";
+		}
+	}
+};
+
+
+/// <summary> A single JSON object with an array of results. </summary>
+class JsonReporter : public BenchmarkReporter {
+public:
+	void Begin(std::ostream& os) override {
+		os << "{\n\t\"results\": [";
+		m_first = true;
+	}
+	void Report(std::ostream& os, const BenchmarkResult& result) override {
+		os << (m_first ? "\n" : ",\n");
+		m_first = false;
+
+		os << "\t\t{ \"name\": ";
+		WriteString(os, result.name);
+		os << ", \"parameters\": {";
+		for (size_t i = 0; i < result.parameters.size(); ++i) {
+			os << (i == 0 ? " " : ", ");
+			WriteString(os, result.parameters[i].first);
+			os << ": ";
+			WriteString(os, result.parameters[i].second);
+		}
+		os << " }, \"metrics\": {";
+		for (size_t i = 0; i < result.metrics.size(); ++i) {
+			os << (i == 0 ? " " : ", ");
+			WriteString(os, result.metrics[i].first);
+			os << ": ";
+			WriteNumber(os, result.metrics[i].second);
+		}
+		os << " } }";
+	}
+	void End(std::ostream& os) override {
+		os << "\n\t]\n}\n";
+	}
+
+private:
+	static void WriteString(std::ostream& os, const std::string& str) {
+		constexpr char hexDigits[] = "0123456789abcdef";
+		os << '"';
+		for (char c : str) {
+			if (c == '"' || c == '\\') {
+				os << '\\' << c;
+			}
+			else if (static_cast<unsigned char>(c) < 0x20) {
+				os << "\\u00" << hexDigits[c >> 4] << hexDigits[c & 0xF];
+			}
+			else {
+				os << c;
+			}
+		}
+		os << '"';
+	}
+
+	// JSON has no NaN or infinity.
+	static void WriteNumber(std::ostream& os, double value) {
+		if (std::isfinite(value)) {
+			os << value;
+		}
+		else {
+			os << "null";
+		}
+	}
+
+	bool m_first = true;
+};
+
+
+/// <summary> Returns the value below which the given fraction of the samples fall. Reorders the samples. </summary>
+inline double Percentile(std::vector<double>& samples, double fraction) {
+	if (samples.empty()) {
+		return 0.0;
+	}
+	size_t index = std::min(samples.size() - 1, size_t(fraction * samples.size()));
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
+
+
+/// <summary> Nanoseconds elapsed between two time points as floating point. </summary>
+inline double Nanoseconds(std::chrono::high_resolution_clock::time_point start, std::chrono::high_resolution_clock::time_point end) {
+	return std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+
+} // namespace inl::bench
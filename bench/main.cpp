@@ -0,0 +1,72 @@
+#include "Benchmark.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+using namespace inl::bench;
+
+
+// Usage: InlineBench [--format=text|csv|json] [--output=<file>] [filter]
+// The filter selects benchmarks whose name contains it.
+int main(int argc, char* argv[]) {
+	std::string filter;
+	std::string format = "text";
+	std::string outputPath;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		if (arg.rfind("--format=", 0) == 0) {
+			format = arg.substr(9);
+		}
+		else if (arg.rfind("--output=", 0) == 0) {
+			outputPath = arg.substr(9);
+		}
+		else {
+			filter = arg;
+		}
+	}
+
+	std::unique_ptr<BenchmarkReporter> reporter;
+	if (format == "csv") {
+		reporter = std::make_unique<CsvReporter>();
+	}
+	else if (format == "json") {
+		reporter = std::make_unique<JsonReporter>();
+	}
+	else if (format == "text") {
+		reporter = std::make_unique<TextReporter>();
+	}
+	else {
+		std::cerr << "Unknown format: " << format << std::endl;
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (!outputPath.empty()) {
+		outputFile.open(outputPath, std::ios::out | std::ios::trunc);
+		if (!outputFile.is_open()) {
+			std::cerr << "Could not open output file: " << outputPath << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& os = outputFile.is_open() ? outputFile : std::cout;
+
+	reporter->Begin(os);
+	for (const auto& benchmark : GetBenchmarks()) {
+		if (benchmark.name.find(filter) == std::string::npos) {
+			continue;
+		}
+
+		std::vector<BenchmarkResult> results;
+		benchmark.func(results);
+
+		for (const auto& result : results) {
+			reporter->Report(os, result);
+		}
+		os.flush();
+	}
+	reporter->End(os);
+
+	return 0;
+}
@@ -1,3 +1,5 @@
+#pragma once
+
 #include <iterator>
 #include <type_traits>
 #include <cassert>
@@ -37,7 +39,7 @@ namespace impl {
 
 		// basic
 		T& operator*() { return *ptr; }
-		T* operator->() { return *ptr; }
+		T* operator->() { return ptr; }
 
 		bool operator==(const iterator_impl& rhs) const { return ptr == rhs.ptr; }
 		bool operator!=(const iterator_impl& rhs) const { return !(*this == rhs); }
@@ -74,12 +76,12 @@ namespace impl {
 		}
 		iterator_impl operator+(difference_type n) const {
 			iterator_impl tmp(*this);
-			ptr += n;
+			tmp.ptr += n;
 			return tmp;
 		}
 		iterator_impl operator-(difference_type n) const {
 			iterator_impl tmp(*this);
-			ptr -= n;
+			tmp.ptr -= n;
 			return tmp;
 		}
 		difference_type operator-(const iterator_impl& rhs) const { return ptr - rhs.ptr; }
@@ -102,12 +104,15 @@ namespace impl {
 
 		class iterator : public iterator_impl<type> {
 			template <class ViewU>
-			friend class ArrayView;
+			friend class inl::ArrayView;
 			template <class ViewU>
 			friend class const_iterator;
 
 		public:
-			using iterator_impl<type>::iterator_impl;
+			iterator() = default;
+
+		private:
+			iterator(type* ptr) : iterator_impl<type>(ptr) {}
 		};
 	};
 
@@ -120,13 +125,16 @@ namespace impl {
 	template <class ViewT>
 	class const_iterator : public iterator_impl<const ViewT> {
 		template <class ViewU>
-		friend class ArrayView;
+		friend class inl::ArrayView;
 
 	public:
-		using iterator_impl<const ViewT>::iterator_impl;
+		const_iterator() = default;
 
 		// Convert from mutable iterators.
-		const_iterator(typename HasIterator<ViewT>::iterator& rhs) : iterator_impl(rhs.ptr) {}
+		const_iterator(typename HasIterator<ViewT>::iterator& rhs) : iterator_impl<const ViewT>(rhs.ptr) {}
+
+	private:
+		const_iterator(const ViewT* ptr) : iterator_impl<const ViewT>(ptr) {}
 	};
 
 
@@ -157,8 +165,8 @@ public:
 	/// <param name="size"> Number of elements in the array. </summary>
 	/// <param name="stride"> Size of an element in bytes. Typically sizeof(*array). </summary>
 	/// <exception cref="std::bad_cast"> When given array cannot be dynamically cast to view type. </summary>
-	template <class ArrayT, class = std::enable_if_t<IsConst>>
-	ArrayView(const ArrayT* array, size_t size, size_t stride) {
+	template <class ArrayT>
+	ArrayView(const ArrayT* array, size_t size, size_t stride) requires IsConst {
 		Init(array, size, stride);
 	}
 
@@ -167,8 +175,8 @@ public:
 	/// <param name="size"> Number of elements in the array. </summary>
 	/// <param name="stride"> Size of an element in bytes. Typically sizeof(*array). </summary>
 	/// <exception cref="std::bad_cast"> When given array cannot be dynamically cast to view type. </summary>
-	template <class ArrayT, class = std::enable_if_t<!IsConst>>
-	ArrayView(ArrayT* array, size_t size, size_t stride) {
+	template <class ArrayT>
+	ArrayView(ArrayT* array, size_t size, size_t stride) requires(!IsConst) {
 		static_assert(!std::is_const_v<ArrayT>, "You cannot initalize a mutable view with a const array.");
 		Init(array, size, stride);
 	}
@@ -180,8 +188,8 @@ public:
 	/// <param name="size"> Number of elements in the array. </summary>
 	/// <param name="stride"> Size of an element in bytes. Typically sizeof(*array). </summary>
 	/// <exception cref="std::bad_cast"> When given array cannot be dynamically cast to view type. </summary>
-	template <class ArrayT, class = std::enable_if_t<IsConst>>
-	void Set(const ArrayT* array, size_t size, size_t stride) {
+	template <class ArrayT>
+	void Set(const ArrayT* array, size_t size, size_t stride) requires IsConst {
 		Init(array, size, stride);
 	}
 
@@ -190,8 +198,8 @@ public:
 	/// <param name="size"> Number of elements in the array. </summary>
 	/// <param name="stride"> Size of an element in bytes. Typically sizeof(*array). </summary>
 	/// <exception cref="std::bad_cast"> When given array cannot be dynamically cast to view type. </summary>
-	template <class ArrayT, class = std::enable_if_t<!IsConst>>
-	void Set(ArrayT* array, size_t size, size_t stride) {
+	template <class ArrayT>
+	void Set(ArrayT* array, size_t size, size_t stride) requires(!IsConst) {
 		static_assert(!std::is_const_v<ArrayT>, "You cannot initalize a mutable view with a const array.");
 		Init(array, size, stride);
 	}
@@ -210,8 +218,7 @@ public:
 
 
 	/// <summary> Access array by index. </summary>
-	template <class = std::enable_if_t<!IsConst, const int>>
-	ViewT& operator[](size_t idx) {
+	ViewT& operator[](size_t idx) requires(!IsConst) {
 		assert(idx < m_size);
 		return *GetOffsetedPointer(idx);
 	}
@@ -222,13 +229,11 @@ public:
 	}
 
 	/// <summary> Get mutable iterator to the first element of the container. </summary>
-	template <class Q = typename impl::HasIterator<ViewT>::iterator>
-	Q begin() {
+	typename impl::HasIterator<ViewT>::iterator begin() requires(!IsConst) {
 		return typename impl::HasIterator<ViewT>::iterator{ GetOffsetedPointer(0) };
 	}
 	/// <summary> Get mutable iterator to the end (past the last element) of the container. </summary>
-	template <class Q = typename impl::HasIterator<ViewT>::iterator>
-	Q end() {
+	typename impl::HasIterator<ViewT>::iterator end() requires(!IsConst) {
 		return typename impl::HasIterator<ViewT>::iterator{ GetOffsetedPointer(Size()) };
 	}
 
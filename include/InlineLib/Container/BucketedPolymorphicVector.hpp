@@ -0,0 +1,481 @@
+#pragma once
+
+#include "ContiguousPolymorphicVector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace inl {
+
+
+enum class eBucketOrder {
+	RELAXED, // Elements are ordered bucket by bucket, insertion order is only kept within a bucket.
+	INSERTION, // Iteration and indexing follow insertion order, at the cost of an extra table.
+};
+
+
+/// <summary>
+/// A vector of objects derived from <typeparamref name="T"/>, grouped into buckets by their dynamic type.
+/// </summary>
+/// <remarks>
+/// <para> Each bucket is a <see cref="ContiguousPolymorphicVector"/> holding a single type, so its elements
+///		form a plain array. <see cref="ForEachByType"/> visits the buckets one after the other, calling the
+///		visitor with the static type of the bucket, which lets the calls be inlined. Even through a reference
+///		to T, calling a virtual function on a run of the same type is predicted perfectly, unlike on a mix. </para>
+/// <para> The bucket of a type is found by a linear search, which is fine for the handful of types a
+///		collection usually has. </para>
+/// <para> With <see cref="eBucketOrder::RELAXED"/>, element indices refer to the order of iteration,
+///		which changes when an element of an earlier bucket is added or removed. </para>
+/// </remarks>
+template <class T, template <class U> class Alloc = std::allocator>
+class BucketedPolymorphicVector {
+	using BucketElements = ContiguousPolymorphicVector<T, Alloc>;
+
+	struct Bucket {
+		const void* typeId;
+		BucketElements elements;
+	};
+
+	struct Position {
+		size_t bucket;
+		size_t index;
+	};
+
+	template <bool Const>
+	class Iterator;
+
+public:
+	// Types
+	using allocator_type = typename BucketElements::allocator_type;
+	using const_pointer = const T*;
+	using const_reference = const T&;
+	using pointer = T*;
+	using reference = T&;
+	using size_type = std::size_t;
+	using value_type = T;
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	// Construction
+	explicit BucketedPolymorphicVector(eBucketOrder order = eBucketOrder::RELAXED, const allocator_type& alloc = allocator_type());
+	BucketedPolymorphicVector(BucketedPolymorphicVector&& other) noexcept = default;
+	BucketedPolymorphicVector& operator=(BucketedPolymorphicVector&& other) = default;
+
+	allocator_type get_allocator() const;
+	eBucketOrder GetOrder() const noexcept;
+
+	// Element access
+	reference at(size_type pos);
+	const_reference at(size_type pos) const;
+	reference operator[](size_type index);
+	const_reference operator[](size_type index) const;
+
+	// Iterators
+	[[nodiscard]] iterator begin();
+	[[nodiscard]] iterator end();
+	[[nodiscard]] const_iterator begin() const;
+	[[nodiscard]] const_iterator end() const;
+	[[nodiscard]] const_iterator cbegin() const;
+	[[nodiscard]] const_iterator cend() const;
+
+	// Capacity
+	bool empty() const noexcept;
+	size_type size() const noexcept;
+	size_type bucket_count() const noexcept;
+	/// <summary> Reserves room for <paramref name="count"/> elements of type <typeparamref name="U"/>. </summary>
+	template <class U>
+	void reserve(size_type count);
+
+	// Modify
+	void clear() noexcept;
+	template <class U, class... Args>
+	reference emplace_back(std::in_place_type_t<U>, Args&&... args);
+	template <class U>
+	void push_back(U&& value);
+	void erase(size_type index);
+
+	// Visitors
+	/// <summary> Calls <paramref name="func"/> with each element as T, in the order of the container. </summary>
+	template <class Func>
+	void ForEach(Func&& func);
+	template <class Func>
+	void ForEach(Func&& func) const;
+
+	/// <summary> Calls <paramref name="func"/> bucket by bucket, with each element as its dynamic type if that is
+	///		listed in <typeparamref name="Types"/>, or as T otherwise. </summary>
+	/// <remarks> Ignores the insertion order. The listed types must not be virtual bases of T.
+	///		Mark them final, or call their members qualified, to have calls devirtualized. </remarks>
+	template <class... Types, class Func>
+	void ForEachByType(Func&& func);
+	template <class... Types, class Func>
+	void ForEachByType(Func&& func) const;
+
+private:
+	template <class U>
+	static const void* TypeId() noexcept;
+	template <class U>
+	Bucket& GetBucket();
+	Position Locate(size_type index) const;
+
+	template <class U, class BucketT, class Func>
+	static bool VisitBucket(BucketT& bucket, Func& func);
+
+private:
+	template <class U>
+	static constexpr char typeTag = 0;
+
+	std::vector<Bucket, Alloc<Bucket>> m_buckets;
+	std::vector<Position, Alloc<Position>> m_order; // Only with INSERTION order.
+	size_t m_size = 0;
+	size_t m_lastBucket = 0;
+	eBucketOrder m_orderType;
+};
+
+
+//------------------------------------------------------------------------------
+// Iterator.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+template <bool Const>
+class BucketedPolymorphicVector<T, Alloc>::Iterator {
+	using Owner = std::conditional_t<Const, const BucketedPolymorphicVector, BucketedPolymorphicVector>;
+
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using pointer = std::conditional_t<Const, const T*, T*>;
+	using reference = std::conditional_t<Const, const T&, T&>;
+
+	Iterator() = default;
+	template <bool OtherConst>
+	Iterator(const Iterator<OtherConst>& other) requires(Const && !OtherConst)
+		: m_owner(other.m_owner), m_position(other.m_position), m_bucket(other.m_bucket), m_index(other.m_index) {}
+
+	reference operator*() const {
+		if (m_owner->m_orderType == eBucketOrder::INSERTION) {
+			const Position& position = m_owner->m_order[m_position];
+			return m_owner->m_buckets[position.bucket].elements[position.index];
+		}
+		return m_owner->m_buckets[m_bucket].elements[m_index];
+	}
+	pointer operator->() const { return &**this; }
+
+	Iterator& operator++() {
+		++m_position;
+		if (m_owner->m_orderType == eBucketOrder::RELAXED) {
+			++m_index;
+			SkipEmpty();
+		}
+		return *this;
+	}
+	Iterator operator++(int) {
+		Iterator copy = *this;
+		++*this;
+		return copy;
+	}
+
+	bool operator==(const Iterator& rhs) const { return m_position == rhs.m_position; }
+
+private:
+	friend class BucketedPolymorphicVector;
+	friend class Iterator<!Const>;
+	Iterator(Owner* owner, size_t position) : m_owner(owner), m_position(position) {
+		if (m_owner->m_orderType == eBucketOrder::RELAXED && m_position < m_owner->m_size) {
+			SkipEmpty();
+		}
+	}
+
+	void SkipEmpty() {
+		while (m_bucket < m_owner->m_buckets.size() && m_index == m_owner->m_buckets[m_bucket].elements.size()) {
+			++m_bucket;
+			m_index = 0;
+		}
+	}
+
+	Owner* m_owner = nullptr;
+	size_t m_position = 0;
+	size_t m_bucket = 0; // Only with RELAXED order.
+	size_t m_index = 0;
+};
+
+
+//------------------------------------------------------------------------------
+// Construction.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+BucketedPolymorphicVector<T, Alloc>::BucketedPolymorphicVector(eBucketOrder order, const allocator_type& alloc)
+	: m_buckets{ Alloc<Bucket>(alloc) }, m_order{ Alloc<Position>(alloc) }, m_orderType(order) {}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::allocator_type BucketedPolymorphicVector<T, Alloc>::get_allocator() const {
+	return allocator_type(m_buckets.get_allocator());
+}
+
+template <class T, template <class U> class Alloc>
+eBucketOrder BucketedPolymorphicVector<T, Alloc>::GetOrder() const noexcept {
+	return m_orderType;
+}
+
+
+//------------------------------------------------------------------------------
+// Element access.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::reference BucketedPolymorphicVector<T, Alloc>::at(size_type pos) {
+	if (pos >= m_size) {
+		throw std::out_of_range("BucketedPolymorphicVector index out of range.");
+	}
+	return (*this)[pos];
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::const_reference BucketedPolymorphicVector<T, Alloc>::at(size_type pos) const {
+	if (pos >= m_size) {
+		throw std::out_of_range("BucketedPolymorphicVector index out of range.");
+	}
+	return (*this)[pos];
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::reference BucketedPolymorphicVector<T, Alloc>::operator[](size_type index) {
+	Position position = Locate(index);
+	return m_buckets[position.bucket].elements[position.index];
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::const_reference BucketedPolymorphicVector<T, Alloc>::operator[](size_type index) const {
+	Position position = Locate(index);
+	return m_buckets[position.bucket].elements[position.index];
+}
+
+
+//------------------------------------------------------------------------------
+// Iterators.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::iterator BucketedPolymorphicVector<T, Alloc>::begin() {
+	return iterator{ this, 0 };
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::iterator BucketedPolymorphicVector<T, Alloc>::end() {
+	return iterator{ this, m_size };
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::const_iterator BucketedPolymorphicVector<T, Alloc>::begin() const {
+	return const_iterator{ this, 0 };
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::const_iterator BucketedPolymorphicVector<T, Alloc>::end() const {
+	return const_iterator{ this, m_size };
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::const_iterator BucketedPolymorphicVector<T, Alloc>::cbegin() const {
+	return begin();
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::const_iterator BucketedPolymorphicVector<T, Alloc>::cend() const {
+	return end();
+}
+
+
+//------------------------------------------------------------------------------
+// Capacity.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+bool BucketedPolymorphicVector<T, Alloc>::empty() const noexcept {
+	return m_size == 0;
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::size_type BucketedPolymorphicVector<T, Alloc>::size() const noexcept {
+	return m_size;
+}
+
+template <class T, template <class U> class Alloc>
+typename BucketedPolymorphicVector<T, Alloc>::size_type BucketedPolymorphicVector<T, Alloc>::bucket_count() const noexcept {
+	return m_buckets.size();
+}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+void BucketedPolymorphicVector<T, Alloc>::reserve(size_type count) {
+	GetBucket<U>().elements.reserve(count, sizeof(U));
+	if (m_orderType == eBucketOrder::INSERTION) {
+		m_order.reserve(m_size + count);
+	}
+}
+
+
+//------------------------------------------------------------------------------
+// Modify.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+void BucketedPolymorphicVector<T, Alloc>::clear() noexcept {
+	// Buckets are kept, most likely the same types will be added again.
+	for (auto& bucket : m_buckets) {
+		bucket.elements.clear();
+	}
+	m_order.clear();
+	m_size = 0;
+}
+
+template <class T, template <class U> class Alloc>
+template <class U, class... Args>
+typename BucketedPolymorphicVector<T, Alloc>::reference BucketedPolymorphicVector<T, Alloc>::emplace_back(std::in_place_type_t<U>, Args&&... args) {
+	Bucket& bucket = GetBucket<U>();
+	if (m_orderType == eBucketOrder::INSERTION && m_order.size() == m_order.capacity()) {
+		m_order.reserve(std::max(size_t(8), 2 * m_order.size()));
+	}
+	T& element = bucket.elements.emplace_back(std::in_place_type<U>, std::forward<Args>(args)...);
+	if (m_orderType == eBucketOrder::INSERTION) {
+		m_order.push_back(Position{ m_lastBucket, bucket.elements.size() - 1 });
+	}
+	++m_size;
+	return element;
+}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+void BucketedPolymorphicVector<T, Alloc>::push_back(U&& value) {
+	emplace_back(std::in_place_type<std::decay_t<U>>, std::forward<U>(value));
+}
+
+template <class T, template <class U> class Alloc>
+void BucketedPolymorphicVector<T, Alloc>::erase(size_type index) {
+	Position position = Locate(index);
+	auto& elements = m_buckets[position.bucket].elements;
+	elements.erase(elements.begin() + position.index);
+	if (m_orderType == eBucketOrder::INSERTION) {
+		m_order.erase(m_order.begin() + index);
+		for (auto& other : m_order) {
+			if (other.bucket == position.bucket && other.index > position.index) {
+				--other.index;
+			}
+		}
+	}
+	--m_size;
+}
+
+
+//------------------------------------------------------------------------------
+// Visitors.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+template <class Func>
+void BucketedPolymorphicVector<T, Alloc>::ForEach(Func&& func) {
+	for (T& element : *this) {
+		func(element);
+	}
+}
+
+template <class T, template <class U> class Alloc>
+template <class Func>
+void BucketedPolymorphicVector<T, Alloc>::ForEach(Func&& func) const {
+	for (const T& element : *this) {
+		func(element);
+	}
+}
+
+template <class T, template <class U> class Alloc>
+template <class... Types, class Func>
+void BucketedPolymorphicVector<T, Alloc>::ForEachByType(Func&& func) {
+	for (Bucket& bucket : m_buckets) {
+		if (!(false || ... || VisitBucket<Types>(bucket, func))) {
+			for (T& element : bucket.elements) {
+				func(element);
+			}
+		}
+	}
+}
+
+template <class T, template <class U> class Alloc>
+template <class... Types, class Func>
+void BucketedPolymorphicVector<T, Alloc>::ForEachByType(Func&& func) const {
+	for (const Bucket& bucket : m_buckets) {
+		if (!(false || ... || VisitBucket<Types>(bucket, func))) {
+			for (const T& element : bucket.elements) {
+				func(element);
+			}
+		}
+	}
+}
+
+template <class T, template <class U> class Alloc>
+template <class U, class BucketT, class Func>
+bool BucketedPolymorphicVector<T, Alloc>::VisitBucket(BucketT& bucket, Func& func) {
+	static_assert(std::is_base_of_v<T, U>, "Visited types must be derived from T.");
+	if (bucket.typeId != TypeId<U>()) {
+		return false;
+	}
+	using Element = std::conditional_t<std::is_const_v<BucketT>, const U, U>;
+	for (auto& element : bucket.elements) {
+		func(static_cast<Element&>(element));
+	}
+	return true;
+}
+
+
+//------------------------------------------------------------------------------
+// Buckets.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+template <class U>
+const void* BucketedPolymorphicVector<T, Alloc>::TypeId() noexcept {
+	return &typeTag<U>;
+}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+auto BucketedPolymorphicVector<T, Alloc>::GetBucket() -> Bucket& {
+	const void* typeId = TypeId<U>();
+	if (m_lastBucket < m_buckets.size() && m_buckets[m_lastBucket].typeId == typeId) {
+		return m_buckets[m_lastBucket];
+	}
+	for (size_t i = 0; i < m_buckets.size(); ++i) {
+		if (m_buckets[i].typeId == typeId) {
+			m_lastBucket = i;
+			return m_buckets[i];
+		}
+	}
+	m_buckets.push_back(Bucket{ typeId, BucketElements(get_allocator()) });
+	m_lastBucket = m_buckets.size() - 1;
+	return m_buckets.back();
+}
+
+template <class T, template <class U> class Alloc>
+auto BucketedPolymorphicVector<T, Alloc>::Locate(size_type index) const -> Position {
+	if (m_orderType == eBucketOrder::INSERTION) {
+		return m_order[index];
+	}
+	size_t bucket = 0;
+	while (index >= m_buckets[bucket].elements.size()) {
+		index -= m_buckets[bucket].elements.size();
+		++bucket;
+	}
+	return Position{ bucket, index };
+}
+
+
+} // namespace inl
\ No newline at end of file
@@ -0,0 +1,768 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace inl {
+
+/// <summary>
+/// A vector of objects derived from <typeparamref name="T"/>, accessed as references to T,
+/// with the objects themselves stored back to back in a single buffer.
+/// </summary>
+/// <remarks>
+/// <para> Unlike <see cref="PolymorphicVector"/>, there is no heap allocation per element.
+///		Objects are placed in a byte arena in insertion order, each aligned for its dynamic type,
+///		and a table records the offset and size of each. Iterating is then a linear walk
+///		through memory instead of chasing a pointer per element. </para>
+/// <para> When the arena runs out of space, it's reallocated and the elements are move constructed
+///		into the new one, so like std::vector, growing invalidates references and iterators.
+///		Element types must be move or copy constructible, and must not be over-aligned. </para>
+/// <para> Elements can only be added at the end. Erasing moves the elements after the erased ones down. </para>
+/// </remarks>
+template <class T, template <class U> class Alloc = std::allocator>
+class ContiguousPolymorphicVector {
+	static constexpr size_t ArenaAlignment = alignof(std::max_align_t);
+
+	struct alignas(ArenaAlignment) Block {
+		std::byte bytes[ArenaAlignment];
+	};
+
+public:
+	using allocator_type = Alloc<std::byte>;
+
+private:
+	/// <summary> Operations on the dynamic type of an element, one static instance per type. </summary>
+	struct ElementOps {
+		void (*moveConstruct)(const allocator_type& alloc, std::byte* from, std::byte* to);
+		void (*destroy)(const allocator_type& alloc, std::byte* object) noexcept;
+		size_t alignment;
+		bool nothrowMove;
+	};
+
+	struct Entry {
+		size_t offset; // Start of the object in the arena.
+		uint32_t size; // Size of the dynamic type.
+		uint32_t baseOffset; // Offset of the T subobject from the start of the object.
+		const ElementOps* ops;
+	};
+
+	template <bool Const>
+	class Iterator;
+
+public:
+	// Types
+	using const_pointer = const T*;
+	using const_reference = const T&;
+	using pointer = T*;
+	using reference = T&;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using value_type = T;
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+	using reverse_iterator = std::reverse_iterator<iterator>;
+	using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+	// Construction
+	ContiguousPolymorphicVector() noexcept(noexcept(allocator_type()));
+	explicit ContiguousPolymorphicVector(const allocator_type& alloc) noexcept;
+	template <class U>
+	ContiguousPolymorphicVector(std::initializer_list<U> init, const allocator_type& alloc = allocator_type());
+	template <class... Items>
+	ContiguousPolymorphicVector(Items&&... items) requires std::conjunction_v<std::is_convertible<std::decay_t<Items>*, T*>...>;
+	ContiguousPolymorphicVector(ContiguousPolymorphicVector&& other) noexcept;
+	~ContiguousPolymorphicVector();
+
+	ContiguousPolymorphicVector& operator=(ContiguousPolymorphicVector&& other);
+
+	allocator_type get_allocator() const;
+
+	// Element access
+	reference at(size_type pos);
+	const_reference at(size_type pos) const;
+
+	reference operator[](size_type index);
+	const_reference operator[](size_type index) const;
+
+	reference back();
+	const_reference back() const;
+	reference front();
+	const_reference front() const;
+
+	// Iterators
+	[[nodiscard]] iterator begin();
+	[[nodiscard]] iterator end();
+	[[nodiscard]] const_iterator begin() const;
+	[[nodiscard]] const_iterator end() const;
+	[[nodiscard]] const_iterator cbegin() const;
+	[[nodiscard]] const_iterator cend() const;
+	[[nodiscard]] reverse_iterator rbegin();
+	[[nodiscard]] reverse_iterator rend();
+	[[nodiscard]] const_reverse_iterator rbegin() const;
+	[[nodiscard]] const_reverse_iterator rend() const;
+	[[nodiscard]] const_reverse_iterator crbegin() const;
+	[[nodiscard]] const_reverse_iterator crend() const;
+
+	// Capacity
+	size_type capacity() const noexcept;
+	bool empty() const noexcept;
+	size_type max_size() const noexcept;
+	/// <summary> Reserves room in the table for <paramref name="count"/> elements, and in the arena for as many of the given size. </summary>
+	void reserve(size_type count, size_type bytesPerElement = sizeof(T));
+	void shrink_to_fit();
+	size_type size() const noexcept;
+
+	/// <summary> The number of bytes the elements span in the arena, including padding between them. </summary>
+	size_type size_bytes() const noexcept;
+	size_type capacity_bytes() const noexcept;
+
+	// Modify
+	void clear() noexcept;
+	template <class U, class... Args>
+	reference emplace_back(std::in_place_type_t<U>, Args&&... args);
+	template <class U>
+	void push_back(U&& value);
+	void pop_back() noexcept;
+
+	void erase(const_iterator it);
+	void erase(const_iterator first, const_iterator last);
+
+private:
+	std::byte* Object(size_t index) const noexcept;
+	T* Element(size_t index) const noexcept;
+	static size_t AlignUp(size_t offset, size_t alignment) noexcept;
+
+	void Reallocate(size_t capacityBytes);
+	void Deallocate() noexcept;
+	size_t MoveElements(const allocator_type& alloc, std::byte* target, size_t first, size_t last, size_t targetOffset);
+	void DestroyElements(size_t first, size_t last) noexcept;
+	void UpdateOffsets(size_t first) noexcept;
+
+	template <class U>
+	static void MoveElement(const allocator_type& alloc, std::byte* from, std::byte* to);
+	template <class U>
+	static void DestroyElement(const allocator_type& alloc, std::byte* object) noexcept;
+
+	template <class U>
+	static constexpr ElementOps elementOps = {
+		&MoveElement<U>,
+		&DestroyElement<U>,
+		alignof(U),
+		std::is_nothrow_constructible_v<U, decltype(std::move_if_noexcept(std::declval<U&>()))>,
+	};
+
+private:
+	std::vector<Entry, Alloc<Entry>> m_entries;
+	std::byte* m_arena = nullptr;
+	size_t m_capacityBytes = 0;
+	size_t m_sizeBytes = 0;
+};
+
+
+//------------------------------------------------------------------------------
+// Iterator.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+template <bool Const>
+class ContiguousPolymorphicVector<T, Alloc>::Iterator {
+public:
+	using iterator_category = std::random_access_iterator_tag;
+	using value_type = T;
+	using difference_type = std::ptrdiff_t;
+	using pointer = std::conditional_t<Const, const T*, T*>;
+	using reference = std::conditional_t<Const, const T&, T&>;
+
+	Iterator() = default;
+	template <bool OtherConst>
+	Iterator(const Iterator<OtherConst>& other) requires(Const && !OtherConst)
+		: m_arena(other.m_arena), m_entry(other.m_entry) {}
+
+	reference operator*() const { return *operator->(); }
+	pointer operator->() const { return std::launder(reinterpret_cast<pointer>(m_arena + m_entry->offset + m_entry->baseOffset)); }
+	reference operator[](difference_type n) const { return *(*this + n); }
+
+	Iterator& operator++() {
+		++m_entry;
+		return *this;
+	}
+	Iterator operator++(int) {
+		Iterator copy = *this;
+		++m_entry;
+		return copy;
+	}
+	Iterator& operator--() {
+		--m_entry;
+		return *this;
+	}
+	Iterator operator--(int) {
+		Iterator copy = *this;
+		--m_entry;
+		return copy;
+	}
+
+	Iterator& operator+=(difference_type n) {
+		m_entry += n;
+		return *this;
+	}
+	Iterator& operator-=(difference_type n) {
+		m_entry -= n;
+		return *this;
+	}
+	Iterator operator+(difference_type n) const { return Iterator{ m_arena, m_entry + n }; }
+	Iterator operator-(difference_type n) const { return Iterator{ m_arena, m_entry - n }; }
+	friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+	difference_type operator-(const Iterator& rhs) const { return m_entry - rhs.m_entry; }
+
+	bool operator==(const Iterator& rhs) const { return m_entry == rhs.m_entry; }
+	auto operator<=>(const Iterator& rhs) const { return m_entry <=> rhs.m_entry; }
+
+private:
+	friend class ContiguousPolymorphicVector;
+	friend class Iterator<!Const>;
+	Iterator(std::byte* arena, const Entry* entry) : m_arena(arena), m_entry(entry) {}
+
+	std::byte* m_arena = nullptr;
+	const Entry* m_entry = nullptr;
+};
+
+
+//------------------------------------------------------------------------------
+// Constructors.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+ContiguousPolymorphicVector<T, Alloc>::ContiguousPolymorphicVector() noexcept(noexcept(allocator_type())) {}
+
+template <class T, template <class U> class Alloc>
+ContiguousPolymorphicVector<T, Alloc>::ContiguousPolymorphicVector(const allocator_type& alloc) noexcept
+	: m_entries{ Alloc<Entry>(alloc) } {}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+ContiguousPolymorphicVector<T, Alloc>::ContiguousPolymorphicVector(std::initializer_list<U> init, const allocator_type& alloc)
+	: m_entries{ Alloc<Entry>(alloc) } {
+	reserve(init.size(), sizeof(U));
+	for (typename std::initializer_list<U>::reference item : init) {
+		emplace_back(std::in_place_type<U>, item);
+	}
+}
+
+template <class T, template <class U> class Alloc>
+template <class... Items>
+ContiguousPolymorphicVector<T, Alloc>::ContiguousPolymorphicVector(Items&&... items) requires std::conjunction_v<std::is_convertible<std::decay_t<Items>*, T*>...> {
+	reserve(sizeof...(Items), (0 + ... + sizeof(std::decay_t<Items>)) / sizeof...(Items));
+	(..., emplace_back(std::in_place_type<std::decay_t<Items>>, std::forward<Items>(items)));
+}
+
+template <class T, template <class U> class Alloc>
+ContiguousPolymorphicVector<T, Alloc>::ContiguousPolymorphicVector(ContiguousPolymorphicVector&& other) noexcept
+	: m_entries{ std::move(other.m_entries) },
+	  m_arena{ std::exchange(other.m_arena, nullptr) },
+	  m_capacityBytes{ std::exchange(other.m_capacityBytes, 0) },
+	  m_sizeBytes{ std::exchange(other.m_sizeBytes, 0) } {
+	other.m_entries.clear();
+}
+
+template <class T, template <class U> class Alloc>
+ContiguousPolymorphicVector<T, Alloc>::~ContiguousPolymorphicVector() {
+	clear();
+	Deallocate();
+}
+
+//------------------------------------------------------------------------------
+// Construct/assign.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+ContiguousPolymorphicVector<T, Alloc>& ContiguousPolymorphicVector<T, Alloc>::operator=(ContiguousPolymorphicVector&& other) {
+	if (this == &other) {
+		return *this;
+	}
+	clear();
+	using Traits = std::allocator_traits<Alloc<Entry>>;
+	if (Traits::propagate_on_container_move_assignment::value || m_entries.get_allocator() == other.m_entries.get_allocator()) {
+		Deallocate();
+		m_entries = std::move(other.m_entries);
+		m_arena = std::exchange(other.m_arena, nullptr);
+		m_capacityBytes = std::exchange(other.m_capacityBytes, 0);
+		m_sizeBytes = std::exchange(other.m_sizeBytes, 0);
+		other.m_entries.clear();
+	}
+	else {
+		// The arena can't be taken over, it belongs to a different allocator.
+		if (other.m_sizeBytes > m_capacityBytes) {
+			Reallocate(other.m_sizeBytes);
+		}
+		// Reserved before the elements are moved in, assigning the entries can't throw after that.
+		m_entries.reserve(other.m_entries.size());
+		other.MoveElements(get_allocator(), m_arena, 0, other.m_entries.size(), 0);
+		m_entries.assign(other.m_entries.begin(), other.m_entries.end());
+		m_sizeBytes = other.m_sizeBytes;
+		other.clear();
+	}
+	return *this;
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::allocator_type ContiguousPolymorphicVector<T, Alloc>::get_allocator() const {
+	return allocator_type(m_entries.get_allocator());
+}
+
+//------------------------------------------------------------------------------
+// Element access.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::reference ContiguousPolymorphicVector<T, Alloc>::at(size_type pos) {
+	if (pos >= size()) {
+		throw std::out_of_range("ContiguousPolymorphicVector index out of range.");
+	}
+	return *Element(pos);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reference ContiguousPolymorphicVector<T, Alloc>::at(size_type pos) const {
+	if (pos >= size()) {
+		throw std::out_of_range("ContiguousPolymorphicVector index out of range.");
+	}
+	return *Element(pos);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::reference ContiguousPolymorphicVector<T, Alloc>::operator[](size_type index) {
+	return *Element(index);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reference ContiguousPolymorphicVector<T, Alloc>::operator[](size_type index) const {
+	return *Element(index);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::reference ContiguousPolymorphicVector<T, Alloc>::back() {
+	return *Element(size() - 1);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reference ContiguousPolymorphicVector<T, Alloc>::back() const {
+	return *Element(size() - 1);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::reference ContiguousPolymorphicVector<T, Alloc>::front() {
+	return *Element(0);
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reference ContiguousPolymorphicVector<T, Alloc>::front() const {
+	return *Element(0);
+}
+
+
+//------------------------------------------------------------------------------
+// Iterators.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::iterator ContiguousPolymorphicVector<T, Alloc>::begin() {
+	return iterator{ m_arena, m_entries.data() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::iterator ContiguousPolymorphicVector<T, Alloc>::end() {
+	return iterator{ m_arena, m_entries.data() + m_entries.size() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_iterator ContiguousPolymorphicVector<T, Alloc>::begin() const {
+	return const_iterator{ m_arena, m_entries.data() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_iterator ContiguousPolymorphicVector<T, Alloc>::end() const {
+	return const_iterator{ m_arena, m_entries.data() + m_entries.size() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_iterator ContiguousPolymorphicVector<T, Alloc>::cbegin() const {
+	return begin();
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_iterator ContiguousPolymorphicVector<T, Alloc>::cend() const {
+	return end();
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::reverse_iterator ContiguousPolymorphicVector<T, Alloc>::rbegin() {
+	return reverse_iterator{ end() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::reverse_iterator ContiguousPolymorphicVector<T, Alloc>::rend() {
+	return reverse_iterator{ begin() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reverse_iterator ContiguousPolymorphicVector<T, Alloc>::rbegin() const {
+	return const_reverse_iterator{ end() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reverse_iterator ContiguousPolymorphicVector<T, Alloc>::rend() const {
+	return const_reverse_iterator{ begin() };
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reverse_iterator ContiguousPolymorphicVector<T, Alloc>::crbegin() const {
+	return rbegin();
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::const_reverse_iterator ContiguousPolymorphicVector<T, Alloc>::crend() const {
+	return rend();
+}
+
+
+//------------------------------------------------------------------------------
+// Capacity.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::size_type ContiguousPolymorphicVector<T, Alloc>::capacity() const noexcept {
+	return m_entries.capacity();
+}
+
+template <class T, template <class U> class Alloc>
+bool ContiguousPolymorphicVector<T, Alloc>::empty() const noexcept {
+	return m_entries.empty();
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::size_type ContiguousPolymorphicVector<T, Alloc>::max_size() const noexcept {
+	return m_entries.max_size();
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::reserve(size_type count, size_type bytesPerElement) {
+	m_entries.reserve(count);
+	size_t bytes = count * AlignUp(bytesPerElement, alignof(T));
+	if (bytes > m_capacityBytes) {
+		Reallocate(bytes);
+	}
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::shrink_to_fit() {
+	m_entries.shrink_to_fit();
+	if (m_sizeBytes == 0) {
+		Deallocate();
+	}
+	else if (AlignUp(m_sizeBytes, ArenaAlignment) < m_capacityBytes) {
+		Reallocate(m_sizeBytes);
+	}
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::size_type ContiguousPolymorphicVector<T, Alloc>::size() const noexcept {
+	return m_entries.size();
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::size_type ContiguousPolymorphicVector<T, Alloc>::size_bytes() const noexcept {
+	return m_sizeBytes;
+}
+
+template <class T, template <class U> class Alloc>
+typename ContiguousPolymorphicVector<T, Alloc>::size_type ContiguousPolymorphicVector<T, Alloc>::capacity_bytes() const noexcept {
+	return m_capacityBytes;
+}
+
+
+//------------------------------------------------------------------------------
+// Modify.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::clear() noexcept {
+	DestroyElements(0, m_entries.size());
+	m_entries.clear();
+	m_sizeBytes = 0;
+}
+
+template <class T, template <class U> class Alloc>
+template <class U, class... Args>
+typename ContiguousPolymorphicVector<T, Alloc>::reference ContiguousPolymorphicVector<T, Alloc>::emplace_back(std::in_place_type_t<U>, Args&&... args) {
+	static_assert(std::is_base_of_v<T, U>, "Elements must be derived from T.");
+	static_assert(alignof(U) <= ArenaAlignment, "Over-aligned element types are not supported.");
+	static_assert(sizeof(U) <= UINT32_MAX, "Element type is too large.");
+
+	if (m_entries.size() == m_entries.capacity()) {
+		m_entries.reserve(std::max(size_t(8), 2 * m_entries.size()));
+	}
+
+	using Traits = std::allocator_traits<Alloc<U>>;
+	Alloc<U> alloc(get_allocator());
+	size_t offset = AlignUp(m_sizeBytes, alignof(U));
+	U* object;
+	if (offset + sizeof(U) > m_capacityBytes) {
+		// The arguments may refer to current elements, so the new element is constructed
+		// in the new arena before the current elements are moved over and destroyed.
+		using BlockTraits = std::allocator_traits<Alloc<Block>>;
+		Alloc<Block> blockAlloc(get_allocator());
+		size_t blockCount = AlignUp(std::max(offset + sizeof(U), 2 * m_capacityBytes), ArenaAlignment) / ArenaAlignment;
+		auto arena = reinterpret_cast<std::byte*>(BlockTraits::allocate(blockAlloc, blockCount));
+		object = reinterpret_cast<U*>(arena + offset);
+		try {
+			Traits::construct(alloc, object, std::forward<Args>(args)...);
+			try {
+				MoveElements(get_allocator(), arena, 0, m_entries.size(), 0);
+			}
+			catch (...) {
+				Traits::destroy(alloc, object);
+				throw;
+			}
+		}
+		catch (...) {
+			BlockTraits::deallocate(blockAlloc, reinterpret_cast<Block*>(arena), blockCount);
+			throw;
+		}
+		DestroyElements(0, m_entries.size());
+		Deallocate();
+		m_arena = arena;
+		m_capacityBytes = blockCount * ArenaAlignment;
+	}
+	else {
+		object = reinterpret_cast<U*>(m_arena + offset);
+		Traits::construct(alloc, object, std::forward<Args>(args)...);
+	}
+
+	T* base = object;
+	uint32_t baseOffset = uint32_t(reinterpret_cast<std::byte*>(base) - reinterpret_cast<std::byte*>(object));
+	m_entries.push_back(Entry{ offset, uint32_t(sizeof(U)), baseOffset, &elementOps<U> });
+	m_sizeBytes = offset + sizeof(U);
+	return *base;
+}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+void ContiguousPolymorphicVector<T, Alloc>::push_back(U&& value) {
+	emplace_back(std::in_place_type<std::decay_t<U>>, std::forward<U>(value));
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::pop_back() noexcept {
+	DestroyElements(m_entries.size() - 1, m_entries.size());
+	m_entries.pop_back();
+	m_sizeBytes = m_entries.empty() ? 0 : m_entries.back().offset + m_entries.back().size;
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::erase(const_iterator it) {
+	erase(it, it + 1);
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::erase(const_iterator first, const_iterator last) {
+	size_t indexFirst = first.m_entry - m_entries.data();
+	size_t indexLast = last.m_entry - m_entries.data();
+	if (indexFirst == indexLast) {
+		return;
+	}
+	size_t count = m_entries.size();
+	size_t offset = indexFirst == 0 ? 0 : m_entries[indexFirst - 1].offset + m_entries[indexFirst - 1].size;
+
+	// The tail can be moved down in place if no element overlaps its own new place.
+	bool inPlace = true;
+	for (size_t i = indexLast, cursor = offset; i < count; ++i) {
+		const Entry& entry = m_entries[i];
+		size_t newOffset = AlignUp(cursor, entry.ops->alignment);
+		if (newOffset == entry.offset) {
+			break; // The rest of the elements stay where they are.
+		}
+		if (newOffset + entry.size > entry.offset || !entry.ops->nothrowMove) {
+			inPlace = false;
+			break;
+		}
+		cursor = newOffset + entry.size;
+	}
+
+	if (inPlace) {
+		DestroyElements(indexFirst, indexLast);
+		allocator_type alloc = get_allocator();
+		for (size_t i = indexLast, cursor = offset; i < count; ++i) {
+			const Entry& entry = m_entries[i];
+			size_t newOffset = AlignUp(cursor, entry.ops->alignment);
+			if (newOffset == entry.offset) {
+				break;
+			}
+			entry.ops->moveConstruct(alloc, Object(i), m_arena + newOffset);
+			entry.ops->destroy(alloc, Object(i));
+			cursor = newOffset + entry.size;
+		}
+	}
+	else {
+		using Traits = std::allocator_traits<Alloc<Block>>;
+		Alloc<Block> blockAlloc(get_allocator());
+		size_t blockCount = m_capacityBytes / ArenaAlignment;
+		auto arena = reinterpret_cast<std::byte*>(Traits::allocate(blockAlloc, blockCount));
+		allocator_type alloc = get_allocator();
+		try {
+			MoveElements(alloc, arena, 0, indexFirst, 0);
+			try {
+				MoveElements(alloc, arena, indexLast, count, offset);
+			}
+			catch (...) {
+				for (size_t i = 0; i < indexFirst; ++i) {
+					m_entries[i].ops->destroy(alloc, arena + m_entries[i].offset);
+				}
+				throw;
+			}
+		}
+		catch (...) {
+			Traits::deallocate(blockAlloc, reinterpret_cast<Block*>(arena), blockCount);
+			throw;
+		}
+		DestroyElements(0, count);
+		Traits::deallocate(blockAlloc, reinterpret_cast<Block*>(m_arena), blockCount);
+		m_arena = arena;
+	}
+
+	m_entries.erase(m_entries.begin() + indexFirst, m_entries.begin() + indexLast);
+	UpdateOffsets(indexFirst);
+}
+
+
+//------------------------------------------------------------------------------
+// Arena.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+std::byte* ContiguousPolymorphicVector<T, Alloc>::Object(size_t index) const noexcept {
+	return m_arena + m_entries[index].offset;
+}
+
+template <class T, template <class U> class Alloc>
+T* ContiguousPolymorphicVector<T, Alloc>::Element(size_t index) const noexcept {
+	const Entry& entry = m_entries[index];
+	return std::launder(reinterpret_cast<T*>(m_arena + entry.offset + entry.baseOffset));
+}
+
+template <class T, template <class U> class Alloc>
+size_t ContiguousPolymorphicVector<T, Alloc>::AlignUp(size_t offset, size_t alignment) noexcept {
+	return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::Reallocate(size_t capacityBytes) {
+	using Traits = std::allocator_traits<Alloc<Block>>;
+	Alloc<Block> blockAlloc(get_allocator());
+	size_t blockCount = AlignUp(capacityBytes, ArenaAlignment) / ArenaAlignment;
+	auto arena = reinterpret_cast<std::byte*>(Traits::allocate(blockAlloc, blockCount));
+	try {
+		MoveElements(get_allocator(), arena, 0, m_entries.size(), 0);
+	}
+	catch (...) {
+		Traits::deallocate(blockAlloc, reinterpret_cast<Block*>(arena), blockCount);
+		throw;
+	}
+	DestroyElements(0, m_entries.size());
+	Deallocate();
+	m_arena = arena;
+	m_capacityBytes = blockCount * ArenaAlignment;
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::Deallocate() noexcept {
+	if (m_arena) {
+		using Traits = std::allocator_traits<Alloc<Block>>;
+		Alloc<Block> blockAlloc(get_allocator());
+		Traits::deallocate(blockAlloc, reinterpret_cast<Block*>(m_arena), m_capacityBytes / ArenaAlignment);
+	}
+	m_arena = nullptr;
+	m_capacityBytes = 0;
+}
+
+/// <summary> Move constructs elements [first, last) into <paramref name="target"/>, packed starting at <paramref name="targetOffset"/>. </summary>
+/// <returns> The end of the last moved element in the target. </returns>
+/// <remarks> The source elements are left alive. If a move throws, the already moved ones are destroyed in the target. </remarks>
+template <class T, template <class U> class Alloc>
+size_t ContiguousPolymorphicVector<T, Alloc>::MoveElements(const allocator_type& alloc, std::byte* target, size_t first, size_t last, size_t targetOffset) {
+	size_t cursor = targetOffset;
+	size_t index = first;
+	try {
+		for (; index < last; ++index) {
+			const Entry& entry = m_entries[index];
+			size_t offset = AlignUp(cursor, entry.ops->alignment);
+			entry.ops->moveConstruct(alloc, Object(index), target + offset);
+			cursor = offset + entry.size;
+		}
+	}
+	catch (...) {
+		for (size_t i = first; i < index; ++i) {
+			const Entry& entry = m_entries[i];
+			targetOffset = AlignUp(targetOffset, entry.ops->alignment);
+			entry.ops->destroy(alloc, target + targetOffset);
+			targetOffset += entry.size;
+		}
+		throw;
+	}
+	return cursor;
+}
+
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::DestroyElements(size_t first, size_t last) noexcept {
+	allocator_type alloc = get_allocator();
+	for (size_t i = first; i < last; ++i) {
+		m_entries[i].ops->destroy(alloc, Object(i));
+	}
+}
+
+/// <summary> Recomputes the packed offsets of the elements starting at <paramref name="first"/>. </summary>
+template <class T, template <class U> class Alloc>
+void ContiguousPolymorphicVector<T, Alloc>::UpdateOffsets(size_t first) noexcept {
+	size_t cursor = first == 0 ? 0 : m_entries[first - 1].offset + m_entries[first - 1].size;
+	for (size_t i = first; i < m_entries.size(); ++i) {
+		m_entries[i].offset = AlignUp(cursor, m_entries[i].ops->alignment);
+		cursor = m_entries[i].offset + m_entries[i].size;
+	}
+	m_sizeBytes = cursor;
+}
+
+
+//------------------------------------------------------------------------------
+// Element operations.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+template <class U>
+void ContiguousPolymorphicVector<T, Alloc>::MoveElement(const allocator_type& alloc, std::byte* from, std::byte* to) {
+	using Traits = std::allocator_traits<Alloc<U>>;
+	Alloc<U> typedAlloc(alloc);
+	U* source = std::launder(reinterpret_cast<U*>(from));
+	Traits::construct(typedAlloc, reinterpret_cast<U*>(to), std::move_if_noexcept(*source));
+}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+void ContiguousPolymorphicVector<T, Alloc>::DestroyElement(const allocator_type& alloc, std::byte* object) noexcept {
+	using Traits = std::allocator_traits<Alloc<U>>;
+	Alloc<U> typedAlloc(alloc);
+	Traits::destroy(typedAlloc, std::launder(reinterpret_cast<U*>(object)));
+}
+
+
+} // namespace inl
\ No newline at end of file
@@ -3,6 +3,9 @@
 #include "../Exception/Exception.hpp"
 
 #include <any>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
 
@@ -12,10 +15,18 @@ namespace inl {
 
 class DynamicTuple {
 public:
+	using allocator_type = std::pmr::polymorphic_allocator<>;
+
+	template <class... Members>
+	DynamicTuple(Members&&... members) requires(!std::is_same_v<std::decay_t<Members>, std::allocator_arg_t> && ...);
+	/// <summary> The member table allocates from <paramref name="alloc"/>. </summary>
+	/// <remarks> Members are stored in std::any, which allocates large members on the heap regardless. </remarks>
 	template <class... Members>
-	DynamicTuple(Members&&... members);
+	DynamicTuple(std::allocator_arg_t, const allocator_type& alloc, Members&&... members) requires(!std::is_same_v<std::decay_t<Members>, DynamicTuple> && ...);
 	DynamicTuple(const DynamicTuple&) = default;
 	DynamicTuple(DynamicTuple&&) = default;
+	DynamicTuple(std::allocator_arg_t, const allocator_type& alloc, const DynamicTuple& other);
+	DynamicTuple(std::allocator_arg_t, const allocator_type& alloc, DynamicTuple&& other);
 
 	DynamicTuple& operator=(const DynamicTuple&) = default;
 	DynamicTuple& operator=(DynamicTuple&&) = default;
@@ -37,16 +48,30 @@ public:
 	template <class T>
 	bool Has() const;
 
+	allocator_type get_allocator() const;
+
 private:
-	std::unordered_map<std::type_index, std::any> m_members;
+	std::pmr::unordered_map<std::type_index, std::any> m_members;
 };
 
 
 template <class... Members>
-DynamicTuple::DynamicTuple(Members&&... members) {
+DynamicTuple::DynamicTuple(Members&&... members) requires(!std::is_same_v<std::decay_t<Members>, std::allocator_arg_t> && ...) {
 	(..., Insert(std::forward<Members>(members)));
 }
 
+template <class... Members>
+DynamicTuple::DynamicTuple(std::allocator_arg_t, const allocator_type& alloc, Members&&... members) requires(!std::is_same_v<std::decay_t<Members>, DynamicTuple> && ...)
+	: m_members(alloc) {
+	(..., Insert(std::forward<Members>(members)));
+}
+
+inline DynamicTuple::DynamicTuple(std::allocator_arg_t, const allocator_type& alloc, const DynamicTuple& other)
+	: m_members(other.m_members, alloc) {}
+
+inline DynamicTuple::DynamicTuple(std::allocator_arg_t, const allocator_type& alloc, DynamicTuple&& other)
+	: m_members(std::move(other.m_members), alloc) {}
+
 template <class T>
 void DynamicTuple::Insert(T&& obj) {
 	if (Has<T>()) {
@@ -67,6 +92,10 @@ inline void DynamicTuple::Clear() {
 	m_members.clear();
 }
 
+inline DynamicTuple::allocator_type DynamicTuple::get_allocator() const {
+	return m_members.get_allocator();
+}
+
 template <class T>
 T& DynamicTuple::Get() {
 	auto it = m_members.find(typeid(T));
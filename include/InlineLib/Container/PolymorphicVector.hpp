@@ -2,19 +2,40 @@
 
 #include "TransformIterator.hpp"
 
+#include <cstddef>
+#include <iterator>
 #include <memory>
 #include <vector>
 
 
 namespace inl {
 
+/// <summary>
+/// A vector of objects derived from <typeparamref name="T"/>, accessed as references to T.
+/// </summary>
+/// <remarks>
+/// Elements are constructed individually with Alloc rebound to their dynamic type,
+/// so with std::pmr::polymorphic_allocator the elements, as well as anything they
+/// allocate through uses-allocator construction, come from the same memory resource.
+/// </remarks>
 template <class T, template <class U> class Alloc = std::allocator>
 class PolymorphicVector {
+	/// <summary> Destroys and deallocates an element through the allocator that created it. </summary>
+	struct ElementDeleter {
+		void (*destroy)(T*, const Alloc<std::byte>&) = nullptr;
+		[[no_unique_address]] Alloc<std::byte> alloc;
+
+		void operator()(T* ptr) const {
+			destroy(ptr, alloc);
+		}
+	};
+	using ElementPtr = std::unique_ptr<T, ElementDeleter>;
+
 	struct Transformer {
-		T& operator()(std::unique_ptr<T>& ptr) const {
+		T& operator()(ElementPtr& ptr) const {
 			return *ptr;
 		}
-		const T& operator()(const std::unique_ptr<T>& ptr) const {
+		const T& operator()(const ElementPtr& ptr) const {
 			return *ptr;
 		}
 	};
@@ -25,14 +46,14 @@ class PolymorphicVector {
 
 public:
 	// Types
-	using allocator_type = Alloc<std::unique_ptr<T>>;
+	using allocator_type = Alloc<ElementPtr>;
 	using const_pointer = const T*;
 	using const_reference = const T&;
 	using pointer = T*;
 	using reference = T&;
 	using size_type = std::size_t;
 	using value_type = T;
-	using underlying_container = std::vector<std::unique_ptr<T>, allocator_type>;
+	using underlying_container = std::vector<ElementPtr, allocator_type>;
 
 	using iterator = TransformIterator<typename underlying_container::iterator, Transformer>;
 	using const_iterator = TransformIterator<typename underlying_container::const_iterator, Transformer>;
@@ -45,7 +66,7 @@ public:
 	template <class U>
 	PolymorphicVector(size_type count, const U& value, const allocator_type& alloc = allocator_type());
 	template <class InputIt>
-	PolymorphicVector(InputIt first, InputIt last, const allocator_type& alloc = allocator_type()) requires !std::is_convertible_v<InputIt, T>;
+	PolymorphicVector(InputIt first, InputIt last, const allocator_type& alloc = allocator_type()) requires(!std::is_convertible_v<InputIt, T>);
 	PolymorphicVector(PolymorphicVector&& other) noexcept;
 	PolymorphicVector(PolymorphicVector&& other, const allocator_type& alloc);
 	template <class U>
@@ -126,6 +147,13 @@ public:
 	// Customized parts
 	void swap_elements(const_iterator elem1, const_iterator elem2);
 
+private:
+	template <class U, class... Args>
+	ElementPtr MakeElement(Args&&... args);
+	iterator InsertElements(const_iterator pos, underlying_container&& elements);
+	template <class U>
+	static void DestroyElement(T* ptr, const Alloc<std::byte>& alloc);
+
 private:
 	underlying_container m_items;
 };
@@ -146,19 +174,19 @@ template <class U>
 PolymorphicVector<T, Alloc>::PolymorphicVector(size_type count, const U& value, const allocator_type& alloc) : m_items{ alloc } {
 	m_items.reserve(count);
 	for (size_type i = 0; i < count; ++i) {
-		m_items.push_back(std::make_unique<U>(value));
+		m_items.push_back(MakeElement<U>(value));
 	}
 }
 
 template <class T, template <class U> class Alloc>
 template <class InputIt>
-PolymorphicVector<T, Alloc>::PolymorphicVector(InputIt first, InputIt last, const allocator_type& alloc) requires !std::is_convertible_v<InputIt, T>
+PolymorphicVector<T, Alloc>::PolymorphicVector(InputIt first, InputIt last, const allocator_type& alloc) requires(!std::is_convertible_v<InputIt, T>)
 : m_items{ alloc } {
 	if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename InputIt::iterator_category>) {
 		m_items.reserve(std::distance(first, last));
 	}
 	for (; first != last; ++first) {
-		m_items.push_back(std::make_unique<std::decay_t<decltype(*first)>>(*first));
+		m_items.push_back(MakeElement<std::decay_t<decltype(*first)>>(*first));
 	}
 }
 
@@ -168,21 +196,21 @@ PolymorphicVector<T, Alloc>::PolymorphicVector(PolymorphicVector&& other) noexce
 
 template <class T, template <class U> class Alloc>
 PolymorphicVector<T, Alloc>::PolymorphicVector(PolymorphicVector&& other, const allocator_type& alloc)
-	: m_items{ other.m_items, alloc } {}
+	: m_items{ std::move(other.m_items), alloc } {}
 
 template <class T, template <class U> class Alloc>
 template <class U>
 PolymorphicVector<T, Alloc>::PolymorphicVector(std::initializer_list<U> init, const allocator_type& alloc) : m_items{ alloc } {
 	m_items.reserve(init.size());
 	for (typename std::initializer_list<U>::reference item : init) {
-		m_items.push_back(std::make_unique<U>(item));
+		m_items.push_back(MakeElement<U>(item));
 	}
 }
 
 template <class T, template <class U> class Alloc>
 template <class ... Items>
 PolymorphicVector<T, Alloc>::PolymorphicVector(Items&&... items) requires std::conjunction_v<std::is_convertible<Items*, T*>...> {
-	(..., m_items.push_back(std::make_unique<Items>(std::forward<Items>(items))));
+	(..., m_items.push_back(MakeElement<std::decay_t<Items>>(std::forward<Items>(items))));
 }
 
 //------------------------------------------------------------------------------
@@ -201,7 +229,7 @@ PolymorphicVector<T, Alloc>& PolymorphicVector<T, Alloc>::operator=(std::initial
 	m_items.clear();
 	m_items.reserve(ilist.size());
 	for (typename std::initializer_list<U>::reference item : ilist) {
-		m_items.push_back(std::make_unique<U>(item));
+		m_items.push_back(MakeElement<U>(item));
 	}
 	return *this;
 }
@@ -212,7 +240,7 @@ void PolymorphicVector<T, Alloc>::assign(size_type count, const U& value) {
 	m_items.clear();
 	m_items.reserve(count);
 	for (size_type i = 0; i < count; ++i) {
-		m_items.push_back(std::make_unique<U>(value));
+		m_items.push_back(MakeElement<U>(value));
 	}
 }
 
@@ -224,7 +252,7 @@ void PolymorphicVector<T, Alloc>::assign(InputIt first, InputIt last) {
 		m_items.reserve(std::distance(first, last));
 	}
 	for (; first != last; ++first) {
-		m_items.push_back(std::make_unique<std::decay_t<decltype(*first)>>(*first));
+		m_items.push_back(MakeElement<std::decay_t<decltype(*first)>>(*first));
 	}
 }
 
@@ -234,9 +262,8 @@ void PolymorphicVector<T, Alloc>::assign(std::initializer_list<U> ilist) {
 	m_items.clear();
 	m_items.reserve(ilist.size());
 	for (typename std::initializer_list<U>::reference item : ilist) {
-		m_items.push_back(std::make_unique<U>(item));
+		m_items.push_back(MakeElement<U>(item));
 	}
-	return *this;
 }
 
 template <class T, template <class U> class Alloc>
@@ -375,12 +402,12 @@ typename PolymorphicVector<T, Alloc>::size_type PolymorphicVector<T, Alloc>::max
 
 template <class T, template <class U> class Alloc>
 void PolymorphicVector<T, Alloc>::reserve(size_type count) {
-	return m_items.reserve();
+	return m_items.reserve(count);
 }
 
 template <class T, template <class U> class Alloc>
 void PolymorphicVector<T, Alloc>::resize(size_type count) {
-	return m_items.resize();
+	return m_items.resize(count);
 }
 
 template <class T, template <class U> class Alloc>
@@ -406,72 +433,78 @@ void PolymorphicVector<T, Alloc>::clear() {
 template <class T, template <class U> class Alloc>
 template <class U, class... Args>
 typename PolymorphicVector<T, Alloc>::iterator PolymorphicVector<T, Alloc>::emplace(const_iterator pos, std::in_place_type_t<U>, Args&&... args) {
-	auto index = pos - begin();
-	m_items.insert(m_items.begin() + pos, std::make_unique<U>(std::forward<Args>(args)...));
+	auto index = pos - cbegin();
+	m_items.insert(m_items.begin() + index, MakeElement<U>(std::forward<Args>(args)...));
+	return begin() + index;
 }
 
 template <class T, template <class U> class Alloc>
 template <class U, class... Args>
 typename PolymorphicVector<T, Alloc>::reference PolymorphicVector<T, Alloc>::emplace_back(std::in_place_type_t<U>, Args&&... args) {
-	m_items.push_back(std::make_unique<U>(std::forward<Args>(args)...));
+	m_items.push_back(MakeElement<U>(std::forward<Args>(args)...));
+	return back();
 }
 
 template <class T, template <class U> class Alloc>
 template <class U>
 typename PolymorphicVector<T, Alloc>::iterator PolymorphicVector<T, Alloc>::insert(const_iterator pos, U&& value) {
-	auto index = pos - begin();
-	m_items.insert(m_items.begin() + index, std::make_unique<U>(std::forward<U>(value)));
+	auto index = pos - cbegin();
+	m_items.insert(m_items.begin() + index, MakeElement<std::decay_t<U>>(std::forward<U>(value)));
+	return begin() + index;
 }
 
 template <class T, template <class U> class Alloc>
 template <class U>
 typename PolymorphicVector<T, Alloc>::iterator PolymorphicVector<T, Alloc>::insert(const_iterator pos, size_type count, const U& value) {
-	auto index = pos - begin();
-	m_items.insert(m_items.begin() + index, {});
-	for (auto it = m_items.begin() + index; it < m_items.begin() + index + count; ++it) {
-		*it = std::make_unique<U>(value);
+	underlying_container elements(m_items.get_allocator());
+	elements.reserve(count);
+	for (size_type i = 0; i < count; ++i) {
+		elements.push_back(MakeElement<U>(value));
 	}
+	return InsertElements(pos, std::move(elements));
 }
 
 template <class T, template <class U> class Alloc>
 template <class InputIt>
 typename PolymorphicVector<T, Alloc>::iterator PolymorphicVector<T, Alloc>::insert(const_iterator pos, InputIt first, InputIt last) {
-	auto index = pos - begin();
-	auto itemsPos = m_items.begin() + index;
-	for (; first != last; ++last, ++itemsPos) {
-		m_items.insert(itemsPos, std::make_unique<std::decay_t<decltype(*first)>>(*first));
+	underlying_container elements(m_items.get_allocator());
+	if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<InputIt>::iterator_category>) {
+		elements.reserve(std::distance(first, last));
+	}
+	for (; first != last; ++first) {
+		elements.push_back(MakeElement<std::decay_t<decltype(*first)>>(*first));
 	}
+	return InsertElements(pos, std::move(elements));
 }
 
 template <class T, template <class U> class Alloc>
 template <class U>
 typename PolymorphicVector<T, Alloc>::iterator PolymorphicVector<T, Alloc>::insert(const_iterator pos, std::initializer_list<U> ilist) {
-	auto index = pos - begin();
-	auto count = ilist.size();
-	m_items.insert(m_items.begin() + index, {});
-	auto ilistIt = ilist.begin();
-	for (auto it = m_items.begin() + index; it < m_items.begin() + index + count; ++it) {
-		*it = std::make_unique<U>(*(ilistIt++));
+	underlying_container elements(m_items.get_allocator());
+	elements.reserve(ilist.size());
+	for (typename std::initializer_list<U>::reference item : ilist) {
+		elements.push_back(MakeElement<U>(item));
 	}
+	return InsertElements(pos, std::move(elements));
 }
 
 template <class T, template <class U> class Alloc>
 template <class U>
 void PolymorphicVector<T, Alloc>::push_back(U&& value) {
-	m_items.push_back(std::make_unique<U>(std::forward<U>(value)));
+	m_items.push_back(MakeElement<std::decay_t<U>>(std::forward<U>(value)));
 }
 
 template <class T, template <class U> class Alloc>
 void PolymorphicVector<T, Alloc>::erase(const_iterator it) {
-	auto index = it - begin();
+	auto index = it - cbegin();
 	auto itemsPos = m_items.begin() + index;
 	m_items.erase(itemsPos);
 }
 
 template <class T, template <class U> class Alloc>
 void PolymorphicVector<T, Alloc>::erase(const_iterator first, const_iterator last) {
-	auto indexFirst = first - begin();
-	auto indexLast = last - begin();
+	auto indexFirst = first - cbegin();
+	auto indexLast = last - cbegin();
 	m_items.erase(m_items.begin() + indexFirst, m_items.begin() + indexLast);
 }
 
@@ -482,10 +515,50 @@ void PolymorphicVector<T, Alloc>::erase(const_iterator first, const_iterator las
 
 template <class T, template <class U> class Alloc>
 void PolymorphicVector<T, Alloc>::swap_elements(const_iterator elem1, const_iterator elem2) {
-	auto index1 = elem1 - begin();
-	auto index2 = elem2 - begin();
+	auto index1 = elem1 - cbegin();
+	auto index2 = elem2 - cbegin();
 	std::swap(m_items[index1], m_items[index2]);
 }
 
 
+//------------------------------------------------------------------------------
+// Element allocation.
+//------------------------------------------------------------------------------
+
+template <class T, template <class U> class Alloc>
+template <class U, class... Args>
+auto PolymorphicVector<T, Alloc>::MakeElement(Args&&... args) -> ElementPtr {
+	using Traits = std::allocator_traits<Alloc<U>>;
+	Alloc<U> alloc(m_items.get_allocator());
+	U* ptr = Traits::allocate(alloc, 1);
+	try {
+		Traits::construct(alloc, ptr, std::forward<Args>(args)...);
+	}
+	catch (...) {
+		Traits::deallocate(alloc, ptr, 1);
+		throw;
+	}
+	return ElementPtr{ ptr, ElementDeleter{ &DestroyElement<U>, Alloc<std::byte>(alloc) } };
+}
+
+/// <summary> Moves already made elements into the vector at <paramref name="pos"/>. </summary>
+/// <remarks> The elements are made before anything is inserted, so if one of them throws, the vector is unchanged. </remarks>
+template <class T, template <class U> class Alloc>
+auto PolymorphicVector<T, Alloc>::InsertElements(const_iterator pos, underlying_container&& elements) -> iterator {
+	auto index = pos - cbegin();
+	m_items.insert(m_items.begin() + index, std::make_move_iterator(elements.begin()), std::make_move_iterator(elements.end()));
+	return begin() + index;
+}
+
+template <class T, template <class U> class Alloc>
+template <class U>
+void PolymorphicVector<T, Alloc>::DestroyElement(T* ptr, const Alloc<std::byte>& alloc) {
+	using Traits = std::allocator_traits<Alloc<U>>;
+	Alloc<U> typedAlloc(alloc);
+	U* typedPtr = static_cast<U*>(ptr);
+	Traits::destroy(typedAlloc, typedPtr);
+	Traits::deallocate(typedAlloc, typedPtr, 1);
+}
+
+
 } // namespace inl
\ No newline at end of file
@@ -182,7 +182,13 @@ namespace impl {
 
 template <class Iterator, class Transformer>
 class TransformIterator : public impl::SelectBase<Iterator, Transformer> {
-	using impl::SelectBase<Iterator, Transformer>::SelectBase;
+	using Base = impl::SelectBase<Iterator, Transformer>;
+
+public:
+	using Base::Base;
+	TransformIterator() = default;
+	// Arithmetic returns the base class, this makes the result usable as a TransformIterator again.
+	TransformIterator(const Base& other) : Base(other) {}
 };
 
 
@@ -363,7 +369,7 @@ namespace impl {
 
 	template <class Iterator, class Transformer>
 	TransformRandomIterator<Iterator, Transformer> TransformRandomIterator<Iterator, Transformer>::operator+(difference_type n) const {
-		return { base + n };
+		return TransformRandomIterator{ base + n };
 	}
 
 	template <class Iterator, class Transformer>
@@ -374,7 +380,7 @@ namespace impl {
 
 	template <class Iterator, class Transformer>
 	TransformRandomIterator<Iterator, Transformer> TransformRandomIterator<Iterator, Transformer>::operator-(difference_type n) const {
-		return { base - n };
+		return TransformRandomIterator{ base - n };
 	}
 
 	template <class Iterator, class Transformer>
@@ -43,7 +43,9 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 //Customizable constants
 //#define LTALLOC_DISABLE_OPERATOR_NEW_OVERRIDE
-//#define LTALLOC_AUTO_GC_INTERVAL 3.0
+//#define LTALLOC_OVERRIDE_MALLOC//also replace malloc/free and friends (not available on Windows)
+//#define LTALLOC_STATS//collect statistics, see ltstats()
+//#define LTALLOC_AUTO_GC_INTERVAL 3.0//initial interval of automatic ltsqueeze, see ltsetautogc()
 #ifndef LTALLOC_SIZE_CLASSES_SUBPOWER_OF_TWO
 #define LTALLOC_SIZE_CLASSES_SUBPOWER_OF_TWO 2//determines how accurately size classes are spaced (i.e. when = 0, allocation requests are rounded up to the nearest power of two (2^n), when = 1, rounded to 2^n, or (2^n)*1.5, when = 2, rounded to 2^n, (2^n)*1.25, (2^n)*1.5, or (2^n)*1.75, and so on); this parameter have direct influence on memory fragmentation - bigger values lead to reducing internal fragmentation (which can be approximately estimated as pow(0.5, VALUE)*100%), but at the same time increasing external fragmentation
 #endif
@@ -62,12 +64,26 @@ static const unsigned int MAX_BLOCK_SIZE = CHUNK_SIZE;//requesting memory of any
 #define CPPCODE(code)
 #endif
 
-#ifdef LTALLOC_AUTO_GC_INTERVAL
+#include "ltalloc.h"
 #include <time.h>
+
+#ifdef LTALLOC_AUTO_GC_INTERVAL
 #	if			LTALLOC_AUTO_GC_INTERVAL <= 0
 #		undef	LTALLOC_AUTO_GC_INTERVAL 
 #		define	LTALLOC_AUTO_GC_INTERVAL 3.00
 #	endif
+#else
+#	define	LTALLOC_AUTO_GC_INTERVAL 0
+#endif
+
+#ifdef LTALLOC_STATS
+#define STATS(code) code
+static struct
+{
+	volatile long long largeAllocations, largeDeallocations, largeBytes, squeezes, chunksReleased;
+} globalStats;
+#else
+#define STATS(code)
 #endif
 
 #ifdef __GNUC__
@@ -80,6 +96,8 @@ static const unsigned int MAX_BLOCK_SIZE = CHUNK_SIZE;//requesting memory of any
 #define NOINLINE __attribute__((noinline))
 #define CAS_LOCK(lock) __sync_lock_test_and_set(lock, 1)
 #define SPINLOCK_RELEASE(lock) __sync_lock_release(lock)
+#define ATOMIC_ADD64(p, v) __sync_fetch_and_add((long long*)(p), (long long)(v))
+#define ATOMIC_CAS64(p, expected, desired) __sync_bool_compare_and_swap((long long*)(p), (long long)(expected), (long long)(desired))
 #ifdef __sparc__
 #define PAUSE __asm__ __volatile__("rd    %%ccr, %%g0\n\t" ::: "memory")
 #elif defined(__ppc__)   || defined(_ARCH_PPC)  || \
@@ -102,9 +120,13 @@ static const unsigned int MAX_BLOCK_SIZE = CHUNK_SIZE;//requesting memory of any
 #define NOINLINE __declspec(noinline)
 #define CAS_LOCK(lock) _InterlockedExchange((long*)lock, 1)
 #define SPINLOCK_RELEASE(lock) _InterlockedExchange((long*)lock, 0)
+#define ATOMIC_ADD64(p, v) _InterlockedExchangeAdd64((long long*)(p), (long long)(v))
+#define ATOMIC_CAS64(p, expected, desired) (_InterlockedCompareExchange64((long long*)(p), (long long)(desired), (long long)(expected)) == (long long)(expected))
 #define PAUSE _mm_pause()
 #define BSR(r, v) CODE3264(_BitScanReverse, _BitScanReverse64)((unsigned long*)&r, v)
 CPPCODE(extern "C") long _InterlockedExchange(long volatile *, long);
+CPPCODE(extern "C") long long _InterlockedExchangeAdd64(long long volatile *, long long);
+CPPCODE(extern "C") long long _InterlockedCompareExchange64(long long volatile *, long long, long long);
 CPPCODE(extern "C") void _mm_pause();
 #pragma warning(disable: 4127 4201 4324 4290)//"conditional expression is constant", "nonstandard extension used : nameless struct/union", and "structure was padded due to __declspec(align())"
 
@@ -147,8 +169,6 @@ typedef char CODE3264_check[sizeof(void*) == CODE3264(4, 8) ? 1 : -1];
 #define VMALLOC(size) (void*)(((uintptr_t)mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_ANON|MAP_PRIVATE, -1, 0)+1)&~1)//with the conversion of MAP_FAILED to 0
 #define VMFREE(p, size) munmap(p, size)
 
-#include "ltalloc.h"
-
 static size_t page_size()
 {
 	assert((uintptr_t)MAP_FAILED+1 == 0);//have to use dynamic check somewhere, because some gcc versions (e.g. 4.4.5) won't compile typedef char MAP_FAILED_value_static_check[(uintptr_t)MAP_FAILED+1 == 0 ? 1 : -1];
@@ -300,13 +320,18 @@ static NOINLINE void sys_free(void *p)
 {
 	if (p == NULL) return;
 #ifdef _WIN32
+	STATS({MEMORY_BASIC_INFORMATION mi;
+	VirtualQuery(p, &mi, sizeof(mi));
+	ATOMIC_ADD64(&globalStats.largeBytes, -(long long)mi.RegionSize);})
 	VirtualFree(p, 0, MEM_RELEASE);
 #else
 	SPINLOCK_ACQUIRE(&ptrieLock);
 	size_t size = ptrie_remove((uintptr_t)p);
 	SPINLOCK_RELEASE(&ptrieLock);
+	STATS(ATOMIC_ADD64(&globalStats.largeBytes, -(long long)size);)
 	munmap(p, size);
 #endif
+	STATS(ATOMIC_ADD64(&globalStats.largeDeallocations, 1);)
 }
 
 static void release_thread_cache(void*);
@@ -386,6 +411,9 @@ typedef struct
 	FreeBlock *freeList;
 	FreeBlock *tempList;//intermediate list providing a hysteresis in order to avoid a corner case of too frequent moving free blocks to the central cache and back from
 	int counter;//number of blocks in freeList (used to determine when to move free blocks list to the central cache)
+#ifdef LTALLOC_STATS
+	size_t allocations, deallocations;//not yet published to classStats
+#endif
 } ThreadCache;
 static thread_local ThreadCache threadCache[NUMBER_OF_SIZE_CLASSES];// = {{0}};
 
@@ -396,6 +424,52 @@ static struct
 	size_t size;
 } pad = {0, NULL, 0};
 
+#ifdef LTALLOC_STATS
+typedef struct alignas(CACHE_LINE_SIZE)
+{
+	volatile long long chunks, allocations, deallocations, centralFetches, centralReleases;
+} SizeClassStats;
+static SizeClassStats classStats[NUMBER_OF_SIZE_CLASSES];
+
+static void flush_thread_stats(ThreadCache *tc, unsigned int sizeClass)
+{
+	if (tc->allocations) {
+		ATOMIC_ADD64(&classStats[sizeClass].allocations, tc->allocations);
+		tc->allocations = 0;
+	}
+	if (tc->deallocations) {
+		ATOMIC_ADD64(&classStats[sizeClass].deallocations, tc->deallocations);
+		tc->deallocations = 0;
+	}
+}
+#endif
+
+//Automatic garbage collection (see ltsetautogc)
+static volatile long long autoGcIntervalMs = (long long)(LTALLOC_AUTO_GC_INTERVAL * 1000);
+static volatile long long autoGcDeadlineMs = 0;
+static volatile size_t autoGcPadSize = 0;
+
+static long long monotonic_ms()
+{
+#ifdef _WIN32
+	return (long long)GetTickCount64();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+static void auto_gc()
+{
+	long long interval = autoGcIntervalMs, deadline = autoGcDeadlineMs, now;
+	if (likely(interval == 0)) return;
+	now = monotonic_ms();
+	if (now < deadline) return;
+	if (ATOMIC_CAS64(&autoGcDeadlineMs, deadline, now + interval))//only one of the threads passing the deadline collects
+		ltsqueeze(autoGcPadSize);
+}
+
 static CPPCODE(inline) unsigned int get_size_class(size_t size)
 {
 	unsigned int index;
@@ -451,6 +525,7 @@ CPPCODE(template <bool throw_>) static void *fetch_from_central_cache(size_t siz
 	if (likely(size-1u <= MAX_BLOCK_SIZE-1u))//<=> if (size <= MAX_BLOCK_SIZE && size != 0)
 	{
 		FreeBlock *fb = tc->tempList;
+		STATS(tc->allocations++; flush_thread_stats(tc, sizeClass);)
 		if (fb)
 		{
 			assert(tc->counter == (int)batch_size(sizeClass)+1);
@@ -462,6 +537,7 @@ CPPCODE(template <bool throw_>) static void *fetch_from_central_cache(size_t siz
 
 		assert(tc->counter == 0 || tc->counter == (int)batch_size(sizeClass)+1);
 		tc->counter = 1;
+		STATS(ATOMIC_ADD64(&classStats[sizeClass].centralFetches, 1);)
 
 		{CentralCache *cc = &centralCache[sizeClass];
 		SPINLOCK_ACQUIRE(&cc->lock);
@@ -553,6 +629,7 @@ CPPCODE(template <bool throw_>) static void *fetch_from_central_cache(size_t siz
 
 			//Prepare chunk
 			((Chunk*)p)->sizeClass = sizeClass;
+			STATS(ATOMIC_ADD64(&classStats[sizeClass].chunks, 1);)
 			{char *firstFree = (char*)p + CHUNK_SIZE - numBlocksInChunk*blockSize;//blocks in chunk are located in such way to achieve a maximum possible alignment
 			fb = (FreeBlock*)firstFree;
 			{int n = batchSize; while (--n)
@@ -641,6 +718,10 @@ CPPCODE(template <bool throw_>) static void *fetch_from_central_cache(size_t siz
 		}
 #endif
 		CPPCODE(if (throw_) if (unlikely(!p)) throw std::bad_alloc();)
+		STATS(if (p) {
+			ATOMIC_ADD64(&globalStats.largeAllocations, 1);
+			ATOMIC_ADD64(&globalStats.largeBytes, size);
+		})
 		return p;
 	}
 }
@@ -654,6 +735,7 @@ CPPCODE(template <bool throw_> static) void *ltmalloc(size_t size)
 	{
 		tc->freeList = fb->next;
 		tc->counter++;
+		STATS(tc->allocations++;)
 		return fb;
 	}
 	else
@@ -685,12 +767,14 @@ static NOINLINE void move_to_central_cache(ThreadCache *tc, unsigned int sizeCla
 	init_pthread_destructor();//needed for cases when freed memory was allocated in the other thread and no alloc was called in this thread till its termination
 
 	tc->counter = batch_size(sizeClass);
+	STATS(flush_thread_stats(tc, sizeClass);)
 	if (tc->tempList)//move temp list to the central cache
 	{
 		CentralCache *cc = &centralCache[sizeClass];
 		SPINLOCK_ACQUIRE(&cc->lock);
 		add_batch_to_central_cache(cc, sizeClass, tc->tempList);
 		SPINLOCK_RELEASE(&cc->lock);
+		STATS(ATOMIC_ADD64(&classStats[sizeClass].centralReleases, 1);)
 	}
 // 	else if (unlikely(!tc->freeList))//this is a first call (i.e. when counter = 0) - just initialization of counter needed
 // 	{
@@ -700,6 +784,8 @@ static NOINLINE void move_to_central_cache(ThreadCache *tc, unsigned int sizeCla
 
 	tc->tempList = tc->freeList;
 	tc->freeList = NULL;
+
+	auto_gc();
 }
 
 CPPCODE(extern "C") void ltfree(void *p)
@@ -714,6 +800,7 @@ CPPCODE(extern "C") void ltfree(void *p)
 
 		((FreeBlock*)p)->next = tc->freeList;
 		tc->freeList = (FreeBlock*)p;
+		STATS(tc->deallocations++;)
 	}
 	else
 		sys_free(p);
@@ -747,8 +834,10 @@ static void release_thread_cache(void *p)
 	for (;sizeClass < NUMBER_OF_SIZE_CLASSES; sizeClass++)
 	{
 		ThreadCache *tc = &threadCache[sizeClass];
+		STATS(flush_thread_stats(tc, sizeClass);)
 		if (tc->freeList || tc->tempList)
 		{
+			STATS(ATOMIC_ADD64(&classStats[sizeClass].centralReleases, 1);)
 			FreeBlock *tail = tc->freeList;
 			unsigned int freeListSize = 1;
 			CentralCache *cc = &centralCache[sizeClass];
@@ -774,6 +863,7 @@ static void release_thread_cache(void *p)
 CPPCODE(extern "C") void ltsqueeze(size_t padsz)
 {
 	unsigned int sizeClass = get_size_class(2*sizeof(void*));//skip small chunks because corresponding batches can not be efficiently detached from the central cache (if that becomes relevant, may be it worths to reimplement batches for small chunks from array to linked lists)
+	STATS(ATOMIC_ADD64(&globalStats.squeezes, 1);)
 	for (;sizeClass < NUMBER_OF_SIZE_CLASSES; sizeClass++)
 	{
 		CentralCache *cc = &centralCache[sizeClass];
@@ -801,6 +891,7 @@ CPPCODE(extern "C") void ltsqueeze(size_t padsz)
 		unsigned int numBlocksInChunk = (CHUNK_SIZE - (/*CHUNK_IS_SMALL ? sizeof(ChunkSm) : */sizeof(Chunk)))/class_to_size(sizeClass);
 		FreeBlock **pbatch, *block, **pblock;
 		Chunk *firstFreeChunk = NULL;
+		STATS(long long releasedChunks = 0;)
 		assert(numBlocksInChunk < (1U<<(sizeof(short)*8)));//in case if CHUNK_SIZE is too big that total count of blocks in it doesn't fit at short type (...may be use static_assert instead?)
 		if (inChunkFreeBlocks)//consider VMALLOC can fail
 		{
@@ -813,6 +904,7 @@ CPPCODE(extern "C") void ltsqueeze(size_t padsz)
 						assert(chunk->sizeClass == sizeClass);/*just in case check before overwriting this info*/\
 						*(Chunk**)chunk = firstFreeChunk;/*put nextFreeChunk pointer right at the beginning of Chunk as there are always must be a space for one pointer before first memory block*/\
 						firstFreeChunk = chunk;\
+						STATS(releasedChunks++;)\
 					}
 				FREE_BLOCK(block)
 			for (pblock = &freeList; *pblock; pblock = &(*pblock)->next)
@@ -925,7 +1017,9 @@ continue_:;
 				Chunk *nextFreeChunk = *(Chunk**)firstFreeChunk;
 				VMFREE(firstFreeChunk, CHUNK_SIZE);
 				firstFreeChunk = nextFreeChunk;
+				STATS(ATOMIC_ADD64(&globalStats.chunksReleased, 1);)
 			}
+			STATS(ATOMIC_ADD64(&classStats[sizeClass].chunks, -releasedChunks);)
 		}
 		else//nothing to release - just return batches back to the central cache
 		{
@@ -952,13 +1046,30 @@ void operator delete  (void* p)                        throw() {ltfree(p);}
 void operator delete  (void* p, const std::nothrow_t&) throw() {ltfree(p);}
 void operator delete[](void* p)                        throw() {ltfree(p);}
 void operator delete[](void* p, const std::nothrow_t&) throw() {ltfree(p);}
+
+#ifdef __cpp_aligned_new
+static void *ltmemalign_throw(size_t align, size_t size) {void *p = ltmemalign(align, size); if (unlikely(!p)) throw std::bad_alloc(); return p;}
+
+void *operator new  (size_t size, std::align_val_t al) THROWS                         {return ltmemalign_throw((size_t)al, size);}
+void *operator new  (size_t size, std::align_val_t al, const std::nothrow_t&) throw() {return ltmemalign((size_t)al, size);}
+void *operator new[](size_t size, std::align_val_t al) THROWS                         {return ltmemalign_throw((size_t)al, size);}
+void *operator new[](size_t size, std::align_val_t al, const std::nothrow_t&) throw() {return ltmemalign((size_t)al, size);}
+
+void operator delete  (void* p, std::align_val_t)                        throw() {ltfree(p);}
+void operator delete  (void* p, std::align_val_t, const std::nothrow_t&) throw() {ltfree(p);}
+void operator delete[](void* p, std::align_val_t)                        throw() {ltfree(p);}
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) throw() {ltfree(p);}
+#endif
 #endif
 
 /* @r-lyeh's { */
 #include <string.h>
 CPPCODE(extern "C") void *ltcalloc(size_t elems, size_t size) {
+	void *p;
+	if( elems && size > SIZE_MAX / elems ) return (void *)0;
 	size *= elems;
-	return memset( ltmalloc( size ), 0, size );
+	p = ltmalloc( size );
+	return p ? memset( p, 0, size ) : p;
 }
 CPPCODE(extern "C") void *ltmemalign( size_t align, size_t size ) {
 	return --align, ltmalloc( (size+align)&~align );
@@ -970,22 +1081,98 @@ CPPCODE(extern "C") void *ltrealloc( void *ptr, size_t sz ) {
 	if( sz <= osz ) {
 		return ptr;
 	}
-	void *nptr = memcpy( ltmalloc(sz), ptr, osz );
+	void *nptr = ltmalloc(sz);
+	if( !nptr ) return nptr;
+	memcpy( nptr, ptr, osz );
 	ltfree( ptr );
 
-#ifdef LTALLOC_AUTO_GC_INTERVAL
-	/* this is kind of compromise; the following timer is to guarantee
-	that memory gets wiped out at least every given seconds between consecutive 
-	ltrealloc() calls (I am assuming frequency usage for ltrealloc() is smaller
-	than ltmalloc() or ltfree() too) - @r-lyeh */
-			clock_t now = clock();
-	static	clock_t then = now;
-	if( ( double(now - then) / CLOCKS_PER_SEC ) > LTALLOC_AUTO_GC_INTERVAL ) {
-		ltsqueeze(0);
-	}
-	then = now;
-#endif
+	auto_gc();
 
 	return nptr;
 }
 /* } */
+
+CPPCODE(extern "C") size_t ltstats(LtallocStats *stats, LtallocSizeClassStats *classes, size_t maxClasses)
+{
+#ifdef LTALLOC_STATS
+	unsigned int sizeClass;
+	if (stats)
+	{
+		stats->chunkSize = CHUNK_SIZE;
+		stats->padBytes = pad.size;
+		stats->largeBytes = (size_t)globalStats.largeBytes;
+		stats->largeAllocations = globalStats.largeAllocations;
+		stats->largeDeallocations = globalStats.largeDeallocations;
+		stats->squeezes = globalStats.squeezes;
+		stats->chunksReleased = globalStats.chunksReleased;
+	}
+	for (sizeClass = 0; sizeClass < NUMBER_OF_SIZE_CLASSES && sizeClass < maxClasses; sizeClass++)
+	{
+		SizeClassStats *cs = &classStats[sizeClass];
+		LtallocSizeClassStats *out = &classes[sizeClass];
+		out->blockSize = class_to_size(sizeClass);
+		out->chunks = (size_t)cs->chunks;
+		out->allocations = cs->allocations;
+		out->deallocations = cs->deallocations;
+		out->centralFetches = cs->centralFetches;
+		out->centralReleases = cs->centralReleases;
+	}
+	return NUMBER_OF_SIZE_CLASSES;
+#else
+	(void)stats; (void)classes; (void)maxClasses;
+	return 0;
+#endif
+}
+
+CPPCODE(extern "C") void ltflushthreadstats(void)
+{
+#ifdef LTALLOC_STATS
+	unsigned int sizeClass;
+	for (sizeClass = 0; sizeClass < NUMBER_OF_SIZE_CLASSES; sizeClass++)
+		flush_thread_stats(&threadCache[sizeClass], sizeClass);
+#endif
+}
+
+CPPCODE(extern "C") void ltsetautogc(double intervalSeconds, size_t padsz)
+{
+	long long interval = intervalSeconds > 0 ? (long long)(intervalSeconds * 1000) : 0;
+	if (intervalSeconds > 0 && interval == 0) interval = 1;
+	autoGcPadSize = padsz;
+	autoGcDeadlineMs = monotonic_ms() + interval;
+	autoGcIntervalMs = interval;
+}
+
+#if defined(LTALLOC_OVERRIDE_MALLOC) && !defined(_WIN32)
+//Replacement of the C allocation functions, as described in the "Replacing malloc" section of the glibc manual.
+//Thread caches use TLS, so this only works when ltalloc is linked into the executable, not into a shared library.
+#include <errno.h>
+
+static int valid_alignment(size_t align) {return align && !(align & (align-1)) && align <= CHUNK_SIZE;}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void *malloc(size_t size) {return ltmalloc(size);}
+void free(void *p) {ltfree(p);}
+void *calloc(size_t elems, size_t size) {return ltcalloc(elems, size);}
+void *realloc(void *p, size_t size) {return ltrealloc(p, size);}
+size_t malloc_usable_size(void *p) {return ltmsize(p);}
+void *memalign(size_t align, size_t size) {
+	if (!valid_alignment(align)) {errno = EINVAL; return NULL;}
+	return ltmemalign(align, size);
+}
+void *aligned_alloc(size_t align, size_t size) {return memalign(align, size);}
+int posix_memalign(void **result, size_t align, size_t size) {
+	void *p;
+	if (!valid_alignment(align) || align % sizeof(void*)) return EINVAL;
+	p = ltmemalign(align, size);
+	if (!p) return ENOMEM;
+	*result = p;
+	return 0;
+}
+void *valloc(size_t size) {return ltmemalign(page_size(), size);}
+void *pvalloc(size_t size) {return ltmemalign(page_size(), (size + page_size()-1) & ~(page_size()-1));}
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,60 @@
+#ifndef LTALLOC_H
+#define LTALLOC_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void*  ltmalloc(size_t size);
+void   ltfree(void* p);
+void*  ltrealloc(void* p, size_t size);
+void*  ltcalloc(size_t elems, size_t size);
+void*  ltmemalign(size_t align, size_t size);
+size_t ltmsize(void* p);
+void   ltsqueeze(size_t padsz); /* return free chunks to the system, keeping up to padsz bytes for reuse */
+
+
+/* Statistics, collected when ltalloc.cc is compiled with LTALLOC_STATS.
+   Allocation and free counts are kept per thread and published to the global
+   counters whenever the thread goes to the central cache, on thread exit, or
+   by ltflushthreadstats(), so they may lag behind by up to one batch per thread. */
+
+typedef struct LtallocSizeClassStats
+{
+	size_t blockSize;
+	size_t chunks;                        /* chunks of CHUNK_SIZE bytes owned by the class */
+	unsigned long long allocations;
+	unsigned long long deallocations;
+	unsigned long long centralFetches;    /* thread cache misses: batches moved from the central cache to a thread cache */
+	unsigned long long centralReleases;   /* batches moved from a thread cache back to the central cache */
+} LtallocSizeClassStats;
+
+typedef struct LtallocStats
+{
+	size_t chunkSize;
+	size_t padBytes;                      /* free chunks kept by ltsqueeze for reuse */
+	size_t largeBytes;                    /* bytes in allocations that bypass the size classes */
+	unsigned long long largeAllocations;
+	unsigned long long largeDeallocations;
+	unsigned long long squeezes;          /* ltsqueeze runs, manual or automatic */
+	unsigned long long chunksReleased;    /* chunks returned to the system by ltsqueeze */
+} LtallocStats;
+
+/* Fills the global stats and the stats of up to maxClasses size classes.
+   Returns the total number of size classes, or 0 if statistics are not compiled in. */
+size_t ltstats(LtallocStats* stats, LtallocSizeClassStats* classes, size_t maxClasses);
+
+/* Publishes the calling thread's pending allocation and free counts. */
+void ltflushthreadstats(void);
+
+/* Runs ltsqueeze(padsz) at most once every intervalSeconds, from threads returning memory to
+   the central cache. An interval of 0 disables automatic collection. */
+void ltsetautogc(double intervalSeconds, size_t padsz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LTALLOC_H */
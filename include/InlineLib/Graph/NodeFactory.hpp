@@ -6,11 +6,15 @@
 
 #include <cassert>
 #include <functional>
+#include <memory_resource>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <type_traits>
 #include <typeindex>
 #include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 
 namespace inl {
@@ -19,34 +23,53 @@ class NodeFactory {
 public:
 	/// <summary> Contains description of a Node class, such as
 	/// port count, port names, node name and the like. </summary>
+	/// <remarks> Allocator-aware, the registry's entries allocate from the factory's resource. </remarks>
 	struct NodeInfo {
-		size_t numInputPorts;
-		size_t numOutputPorts;
-		std::vector<std::string> inputNames;
-		std::vector<std::string> outputNames;
-		std::vector<std::type_index> inputTypes;
-		std::vector<std::type_index> outputTypes;
-		std::string name;
-		std::string description;
-		std::string group;
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+
+		NodeInfo() = default;
+		explicit NodeInfo(const allocator_type& alloc);
+		NodeInfo(const NodeInfo& rhs, const allocator_type& alloc);
+		NodeInfo(NodeInfo&& rhs, const allocator_type& alloc);
+		NodeInfo(const NodeInfo&) = default;
+		NodeInfo(NodeInfo&&) = default;
+		NodeInfo& operator=(const NodeInfo&) = default;
+		NodeInfo& operator=(NodeInfo&&) = default;
+
+		size_t numInputPorts = 0;
+		size_t numOutputPorts = 0;
+		std::pmr::vector<std::pmr::string> inputNames;
+		std::pmr::vector<std::pmr::string> outputNames;
+		std::pmr::vector<std::type_index> inputTypes;
+		std::pmr::vector<std::type_index> outputTypes;
+		std::pmr::string name;
+		std::pmr::string description;
+		std::pmr::string group;
 	};
 
 private:
 	/// <summary> A helper struct to instantiate a specific node type. </summary>
 	struct NodeCreator {
+		using allocator_type = std::pmr::polymorphic_allocator<>;
+
 		NodeCreator() = default;
+		explicit NodeCreator(const allocator_type& alloc) : info(alloc) {}
+		NodeCreator(const NodeCreator& rhs, const allocator_type& alloc) : info(rhs.info, alloc), creator(rhs.creator) {}
+		NodeCreator(NodeCreator&& rhs, const allocator_type& alloc) : info(std::move(rhs.info), alloc), creator(rhs.creator) {}
 		NodeCreator(const NodeCreator&) = default;
 		NodeCreator(NodeCreator&&) = default;
 		NodeInfo info;
 		NodeBase* Create() const {
 			return creator ? creator() : nullptr;
 		}
-		std::function<NodeBase*()> creator;
+		NodeBase* (*creator)() = nullptr; // A plain function, nodes are created by their default constructor.
 	};
-	using RegistryMapT = std::unordered_map<std::string, NodeCreator>;
+	using RegistryMapT = std::pmr::unordered_map<std::pmr::string, NodeCreator, TransparentStringHash, std::equal_to<>>;
 
 public:
-	NodeFactory() = default;
+	/// <param name="resource"> The registry tables and their entries allocate from this. </param>
+	explicit NodeFactory(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+		: registeredClasses(resource), typeLookup(resource) {}
 	NodeFactory(const NodeFactory&) = delete;
 	~NodeFactory() = default;
 
@@ -70,7 +93,7 @@ public:
 
 private:
 	RegistryMapT registeredClasses; // Maps group/name entries to creators.
-	std::unordered_map<std::type_index, std::tuple<std::string, std::string>> typeLookup;
+	std::pmr::unordered_map<std::type_index, std::tuple<std::pmr::string, std::pmr::string>> typeLookup;
 };
 
 
@@ -80,27 +103,27 @@ bool NodeFactory::RegisterNodeClass(const std::string& group) {
 	static_assert(std::is_base_of<NodeBase, T>::value, "Registered class does not inherit from NodeBase.");
 
 	// Cut trailing slash from group name.
-	std::string strGroup = group;
-	while (strGroup.size() > 0 && strGroup[strGroup.size() - 1] == '/') {
-		strGroup.pop_back();
+	std::string_view strGroup = group;
+	while (strGroup.size() > 0 && strGroup.back() == '/') {
+		strGroup.remove_suffix(1);
 	}
 
 	// Split name to name and description.
+	// Views into the name, so that only the registry's own strings are allocated.
 	std::string nameDesc = T::Info_GetName();
-	auto tokens = Tokenize(nameDesc, ":", false);
-	if (tokens.size() == 0) {
+	if (nameDesc.empty()) {
 		throw InvalidArgumentException("Node's name cannot be empty.");
 	}
 
-	std::string strName(tokens[0].begin(), tokens[0].end());
-	if (strName.find('/') != std::string::npos) {
+	std::string_view strName = NextToken(nameDesc, ":").value();
+	if (strName.find('/') != std::string_view::npos) {
 		assert(false); // Node's name cannot contain slashes
 		return false;
 	}
 
-	std::string strDesc;
-	if (tokens.size() >= 2) {
-		strDesc = std::string(tokens[1].begin(), tokens[1].end());
+	std::string_view strDesc;
+	if (strName.size() < nameDesc.size()) {
+		strDesc = NextToken(std::string_view(nameDesc).substr(strName.size() + 1), ":").value_or(std::string_view{});
 	}
 
 	// check already registered
@@ -111,15 +134,21 @@ bool NodeFactory::RegisterNodeClass(const std::string& group) {
 	}
 
 	// set up node information for the class
-	NodeCreator creator;
+	NodeInfo::allocator_type alloc = registeredClasses.get_allocator();
+	NodeCreator creator(alloc);
 	creator.info.name = strName;
 	creator.info.description = strDesc;
 	creator.info.group = strGroup;
 	creator.creator = []() -> NodeBase* { return new T(); };
 
 	// insert class to registered classes' map
-	registeredClasses.insert({ strGroup + (strGroup.size() > 0 ? "/" : "") + strName, std::move(creator) });
-	typeLookup.insert({ typeid(T), { strGroup, strName } });
+	std::pmr::string key(strGroup, alloc);
+	if (strGroup.size() > 0) {
+		key += '/';
+	}
+	key += strName;
+	registeredClasses.emplace(std::move(key), std::move(creator));
+	typeLookup.try_emplace(typeid(T), std::pmr::string(strGroup, alloc), std::pmr::string(strName, alloc));
 
 	return true;
 }
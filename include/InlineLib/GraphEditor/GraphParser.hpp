@@ -1,12 +1,16 @@
 #pragma once
 
 #include "../Graph/SerializableNode.hpp"
+#include "../StringUtil.hpp"
 
 #include <InlineMath.hpp>
 #include <functional>
+#include <memory_resource>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 
 namespace inl {
@@ -16,29 +20,39 @@ struct NodeMetaDescription {
 	Vec2i placement = { 0, 0 };
 };
 
+/// <remarks> The parser creates the strings with its resource. Optional strings are not allocator-aware,
+///		so the descriptions are not either, copies allocate from the default resource. </remarks>
 struct NodeDescription {
+	NodeDescription() = default;
+	explicit NodeDescription(std::pmr::memory_resource* resource) : cl(resource), defaultInputs(resource) {}
+
 	std::optional<int> id;
-	std::optional<std::string> name;
-	std::string cl;
-	std::vector<std::optional<std::string>> defaultInputs;
+	std::optional<std::pmr::string> name;
+	std::pmr::string cl;
+	std::pmr::vector<std::optional<std::pmr::string>> defaultInputs;
 	NodeMetaDescription metaData;
 };
 
 struct LinkDescription {
 	std::optional<int> srcid, dstid;
-	std::optional<std::string> srcname, dstname;
+	std::optional<std::pmr::string> srcname, dstname;
 	std::optional<int> srcpidx, dstpidx;
-	std::optional<std::string> srcpname, dstpname;
+	std::optional<std::pmr::string> srcpname, dstpname;
 };
 
 struct GraphHeader {
-	std::string contentType;
+	std::pmr::string contentType;
 };
 
 
 class GraphParser {
 public:
-	void Parse(const std::string& json);
+	/// <param name="resource"> The descriptions, the lookup tables and the parsed JSON document allocate from this. </param>
+	explicit GraphParser(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+	/// <summary> Parses the JSON description of a graph. </summary>
+	/// <remarks> Takes a view, so that the text can come straight from a <see cref="MappedFile"/> without copying. </remarks>
+	void Parse(std::string_view json);
 
 	// TODO: make common interface for all node/port systems.
 	static std::string Serialize(const ISerializableNode* const* nodes,
@@ -48,32 +62,33 @@ public:
 								 const GraphHeader& header);
 
 	const GraphHeader& GetHeader() const;
-	const std::vector<NodeDescription>& GetNodes() const;
-	const std::vector<LinkDescription>& GetLinks() const;
+	const std::pmr::vector<NodeDescription>& GetNodes() const;
+	const std::pmr::vector<LinkDescription>& GetLinks() const;
 
-	size_t FindNode(const std::optional<int>& id, const std::optional<std::string>& name) const;
+	size_t FindNode(const std::optional<int>& id, const std::optional<std::pmr::string>& name) const;
 	size_t FindNode(int id) const;
-	size_t FindNode(const std::string& name) const;
+	size_t FindNode(std::string_view name) const;
 
-	ISerializableInputPort& FindInputPort(ISerializableNode* holder, const std::optional<int>& index, const std::optional<std::string>& name);
-	ISerializableInputPort& FindInputPort(ISerializableNode* holder, const std::string& name);
+	ISerializableInputPort& FindInputPort(ISerializableNode* holder, const std::optional<int>& index, const std::optional<std::pmr::string>& name);
+	ISerializableInputPort& FindInputPort(ISerializableNode* holder, std::string_view name);
 	ISerializableInputPort& FindInputPort(ISerializableNode* holder, int index);
-	ISerializableOutputPort& FindOutputPort(ISerializableNode* holder, const std::optional<int>& index, const std::optional<std::string>& name);
-	ISerializableOutputPort& FindOutputPort(ISerializableNode* holder, const std::string& name);
+	ISerializableOutputPort& FindOutputPort(ISerializableNode* holder, const std::optional<int>& index, const std::optional<std::pmr::string>& name);
+	ISerializableOutputPort& FindOutputPort(ISerializableNode* holder, std::string_view name);
 	ISerializableOutputPort& FindOutputPort(ISerializableNode* holder, int index);
 
 private:
-	void ParseDocument(const std::string& document);
+	void ParseDocument(std::string_view document);
 	void CreateLookupTables();
 	static std::string MakeJson(std::vector<NodeDescription> nodeDescs, std::vector<LinkDescription> linkDescs, const GraphHeader& header);
 
 private:
+	std::pmr::memory_resource* m_resource;
 	GraphHeader m_header;
-	std::vector<NodeDescription> m_nodeDescs;
-	std::vector<LinkDescription> m_linkDescs;
+	std::pmr::vector<NodeDescription> m_nodeDescs;
+	std::pmr::vector<LinkDescription> m_linkDescs;
 
-	std::unordered_map<int, size_t> m_idLookup;
-	std::unordered_map<std::string, size_t> m_nameLookup;
+	std::pmr::unordered_map<int, size_t> m_idLookup;
+	std::pmr::unordered_map<std::pmr::string, size_t, TransparentStringHash, std::equal_to<>> m_nameLookup;
 };
 
 
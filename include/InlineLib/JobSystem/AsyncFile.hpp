@@ -0,0 +1,268 @@
+#pragma once
+
+#include "Scheduler.hpp"
+#include "SchedulablePromiseTag.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <experimental/coroutine>
+#include <memory>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace inl::jobs {
+
+
+enum class eFileAccess {
+	READ, // Opens an existing file for reading.
+	WRITE, // Creates the file or truncates an existing one, opens it for writing.
+	READ_WRITE, // Opens or creates the file without truncating, for reading and writing.
+};
+
+
+enum class eIoBackend {
+	AUTOMATIC, // io_uring where the kernel supports it, the thread pool otherwise.
+	IO_URING,
+	THREAD_POOL,
+};
+
+
+/// <summary> One piece of a scatter/gather transfer. Layout matches POSIX iovec. </summary>
+struct IoBuffer {
+	void* data;
+	size_t size;
+};
+
+
+namespace impl {
+	class IoBackend;
+
+	enum class eIoOperation {
+		READ,
+		WRITE,
+	};
+
+	// Shared by all requests that resume the same coroutine.
+	struct IoCompletion {
+		std::atomic_size_t remaining = 0;
+		std::experimental::coroutine_handle<> handle;
+		Scheduler* scheduler = nullptr;
+	};
+
+	struct IoRequest {
+		eIoOperation operation;
+		intptr_t fileHandle;
+		uint64_t offset;
+		const IoBuffer* buffers;
+		unsigned bufferCount;
+		int64_t result; // Bytes transferred or a negative platform error code.
+		IoCompletion* completion;
+	};
+
+	// Called by the backends when a request has finished.
+	void CompleteRequest(IoRequest* request) noexcept;
+
+	// Throws if the request has failed.
+	size_t GetRequestResult(const IoRequest& request);
+} // namespace impl
+
+
+/// <summary>
+/// Executes the file operations of <see cref="AsyncFile"/> and <see cref="IoBatch"/>, and
+/// resumes the awaiting coroutines when their operations are completed.
+/// </summary>
+/// <remarks>
+/// With io_uring, a single thread reaps completions. With the thread pool, operations are
+/// executed as blocking calls on a few dedicated threads. In both cases, the coroutines are
+/// resumed on the scheduler they were running on, or on the I/O thread if they had none.
+/// All operations must be completed before the service is destroyed.
+/// </remarks>
+class IoService {
+public:
+	/// <param name="backend"> Requesting IO_URING throws <see cref="NotSupportedException"/> if it's not available. </param>
+	/// <param name="threadCount"> Threads used by the thread pool backend. </param>
+	IoService(eIoBackend backend = eIoBackend::AUTOMATIC, int threadCount = 2);
+	IoService(const IoService&) = delete;
+	IoService& operator=(const IoService&) = delete;
+	~IoService();
+
+	/// <summary> The backend actually in use, never AUTOMATIC. </summary>
+	eIoBackend GetBackend() const noexcept;
+
+	/// <summary> Submits all requests in one go. Requests must stay alive until completed. </summary>
+	void Submit(impl::IoRequest* const* requests, size_t count);
+
+	/// <summary> The service used by files that were not given one explicitly. </summary>
+	static IoService& Default();
+
+private:
+	std::unique_ptr<impl::IoBackend> m_backend;
+	eIoBackend m_backendType;
+};
+
+
+/// <summary>
+/// A file that is read and written with co_await instead of blocking the worker thread.
+/// Operations take explicit offsets, so independent reads and writes may be in flight at the same time.
+/// </summary>
+/// <remarks>
+/// Buffers must stay valid until the operation completes, which they do when awaited right away.
+/// </remarks>
+class AsyncFile {
+public:
+	/// <summary> Awaitable of a single operation. co_await returns the number of bytes transferred. </summary>
+	class IoAwaiter {
+		friend class AsyncFile;
+
+	public:
+		bool await_ready() const noexcept { return false; }
+		template <class T>
+		bool await_suspend(T awaitingCoroutine);
+		size_t await_resume();
+
+	private:
+		IoAwaiter(IoService& service, impl::eIoOperation operation, intptr_t fileHandle, uint64_t offset, const IoBuffer* buffers, size_t count);
+		bool await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler);
+
+	private:
+		IoService& m_service;
+		impl::IoRequest m_request;
+		impl::IoCompletion m_completion;
+		IoBuffer m_singleBuffer;
+		std::vector<IoBuffer> m_buffers; // Only used for scatter/gather.
+	};
+
+public:
+	AsyncFile(IoService& service = IoService::Default()) noexcept;
+	/// <exception cref="FileNotFoundException"> If READ access is requested and the file does not exist. </exception>
+	/// <exception cref="RuntimeException"> If the file could not be opened. </exception>
+	AsyncFile(const std::string& path, eFileAccess access, IoService& service = IoService::Default());
+	AsyncFile(AsyncFile&& rhs) noexcept;
+	AsyncFile& operator=(AsyncFile&& rhs) noexcept;
+	~AsyncFile();
+
+	/// <summary> Closes the currently open file, if any, and opens the new one. </summary>
+	/// <exception cref="FileNotFoundException"> If READ access is requested and the file does not exist. </exception>
+	/// <exception cref="RuntimeException"> If the file could not be opened. </exception>
+	void Open(const std::string& path, eFileAccess access);
+	void Close() noexcept;
+	bool IsOpen() const noexcept;
+
+	/// <summary> Size of the file in bytes. </summary>
+	uint64_t Size() const;
+
+	/// <summary> Reads into the buffer starting from offset. May read less at the end of the file. </summary>
+	IoAwaiter Read(uint64_t offset, std::span<std::byte> buffer);
+
+	/// <summary> Writes the data to the file starting at offset. </summary>
+	IoAwaiter Write(uint64_t offset, std::span<const std::byte> data);
+
+	/// <summary> Reads a contiguous range of the file into multiple buffers, in order. </summary>
+	IoAwaiter ReadScatter(uint64_t offset, std::span<const std::span<std::byte>> buffers);
+
+	/// <summary> Writes multiple buffers to a contiguous range of the file, in order. </summary>
+	IoAwaiter WriteGather(uint64_t offset, std::span<const std::span<const std::byte>> buffers);
+
+	IoService& GetService() const noexcept { return *m_service; }
+	intptr_t GetNativeHandle() const noexcept { return m_handle; }
+
+private:
+	void CheckOpen() const;
+
+private:
+	IoService* m_service;
+	intptr_t m_handle;
+};
+
+
+/// <summary>
+/// Collects reads and writes, possibly to several files, and submits them together.
+/// The awaiting coroutine is resumed once, when all of them have completed.
+/// </summary>
+/// <remarks> Saves a system call per operation with io_uring. </remarks>
+class IoBatch {
+public:
+	class SubmitAwaiter {
+		friend class IoBatch;
+
+	public:
+		bool await_ready() const noexcept { return m_batch.m_requests.empty(); }
+		template <class T>
+		bool await_suspend(T awaitingCoroutine);
+		/// <exception cref="RuntimeException"> If any of the operations has failed. </exception>
+		void await_resume() const;
+
+	private:
+		SubmitAwaiter(IoBatch& batch) noexcept : m_batch(batch) {}
+		bool await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler);
+
+	private:
+		IoBatch& m_batch;
+	};
+
+public:
+	IoBatch(IoService& service = IoService::Default()) noexcept;
+
+	/// <summary> Adds a read to the batch. </summary>
+	/// <returns> The index of the operation, to be used with <see cref="GetResult"/>. </returns>
+	/// <exception cref="InvalidArgumentException"> If the file belongs to a different service. </exception>
+	size_t Read(const AsyncFile& file, uint64_t offset, std::span<std::byte> buffer);
+
+	/// <summary> Adds a write to the batch. </summary>
+	/// <returns> The index of the operation, to be used with <see cref="GetResult"/>. </returns>
+	/// <exception cref="InvalidArgumentException"> If the file belongs to a different service. </exception>
+	size_t Write(const AsyncFile& file, uint64_t offset, std::span<const std::byte> data);
+
+	/// <summary> Submits all operations added so far. The batch must not be modified until completed. </summary>
+	SubmitAwaiter Submit() noexcept;
+
+	/// <summary> Number of bytes transferred by the given operation. </summary>
+	/// <exception cref="RuntimeException"> If the operation has failed. </exception>
+	size_t GetResult(size_t index) const;
+
+	size_t Size() const noexcept { return m_requests.size(); }
+
+	/// <summary> Removes all operations so that the batch can be reused. </summary>
+	void Clear() noexcept;
+
+private:
+	size_t Add(const AsyncFile& file, impl::eIoOperation operation, uint64_t offset, void* data, size_t size);
+
+private:
+	IoService* m_service;
+	std::vector<impl::IoRequest> m_requests;
+	std::vector<IoBuffer> m_buffers;
+	std::vector<impl::IoRequest*> m_submitList;
+	impl::IoCompletion m_completion;
+};
+
+
+//------------------------------------------------------------------------------
+// Template defs.
+//------------------------------------------------------------------------------
+
+template <class T>
+bool AsyncFile::IoAwaiter::await_suspend(T awaitingCoroutine) {
+	Scheduler* scheduler = nullptr;
+	if constexpr (std::is_base_of_v<SchedulablePromiseTag, std::decay_t<decltype(awaitingCoroutine.promise())>>) {
+		scheduler = static_cast<const SchedulablePromiseTag&>(awaitingCoroutine.promise()).m_scheduler;
+	}
+	return await_suspend(std::experimental::coroutine_handle<>(awaitingCoroutine), scheduler);
+}
+
+
+template <class T>
+bool IoBatch::SubmitAwaiter::await_suspend(T awaitingCoroutine) {
+	Scheduler* scheduler = nullptr;
+	if constexpr (std::is_base_of_v<SchedulablePromiseTag, std::decay_t<decltype(awaitingCoroutine.promise())>>) {
+		scheduler = static_cast<const SchedulablePromiseTag&>(awaitingCoroutine.promise()).m_scheduler;
+	}
+	return await_suspend(std::experimental::coroutine_handle<>(awaitingCoroutine), scheduler);
+}
+
+
+} // namespace inl::jobs
@@ -4,7 +4,6 @@
 #include "Mutex.hpp"
 
 #include <future>
-#include <optional>
 #include <type_traits>
 
 
@@ -16,30 +15,45 @@ class ConditionVariable {
 public:
 	class CvarAwaiter {
 		friend class ConditionVariable;
-		using MutexAwaiter = std::invoke_result_t<decltype(&UniqueLock::Lock), UniqueLock*>;
 
 	public:
-		CvarAwaiter(CvarAwaiter&&);
+		CvarAwaiter(CvarAwaiter&&) noexcept;
 		CvarAwaiter(const CvarAwaiter&) = delete;
 
-		bool await_ready() const noexcept;
+		bool await_ready() const noexcept { return false; }
 		template <class T>
 		bool await_suspend(T awaitingCoroutine) noexcept;
 		void await_resume() noexcept {}
 
 	protected:
-		CvarAwaiter(const ConditionVariable& cvar, UniqueLock& mtx, std::function<bool()> pred = {}) noexcept
-			: m_cvar(cvar), m_mtx(mtx), m_pred(pred) {}
+		CvarAwaiter(const ConditionVariable& cvar, UniqueLock& lock) noexcept;
 		bool await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler = nullptr) noexcept;
 
 	private:
-		std::experimental::coroutine_handle<> m_awaitingHandle;
-		std::function<bool()> m_pred;
 		CvarAwaiter* m_next = nullptr;
-		Scheduler* m_scheduler = nullptr;
 		const ConditionVariable& m_cvar;
-		std::optional<MutexAwaiter> m_mutexAwaiter;
-		UniqueLock& m_mtx;
+		UniqueLock& m_lock;
+		Mutex::MutexAwaiter m_mutexAwaiter; // Handed over to the mutex's queue when notified, stores the coroutine as well.
+	};
+
+	/// <summary> Stores the predicate by value, no type erasure involved. </summary>
+	template <class Predicate>
+	class CvarAwaiterPred : public CvarAwaiter {
+		friend class ConditionVariable;
+
+	public:
+		CvarAwaiterPred(CvarAwaiterPred&&) noexcept = default;
+		CvarAwaiterPred(const CvarAwaiterPred&) = delete;
+
+		// Note that predicate does not need to be checked in await_suspend because it's protected by the mutex.
+		bool await_ready() const noexcept { return m_pred(); }
+
+	private:
+		CvarAwaiterPred(const ConditionVariable& cvar, UniqueLock& lock, Predicate pred) noexcept
+			: CvarAwaiter(cvar, lock), m_pred(std::move(pred)) {}
+
+	private:
+		Predicate m_pred;
 	};
 
 public:
@@ -47,14 +61,17 @@ public:
 
 	CvarAwaiter Wait(UniqueLock& lock);
 	template <class Predicate>
-	CvarAwaiter Wait(UniqueLock& lock, Predicate pred);
+	CvarAwaiterPred<Predicate> Wait(UniqueLock& lock, Predicate pred);
 	void WaitExplicit(UniqueLock& lock);
 	template <class Predicate>
 	void WaitExplicit(UniqueLock& lock, Predicate pred);
-	void AwakeAwaiter(CvarAwaiter* last);
 	void NotifyOne();
 	void NotifyAll();
 
+private:
+	/// <summary> Moves a chain of waiters linked via m_next into the wait queue of the mutex they belong to. </summary>
+	static void AwakeAwaiters(CvarAwaiter* first, CvarAwaiter* last);
+
 private:
 	mutable std::atomic<CvarAwaiter*> m_firstAwaiter;
 };
@@ -70,8 +87,8 @@ bool ConditionVariable::CvarAwaiter::await_suspend(T awaitingCoroutine) noexcept
 }
 
 template <class Predicate>
-ConditionVariable::CvarAwaiter ConditionVariable::Wait(UniqueLock& lock, Predicate pred) {
-	return CvarAwaiter{ *this, lock, pred };
+ConditionVariable::CvarAwaiterPred<Predicate> ConditionVariable::Wait(UniqueLock& lock, Predicate pred) {
+	return CvarAwaiterPred<Predicate>{ *this, lock, std::move(pred) };
 }
 
 template <class Predicate>
@@ -46,6 +46,7 @@ public:
 	void Signal(uint64_t value);
 	FenceAwaiter Wait(uint64_t value) const;
 	bool TryWait(uint64_t value) const;
+	uint64_t GetValue() const noexcept { return m_currentValue.load(std::memory_order_acquire); }
 	void WaitExplicit(uint64_t value) const;
 
 private:
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "../Memory/ArenaResource.hpp"
+#include "SharedFuture.hpp"
+
+
+namespace inl::jobs {
+
+
+/// <summary>
+/// Scratch memory for the temporary allocations of a job.
+/// The arena is reset when the job's <see cref="SharedFuture"/> completes.
+/// </summary>
+/// <remarks>
+/// The arena itself is not thread-safe: it should be used by one job at a time,
+/// which may of course move between threads as it's resumed.
+/// </remarks>
+class JobScratchArena : public ScratchArenaResource {
+public:
+	using ScratchArenaResource::ScratchArenaResource;
+
+	/// <summary> Resets the arena as soon as the job completes, even if it throws. </summary>
+	/// <param name="job"> The job using the arena. </param>
+	/// <returns> A future that completes with the job's result after the arena has been reset. </returns>
+	template <class T>
+	SharedFuture<T> ResetWhenComplete(SharedFuture<T> job) {
+		auto future = ResetAfter(std::move(job), this);
+		future.Run();
+		return future;
+	}
+
+	SharedFuture<void> ResetWhenComplete(SharedFuture<void> job) {
+		auto future = ResetAfter(std::move(job), this);
+		future.Run();
+		return future;
+	}
+
+private:
+	// Not scheduled, so it continues on whichever thread completes the job.
+	template <class T>
+	static SharedFuture<T> ResetAfter(SharedFuture<T> job, JobScratchArena* arena) {
+		try {
+			T result = co_await job;
+			arena->Reset();
+			co_return result;
+		}
+		catch (...) {
+			arena->Reset();
+			throw;
+		}
+	}
+
+	static SharedFuture<void> ResetAfter(SharedFuture<void> job, JobScratchArena* arena) {
+		try {
+			co_await job;
+			arena->Reset();
+		}
+		catch (...) {
+			arena->Reset();
+			throw;
+		}
+	}
+};
+
+
+} // namespace inl::jobs
@@ -9,7 +9,21 @@
 namespace inl::jobs {
 
 
+/// <summary> Decides which waiter the mutex is handed over to on unlock. </summary>
+enum class eMutexPolicy {
+	/// <summary> Waiters get the mutex strictly in the order they started waiting. </summary>
+	FIFO,
+	/// <summary>
+	/// The most recent arrival is served first, its frame is still hot in the cache.
+	/// Older waiters are overtaken at most maxBarges times in a row.
+	/// </summary>
+	BARGING,
+};
+
+
 class Mutex {
+	friend class ConditionVariable;
+
 public:
 	class MutexAwaiter {
 		friend class ConditionVariable;
@@ -40,7 +54,7 @@ public:
 	};
 
 public:
-	Mutex() noexcept;
+	Mutex(eMutexPolicy policy = eMutexPolicy::FIFO, unsigned maxBarges = 8) noexcept;
 	Mutex(const Mutex&) = delete;
 	Mutex(Mutex&&) noexcept = default;
 	Mutex& operator=(const Mutex&) = delete;
@@ -52,10 +66,29 @@ public:
 	bool TryLock();
 	void Unlock();
 
+	eMutexPolicy GetPolicy() const noexcept { return m_policy; }
+
 private:
-	std::atomic<MutexAwaiter*> m_firstAwaiter; // Nullptr if free, otherwise last in the list owns mutex. Lst is a dangling pointer.
-	volatile MutexAwaiter* m_holder; // If same as the last in the list above. Used to figure out where the list ends, because last pointer in list in always dangling.
-	inline static MutexAwaiter* tryLockTag = reinterpret_cast<MutexAwaiter*>(~size_t(0));
+	/// <summary> Appends an already suspended chain of awaiters linked via m_next to the wait queue in one step. </summary>
+	/// <remarks> If the mutex was free, it's handed over to the longest waiting of the chain right away. </remarks>
+	void EnqueueAwaiters(MutexAwaiter* first, MutexAwaiter* last) noexcept;
+
+	/// <summary> Removes the next owner from the waiters, or releases the mutex if there are none. Holder only. </summary>
+	MutexAwaiter* PopWaiter() noexcept;
+
+	/// <summary> Reverses the stack of new arrivals and appends it to the holder's FIFO queue. </summary>
+	void AppendToQueue(MutexAwaiter* arrivals) noexcept;
+
+	static void ResumeAwaiter(MutexAwaiter* awaiter) noexcept;
+
+private:
+	std::atomic<MutexAwaiter*> m_state; // notLockedTag if free, nullptr if locked with no new arrivals, otherwise locked and a stack of new arrivals (newest first).
+	MutexAwaiter* m_waitersFirst = nullptr; // Waiters already taken off the arrival stack in FIFO order. Only accessed by the holder.
+	MutexAwaiter* m_waitersLast = nullptr;
+	eMutexPolicy m_policy;
+	unsigned m_maxBarges;
+	unsigned m_barges = 0; // Number of times in a row the oldest waiter was overtaken.
+	inline static MutexAwaiter* const notLockedTag = reinterpret_cast<MutexAwaiter*>(~size_t(0));
 };
 
 
@@ -73,6 +106,8 @@ private:
 
 
 class UniqueLock {
+	friend class ConditionVariable;
+
 public:
 	UniqueLock(Mutex& mutex) noexcept;
 	~UniqueLock() noexcept;
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "Scheduler.hpp"
+#include "SchedulablePromiseTag.hpp"
+
+#include <atomic>
+#include <exception>
+#include <experimental/coroutine>
+#include <type_traits>
+
+
+namespace inl::jobs {
+
+
+/// <summary>
+/// Runs child tasks whose lifetime is bound to the group.
+/// Spawning a regular function costs one child frame and an increment of the outstanding counter,
+/// no future is created for it. A coroutine child still creates its own frame and SharedFuture state,
+/// the group's child frame awaits it. The group must be joined before it's destroyed.
+/// </summary>
+class TaskGroup {
+	class ChildTask;
+
+public:
+	class JoinAwaiter {
+		friend class TaskGroup;
+
+	public:
+		bool await_ready() const noexcept;
+		template <class T>
+		bool await_suspend(T awaitingCoroutine) noexcept;
+		void await_resume();
+
+	private:
+		JoinAwaiter(TaskGroup& group) noexcept : m_group(group) {}
+		bool await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler = nullptr) noexcept;
+
+	private:
+		TaskGroup& m_group;
+	};
+
+public:
+	/// <param name="cancelOnFailure"> If a child throws, the group gets cancelled. </param>
+	TaskGroup(bool cancelOnFailure = false) noexcept;
+	TaskGroup(const TaskGroup&) = delete;
+	TaskGroup& operator=(const TaskGroup&) = delete;
+	~TaskGroup();
+
+	/// <summary> Starts func(args...) as a child of the group on the given scheduler. </summary>
+	/// <remarks> Func may be a regular function or a coroutine returning a SharedFuture.
+	///		Coroutines cost their own frame and shared state on top of the child frame.
+	///		If the child's frame can't be created, the exception propagates and the group is unchanged. </remarks>
+	template <class Func, class... Args>
+	void Spawn(Scheduler& scheduler, Func func, Args... args);
+
+	/// <summary> Completes when all children have finished. Rethrows the first exception thrown by a child. </summary>
+	/// <remarks> The group may be reused after joining. </remarks>
+	JoinAwaiter Join() noexcept;
+
+	/// <summary> Children that have not started yet won't run, running children can check <see cref="IsCancelled"/>. </summary>
+	void Cancel() noexcept;
+	bool IsCancelled() const noexcept;
+
+private:
+	template <class Func, class... Args>
+	static ChildTask RunChild(const TaskGroup* group, Scheduler* scheduler, Func func, Args... args);
+
+	void OnChildFinished() noexcept;
+	void SetException(std::exception_ptr ex) noexcept;
+
+private:
+	std::atomic_ptrdiff_t m_outstanding; // Running children plus one held by the joiner until it suspends.
+	std::atomic_bool m_cancelled;
+	std::atomic_flag m_hasException;
+	std::exception_ptr m_exception;
+	std::experimental::coroutine_handle<> m_joiningHandle;
+	Scheduler* m_joiningScheduler = nullptr;
+	bool m_cancelOnFailure;
+};
+
+
+//------------------------------------------------------------------------------
+// Child task coroutine.
+//------------------------------------------------------------------------------
+
+class TaskGroup::ChildTask {
+public:
+	class promise_type : public SchedulablePromiseTag {
+	public:
+		struct FinalAwaiter {
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::experimental::coroutine_handle<promise_type> handle) noexcept {
+				// Frame is gone before the group learns about it, so the group can be destroyed right after.
+				TaskGroup* group = handle.promise().m_group;
+				handle.destroy();
+				group->OnChildFinished();
+			}
+			void await_resume() noexcept {}
+		};
+
+		ChildTask get_return_object() { return ChildTask{ std::experimental::coroutine_handle<promise_type>::from_promise(*this) }; }
+		auto initial_suspend() noexcept { return std::experimental::suspend_always(); }
+		auto final_suspend() noexcept { return FinalAwaiter{}; }
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept { m_group->SetException(std::current_exception()); }
+
+		TaskGroup* m_group = nullptr;
+	};
+
+	std::experimental::coroutine_handle<promise_type> m_handle;
+};
+
+
+//------------------------------------------------------------------------------
+// TaskGroup - template defs.
+//------------------------------------------------------------------------------
+
+template <class Func, class... Args>
+void TaskGroup::Spawn(Scheduler& scheduler, Func func, Args... args) {
+	static_assert(std::is_invocable<Func, Args...>::value, "Object must be callable with given arguments.");
+
+	// Count the child only once its frame exists, if creating it throws, the group must be left as it was.
+	auto handle = RunChild(this, &scheduler, std::move(func), std::forward<Args>(args)...).m_handle;
+	m_outstanding.fetch_add(1);
+	handle.promise().m_group = this;
+	handle.promise().m_scheduler = &scheduler;
+	scheduler.Resume(handle);
+}
+
+
+template <class Func, class... Args>
+TaskGroup::ChildTask TaskGroup::RunChild(const TaskGroup* group, Scheduler* scheduler, Func func, Args... args) {
+	if (group->IsCancelled()) {
+		co_return;
+	}
+	if constexpr (is_schedulable<Func, Args...>::value) {
+		auto task = func(std::forward<Args>(args)...);
+		task.Schedule(*scheduler);
+		co_await task;
+	}
+	else {
+		func(std::forward<Args>(args)...);
+	}
+}
+
+
+template <class T>
+bool TaskGroup::JoinAwaiter::await_suspend(T awaitingCoroutine) noexcept {
+	Scheduler* scheduler = nullptr;
+	if constexpr (std::is_base_of_v<SchedulablePromiseTag, std::decay_t<decltype(awaitingCoroutine.promise())>>) {
+		scheduler = static_cast<const SchedulablePromiseTag&>(awaitingCoroutine.promise()).m_scheduler;
+	}
+	return await_suspend(std::experimental::coroutine_handle<>(awaitingCoroutine), scheduler);
+}
+
+
+} // namespace inl::jobs
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <charconv>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -37,6 +38,7 @@ struct EventParameter {
 	EventParameter() = default;
 	EventParameter(const std::string& name) : name(name) {}
 	EventParameter(const char* name) : name(name) {}
+	virtual ~EventParameter() = default;
 
 	/// <summary> Name of the parameter. </summary>
 	std::string name;
@@ -44,6 +46,10 @@ struct EventParameter {
 	/// <summary> Convert the parameter's value to string. </summary>
 	virtual std::string ToString() const { return std::string{}; }
 
+	/// <summary> Append the parameter's value to <paramref name="text"/>, the same as <see cref="ToString"/> would give. </summary>
+	/// <remarks> Used when writing logs, derived classes override it to format without a temporary string. </remarks>
+	virtual void AppendValue(std::string& text) const { text += ToString(); }
+
 	/// <summary> Get the underlying type (Float, Int or Raw). </summary>
 	virtual eEventParameterType Type() const { return eEventParameterType::DEFAULT; }
 
@@ -68,6 +74,13 @@ struct EventParameterFloat : public EventParameter {
 		return ss.str();
 	}
 
+	/// <summary> Append the float value, formatted like the streams do by default. </summary>
+	void AppendValue(std::string& text) const override {
+		char buffer[32];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, 6);
+		text.append(buffer, result.ptr);
+	}
+
 	/// <summary> Get the underlying type which is Float. </summary>
 	eEventParameterType Type() const override { return eEventParameterType::FLOAT; }
 
@@ -92,6 +105,13 @@ struct EventParameterInt : public EventParameter {
 		return ss.str();
 	}
 
+	/// <summary> Append the int value. </summary>
+	void AppendValue(std::string& text) const override {
+		char buffer[16];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+		text.append(buffer, result.ptr);
+	}
+
 	/// <summary> Get the underlying type which is Int. </summary>
 	eEventParameterType Type() const override { return eEventParameterType::INT; }
 
@@ -116,6 +136,13 @@ struct EventParameterString : public EventParameter {
 		return ss.str();
 	}
 
+	/// <summary> Append the string value in quotes. </summary>
+	void AppendValue(std::string& text) const override {
+		text += '"';
+		text += value;
+		text += '"';
+	}
+
 	/// <summary> Get the underlying type which is Int. </summary>
 	eEventParameterType Type() const override { return eEventParameterType::STRING; }
 
@@ -133,6 +160,11 @@ struct EventParameterRaw : public EventParameter {
 		return "binary data";
 	}
 
+	/// <summary> Append "binary data". </summary>
+	void AppendValue(std::string& text) const override {
+		text += "binary data";
+	}
+
 	/// <summary> Get the underlying type which is Raw. </summary>
 	eEventParameterType Type() const override { return eEventParameterType::RAW; }
 
@@ -182,6 +214,8 @@ public:
 	LogEvent(LogEvent&&) = default;
 	~LogEvent() = default;
 
+	LogEvent& operator=(LogEvent&&) = default;
+
 	/// <summary> Set message of the event. </summary>
 	void SetMessage(const std::string& message);
 	/// <summary> Get current message. </summary>
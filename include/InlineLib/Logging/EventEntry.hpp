@@ -3,20 +3,17 @@
 #include "Event.hpp"
 
 #include <chrono>
-#include <deque>
+#include <cstddef>
 
 
 namespace inl {
 
-/// <summary> Contains an event and its timestamp. </summary>
+/// <summary> Contains an event, its timestamp and the stream it was logged to. </summary>
 struct EventEntry {
 	std::chrono::high_resolution_clock::time_point timestamp;
+	size_t stream; /// <summary> Index of the stream in the LogNode. </summary>
 	LogEvent event;
 };
 
 
-/// <summary> Used by LogPipe and LogNode to buffer incoming events. </summary>
-using EventBuffer = std::deque<EventEntry>;
-
-
 } // namespace inl
\ No newline at end of file
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "EventEntry.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+
+namespace inl {
+
+
+/// <summary> What a producer does when its event queue is full. </summary>
+enum class eLogOverflowPolicy {
+	/// <summary> Wait until the queue is drained. No events are lost. </summary>
+	BLOCK,
+	/// <summary> Discard the event that is being logged. </summary>
+	DROP_NEWEST,
+	/// <summary> Discard the oldest event in the queue to make room. </summary>
+	DROP_OLDEST,
+	/// <summary> Allocate a larger queue. No events are lost, and the producer never waits. </summary>
+	GROW,
+};
+
+
+/// <summary>
+/// Bounded event queue with a single producer thread and a single consumer.
+/// Used by LogNode to buffer the events of each producer thread.
+/// </summary>
+/// <remarks>
+/// <para> Neither side takes a lock. Each slot carries a sequence number, in the manner of Vyukov's bounded queue,
+///		which tells whether it is free, holds an event, or is being read. The producer writes only its own
+///		slots and position, so an uncontended push is a few loads and a release store. </para>
+/// <para> To drop the oldest event, the producer pops it the same way the consumer does. The read position is
+///		advanced with a compare-exchange, so the two never take the same event. </para>
+/// <para> When growing, the producer links a segment of twice the size after the full one, and continues there.
+///		The consumer frees the old segment once it has emptied it. </para>
+/// </remarks>
+class EventQueue {
+public:
+	/// <param name="capacity"> Number of events that fit the queue, rounded up to a power of two.
+	///		With <see cref="eLogOverflowPolicy::GROW"/>, only the initial capacity. </param>
+	/// <param name="resource"> The slots are allocated from this. Used by the producer if the queue grows. </param>
+	EventQueue(size_t capacity, eLogOverflowPolicy policy, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	EventQueue(const EventQueue&) = delete;
+	EventQueue& operator=(const EventQueue&) = delete;
+	~EventQueue();
+
+	/// <summary> Adds an event, or applies the overflow policy if the queue is full. Producer only. </summary>
+	/// <returns> False if the queue is full and the policy is <see cref="eLogOverflowPolicy::BLOCK"/>.
+	///		The entry is left untouched then, and the caller should retry once the consumer made room. </returns>
+	bool TryPush(EventEntry& entry);
+
+	/// <summary> Removes the oldest event. Consumer only. </summary>
+	/// <returns> False if the queue is empty. </returns>
+	bool TryPop(EventEntry& entry);
+
+	/// <summary> The number of events in the queue. Exact when called by the producer, an estimate otherwise. </summary>
+	size_t Size() const;
+
+	/// <summary> The number of events discarded by the overflow policy. </summary>
+	uint64_t GetDroppedCount() const;
+
+	eLogOverflowPolicy GetPolicy() const { return m_policy; }
+
+private:
+	struct Slot {
+		std::atomic_size_t sequence;
+		alignas(EventEntry) std::byte storage[sizeof(EventEntry)];
+	};
+
+	struct Segment {
+		Slot* slots;
+		size_t mask;
+		size_t pushPosition = 0; // Producer only.
+		alignas(64) std::atomic_size_t popPosition = 0;
+		std::atomic<Segment*> next = nullptr;
+	};
+
+	Segment* NewSegment(size_t capacity);
+	void DeleteSegment(Segment* segment);
+	static bool TryPush(Segment& segment, EventEntry& entry);
+	static bool TryPop(Segment& segment, EventEntry* entry);
+
+private:
+	eLogOverflowPolicy m_policy;
+	std::pmr::memory_resource* m_resource;
+
+	Segment* m_pushSegment; // Producer only.
+	std::atomic_uint64_t m_pushCount = 0; // Written by the producer only.
+	alignas(64) Segment* m_popSegment; // Consumer only.
+	std::atomic_uint64_t m_popCount = 0;
+	std::atomic_uint64_t m_droppedCount = 0;
+};
+
+
+} // namespace inl
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "EventEntry.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary> How a LogNode writes events to its output stream. </summary>
+enum class eLogFormat {
+	/// <summary> Human readable lines, formatted when the events are written. </summary>
+	TEXT,
+	/// <summary> Compact records, see <see cref="BinaryLogEncoder"/>. Rendered to text by <see cref="DecodeBinaryLog"/>. </summary>
+	BINARY,
+};
+
+
+/// <summary> Appends an event in the text format: a line with the time, stream and message, then a line per parameter. </summary>
+/// <param name="seconds"> Time of the event since the start of the logging. </param>
+void AppendTextLogEvent(std::string& text, double seconds, const std::string& stream, const LogEvent& evt);
+
+
+/// <summary>
+/// Writes events as binary records, deferring all formatting to <see cref="DecodeBinaryLog"/>.
+/// </summary>
+/// <remarks>
+/// <para> The log starts with the text line "InlineLib binary log 1", followed by the tick period of the clock
+///		and the start time in ticks. Then comes a sequence of records, each starting with a tag byte. </para>
+/// <para> Strings that repeat, like messages, parameter names and stream names, go into a string table.
+///		A string record assigns the next id to a string before its first use, and later records refer to it by id.
+///		Once the table is full, strings are written inline. Parameter values are written as raw bytes
+///		according to their type, strings and unknown types inline. </para>
+/// <para> Integers are little-endian variable-length, signed ones zigzag encoded. Event timestamps are raw
+///		clock ticks, stored as the difference from the previous event. </para>
+/// </remarks>
+class BinaryLogEncoder {
+public:
+	/// <summary> Appends the header of a new log, forgetting the strings and streams of the previous one. </summary>
+	void Begin(std::string& buffer, std::chrono::high_resolution_clock::time_point startTime);
+
+	/// <summary> Appends an event, preceded by the string and stream records it needs. </summary>
+	/// <param name="streamNames"> Names of the streams, indexed by the entry's stream. </param>
+	void Encode(std::string& buffer, const EventEntry& entry, const std::vector<std::string>& streamNames);
+
+	/// <summary> Strings beyond this many are written inline. </summary>
+	static constexpr size_t MaxStringCount = 65536;
+
+private:
+	/// <summary> Returns the id of the string, writing a string record if it's new. Zero if the table is full. </summary>
+	uint64_t Intern(std::string& buffer, const std::string& str);
+
+private:
+	std::unordered_map<std::string, uint64_t> m_stringIds;
+	std::vector<bool> m_streamsWritten;
+	std::vector<uint64_t> m_parameterNameIds;
+	int64_t m_lastTimestamp = 0;
+};
+
+
+/// <summary> Renders a binary log to the text format, as if it had been written as text. </summary>
+/// <exception cref="InvalidArgumentException"> If the input is not a binary log or is malformed.
+///		The events before the error have been written by then. </exception>
+void DecodeBinaryLog(std::istream& input, std::ostream& output);
+
+
+} // namespace inl
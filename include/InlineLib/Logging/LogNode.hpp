@@ -1,57 +1,149 @@
 #pragma once
 
+#include "EventQueue.hpp"
+#include "LogFormat.hpp"
+#include "../Memory/MultiInstanceTLS.hpp"
+
 #include <atomic>
 #include <chrono>
-#include <memory>
-#include <shared_mutex>
+#include <condition_variable>
+#include <memory_resource>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace inl {
 
+
+class LogPipe;
+
+
 /// <summary>
-/// The LogNode groups together a list of LogPipes.
-/// Each pipe collects and buffers events, the lognode periodically sorts
-/// and writes these messages to an output stream.
+/// The LogNode groups together a list of log streams.
+/// Each producer thread buffers its events in its own queue, the lognode's writer thread
+/// periodically merges the queues by timestamp and writes the events to an output stream.
 /// </summary>
+/// <remarks>
+/// <para> Producers never lock. A thread's first event allocates its queue and links it into the node,
+///		later events are pushed into that queue. When the thread exits, its queue is marked, and the writer
+///		frees it after draining it. Events are ordered by timestamp within each flush. </para>
+/// <para> The writer thread is started with the first stream. It flushes when a queue fills up to the threshold,
+///		when asked by <see cref="Flush"/>, or when the flush interval has passed. Producers wake it without
+///		taking its mutex, so a wakeup can be missed, which delays the flush by at most one interval. </para>
+/// </remarks>
 class LogNode {
 	friend class LogPipe;
 
 private:
-	struct PipeInfo {
-		std::weak_ptr<LogPipe> pipe;
-		std::string name;
+	struct ThreadQueue {
+		ThreadQueue(size_t capacity, eLogOverflowPolicy policy, std::pmr::memory_resource* resource)
+			: queue(capacity, policy, resource) {}
+		EventQueue queue;
+		ThreadQueue* next = nullptr;
+		std::atomic_bool exited = false; /// <summary> The thread won't push any more events. </summary>
+	};
+	/// <summary> A thread's reference to its queue, marks the queue when the thread exits. </summary>
+	struct ThreadQueueRef {
+		~ThreadQueueRef() {
+			if (queue) {
+				queue->exited.store(true, std::memory_order_release);
+			}
+		}
+		ThreadQueue* queue = nullptr;
 	};
-	struct PipeInfoShared {
-		std::shared_ptr<LogPipe> pipe;
-		std::string name;
+	/// <summary> The next event of a drained queue, in the heap that merges the queues. </summary>
+	struct MergeHead {
+		std::chrono::high_resolution_clock::time_point timestamp;
+		size_t buffer;
+		size_t position;
 	};
 
 public:
-	LogNode();
+	/// <param name="overflowPolicy"> What producers do when their queue is full. </param>
+	/// <param name="queueCapacity"> Number of events each producer thread can buffer. </param>
+	/// <param name="resource"> The queues allocate from this, when created or grown. Must be thread-safe. </param>
+	LogNode(eLogOverflowPolicy overflowPolicy = eLogOverflowPolicy::GROW,
+			size_t queueCapacity = defaultQueueCapacity,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 	~LogNode();
 
-	/// <summary> Force writing all pending events to disk. </summary>
+	/// <summary> Force writing all pending events to disk. Returns when the writer thread has written them. </summary>
 	void Flush();
 
-	/// <summar> Create a pipe connected to *this. </summary>
-	void AddPipe(std::shared_ptr<LogPipe> pipe, const std::string& name);
+	/// <summary> Register a new stream. </summary>
+	/// <returns> The index that identifies the stream's events. </returns>
+	size_t AddStream(const std::string& name);
 
 	/// <summary> Specify output stream. </summary>
-	void SetOutputStream(std::ostream* outputStream);
+	/// <param name="format"> How events are written. The binary format writes its header right away. </param>
+	void SetOutputStream(std::ostream* outputStream, eLogFormat format = eLogFormat::TEXT);
+
+	/// <summary> Number of events discarded by the overflow policy, over all producer threads. </summary>
+	uint64_t GetDroppedEventCount() const;
+
+	/// <summary> Set how often the writer thread flushes when no queue reaches the threshold. </summary>
+	void SetFlushInterval(std::chrono::milliseconds interval);
+
+	static constexpr size_t defaultQueueCapacity = 1024;
+	static constexpr std::chrono::milliseconds defaultFlushInterval{ 100 };
 
 private:
-	/// <summary> Call this from Pipe whenever a new message is buffered. </summary>
-	void NotifyNewEvent();
+	/// <summary> Called by pipes to buffer a new event. </summary>
+	void PutEvent(size_t stream, LogEvent&& evt);
+
+	/// <summary> Write pending events, mtx must be held. </summary>
+	void FlushLocked();
+
+	/// <summary> Format or encode an event to the end of writeBuffer. </summary>
+	void FormatEvent(const EventEntry& entry);
+
+	/// <summary> Write and clear writeBuffer. </summary>
+	void WriteBuffer();
+
+	/// <summary> Returns the calling thread's queue, creating it on first use. </summary>
+	EventQueue& GetThreadQueue();
+
+	/// <summary> Unlinks and frees the queue of an exited thread, mtx must be held. </summary>
+	/// <param name="previous"> The queue before it, as seen by the writer, or null if it was the first. </param>
+	void RetireQueue(ThreadQueue* queue, ThreadQueue* previous);
+
+	/// <summary> Body of the writer thread. </summary>
+	void WriterLoop();
+
+	std::vector<std::string> streamNames; /// <summary> Names of the streams, indexed by stream. </summary>
+	mutable std::mutex mtx; /// <summary> Serializes flushing, configuration and retiring queues. Producers don't use it. </summary>
+
+	std::thread writer; /// <summary> Writes the events, started by the first AddStream. </summary>
+	std::mutex writerMtx; /// <summary> Guards the writer's state below. </summary>
+	std::condition_variable writerWake;
+	std::condition_variable writerDone;
+	uint64_t flushRequested = 0; /// <summary> Ticket of the last Flush call. </summary>
+	uint64_t flushCompleted = 0; /// <summary> Ticket of the last Flush call the writer has completed. </summary>
+	bool stopWriter = false;
+	std::chrono::milliseconds flushInterval = defaultFlushInterval;
+	std::atomic_bool wakeRequested; /// <summary> Set by producers whose queue reached the threshold. </summary>
+
+	std::atomic<ThreadQueue*> queues; /// <summary> Queues of the producer threads, newest first. </summary>
+	mi_tls<ThreadQueueRef, eMiTlsLifetime::THREAD> threadQueue; /// <summary> Queue of the calling thread. </summary>
+	uint64_t retiredDroppedCount = 0; /// <summary> Events dropped by the queues already retired. </summary>
+	eLogOverflowPolicy overflowPolicy;
+	size_t queueCapacity;
+	size_t queueFlushThreshold; /// <summary> Wake the writer if a queue holds this many events. </summary>
+	std::pmr::memory_resource* resource;
 
-	std::vector<PipeInfo> pipes; /// <summary> List of associated pipes. </summary>
-	std::shared_timed_mutex mtx; /// <summary> Synchronize pipes with node. Node uses exclusive, pipes use shared mode. </summary>
-	std::atomic_bool prohibitPipes; /// <summary> Set to true to give node priority locking mtx. </summary>
-	std::atomic_ptrdiff_t pendingEvents; /// <summary> Number of pending events. </summary>
+	std::vector<std::vector<EventEntry>> drainedEvents; /// <summary> Events taken from each queue, kept to reuse the memory. </summary>
+	std::vector<MergeHead> mergeHeap; /// <summary> Min-heap of the oldest event of each drained queue. </summary>
+	std::string writeBuffer; /// <summary> Formatted events, written in one go. </summary>
 
 	std::ostream* outputStream;
+	eLogFormat outputFormat = eLogFormat::TEXT;
+	BinaryLogEncoder binaryEncoder; /// <summary> Keeps the string table of the binary output. </summary>
 	std::chrono::high_resolution_clock::time_point startTime; /// <summary> When the logging started. </summary>
 
-	static constexpr ptrdiff_t flushThreshold = 1000; /// <summary> Auto-flush if pending more than this. </summary>
+	static constexpr size_t flushThreshold = 1000; /// <summary> Auto-flush if pending more than this. </summary>
+	static constexpr size_t writeBatchSize = 64 * 1024; /// <summary> Write the formatted events when the buffer grows past this. </summary>
 };
 
 
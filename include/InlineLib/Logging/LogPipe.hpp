@@ -1,9 +1,9 @@
 #pragma once
 
-#include "EventEntry.hpp"
+#include "Event.hpp"
 
+#include <cstddef>
 #include <memory>
-#include <mutex>
 
 
 namespace inl {
@@ -11,13 +11,18 @@ namespace inl {
 class Logger;
 class LogNode;
 
+/// <summary>
+/// Connects a LogStream to its LogNode. Events are handed to the node, which queues them
+/// per producer thread, so a pipe can be used by many threads at once without locking.
+/// </summary>
 class LogPipe {
 	friend class inl::Logger;
 	friend class inl::LogNode;
 
 private:
 	/// <summary> Private to allow only Logger to create a pipe. </summary>
-	LogPipe(std::shared_ptr<LogNode> node);
+	/// <param name="stream"> Index of the stream in the node, returned by <see cref="LogNode::AddStream"/>. </param>
+	LogPipe(std::shared_ptr<LogNode> node, size_t stream);
 
 public:
 	LogPipe(const LogPipe&) = delete;
@@ -33,9 +38,8 @@ public:
 	std::shared_ptr<LogNode> GetNode();
 
 private:
-	EventBuffer buffer; /// <sumary> Temporary buffer for events, so less disk writes. </summary>
 	std::shared_ptr<LogNode> node; /// <summary> Which node *this belongs to. </summary>
-	std::mutex pipeLock; /// <summary> Prevent concurrent access to this pipe instance. </summary>
+	size_t stream; /// <summary> Which stream of the node events are logged to. </summary>
 };
 
 
@@ -5,8 +5,10 @@
 
 #include <InlineLib/Singleton.hpp>
 
+#include <chrono>
 #include <fstream>
 #include <memory>
+#include <memory_resource>
 #include <ostream>
 #include <string>
 
@@ -22,13 +24,25 @@ namespace inl {
 /// </summary>
 class Logger {
 public:
-	Logger();
+	/// <param name="resource"> Event queues of the producer threads allocate from this.
+	///		Logstreams are used concurrently, so the resource must be thread-safe. </param>
+	/// <param name="overflowPolicy"> What a thread does when it logs faster than events are written. </param>
+	/// <param name="queueCapacity"> Number of events each thread can buffer before the overflow policy applies. </param>
+	Logger(std::pmr::memory_resource* resource = std::pmr::get_default_resource(),
+		   eLogOverflowPolicy overflowPolicy = eLogOverflowPolicy::GROW,
+		   size_t queueCapacity = LogNode::defaultQueueCapacity);
+
+	/// <summary> Writes the pending events and detaches the output, streams may outlive the logger. </summary>
+	~Logger();
 
 	/// <summary> Open a log file for output. </summary>
-	bool OpenFile(const std::string& path);
+	/// <param name="format"> Binary logs are smaller and cheaper to write, and can be rendered to text
+	///		with <see cref="DecodeBinaryLog"/> or the InlineLogDecoder tool. </param>
+	bool OpenFile(const std::string& path, eLogFormat format = eLogFormat::TEXT);
 
 	/// <summary> Use an already opened output stream. </summary>
-	void OpenStream(std::ostream* stream);
+	/// <param name="format"> For binary output, the stream should be opened in binary mode. </param>
+	void OpenStream(std::ostream* stream, eLogFormat format = eLogFormat::TEXT);
 
 	/// <summary> Stop logging to output stream, close file, if any. </summary>
 	void CloseStream();
@@ -36,9 +50,16 @@ public:
 	/// <summary> Create a logstream. Use logstreams to log events. </summary>
 	LogStream CreateLogStream(const std::string& name);
 
-	/// <summary> Write all pending events to log file immediately. </summary>
+	/// <summary> Write all pending events to log file immediately.
+	///		Waits until the background writer has written them. </summary>
 	void Flush();
 
+	/// <summary> Set how often pending events are written when there are only a few of them. </summary>
+	void SetFlushInterval(std::chrono::milliseconds interval);
+
+	/// <summary> Number of events discarded because of the overflow policy. </summary>
+	uint64_t GetDroppedEventCount() const;
+
 private:
 	// do not ever flip the order of the two below!
 	// myNode must be destroyed first because it's using outputFile
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Container/ArrayView.hpp"
+#include "Exception/Exception.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+
+namespace inl {
+
+
+enum class eMapAccess {
+	READ_ONLY, // Maps an existing file for reading.
+	COPY_ON_WRITE, // Maps an existing file, writes go to private copies of the pages and never reach the file.
+	READ_WRITE, // Opens or creates the file, writes go to the file.
+};
+
+
+enum class eMapHint {
+	NORMAL,
+	SEQUENTIAL, // Pages will be accessed in order, read ahead aggressively and drop them soon after.
+	RANDOM, // Pages will be accessed in random order, don't read ahead.
+	WILL_NEED, // Pages will be accessed soon, start reading them in.
+	DONT_NEED, // Pages won't be accessed soon. Discards the changes of COPY_ON_WRITE mappings.
+	HUGE_PAGES, // Back the range with transparent huge pages where the file system supports it.
+};
+
+
+/// <summary>
+/// A file mapped into memory, so that its contents can be used in place without reading them into a buffer.
+/// </summary>
+/// <remarks>
+/// Opening is fast regardless of file size, pages are read in by the OS on first access.
+/// Empty files are not mapped, their data pointer is null.
+/// </remarks>
+class MappedFile {
+public:
+	MappedFile() noexcept = default;
+	/// <param name="size"> With READ_WRITE, the file is created or resized to this size if not zero. Ignored otherwise. </param>
+	/// <exception cref="FileNotFoundException"> If the file does not exist and the access is not READ_WRITE. </exception>
+	/// <exception cref="RuntimeException"> If the file could not be opened or mapped. </exception>
+	MappedFile(const std::string& path, eMapAccess access = eMapAccess::READ_ONLY, size_t size = 0);
+	MappedFile(MappedFile&& rhs) noexcept;
+	MappedFile& operator=(MappedFile&& rhs) noexcept;
+	~MappedFile();
+
+	/// <summary> Closes the currently open file, if any, and maps the new one. </summary>
+	/// <param name="size"> With READ_WRITE, the file is created or resized to this size if not zero. Ignored otherwise. </param>
+	/// <exception cref="FileNotFoundException"> If the file does not exist and the access is not READ_WRITE. </exception>
+	/// <exception cref="RuntimeException"> If the file could not be opened or mapped. </exception>
+	void Open(const std::string& path, eMapAccess access = eMapAccess::READ_ONLY, size_t size = 0);
+	void Close() noexcept;
+	bool IsOpen() const noexcept { return m_fileHandle != InvalidHandle; }
+
+	size_t Size() const noexcept { return m_size; }
+	eMapAccess GetAccess() const noexcept { return m_access; }
+
+	const std::byte* Data() const noexcept { return m_data; }
+	/// <exception cref="InvalidCallException"> If the file is mapped READ_ONLY. </exception>
+	std::byte* MutableData();
+
+	std::span<const std::byte> Bytes() const noexcept { return { m_data, m_size }; }
+	std::string_view Text() const noexcept { return { reinterpret_cast<const char*>(m_data), m_size }; }
+
+	/// <summary> Views the mapping as an array of <typeparamref name="T"/>. </summary>
+	/// <param name="offset"> Byte offset of the first element. Must be aligned for T. </param>
+	/// <param name="count"> Number of elements, or as many as fit if SIZE_MAX. </param>
+	/// <param name="stride"> Distance between elements in bytes. </param>
+	/// <exception cref="OutOfRangeException"> If the elements extend past the end of the file. </exception>
+	/// <exception cref="InvalidArgumentException"> If the offset or stride is not aligned for T. </exception>
+	template <class T>
+	ArrayView<const T> View(size_t offset = 0, size_t count = SIZE_MAX, size_t stride = sizeof(T)) const;
+
+	/// <summary> Views the mapping as a mutable array of <typeparamref name="T"/>. </summary>
+	/// <exception cref="InvalidCallException"> If the file is mapped READ_ONLY. </exception>
+	template <class T>
+	ArrayView<T> MutableView(size_t offset = 0, size_t count = SIZE_MAX, size_t stride = sizeof(T));
+
+	/// <summary> Tells the OS how a range of the mapping is going to be used. </summary>
+	/// <returns> False if the hint is not supported by the platform or file system. Hints are only advisory, so this is not an error. </returns>
+	bool Advise(eMapHint hint, size_t offset = 0, size_t length = SIZE_MAX) noexcept;
+
+	/// <summary> Writes modified pages back to the file. Does nothing unless mapped READ_WRITE. </summary>
+	/// <param name="wait"> Wait until the data is on disk, otherwise the writes are only scheduled. </param>
+	/// <exception cref="RuntimeException"> If the pages could not be written. </exception>
+	void Flush(bool wait = true);
+
+private:
+	static constexpr intptr_t InvalidHandle = -1;
+
+	size_t CheckedCount(size_t offset, size_t count, size_t stride, size_t elementSize, size_t alignment) const;
+
+private:
+	intptr_t m_fileHandle = InvalidHandle;
+	intptr_t m_mappingHandle = InvalidHandle; // Only used on Windows.
+	std::byte* m_data = nullptr;
+	size_t m_size = 0;
+	eMapAccess m_access = eMapAccess::READ_ONLY;
+};
+
+
+//------------------------------------------------------------------------------
+// Template defs.
+//------------------------------------------------------------------------------
+
+template <class T>
+ArrayView<const T> MappedFile::View(size_t offset, size_t count, size_t stride) const {
+	count = CheckedCount(offset, count, stride, sizeof(T), alignof(T));
+	return ArrayView<const T>(reinterpret_cast<const T*>(m_data + offset), count, stride);
+}
+
+
+template <class T>
+ArrayView<T> MappedFile::MutableView(size_t offset, size_t count, size_t stride) {
+	std::byte* data = MutableData();
+	count = CheckedCount(offset, count, stride, sizeof(T), alignof(T));
+	return ArrayView<T>(reinterpret_cast<T*>(data + offset), count, stride);
+}
+
+
+} // namespace inl
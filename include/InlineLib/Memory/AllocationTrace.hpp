@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+
+namespace inl {
+
+
+enum class eAllocationOp : uint8_t {
+	ALLOCATE,
+	DEALLOCATE,
+};
+
+
+/// <summary> A single allocation or deallocation in an <see cref="AllocationTrace"/>. </summary>
+struct AllocationTraceEvent {
+	eAllocationOp op;
+	uint32_t thread; // Index of the thread that made the call, in order of their first event.
+	uint64_t id; // Identifies the allocation, the same for an allocation and its deallocation.
+	uint64_t size; // Requested size in bytes, repeated for the deallocation.
+};
+
+
+/// <summary>
+/// A sequence of allocations and deallocations, recorded from a program or generated, to be replayed against allocators.
+/// </summary>
+/// <remarks>
+/// Allocation ids are dense and increase with the allocations. Every deallocation refers to an earlier
+/// allocation, but allocations may be left without a deallocation.
+/// </remarks>
+struct AllocationTrace {
+	std::vector<AllocationTraceEvent> events;
+
+	/// <summary> The number of distinct allocation ids. </summary>
+	size_t AllocationCount() const;
+
+	/// <summary> Writes the trace as text, one event per line. </summary>
+	void Write(std::ostream& os) const;
+
+	/// <summary> Reads a trace written by <see cref="Write"/>. </summary>
+	/// <exception cref="InvalidArgumentException"> If the stream does not contain a valid trace. </exception>
+	static AllocationTrace Read(std::istream& is);
+};
+
+
+/// <summary>
+/// Records the allocations of a running process into an <see cref="AllocationTrace"/>.
+/// </summary>
+/// <remarks>
+/// <para> Like <see cref="HeapProfiler"/>, the recorder doesn't hook anything itself. The operator new and delete
+///		replacements of the InlineLibHeapProfiler target report to both. Setting the INL_ALLOCATION_TRACE
+///		environment variable to a file path records the whole run of such a program and writes the trace at exit. </para>
+/// <para> Events go into a buffer that is allocated by <see cref="Start"/>, an atomic increment claims a slot.
+///		When the buffer is full, further events are counted and dropped. Pointers are turned into allocation ids
+///		only by <see cref="GetTrace"/>, so recording doesn't allocate or lock. </para>
+/// </remarks>
+class AllocationTraceRecorder {
+public:
+	static constexpr size_t DefaultCapacity = size_t(1) << 22;
+
+	/// <summary> Starts recording, discarding earlier events. </summary>
+	/// <param name="capacity"> The maximum number of events. </param>
+	/// <exception cref="InvalidCallException"> If already recording. </exception>
+	static void Start(size_t capacity = DefaultCapacity);
+
+	/// <summary> Stops recording. Events are kept until the next <see cref="Start"/>. </summary>
+	static void Stop();
+
+	static bool IsRunning();
+
+	/// <summary> The number of events that didn't fit the buffer. </summary>
+	static uint64_t GetDroppedEventCount();
+
+	/// <summary> Converts the recorded events to a trace. Deallocations of memory allocated before the recording started are left out. </summary>
+	/// <exception cref="InvalidCallException"> If called while recording, as building the trace allocates. </exception>
+	static AllocationTrace GetTrace();
+
+	/// <summary> Must be called after each allocation. </summary>
+	static void OnAllocation(void* ptr, size_t size) noexcept {
+		if (s_running.load(std::memory_order_relaxed)) {
+			Record(eAllocationOp::ALLOCATE, ptr, size);
+		}
+	}
+
+	/// <summary> Must be called before each deallocation, so that the address can't be reused in between. </summary>
+	static void OnDeallocation(void* ptr) noexcept {
+		if (s_running.load(std::memory_order_relaxed) && ptr) {
+			Record(eAllocationOp::DEALLOCATE, ptr, 0);
+		}
+	}
+
+private:
+	static void Record(eAllocationOp op, void* ptr, size_t size) noexcept;
+
+	static inline std::atomic_bool s_running = false;
+};
+
+
+} // namespace inl
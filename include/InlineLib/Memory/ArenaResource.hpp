@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+
+namespace inl {
+
+
+/// <summary>
+/// A memory resource that allocates by bumping a pointer and frees everything at once.
+/// When the current chunk is exhausted, a new chunk is requested from the upstream
+/// resource and chained to the previous ones. Chunks grow geometrically.
+/// </summary>
+/// <remarks> Deallocation is a no-op. Not thread-safe. </remarks>
+class MonotonicArenaResource : public std::pmr::memory_resource {
+	struct ChunkHeader {
+		ChunkHeader* previous;
+		size_t size; // Including the header.
+	};
+
+public:
+	/// <param name="initialChunkSize"> Size of the first chunk in bytes, requested on the first allocation. </param>
+	/// <param name="upstream"> Chunks are allocated from this resource. With a <see cref="HugePageResource"/>, they are rounded up to whole pages. </param>
+	MonotonicArenaResource(size_t initialChunkSize = 4096, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	MonotonicArenaResource(const MonotonicArenaResource&) = delete;
+	MonotonicArenaResource& operator=(const MonotonicArenaResource&) = delete;
+	~MonotonicArenaResource() override;
+
+	/// <summary> Returns all chunks to the upstream resource. </summary>
+	void Release() noexcept;
+
+	/// <summary> Total size of the chunks currently held. </summary>
+	size_t GetCapacity() const noexcept { return m_capacity; }
+
+	std::pmr::memory_resource* GetUpstream() const noexcept { return m_upstream; }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void*, size_t, size_t) override {}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+	/// <summary> Makes the next allocation start at the beginning of the last chunk. Earlier chunks are kept. </summary>
+	void Rewind() noexcept;
+	size_t GetChunkCount() const noexcept;
+	void AddChunk(size_t minimumSize, size_t alignment);
+
+private:
+	std::pmr::memory_resource* m_upstream;
+	size_t m_chunkGranularity;
+	ChunkHeader* m_currentChunk = nullptr;
+	std::byte* m_top = nullptr;
+	std::byte* m_end = nullptr;
+	size_t m_nextChunkSize;
+	size_t m_capacity = 0;
+};
+
+
+/// <summary>
+/// A monotonic arena that can be reset and reused, for temporary allocations with a clear end,
+/// like the work of a frame or a request.
+/// </summary>
+/// <remarks> Not thread-safe. </remarks>
+class ScratchArenaResource : public MonotonicArenaResource {
+public:
+	using MonotonicArenaResource::MonotonicArenaResource;
+
+	/// <summary> Frees all allocations and keeps the memory for reuse. </summary>
+	/// <remarks>
+	/// If the allocations spilled over into more than one chunk, the chunks are replaced with
+	/// a single one that fits all, so that the next round doesn't need to chain.
+	/// </remarks>
+	void Reset();
+};
+
+
+} // namespace inl
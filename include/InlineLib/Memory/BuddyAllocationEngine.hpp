@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary> Occupancy of a <see cref="BuddyAllocationEngine"/>, in slots. </summary>
+struct BuddyAllocationStats {
+	size_t poolSize;
+	size_t allocatedSize; // Sum of the allocated blocks, which are the requested sizes rounded up to powers of two.
+	size_t allocationCount;
+	size_t freeSize;
+	size_t freeBlockCount;
+	size_t largestFreeBlock;
+
+	/// <summary> The fraction of free space that is not in the largest free block. 0 if all free space is in one piece. </summary>
+	double ExternalFragmentation() const {
+		return freeSize == 0 ? 0.0 : 1.0 - double(largestFreeBlock) / double(freeSize);
+	}
+};
+
+
+/// <summary>
+/// Serves as a base for allocators that sub-allocate ranges of varying size with arbitrary lifetimes.
+/// Ranges are power of two sized blocks of slots, aligned to their size. This class does
+/// NOT handle space allocation for the objects, only slot allocation, like
+/// <see cref="SlabAllocatorEngine"/> and <see cref="RingAllocationEngine"/>.
+/// </summary>
+/// <remarks>
+/// Metadata takes about 2 bytes per slot, so for large buffers, a slot should be a
+/// larger unit, like 256 bytes, rather than a single byte.
+/// </remarks>
+class BuddyAllocationEngine {
+	// How it works:
+	// The pool is covered by a complete binary tree, the root is the whole pool rounded up to
+	// a power of two, the leaves are single slots. Every node stores the order of the largest
+	// free block in its subtree plus one, or zero if it has no free space. A node is either
+	// split, then its children are meaningful, or it's a single free or allocated block, then
+	// its descendants are not looked at. Split flags are kept in a separate bit set.
+	// Allocation descends from the root to a block of the requested order, splitting blocks on
+	// the way, and picks the child with the smaller block that still fits. Deallocation walks up
+	// from the leaf to the block, then merges it with its buddy as long as the buddy is free.
+	// Both touch one node per level, so they are O(log n).
+	// The part of the tree past the pool size is covered by permanently allocated blocks.
+public:
+	BuddyAllocationEngine();
+	/// <summary> Initialize an allocator of specified size. </summary>
+	/// <param name="poolSize"> The number of available slots in the pool. Need not be a power of two. </param>
+	BuddyAllocationEngine(size_t poolSize);
+
+	/// <summary> Allocates a range of slots. </summary>
+	/// <param name="allocationSize"> The number of slots. It's rounded up to the next power of two. </param>
+	/// <returns> The starting index of the range, which is a multiple of the rounded size. </returns>
+	/// <exception cref="std::bad_alloc"> Thrown if there is no free block large enough. </exception>
+	/// <exception cref="InvalidArgumentException"> If allocation size is zero. </exception>
+	size_t Allocate(size_t allocationSize = 1);
+
+	/// <summary> Deallocates the range starting at index, and merges it with free neighbours. </summary>
+	/// <exception cref="OutOfRangeException"> Thrown if index is out of the pools range. </exception>
+	/// <exception cref="InvalidArgumentException"> Thrown if no allocation starts at index. </exception>
+	void Deallocate(size_t index);
+
+	/// <summary> The number of slots actually reserved for the allocation starting at index. </summary>
+	/// <exception cref="InvalidArgumentException"> Thrown if no allocation starts at index. </exception>
+	size_t AllocationSize(size_t index) const;
+
+	/// <summary> Resizes the pool, allocated ranges are kept, but those not entirely inside the new pool are dropped. </summary>
+	/// <remarks> Rebuilds the tree, so it's O(n). </remarks>
+	void Resize(size_t newPoolSize);
+
+	/// <summary> Clears all slots, does not affect pool size. </summary>
+	void Reset();
+
+	/// <summary> Get the total number of slots (free + taken). </summary>
+	size_t Size() const { return m_poolSize; }
+
+	/// <summary> The size of the largest range that can currently be allocated. </summary>
+	size_t LargestFreeBlock() const;
+
+	/// <summary> Gathers statistics. Walks the tree, so it's O(n). </summary>
+	BuddyAllocationStats GetStats() const;
+
+private:
+	void Initialize(size_t poolSize);
+	void MarkAllocated(size_t index, unsigned order);
+	void Split(size_t node, unsigned order);
+	void UpdateAncestors(size_t node, unsigned order);
+	std::pair<size_t, unsigned> FindAllocation(size_t index) const;
+
+	template <class Func>
+	void VisitBlocks(Func&& func) const;
+
+	bool IsSplit(size_t node) const { return (m_split[node / 64] >> (node % 64)) & 1; }
+	size_t LeafCount() const { return size_t(1) << m_height; }
+
+private:
+	size_t m_poolSize = 0;
+	unsigned m_height = 0; // Order of the root.
+	std::vector<uint8_t> m_tree; // Largest free order + 1 in the subtree of each node, heap ordered.
+	std::vector<uint64_t> m_split; // A bit per node, set if the node is divided into its children.
+	size_t m_allocatedSize = 0;
+	size_t m_allocationCount = 0;
+};
+
+
+} // namespace inl
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+
+namespace inl {
+
+
+/// <summary>
+/// Thread-safe version of <see cref="SlabAllocatorEngine"/>.
+/// Allocate and Deallocate may be called from any number of threads at the same time
+/// without locking. Like the single-threaded engine, it only hands out slot indices.
+/// </summary>
+class ConcurrentSlabAllocatorEngine {
+	// How it works:
+	// Slots are grouped into blocks of 64, each with an atomic occupancy mask.
+	// A block that is in use by a thread is owned by that thread: only the owner sets bits,
+	// any thread may clear them. Owned blocks are kept in per-thread cache slots, so
+	// allocation mostly touches memory that no other thread writes.
+	// Blocks with free slots that are not owned are on a lock-free stack, the head of which
+	// is tagged against ABA. When a block fills up, the owner lets go of it, and whoever frees
+	// the first slot in a full block pushes it back to the stack.
+	// Blocks are stored in segments of growing size that never move, so the pool can grow
+	// while other threads are allocating.
+private:
+	static constexpr unsigned SlotsPerBlock = 64;
+	static constexpr unsigned MaxSegments = 32;
+	static constexpr unsigned CacheCount = 64;
+	static constexpr uint32_t NoBlock = ~uint32_t(0);
+	static constexpr uint64_t FullMask = ~uint64_t(0);
+
+	struct alignas(64) Block {
+		std::atomic_uint64_t occupancy; /// <summary> 0 means the slot if free, 1 is occupied. </summary>
+		std::atomic_uint32_t nextBlockIndex; /// <summary> Index of the next block in the free stack. </summary>
+		std::atomic_bool listed; /// <summary> Either on the free stack or owned by a thread. </summary>
+	};
+
+	struct alignas(64) CacheSlot {
+		std::atomic_uint32_t blockIndex = NoBlock;
+	};
+
+public:
+	/// <summary> Initialize an allocator of specified size. </summary>
+	/// <param name="poolSize">The number of available slots in the pool.</param>
+	ConcurrentSlabAllocatorEngine(size_t poolSize = 0);
+	ConcurrentSlabAllocatorEngine(const ConcurrentSlabAllocatorEngine&) = delete;
+	ConcurrentSlabAllocatorEngine& operator=(const ConcurrentSlabAllocatorEngine&) = delete;
+	~ConcurrentSlabAllocatorEngine();
+
+	/// <summary> Allocates space from the pool for one item. Thread-safe. </summary>
+	/// <returns> The index of the allocated slot. </returns>
+	/// <exception cref="std::bad_alloc"> Thrown if pool is full. </exception>
+	size_t Allocate();
+
+	/// <summary> Deallocated the slot specified by the index. Thread-safe. </summary>
+	void Deallocate(size_t index);
+
+	/// <summary> Grows the pool. Thread-safe, even with respect to Allocate and Deallocate. </summary>
+	/// <param name="newPoolSize"> The number of available slots in the new pool. Smaller values are ignored. </param>
+	void Resize(size_t newPoolSize);
+
+	/// <summary> Clears all slots, does not affect pool size. Must not be called concurrently with anything else. </summary>
+	void Reset();
+
+	/// <summary> Get the total number of slots (free + taken). </summary>
+	size_t Size() const { return m_poolSize.load(std::memory_order_acquire); }
+
+private:
+	Block& GetBlock(uint32_t blockIndex) const;
+	CacheSlot& GetThreadCache();
+
+	void PushFreeBlocks(uint32_t first, uint32_t last);
+	uint32_t PopFreeBlock();
+	uint32_t StealCachedBlock();
+	void ReleaseBlock(uint32_t blockIndex);
+	void OnSlotsFreed(uint32_t blockIndex, uint64_t previousOccupancy);
+
+	static uint64_t ValidSlotMask(size_t poolSize, uint32_t blockIndex);
+
+private:
+	std::atomic<Block*> m_segments[MaxSegments] = {};
+	std::atomic_size_t m_poolSize;
+	alignas(64) std::atomic_uint64_t m_freeHead; // Tag in the upper, block index in the lower 32 bits.
+	CacheSlot m_caches[CacheCount];
+	std::mutex m_resizeMtx;
+};
+
+
+} // namespace inl
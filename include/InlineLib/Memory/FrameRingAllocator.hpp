@@ -0,0 +1,86 @@
+#pragma once
+
+#include "RingAllocationEngine.hpp"
+
+#include "../JobSystem/Fence.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary>
+/// Hands out transient memory from a buffer it owns. Each allocation is tagged with a fence value,
+/// and its space is reclaimed automatically once the fence has reached that value.
+/// There is no per-object free and no heap allocation after construction.
+/// </summary>
+/// <remarks>
+/// The buffer is divided into cells of granularity bytes, which are managed by a <see cref="RingAllocationEngine"/>.
+/// Allocations are reclaimed in the order they were made, so fence values should not decrease.
+/// Not thread-safe.
+/// </remarks>
+class FrameRingAllocator {
+	struct Allocation {
+		size_t cellIndex;
+		uint64_t fenceValue;
+	};
+
+public:
+	/// <param name="size"> Size of the buffer in bytes. </param>
+	/// <param name="fence"> The fence that tells when allocations are not in use anymore. Must outlive the allocator. </param>
+	/// <param name="granularity"> Allocations are rounded up to this many bytes. Also the smallest alignment, must be a power of two. </param>
+	/// <param name="upstream"> The buffer is allocated from this resource, for example a <see cref="HugePageResource"/>. </param>
+	/// <exception cref="InvalidArgumentException"> If granularity is not a power of two. </exception>
+	FrameRingAllocator(size_t size, const jobs::Fence& fence, size_t granularity = 256, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	FrameRingAllocator(const FrameRingAllocator&) = delete;
+	FrameRingAllocator& operator=(const FrameRingAllocator&) = delete;
+
+	/// <summary> Allocates memory that stays valid until the fence reaches fenceValue. </summary>
+	/// <param name="alignment"> Must be a power of two. </param>
+	/// <exception cref="std::bad_alloc"> If there's not enough space even after reclaiming finished allocations. </exception>
+	void* Allocate(size_t size, size_t alignment, uint64_t fenceValue);
+
+	/// <summary> Allocates uninitialized storage for count objects of type T. </summary>
+	/// <exception cref="std::bad_alloc"> If there's not enough space even after reclaiming finished allocations. </exception>
+	template <class T>
+	T* Allocate(size_t count, uint64_t fenceValue) {
+		return static_cast<T*>(Allocate(count * sizeof(T), alignof(T), fenceValue));
+	}
+
+	/// <summary> Frees all allocations the fence has passed. Called by Allocate as well. </summary>
+	void Reclaim();
+
+	/// <summary> Size of the buffer in bytes. </summary>
+	size_t Size() const noexcept { return m_engine.Size() * m_granularity; }
+
+	/// <summary> Number of allocations that have not been reclaimed yet. </summary>
+	size_t GetAllocationCount() const noexcept { return m_allocationCount; }
+
+private:
+	struct BufferDeleter {
+		std::pmr::memory_resource* resource;
+		size_t size;
+		size_t alignment;
+		void operator()(std::byte* buffer) const { resource->deallocate(buffer, size, alignment); }
+	};
+
+	RingAllocationEngine m_engine;
+	std::unique_ptr<std::byte[], BufferDeleter> m_buffer;
+	const jobs::Fence& m_fence;
+	size_t m_granularity;
+
+	// Circular queue of allocations in the order they were made. Every allocation takes at least
+	// one cell, so there can't be more than the number of cells.
+	std::vector<Allocation> m_allocations;
+	size_t m_firstAllocation = 0;
+	size_t m_allocationCount = 0;
+};
+
+
+} // namespace inl
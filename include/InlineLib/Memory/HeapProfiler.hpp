@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary> Aggregated samples of a single allocating call stack. </summary>
+/// <remarks> Counts and byte totals are estimates of the real values, scaled up from the samples. </remarks>
+struct HeapProfileEntry {
+	std::vector<void*> frames; // Return addresses, innermost frame first.
+	uint64_t samples;
+	uint64_t allocations;
+	uint64_t allocatedBytes;
+	uint64_t liveAllocations;
+	uint64_t liveBytes;
+};
+
+
+/// <summary> Health of the profiler's fixed-size tables. </summary>
+struct HeapProfilerStats {
+	uint64_t samples;
+	uint64_t liveSamples;
+	uint64_t droppedStacks; // Samples that were attributed to the overflow entry because the stack table was full.
+	uint64_t droppedLiveSamples; // Samples that couldn't be tracked in the live heap because the live table was full.
+};
+
+
+/// <summary>
+/// A sampling heap profiler that attributes allocations to their call stacks.
+/// </summary>
+/// <remarks>
+/// <para> Allocations are sampled by byte interval: each thread counts down a random number of bytes,
+///		drawn from an exponential distribution with the sampling interval as mean. The allocation that
+///		crosses zero is sampled. This makes sampling a Poisson process over the allocated bytes, so that
+///		large allocations are sampled more often than small ones, and each sample can be scaled up
+///		into an unbiased estimate of the allocations it stands for. </para>
+/// <para> Sampled stacks are aggregated in a lock-free hash table, sampled pointers are kept in a
+///		second lock-free table until they are freed. Both tables have a fixed size and never allocate. </para>
+/// <para> The profiler doesn't hook anything itself. Linking the InlineLibHeapProfiler target
+///		(CMake option INL_USE_HEAP_PROFILER) replaces global operator new and delete with versions that call
+///		<see cref="OnAllocation"/> and <see cref="OnDeallocation"/>. Custom allocators can call them too. </para>
+/// <para> When not running, the cost is a relaxed load per allocation. When running, an allocation that isn't
+///		sampled costs a thread-local subtraction, and a deallocation costs a probe into the live table. </para>
+/// </remarks>
+class HeapProfiler {
+public:
+	static constexpr size_t DefaultSamplingInterval = 512 * 1024;
+	static constexpr size_t MaxStackDepth = 32;
+
+	/// <summary> Starts sampling allocations. </summary>
+	/// <param name="samplingInterval"> The mean number of bytes allocated between two samples. </param>
+	static void Start(size_t samplingInterval = DefaultSamplingInterval);
+
+	/// <summary> Stops sampling. Collected data is kept, and sampled pointers are still removed from the live heap when freed. </summary>
+	static void Stop();
+
+	static bool IsRunning();
+	static size_t GetSamplingInterval();
+
+	/// <summary> Clears the allocation totals of all stacks. The live heap is kept. </summary>
+	static void Reset();
+
+	/// <summary> Returns the stacks that allocated the most bytes since the last <see cref="Reset"/>, largest first. </summary>
+	static std::vector<HeapProfileEntry> GetTopAllocators(size_t count);
+
+	/// <summary> Returns the stacks that currently hold the most memory, largest first. </summary>
+	static std::vector<HeapProfileEntry> GetLiveHeap(size_t count = SIZE_MAX);
+
+	static HeapProfilerStats GetStats();
+
+	/// <summary> Writes the result of <see cref="GetTopAllocators"/> with resolved symbols. </summary>
+	static void DumpTopAllocators(std::ostream& os, size_t count = 20);
+
+	/// <summary> Writes the result of <see cref="GetLiveHeap"/> with resolved symbols. </summary>
+	static void DumpLiveHeap(std::ostream& os, size_t count = 20);
+
+	/// <summary> Must be called after each allocation. </summary>
+	static void OnAllocation(void* ptr, size_t size) noexcept {
+		if (!s_running.load(std::memory_order_relaxed)) {
+			return;
+		}
+		t_bytesUntilSample -= int64_t(size);
+		if (t_bytesUntilSample < 0) [[unlikely]] {
+			SampleAllocation(ptr, size);
+		}
+	}
+
+	/// <summary> Must be called before each deallocation, so that the address can't be reused in between. </summary>
+	static void OnDeallocation(void* ptr) noexcept {
+		if (s_liveSamples.load(std::memory_order_relaxed) != 0 && ptr) {
+			ReleaseSample(ptr);
+		}
+	}
+
+private:
+	static void SampleAllocation(void* ptr, size_t size) noexcept;
+	static void ReleaseSample(void* ptr) noexcept;
+
+	static inline std::atomic_bool s_running = false;
+	static inline std::atomic_size_t s_liveSamples = 0;
+	static inline thread_local int64_t t_bytesUntilSample = 0;
+};
+
+
+} // namespace inl
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory_resource>
+
+
+namespace inl {
+
+
+enum class ePageSize {
+	NORMAL, // The system's base page size, usually 4 KiB.
+	HUGE_2MB,
+	HUGE_1GB,
+};
+
+
+/// <summary> How the memory of a <see cref="HugePageResource"/> ended up being backed, in total since construction. </summary>
+struct HugePageStats {
+	size_t explicitHugePageBytes; // Reserved huge pages, MAP_HUGETLB or large pages on Windows.
+	size_t transparentHugePageBytes; // Normal pages with transparent huge pages requested.
+	size_t normalPageBytes; // Normal pages, when neither was available.
+};
+
+
+/// <summary>
+/// A memory resource that maps memory directly from the OS in whole pages, preferably huge pages.
+/// Meant as the upstream of large pools, to reduce TLB misses on random access.
+/// </summary>
+/// <remarks>
+/// <para> Each allocation tries, in order: reserved huge pages of the requested size, reserved 2 MiB
+///		pages if 1 GiB was requested, then normal pages marked for transparent huge pages (Linux THP).
+///		If none of them work, it falls back to normal pages, so allocation only fails when out of memory. </para>
+/// <para> Sizes are rounded up to the requested page size, so small allocations are wasteful.
+///		<see cref="MonotonicArenaResource"/> and <see cref="SlabPoolResource"/> round their chunks up to
+///		the page size when they draw from this resource. </para>
+/// <para> Thread-safe. Memory is returned to the OS on deallocation. </para>
+/// </remarks>
+class HugePageResource : public std::pmr::memory_resource {
+public:
+	/// <param name="pageSize"> The preferred page size. </param>
+	/// <param name="prefault"> Fault in all pages on allocation, so that first touches don't stall. </param>
+	/// <param name="numaNode"> Bind the memory to this NUMA node, or -1 to use the default policy. </param>
+	HugePageResource(ePageSize pageSize = ePageSize::HUGE_2MB, bool prefault = false, int numaNode = -1);
+	HugePageResource(const HugePageResource&) = delete;
+	HugePageResource& operator=(const HugePageResource&) = delete;
+
+	/// <summary> Allocations are rounded up to this size, and aligned to it. </summary>
+	size_t GetPageSize() const noexcept { return m_pageSize; }
+	HugePageStats GetStats() const noexcept;
+
+	/// <summary> The page size a memory resource allocates in, or 1 if it's not a <see cref="HugePageResource"/>. </summary>
+	static size_t GetGranularity(const std::pmr::memory_resource* resource) noexcept;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	size_t MappingSize(size_t bytes) const noexcept;
+	void Prefault(void* memory, size_t size) const noexcept;
+
+private:
+	ePageSize m_pageSizeType;
+	size_t m_pageSize;
+	bool m_prefault;
+	int m_numaNode;
+	std::atomic_size_t m_explicitBytes = 0;
+	std::atomic_size_t m_transparentBytes = 0;
+	std::atomic_size_t m_normalBytes = 0;
+};
+
+
+} // namespace inl
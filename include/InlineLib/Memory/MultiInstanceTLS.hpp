@@ -1,29 +1,209 @@
 #pragma once
 
-#include "SlabAllocatorEngine.hpp"
+#include "ConcurrentSlabAllocatorEngine.hpp"
 
 #include <algorithm>
-#include <deque>
-#include <map>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
-#include <optional>
-#include <set>
+#include <new>
+#include <utility>
 
 namespace inl {
 
 
-template <class T>
+/// <summary> When the values of an <see cref="mi_tls"/> are destroyed. </summary>
+enum class eMiTlsLifetime {
+	/// <summary> Values outlive their threads, until the instance is destroyed or cleared. </summary>
+	INSTANCE,
+	/// <summary> A thread's value is destroyed when the thread exits, or earlier with the instance. </summary>
+	THREAD,
+};
+
+
+namespace impl {
+
+	/// <summary> Shared by an instance and the exit hooks of its threads, so that the hooks know if it's still alive. </summary>
+	struct MiTlsExitState {
+		std::mutex mtx;
+		std::atomic_bool alive = true;
+	};
+
+	/// <summary>
+	/// The per-thread lookup table shared by all mi_tls instances.
+	/// Each instance owns a slot index, and each thread has a flat array with the thread's
+	/// value for every slot. Entries are tagged with the owner's instance id, so that a
+	/// slot reused by a new instance doesn't see the values of the previous one.
+	/// </summary>
+	class MiTlsTable {
+	public:
+		struct Entry {
+			uint64_t instanceId;
+			void* record;
+		};
+
+		/// <summary> A thread's value to destroy when the thread exits, one per instance and thread. </summary>
+		struct ExitHook {
+			std::shared_ptr<MiTlsExitState> state;
+			void* owner = nullptr;
+			void* record = nullptr;
+			uint64_t instanceId = 0;
+			/// <summary> Destroys the record, called with the state locked while the instance is alive. </summary>
+			void (*onExit)(ExitHook& hook) noexcept = nullptr;
+			ExitHook* next = nullptr;
+		};
+
+		/// <summary> Returns the record of the calling thread, or null if it has none yet. </summary>
+		static void* Find(size_t slot, uint64_t instanceId) noexcept {
+			if (slot < t_size && t_entries[slot].instanceId == instanceId) {
+				return t_entries[slot].record;
+			}
+			return nullptr;
+		}
+
+		static void Set(size_t slot, uint64_t instanceId, void* record) {
+			if (slot >= t_size) {
+				Grow(slot + 1);
+			}
+			t_entries[slot] = { instanceId, record };
+		}
+
+		static size_t AllocateSlot() {
+			while (true) {
+				try {
+					return s_slots.Allocate();
+				}
+				catch (std::bad_alloc&) {
+					s_slots.Resize(std::max(size_t(64), s_slots.Size() * 2));
+				}
+			}
+		}
+
+		static void DeallocateSlot(size_t slot) {
+			s_slots.Deallocate(slot);
+		}
+
+		static uint64_t NextInstanceId() noexcept {
+			return s_nextInstanceId.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		/// <summary> Returns the calling thread's exit hook for the instance owning the state, creating it if needed. </summary>
+		/// <remarks> Hooks of destroyed instances are freed along the way, so they don't pile up on long-lived threads. </remarks>
+		static ExitHook& GetExitHook(const std::shared_ptr<MiTlsExitState>& state) {
+			RegisterCleanup();
+			ExitHook** link = &t_exitHooks;
+			while (ExitHook* hook = *link) {
+				if (hook->state == state) {
+					return *hook;
+				}
+				if (!hook->state->alive.load(std::memory_order_relaxed)) {
+					*link = hook->next;
+					delete hook;
+				}
+				else {
+					link = &hook->next;
+				}
+			}
+			auto hook = new ExitHook{ state };
+			hook->next = t_exitHooks;
+			t_exitHooks = hook;
+			return *hook;
+		}
+
+	private:
+		/// <summary> Destroys the thread's values that die with it, then frees the table when its thread exits. </summary>
+		struct ThreadCleanup {
+			~ThreadCleanup() {
+				// Destructors of the values may access other instances, and even register new hooks.
+				while (ExitHook* hook = t_exitHooks) {
+					t_exitHooks = hook->next;
+					{
+						std::lock_guard<std::mutex> lk(hook->state->mtx);
+						if (hook->state->alive.load(std::memory_order_relaxed) && hook->record) {
+							hook->onExit(*hook);
+						}
+					}
+					delete hook;
+				}
+				delete[] t_entries;
+				t_entries = nullptr;
+				t_size = 0;
+			}
+		};
+
+		static void RegisterCleanup() {
+			static thread_local ThreadCleanup cleanup;
+			(void)cleanup;
+		}
+
+		static void Grow(size_t minimumSize) {
+			RegisterCleanup();
+
+			size_t newSize = std::max(minimumSize, t_size * 2);
+			Entry* newEntries = new Entry[newSize]{};
+			std::copy(t_entries, t_entries + t_size, newEntries);
+			delete[] t_entries;
+			t_entries = newEntries;
+			t_size = newSize;
+		}
+
+		// Plain thread_locals, so that accessing them doesn't need an initialization check.
+		static inline thread_local Entry* t_entries = nullptr;
+		static inline thread_local size_t t_size = 0;
+		static inline thread_local ExitHook* t_exitHooks = nullptr;
+
+		static inline ConcurrentSlabAllocatorEngine s_slots{ 64 };
+		static inline std::atomic_uint64_t s_nextInstanceId = 1;
+	};
+
+} // namespace impl
+
+
+/// <summary>
+/// Thread-local storage that can have many instances, like a regular member variable.
+/// Each thread sees its own copy of the value, initialized from the value
+/// given to the constructor when the thread first accesses it.
+/// </summary>
+/// <remarks>
+/// <para> Accessing the thread's value is a lookup in a flat per-thread array. Slots are allocated
+///		without locking, and the per-thread arrays are freed when their threads exit. </para>
+/// <para> Like TBB's enumerable_thread_specific, the values of all threads can be enumerated
+///		with <see cref="ForEach"/> and reduced with <see cref="Combine"/>. By default, values outlive their
+///		threads, so a reduction can be done after the workers have been joined. They are destroyed
+///		together with the instance, or by <see cref="Clear"/>. </para>
+/// <para> This means memory grows with the number of threads that have ever accessed the instance.
+///		For a long-lived instance used by short-lived threads, choose <see cref="eMiTlsLifetime::THREAD"/>,
+///		which destroys a thread's value when the thread exits. Values are then enumerated under a lock,
+///		and a thread creating its value also takes the lock. </para>
+/// </remarks>
+template <class T, eMiTlsLifetime lifetime = eMiTlsLifetime::INSTANCE>
 class mi_tls {
+	// Each value on its own cache line, so per-thread counters don't slow each other down.
+	struct alignas(64) Record {
+		template <class... Args>
+		Record(Args&&... args) : value(std::forward<Args>(args)...) {}
+		T value;
+		Record* next = nullptr;
+		Record* prev = nullptr; // Only maintained if values die with their threads.
+	};
+
+	static constexpr bool destroyOnThreadExit = lifetime == eMiTlsLifetime::THREAD;
+
 public:
 	mi_tls() {
 		AllocateSlot();
 	}
 
 	~mi_tls() {
-		// deallocate our slot
-		std::lock_guard<std::mutex> lkg(indexAllocatorLock);
-
-		indexAllocator.Deallocate(myIndex);
+		Clear();
+		if constexpr (destroyOnThreadExit) {
+			// Exit hooks of the threads will skip the instance from now on.
+			std::lock_guard<std::mutex> lk(exitState->mtx);
+			exitState->alive.store(false, std::memory_order_relaxed);
+		}
+		impl::MiTlsTable::DeallocateSlot(myIndex);
 	}
 
 	// Construct from in-place arguments
@@ -79,87 +259,158 @@ public:
 		return std::move(GetRef());
 	}
 
-private:
-	void AllocateSlot() {
-		std::lock_guard<std::mutex> lkg(indexAllocatorLock);
 
-		try {
-			myIndex = indexAllocator.Allocate();
-		}
-		catch (std::bad_alloc&) {
-			size_t currentSize = indexAllocator.Size();
-			indexAllocator.Resize(size_t(currentSize * 1.2 + 1));
-			myIndex = indexAllocator.Allocate(); // supposed to have enough space now
+	/// <summary> Returns the calling thread's value, creating it if this is the thread's first access. </summary>
+	T& GetRef() {
+		void* record = impl::MiTlsTable::Find(myIndex, myId);
+		if (record) {
+			return static_cast<Record*>(record)->value;
 		}
+		return CreateRecord()->value;
 	}
 
+	/// <summary> Returns the calling thread's value, creating it if this is the thread's first access. </summary>
+	const T& GetRef() const {
+		return const_cast<mi_tls*>(this)->GetRef();
+	}
 
-	T& GetRef() {
-		size_t size = threadObjects.size() - 1;
-		size_t testIndex = myIndex < size ? myIndex : size;
-		if (!threadObjects[testIndex]) {
-			if (threadObjects.size() - 1 <= myIndex) {
-				threadObjects.resize(myIndex + 2);
-			}
-			threadObjects[myIndex] = defaultRecord;
+	/// <summary> Returns the calling thread's value, or null if the thread hasn't accessed the instance yet. </summary>
+	/// <remarks> Never creates the value, unlike <see cref="GetRef"/>. </remarks>
+	T* TryGet() noexcept {
+		void* record = impl::MiTlsTable::Find(myIndex, myId);
+		return record ? &static_cast<Record*>(record)->value : nullptr;
+	}
+
+	/// <summary> Returns the calling thread's value, or null if the thread hasn't accessed the instance yet. </summary>
+	const T* TryGet() const noexcept {
+		return const_cast<mi_tls*>(this)->TryGet();
+	}
+
+	/// <summary> Calls <paramref name="func"/> with the value of each thread that has accessed the instance. </summary>
+	/// <remarks> Can be called while other threads are using their values,
+	///		but synchronizing access to the values themselves is up to the caller. </remarks>
+	template <class Func>
+	void ForEach(Func func) {
+		auto lk = LockValues();
+		for (Record* record = head.load(std::memory_order_acquire); record; record = record->next) {
+			func(record->value);
 		}
-		return threadObjects[myIndex].value();
 	}
 
-	const T& GetRef() const {
-		size_t size = threadObjects.size() - 1;
-		size_t testIndex = myIndex < size ? myIndex : size;
-		if (!threadObjects[testIndex]) {
-			if (threadObjects.size() - 1 <= myIndex) {
-				threadObjects.resize(myIndex + 2);
-			}
-			threadObjects[myIndex] = defaultRecord;
-		}
-		return threadObjects[myIndex].value();
-	}
-
-	//void UnregisterByThread() {
-	//	std::lock_guard<std::mutex> lkg(registryLock);
-	//	threadObjects.clear();
-	//	for (auto& instance : threadInstances) {
-	//		instance->myThreadObjects.erase(&threadObjects);
-	//		instant->myThreadInstances.erase(&threadInstances);
-	//	}
-	//}
-
-	//void UnregisterByInstance() {
-	//	std::lock_guard<std::mutex> lkg(registryLock);
-	//	for (auto& instances : myThreadInstances) {
-	//		instances.erase(this);
-	//	}
-	//	for (auto& objects : myThreadObjects) {
-	//		objects[myIndex].erase()
-	//	}
-	//}
-private:
-	static thread_local std::deque<std::optional<T>> threadObjects; // vector would be better, but deque.resize does not invalidate refs and ptrs
-	static std::mutex indexAllocatorLock;
-	static SlabAllocatorEngine indexAllocator;
+	/// <summary> Calls <paramref name="func"/> with the value of each thread that has accessed the instance. </summary>
+	template <class Func>
+	void ForEach(Func func) const {
+		auto lk = LockValues();
+		for (const Record* record = head.load(std::memory_order_acquire); record; record = record->next) {
+			func(std::as_const(record->value));
+		}
+	}
 
-	size_t myIndex;
-	T defaultRecord;
+	/// <summary> Reduces the values of all threads with a binary operation. </summary>
+	/// <returns> The reduced value, or the initial value if no thread has accessed the instance. </returns>
+	template <class BinaryOp>
+	T Combine(BinaryOp op) const {
+		auto lk = LockValues();
+		const Record* record = head.load(std::memory_order_acquire);
+		if (!record) {
+			return defaultRecord;
+		}
+		T result = record->value;
+		for (record = record->next; record; record = record->next) {
+			result = op(std::move(result), record->value);
+		}
+		return result;
+	}
 
-	//static std::mutex registryLock;
-	//thread_local std::set<mi_tls*> threadInstances;
-	//std::set<decltype(threadObjects)*> myThreadObjects;
-	//std::set<decltype(threadInstances)> myThreadInstances;
-};
+	/// <summary> Destroys the values of all threads. Threads get a fresh copy of the initial value on their next access. </summary>
+	/// <remarks> Must not be called concurrently with anything else on this instance. </remarks>
+	void Clear() {
+		auto lk = LockValues();
+		Record* record = head.exchange(nullptr, std::memory_order_acquire);
+		while (record) {
+			Record* next = record->next;
+			delete record;
+			record = next;
+		}
+		// Stale entries in the per-thread tables are told apart by the id.
+		myId = impl::MiTlsTable::NextInstanceId();
+	}
 
+private:
+	void AllocateSlot() {
+		if constexpr (destroyOnThreadExit) {
+			exitState = std::make_shared<impl::MiTlsExitState>();
+		}
+		myIndex = impl::MiTlsTable::AllocateSlot();
+		myId = impl::MiTlsTable::NextInstanceId();
+	}
 
-template <class T>
-thread_local std::deque<std::optional<T>> mi_tls<T>::threadObjects(1);
+	Record* CreateRecord() {
+		if constexpr (destroyOnThreadExit) {
+			// The hook is fetched first, so that nothing has to be undone if that throws.
+			impl::MiTlsTable::ExitHook& hook = impl::MiTlsTable::GetExitHook(exitState);
+			std::lock_guard<std::mutex> lk(exitState->mtx);
+			auto record = new Record(defaultRecord);
+			Record* first = head.load(std::memory_order_relaxed);
+			record->next = first;
+			if (first) {
+				first->prev = record;
+			}
+			head.store(record, std::memory_order_release);
+			impl::MiTlsTable::Set(myIndex, myId, record);
+
+			hook.owner = this;
+			hook.record = record;
+			hook.instanceId = myId;
+			hook.onExit = &OnThreadExit;
+			return record;
+		}
+		else {
+			auto record = new Record(defaultRecord);
+			record->next = head.load(std::memory_order_relaxed);
+			while (!head.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) {
+			}
+			impl::MiTlsTable::Set(myIndex, myId, record);
+			return record;
+		}
+	}
 
-template <class T>
-std::mutex mi_tls<T>::indexAllocatorLock;
+	/// <summary> Destroys the exiting thread's value, unless it has been cleared since. </summary>
+	static void OnThreadExit(impl::MiTlsTable::ExitHook& hook) noexcept {
+		auto self = static_cast<mi_tls*>(hook.owner);
+		if (self->myId != hook.instanceId) {
+			return;
+		}
+		auto record = static_cast<Record*>(hook.record);
+		if (record->prev) {
+			record->prev->next = record->next;
+		}
+		else {
+			self->head.store(record->next, std::memory_order_relaxed);
+		}
+		if (record->next) {
+			record->next->prev = record->prev;
+		}
+		delete record;
+	}
 
-template <class T>
-SlabAllocatorEngine mi_tls<T>::indexAllocator(10);
+	/// <summary> Guards the list of values if threads remove theirs on exit, otherwise does nothing. </summary>
+	std::unique_lock<std::mutex> LockValues() const {
+		if constexpr (destroyOnThreadExit) {
+			return std::unique_lock<std::mutex>(exitState->mtx);
+		}
+		else {
+			return {};
+		}
+	}
 
+private:
+	size_t myIndex;
+	uint64_t myId;
+	T defaultRecord;
+	std::atomic<Record*> head = nullptr; // Values of all threads, newest first.
+	std::shared_ptr<impl::MiTlsExitState> exitState; // Only if values die with their threads.
+};
 
 
 } // namespace inl
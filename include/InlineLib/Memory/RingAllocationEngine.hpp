@@ -24,6 +24,7 @@ protected:
 							END,
 							PREVIOUS_IN_USE };
 
+	// Cells are packed 32 to a 64-bit word, so ranges are searched and filled a word at a time.
 	class CellContainer {
 	public:
 		CellContainer(size_t size);
@@ -32,6 +33,15 @@ protected:
 
 		eCellState At(size_t index) const;
 
+		/// <summary> Sets all cells in [first, last) to value. </summary>
+		void Fill(size_t first, size_t last, eCellState value);
+
+		/// <summary> Index of the first cell in [first, last) that is in state value, or last if there is none. </summary>
+		size_t Find(size_t first, size_t last, eCellState value) const;
+
+		/// <summary> Index of the first cell in [first, last) that is not in state value, or last if there is none. </summary>
+		size_t FindNot(size_t first, size_t last, eCellState value) const;
+
 		size_t Size() const;
 
 		void Resize(size_t size);
@@ -39,8 +49,15 @@ protected:
 		void Reset();
 
 	protected:
+		template <class MatchFunc>
+		size_t FindIf(size_t first, size_t last, eCellState value, MatchFunc match) const;
+		static uint64_t Pattern(eCellState value) { return uint64_t(value) * LOW_BITS; }
+
 		static constexpr int CELL_SIZE = 2;
-		std::vector<bool> m_bitset;
+		static constexpr size_t CELLS_PER_WORD = 64 / CELL_SIZE;
+		static constexpr uint64_t LOW_BITS = 0x5555'5555'5555'5555ull; // Lower bit of each cell.
+		std::vector<uint64_t> m_words;
+		size_t m_size;
 	};
 
 public:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
 
@@ -16,19 +17,15 @@ namespace inl {
 /// </summary>
 class SlabAllocatorEngine {
 	// How it works:
-	// Slots are grouped into blocks of size_t slots.
-	// There's an array of such blocks, each block containing a bit mask that indicate
-	// if those slots are free.
-	// Block that contain at least one free slot are linked into a list. Allocation
-	// check the free list, populates a slot and pops the first block if it's full.
+	// Slots are grouped into blocks of 64 slots, each block having a bit mask that indicates
+	// which slots are occupied.
+	// On top of the blocks, there is a hierarchy of summary bitmaps: a bit on the first level is
+	// set if the corresponding block has a free slot, a bit on the next levels is set if the
+	// corresponding word of the level below is not zero. The top level is a single word.
+	// Allocation descends the levels with CountTrailingZeros, so it always returns the lowest
+	// free slot in O(log64 n), which keeps the used part of the pool dense.
 private:
-	struct Block {
-		Block() = default;
-		Block(size_t nextBlockIndex, size_t slotOccupancy) : nextBlockIndex(nextBlockIndex), slotOccupancy(slotOccupancy) {}
-		size_t nextBlockIndex; /// <summary> Index of the next block in the free-list. </summary>
-		size_t slotOccupancy; /// <summary> 0 means the slot if free, 1 is occupied. </summary>
-	};
-	static constexpr unsigned SlotsPerBlock = 8 * sizeof(size_t);
+	static constexpr unsigned SlotsPerBlock = 64;
 
 public:
 	/// <summary>
@@ -37,14 +34,14 @@ public:
 	/// <param name="poolSize">The number of available slots in the pool.</param>
 	SlabAllocatorEngine();
 	SlabAllocatorEngine(size_t poolSize);
-	SlabAllocatorEngine(const SlabAllocatorEngine& rhs);
-	SlabAllocatorEngine(SlabAllocatorEngine&& rhs);
+	SlabAllocatorEngine(const SlabAllocatorEngine& rhs) = default;
+	SlabAllocatorEngine(SlabAllocatorEngine&& rhs) = default;
 
-	SlabAllocatorEngine& operator=(const SlabAllocatorEngine& rhs);
-	SlabAllocatorEngine& operator=(SlabAllocatorEngine&& rhs);
+	SlabAllocatorEngine& operator=(const SlabAllocatorEngine& rhs) = default;
+	SlabAllocatorEngine& operator=(SlabAllocatorEngine&& rhs) = default;
 
 	/// <summary> Allocates space from the pool for one item. </summary>
-	/// <returns> The index of the allocated slot. </returns>
+	/// <returns> The index of the allocated slot, which is the lowest free one. </returns>
 	/// <exception cref="std::bad_alloc"> Thrown if pool is full. </exception>
 	size_t Allocate();
 
@@ -53,6 +50,7 @@ public:
 
 	/// <summary> Resizes the pool, allocated slots won't be cleared, but may become invalid if pool is shrunk. </summary>
 	/// <param name="newPoolSize"> The number of available slots in the new pool. </param>
+	/// <remarks> Growing only touches the new blocks, shrinking rebuilds the summary. </remarks>
 	void Resize(size_t newPoolSize);
 
 	/// <summary> Clears all slots, does not affect pool size. </summary>
@@ -62,20 +60,20 @@ public:
 	/// <summary> Get the total number of slots (free + taken). </summary>
 	size_t Size() const { return m_poolSize; }
 
+	/// <summary> One past the highest allocated slot. The pool can be shrunk to this size without invalidating slots. </summary>
+	size_t AllocatedExtent() const;
+
 private:
-	inline size_t IndexOf(const Block* block) const {
-		return block - m_blocks.data();
-	}
-	inline void BlockOf(size_t globalIndex, Block*& block, int& inBlockIndex) {
-		size_t divRes = globalIndex / SlotsPerBlock;
-		block = &m_blocks[divRes];
-		inBlockIndex = int(globalIndex - (divRes * SlotsPerBlock)); // globalIndex % SlotsPerBlock costs much more
-	}
+	void MarkBlockFree(size_t blockIndex);
+	void MarkBlockFull(size_t blockIndex);
+	void RebuildSummary();
+	void ExtendSummary();
+	static uint64_t LockedSlotMask(size_t poolSize, size_t blockIndex);
 
 private:
 	size_t m_poolSize;
-	std::vector<Block> m_blocks;
-	Block* m_first;
+	std::vector<uint64_t> m_occupancy; // 0 means the slot if free, 1 is occupied.
+	std::vector<std::vector<uint64_t>> m_summary; // Level 0 has a bit per block, the last level is a single word.
 };
 
 
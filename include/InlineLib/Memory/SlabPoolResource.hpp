@@ -0,0 +1,63 @@
+#pragma once
+
+#include "SlabAllocatorEngine.hpp"
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+
+namespace inl {
+
+
+/// <summary>
+/// A memory resource that serves small allocations from fixed-size blocks.
+/// Requests are rounded up to a power of two size class. Each size class has its own
+/// <see cref="SlabAllocatorEngine"/> that indexes slots in chunks from the upstream resource.
+/// Allocations larger than the largest size class go directly to the upstream resource.
+/// </summary>
+/// <remarks>
+/// Freed slots are reused, lowest address first. Memory is returned to the upstream
+/// resource only by Release or destruction. Not thread-safe.
+/// </remarks>
+class SlabPoolResource : public std::pmr::memory_resource {
+	struct SizeClass {
+		SlabAllocatorEngine engine;
+		std::vector<std::byte*> chunks; // Chunk k holds the slots starting at firstSlots[k].
+		std::vector<size_t> firstSlots;
+	};
+
+public:
+	/// <param name="maxBlockSize"> Largest size class, rounded up to a power of two. </param>
+	/// <param name="upstream"> Chunks and large allocations come from this resource. With a <see cref="HugePageResource"/>, chunks are rounded up to whole pages. </param>
+	SlabPoolResource(size_t maxBlockSize = 1024, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	SlabPoolResource(const SlabPoolResource&) = delete;
+	SlabPoolResource& operator=(const SlabPoolResource&) = delete;
+	~SlabPoolResource() override;
+
+	/// <summary> Returns all chunks to the upstream resource, invalidating all allocations. </summary>
+	void Release() noexcept;
+
+	std::pmr::memory_resource* GetUpstream() const noexcept { return m_upstream; }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	static constexpr size_t MinBlockSize = 8;
+	static constexpr size_t MinChunkSlots = 64;
+
+	size_t SizeClassIndex(size_t bytes, size_t alignment) const noexcept;
+	size_t BlockSize(size_t sizeClassIndex) const noexcept { return MinBlockSize << sizeClassIndex; }
+	void AddChunk(size_t sizeClassIndex);
+
+private:
+	std::pmr::memory_resource* m_upstream;
+	size_t m_chunkGranularity;
+	std::vector<SizeClass> m_sizeClasses;
+};
+
+
+} // namespace inl
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+
+namespace inl {
+
+
+/// <summary>
+/// Two-level segregated fit allocator over a memory region given by the caller.
+/// Allocation and deallocation take constant time regardless of the number of allocations
+/// and the fragmentation of the region, so it can be used on threads with latency deadlines.
+/// </summary>
+/// <remarks>
+/// <para> Unlike <see cref="SlabAllocatorEngine"/> and <see cref="BuddyAllocationEngine"/>, this class
+///		returns pointers into the region and keeps its bookkeeping inside it, 16 bytes per block. </para>
+/// <para> The engine does not own the region, it must outlive the engine or be reset with a new one. </para>
+/// <para> Not thread-safe. See <see cref="ThreadLocalTlsfResource"/> for a thread-safe variant. </para>
+/// </remarks>
+class TlsfAllocationEngine {
+	// How it works:
+	// The region is divided into physically adjacent blocks, each starting with a header that
+	// holds the size, a free flag, and a pointer to the previous block. Free blocks are kept in
+	// a two-level table of doubly linked lists: the first level is the power of two range of
+	// the size, the second level divides the range linearly into SecondLevelCount parts.
+	// A bitmap for each level tells which lists are non-empty, so the smallest list that
+	// surely fits a request is found with a CTZ on two words, no loops. The found block is
+	// split, and the remainder goes back into the table. Freed blocks are merged with their
+	// free physical neighbours immediately, so there are never two adjacent free blocks.
+	struct BlockHeader;
+
+public:
+	/// <summary> The alignment of every allocation, and the granularity of block sizes. </summary>
+	static constexpr size_t MinAlignment = 16;
+	/// <summary> Blocks can't be larger than this, larger regions must be split between several engines. </summary>
+	static constexpr size_t MaxBlockSize = size_t(1) << 40;
+
+	/// <summary> Creates an engine without a region, all allocations fail. </summary>
+	TlsfAllocationEngine();
+	/// <summary> Manages the given memory region. </summary>
+	/// <exception cref="InvalidArgumentException"> If the region is too small to hold a single block or too large. </exception>
+	TlsfAllocationEngine(void* memory, size_t size);
+	TlsfAllocationEngine(const TlsfAllocationEngine&) = delete;
+	TlsfAllocationEngine& operator=(const TlsfAllocationEngine&) = delete;
+
+	/// <summary> Allocates a block of at least <paramref name="size"/> bytes. </summary>
+	/// <param name="alignment"> Must be a power of two. Above <see cref="MinAlignment"/>,
+	///		the search is done for size + alignment bytes, and the unused head is freed. </param>
+	/// <exception cref="std::bad_alloc"> Thrown if there is no free block large enough. </exception>
+	/// <exception cref="InvalidArgumentException"> If size is zero or alignment is not a power of two. </exception>
+	void* Allocate(size_t size, size_t alignment = MinAlignment);
+
+	/// <summary> Frees a block and merges it with its free neighbours. </summary>
+	/// <exception cref="InvalidArgumentException"> If the pointer is outside the region or the block is already free. </exception>
+	void Deallocate(void* ptr);
+
+	/// <summary> The usable size of the block at ptr, which may be larger than the requested size. </summary>
+	static size_t AllocationSize(const void* ptr) noexcept;
+
+	/// <summary> Replaces the managed region, dropping all allocations. </summary>
+	/// <exception cref="InvalidArgumentException"> If the region is too small to hold a single block or too large. </exception>
+	void Reset(void* memory, size_t size);
+	/// <summary> Frees all allocations. </summary>
+	void Reset();
+
+	/// <summary> Whether ptr points into the managed region. </summary>
+	bool Owns(const void* ptr) const noexcept { return m_begin <= ptr && ptr < m_end; }
+
+	/// <summary> The number of bytes available for allocations when the region is empty. </summary>
+	size_t Size() const noexcept { return m_capacity; }
+	/// <summary> The sum of the sizes of the allocated blocks, excluding the headers. </summary>
+	size_t AllocatedSize() const noexcept { return m_allocatedSize; }
+	size_t AllocationCount() const noexcept { return m_allocationCount; }
+
+private:
+	static constexpr int SecondLevelLog2 = 5;
+	static constexpr int SecondLevelCount = 1 << SecondLevelLog2;
+	static constexpr int FirstLevelShift = SecondLevelLog2 + 4; // Below 2^FirstLevelShift, first level 0 is split into MinAlignment steps.
+	static constexpr int FirstLevelCount = 32;
+	static constexpr size_t SmallBlockSize = size_t(1) << FirstLevelShift;
+	static_assert(SmallBlockSize / MinAlignment == SecondLevelCount, "Small blocks must map to the second levels of the first row.");
+	static_assert(size_t(1) << (FirstLevelShift - 1 + FirstLevelCount) == MaxBlockSize, "First levels must cover all block sizes.");
+
+	static void Mapping(size_t size, int& firstLevel, int& secondLevel) noexcept;
+	BlockHeader* FindFree(size_t size) noexcept;
+	void InsertFree(BlockHeader* block) noexcept;
+	void RemoveFree(BlockHeader* block) noexcept;
+	BlockHeader* SplitBlock(BlockHeader* block, size_t size) noexcept;
+	BlockHeader* Merge(BlockHeader* previous, BlockHeader* block) noexcept;
+
+private:
+	std::byte* m_begin = nullptr;
+	std::byte* m_end = nullptr;
+	size_t m_capacity = 0;
+	size_t m_allocatedSize = 0;
+	size_t m_allocationCount = 0;
+	uint32_t m_firstLevelBitmap = 0;
+	uint32_t m_secondLevelBitmaps[FirstLevelCount] = {};
+	BlockHeader* m_freeLists[FirstLevelCount][SecondLevelCount] = {};
+};
+
+
+} // namespace inl
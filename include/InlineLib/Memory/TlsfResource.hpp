@@ -0,0 +1,101 @@
+#pragma once
+
+#include "MultiInstanceTLS.hpp"
+#include "TlsfAllocationEngine.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+
+namespace inl {
+
+
+/// <summary>
+/// A memory resource that allocates from a caller-provided region through a <see cref="TlsfAllocationEngine"/>.
+/// Allocation and deallocation are O(1), there is no upstream to fall back to.
+/// </summary>
+/// <remarks> Throws std::bad_alloc when the region is exhausted. Not thread-safe. </remarks>
+class TlsfResource : public std::pmr::memory_resource {
+public:
+	/// <param name="memory"> The region to allocate from. It must outlive the resource. </param>
+	/// <param name="size"> Size of the region in bytes. </param>
+	TlsfResource(void* memory, size_t size) : m_engine(memory, size) {}
+	TlsfResource(const TlsfResource&) = delete;
+	TlsfResource& operator=(const TlsfResource&) = delete;
+
+	/// <summary> Frees all allocations. </summary>
+	void Release() noexcept { m_engine.Reset(); }
+
+	const TlsfAllocationEngine& GetEngine() const noexcept { return m_engine; }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	TlsfAllocationEngine m_engine;
+};
+
+
+/// <summary>
+/// A memory resource that splits a caller-provided region into equal sized heaps, and gives each
+/// allocating thread a heap of its own, so that threads don't contend and no locks are taken.
+/// </summary>
+/// <remarks>
+/// <para> A thread claims a heap on its first allocation, and keeps it for the lifetime of the resource.
+///		If more threads allocate than there are heaps, they get std::bad_alloc. </para>
+/// <para> Memory can be freed on any thread. If it's not the owner, the block is pushed onto a lock-free
+///		list of the owning heap, and the owner frees it on one of its next allocations. Each allocation
+///		frees at most a few of these blocks to keep the time bounded, except when the heap would
+///		otherwise be exhausted. </para>
+/// <para> Thread-safe. </para>
+/// </remarks>
+class ThreadLocalTlsfResource : public std::pmr::memory_resource {
+	struct RemoteBlock {
+		RemoteBlock* next;
+	};
+	struct alignas(64) Heap {
+		TlsfAllocationEngine engine;
+		std::atomic<RemoteBlock*> remoteFrees = nullptr; // Pushed by other threads.
+		RemoteBlock* pendingFrees = nullptr; // Taken over from remoteFrees, only touched by the owner.
+	};
+
+public:
+	/// <param name="memory"> The region to allocate from. It must outlive the resource. </param>
+	/// <param name="size"> Size of the region in bytes. </param>
+	/// <param name="heapSize"> The size of each thread's heap, the region holds size / heapSize heaps. </param>
+	/// <exception cref="InvalidArgumentException"> If the region can't hold a single heap. </exception>
+	ThreadLocalTlsfResource(void* memory, size_t size, size_t heapSize);
+	ThreadLocalTlsfResource(const ThreadLocalTlsfResource&) = delete;
+	ThreadLocalTlsfResource& operator=(const ThreadLocalTlsfResource&) = delete;
+
+	size_t GetHeapCount() const noexcept { return m_heapCount; }
+	/// <summary> The number of heaps claimed by threads so far. </summary>
+	size_t GetClaimedHeapCount() const noexcept { return std::min(m_claimedHeapCount.load(std::memory_order_relaxed), m_heapCount); }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+private:
+	static constexpr size_t MaxFreesPerAllocation = 4;
+
+	Heap& GetThreadHeap();
+	void FreePending(Heap& heap, size_t maxCount);
+
+private:
+	std::byte* m_memory;
+	size_t m_heapSize;
+	size_t m_heapCount;
+	std::unique_ptr<Heap[]> m_heaps;
+	std::atomic_size_t m_claimedHeapCount = 0;
+	mi_tls<Heap*> m_threadHeap;
+};
+
+
+} // namespace inl
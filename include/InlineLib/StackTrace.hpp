@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <iostream>
 #include <mutex>
 #include <string>
@@ -37,18 +39,20 @@ std::ostream& operator<<(std::ostream& os, const StackFrameT<Allocator>& frame)
 #include <Dbghelp.h>
 #pragma comment(lib, "dbghelp.lib")
 
-template <template <class> class Allocator = std::allocator>
-std::vector<StackFrameT<Allocator>, Allocator<StackFrameT<Allocator>>> GetStackTrace() {
-	// Initialize sym stuff
+// Sym stuff is single-threaded, all users lock this.
+inline std::mutex& GetSymbolMutex() {
+	static std::mutex mtx;
 	[[maybe_unused]] static bool isInitalized = [] {
 		SymInitialize(GetCurrentProcess(), NULL, TRUE);
 		return true;
 	}();
+	return mtx;
+}
 
 
-	// Sym stuff is single-threaded, lock it
-	static std::mutex mtx;
-	std::lock_guard<std::mutex> lkg(mtx);
+template <template <class> class Allocator = std::allocator>
+std::vector<StackFrameT<Allocator>, Allocator<StackFrameT<Allocator>>> GetStackTrace() {
+	std::lock_guard<std::mutex> lkg(GetSymbolMutex());
 
 
 	// Helper to have moar characters
@@ -134,6 +138,58 @@ std::vector<StackFrameT<Allocator>, Allocator<StackFrameT<Allocator>>> GetStackT
 	return frames;
 }
 
+
+/// <summary> Captures the return addresses of the calling thread's stack without resolving any symbols. </summary>
+/// <param name="addresses"> Receives the addresses, innermost frame first. </param>
+/// <param name="maxCount"> The size of <paramref name="addresses"/>. </param>
+/// <param name="skip"> Number of frames to skip, not counting this function. </param>
+/// <returns> The number of addresses written. </returns>
+/// <remarks> Doesn't allocate or lock, so it is safe to call from inside an allocator. </remarks>
+__declspec(noinline) inline size_t CaptureStackAddresses(void** addresses, size_t maxCount, size_t skip = 0) noexcept {
+	return RtlCaptureStackBackTrace(DWORD(skip + 1), DWORD(maxCount), addresses, nullptr);
+}
+
+
+/// <summary> Looks up the symbol and source location of an address captured by <see cref="CaptureStackAddresses"/>. </summary>
+template <template <class> class Allocator = std::allocator>
+StackFrameT<Allocator> ResolveStackFrame(void* instructionAddress) {
+	std::lock_guard<std::mutex> lkg(GetSymbolMutex());
+	HANDLE process = GetCurrentProcess();
+
+	struct IMAGEHLP_SYMBOL64_EXTRA {
+		IMAGEHLP_SYMBOL64 data;
+		char nameExtra[1024] = { 0 };
+	};
+	IMAGEHLP_SYMBOL64_EXTRA symbol;
+	char undecoratedName[256] = { 0 };
+	DWORD64 displacement64 = 0;
+	symbol.data.SizeOfStruct = sizeof(IMAGEHLP_SYMBOL64);
+	symbol.data.MaxNameLength = 255;
+	if (SymGetSymFromAddr64(process, (ULONG64)instructionAddress, &displacement64, &symbol.data)) {
+		UnDecorateSymbolName(symbol.data.Name, (PSTR)undecoratedName, 256, UNDNAME_COMPLETE);
+	}
+
+	DWORD displacement = 0;
+	IMAGEHLP_LINE64 lineInfo;
+	lineInfo.Address = (DWORD64)instructionAddress;
+	lineInfo.Key = nullptr;
+	lineInfo.SizeOfStruct = sizeof(lineInfo);
+	lineInfo.FileName = nullptr;
+	lineInfo.LineNumber = -1;
+	SymSetOptions(SYMOPT_LOAD_LINES);
+	SymGetLineFromAddr64(process, (DWORD64)instructionAddress, &displacement, &lineInfo);
+
+	StackFrameT<Allocator> frame;
+	frame.frame = 0;
+	frame.frameAddress = nullptr;
+	frame.instructionAddress = instructionAddress;
+	frame.stackAddress = nullptr;
+	frame.symbol = undecoratedName;
+	frame.sourceFile = lineInfo.FileName ? lineInfo.FileName : "<no file info>";
+	frame.sourceLine = lineInfo.LineNumber != (DWORD)-1 ? lineInfo.LineNumber : 0;
+	return frame;
+}
+
 #else
 
 template <template <class> class Allocator = std::allocator>
@@ -150,4 +206,76 @@ std::vector<StackFrameT<Allocator>, Allocator<StackFrameT<Allocator>>> GetStackT
 	return { currentFrame };
 }
 
+
+#if defined(__GNUC__) && __has_include(<execinfo.h>) && __has_include(<dlfcn.h>)
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <cstdlib>
+
+/// <summary> Captures the return addresses of the calling thread's stack without resolving any symbols. </summary>
+/// <param name="addresses"> Receives the addresses, innermost frame first. </param>
+/// <param name="maxCount"> The size of <paramref name="addresses"/>. </param>
+/// <param name="skip"> Number of frames to skip, not counting this function. </param>
+/// <returns> The number of addresses written. </returns>
+/// <remarks> The first call may allocate while the unwinder is loaded, later calls don't. </remarks>
+__attribute__((noinline)) inline size_t CaptureStackAddresses(void** addresses, size_t maxCount, size_t skip = 0) noexcept {
+	constexpr size_t bufferSize = 64;
+	void* buffer[bufferSize];
+	size_t count = size_t(backtrace(buffer, int(std::min(maxCount + skip + 1, bufferSize))));
+	size_t first = std::min(count, skip + 1);
+	std::copy(buffer + first, buffer + count, addresses);
+	return count - first;
+}
+
+
+/// <summary> Looks up the symbol of an address captured by <see cref="CaptureStackAddresses"/>. </summary>
+/// <remarks> Only exported symbols can be found, and there is no source location information. </remarks>
+template <template <class> class Allocator = std::allocator>
+StackFrameT<Allocator> ResolveStackFrame(void* instructionAddress) {
+	StackFrameT<Allocator> frame;
+	frame.frame = 0;
+	frame.frameAddress = nullptr;
+	frame.instructionAddress = instructionAddress;
+	frame.stackAddress = nullptr;
+	frame.sourceFile = "<no file info>";
+	frame.sourceLine = 0;
+
+	Dl_info info = {};
+	if (dladdr(instructionAddress, &info)) {
+		if (info.dli_sname) {
+			int status = 0;
+			char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+			frame.symbol = status == 0 && demangled ? demangled : info.dli_sname;
+			std::free(demangled);
+		}
+		if (info.dli_fname) {
+			frame.sourceFile = info.dli_fname;
+		}
+	}
+	return frame;
+}
+
+#else
+
+inline size_t CaptureStackAddresses(void**, size_t, size_t = 0) noexcept {
+	return 0;
+}
+
+template <template <class> class Allocator = std::allocator>
+StackFrameT<Allocator> ResolveStackFrame(void* instructionAddress) {
+	StackFrameT<Allocator> frame;
+	frame.frame = 0;
+	frame.frameAddress = nullptr;
+	frame.instructionAddress = instructionAddress;
+	frame.stackAddress = nullptr;
+	frame.symbol = "no stack trace for this platform";
+	frame.sourceFile = "<no file info>";
+	frame.sourceLine = 0;
+	return frame;
+}
+
+#endif
+
 #endif
\ No newline at end of file
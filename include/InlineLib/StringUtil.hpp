@@ -346,4 +346,18 @@ StringErrorLocation<CharT, Traits> FindStringErrorLocation(std::basic_string_vie
 
 
 
+//------------------------------------------------------------------------------
+// Hashing.
+//------------------------------------------------------------------------------
+
+/// <summary> Hashes all string types alike. Unordered containers with this hash and std::equal_to&lt;&gt;
+///		can be searched by string_view, without building a key in their own string type. </summary>
+struct TransparentStringHash {
+	using is_transparent = void;
+	size_t operator()(std::string_view str) const noexcept {
+		return std::hash<std::string_view>{}(str);
+	}
+};
+
+
 } // namespace inl
@@ -4,8 +4,36 @@
 
 namespace inl {
 
+NodeFactory::NodeInfo::NodeInfo(const allocator_type& alloc)
+	: inputNames(alloc), outputNames(alloc), inputTypes(alloc), outputTypes(alloc), name(alloc), description(alloc), group(alloc) {}
+
+
+NodeFactory::NodeInfo::NodeInfo(const NodeInfo& rhs, const allocator_type& alloc)
+	: numInputPorts(rhs.numInputPorts),
+	  numOutputPorts(rhs.numOutputPorts),
+	  inputNames(rhs.inputNames, alloc),
+	  outputNames(rhs.outputNames, alloc),
+	  inputTypes(rhs.inputTypes, alloc),
+	  outputTypes(rhs.outputTypes, alloc),
+	  name(rhs.name, alloc),
+	  description(rhs.description, alloc),
+	  group(rhs.group, alloc) {}
+
+
+NodeFactory::NodeInfo::NodeInfo(NodeInfo&& rhs, const allocator_type& alloc)
+	: numInputPorts(rhs.numInputPorts),
+	  numOutputPorts(rhs.numOutputPorts),
+	  inputNames(std::move(rhs.inputNames), alloc),
+	  outputNames(std::move(rhs.outputNames), alloc),
+	  inputTypes(std::move(rhs.inputTypes), alloc),
+	  outputTypes(std::move(rhs.outputTypes), alloc),
+	  name(std::move(rhs.name), alloc),
+	  description(std::move(rhs.description), alloc),
+	  group(std::move(rhs.group), alloc) {}
+
+
 NodeBase* NodeFactory::CreateNode(const std::string& name) const {
-	auto it = registeredClasses.find(name);
+	auto it = registeredClasses.find(std::string_view(name));
 	if (it == registeredClasses.end()) {
 		throw InvalidArgumentException("Requested node was not found.", name);
 	}
@@ -15,7 +43,7 @@ NodeBase* NodeFactory::CreateNode(const std::string& name) const {
 }
 
 const NodeFactory::NodeInfo* NodeFactory::GetNodeInfo(const std::string& name) const {
-	auto it = registeredClasses.find(name);
+	auto it = registeredClasses.find(std::string_view(name));
 	if (it == registeredClasses.end()) {
 		return nullptr;
 	}
@@ -40,7 +68,8 @@ std::tuple<std::string, std::string> NodeFactory::GetFullName(std::type_index cl
 	if (it == typeLookup.end()) {
 		throw OutOfRangeException("This type is not registered as a node.");
 	}
-	return it->second;
+	const auto& [group, name] = it->second;
+	return { std::string(group), std::string(name) };
 }
 
 
@@ -10,26 +10,100 @@
 #include <rapidjson/encodings.h>
 #include <rapidjson/prettywriter.h>
 #include <rapidjson/stringbuffer.h>
+#include <cstddef>
+#include <cstring>
 #include <sstream>
 #include <InlineMath.hpp>
 
 
 namespace inl {
 
+//------------------------------------------------------------------------------
+// Parsing allocator.
+//------------------------------------------------------------------------------
+
+namespace {
+
+	/// <summary> Lets rapidjson allocate from a memory resource. </summary>
+	/// <remarks> rapidjson frees through a static function without the size,
+	///		so each block starts with a header that records its resource and size. </remarks>
+	class JsonResourceAllocator {
+	public:
+		static const bool kNeedFree = true;
+
+		JsonResourceAllocator(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_resource(resource) {}
+
+		void* Malloc(size_t size) {
+			if (size == 0) {
+				return nullptr;
+			}
+			auto header = static_cast<Header*>(m_resource->allocate(sizeof(Header) + size, alignof(Header)));
+			header->resource = m_resource;
+			header->size = size;
+			return header + 1;
+		}
+
+		void* Realloc(void* originalPtr, size_t originalSize, size_t newSize) {
+			if (newSize == 0) {
+				Free(originalPtr);
+				return nullptr;
+			}
+			void* newPtr = Malloc(newSize);
+			if (originalPtr) {
+				std::memcpy(newPtr, originalPtr, std::min(originalSize, newSize));
+				Free(originalPtr);
+			}
+			return newPtr;
+		}
+
+		static void Free(void* ptr) {
+			if (ptr) {
+				Header* header = static_cast<Header*>(ptr) - 1;
+				header->resource->deallocate(header, sizeof(Header) + header->size, alignof(Header));
+			}
+		}
+
+	private:
+		struct alignas(alignof(std::max_align_t)) Header {
+			std::pmr::memory_resource* resource;
+			size_t size;
+		};
+		std::pmr::memory_resource* m_resource;
+	};
+
+	constexpr size_t JsonChunkCapacity = 64 * 1024; // rapidjson's defaults.
+	constexpr size_t JsonStackCapacity = 1024;
+
+	using JsonPoolAllocator = rapidjson::MemoryPoolAllocator<JsonResourceAllocator>;
+	using JsonDocument = rapidjson::GenericDocument<rapidjson::UTF8<>, JsonPoolAllocator, JsonResourceAllocator>;
+	using JsonValue = rapidjson::GenericValue<rapidjson::UTF8<>, JsonPoolAllocator>;
+
+} // namespace
+
+
 //------------------------------------------------------------------------------
 // Helper functions prototypes.
 //------------------------------------------------------------------------------
 
 static void AssertThrow(bool condition, const std::string& message);
-static NodeDescription ParseNode(const rapidjson::GenericValue<rapidjson::UTF8<>>& jsonObj);
-static LinkDescription ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& jsonObj);
+static NodeDescription ParseNode(const JsonValue& jsonObj, std::pmr::memory_resource* resource);
+static LinkDescription ParseLink(const JsonValue& jsonObj, std::pmr::memory_resource* resource);
 
 
 //------------------------------------------------------------------------------
 // GraphParser.
 //------------------------------------------------------------------------------
 
-void GraphParser::Parse(const std::string& json) {
+GraphParser::GraphParser(std::pmr::memory_resource* resource)
+	: m_resource(resource),
+	  m_header{ std::pmr::string(resource) },
+	  m_nodeDescs(resource),
+	  m_linkDescs(resource),
+	  m_idLookup(resource),
+	  m_nameLookup(resource) {}
+
+
+void GraphParser::Parse(std::string_view json) {
 	ParseDocument(json);
 	CreateLookupTables();
 }
@@ -144,17 +218,17 @@ const GraphHeader& GraphParser::GetHeader() const {
 }
 
 
-const std::vector<NodeDescription>& GraphParser::GetNodes() const {
+const std::pmr::vector<NodeDescription>& GraphParser::GetNodes() const {
 	return m_nodeDescs;
 }
 
 
-const std::vector<LinkDescription>& GraphParser::GetLinks() const {
+const std::pmr::vector<LinkDescription>& GraphParser::GetLinks() const {
 	return m_linkDescs;
 }
 
 
-size_t GraphParser::FindNode(const std::optional<int>& id, const std::optional<std::string>& name) const {
+size_t GraphParser::FindNode(const std::optional<int>& id, const std::optional<std::pmr::string>& name) const {
 	if (id) {
 		return FindNode(id.value());
 	}
@@ -174,7 +248,7 @@ size_t GraphParser::FindNode(int id) const {
 }
 
 
-size_t GraphParser::FindNode(const std::string& name) const {
+size_t GraphParser::FindNode(std::string_view name) const {
 	auto it = m_nameLookup.find(name);
 	if (it != m_nameLookup.end()) {
 		return it->second;
@@ -184,7 +258,7 @@ size_t GraphParser::FindNode(const std::string& name) const {
 
 
 ISerializableInputPort& GraphParser::FindInputPort(ISerializableNode* holder, const std::optional<int>& index,
-												   const std::optional<std::string>& name) {
+												   const std::optional<std::pmr::string>& name) {
 	if (index) {
 		return FindInputPort(holder, index.value());
 	}
@@ -195,7 +269,7 @@ ISerializableInputPort& GraphParser::FindInputPort(ISerializableNode* holder, co
 }
 
 
-ISerializableInputPort& GraphParser::FindInputPort(ISerializableNode* holder, const std::string& name) {
+ISerializableInputPort& GraphParser::FindInputPort(ISerializableNode* holder, std::string_view name) {
 	for (auto i : Range(holder->GetNumInputs())) {
 		if (holder->GetInputName(i) == name) {
 			return holder->GetInput(i);
@@ -214,7 +288,7 @@ ISerializableInputPort& GraphParser::FindInputPort(ISerializableNode* holder, in
 
 
 ISerializableOutputPort& GraphParser::FindOutputPort(ISerializableNode* holder, const std::optional<int>& index,
-													 const std::optional<std::string>& name) {
+													 const std::optional<std::pmr::string>& name) {
 	if (index) {
 		return FindOutputPort(holder, index.value());
 	}
@@ -225,7 +299,7 @@ ISerializableOutputPort& GraphParser::FindOutputPort(ISerializableNode* holder,
 }
 
 
-ISerializableOutputPort& GraphParser::FindOutputPort(ISerializableNode* holder, const std::string& name) {
+ISerializableOutputPort& GraphParser::FindOutputPort(ISerializableNode* holder, std::string_view name) {
 	for (auto i : Range(holder->GetNumOutputs())) {
 		if (holder->GetOutputName(i) == name) {
 			return holder->GetOutput(i);
@@ -243,22 +317,24 @@ ISerializableOutputPort& GraphParser::FindOutputPort(ISerializableNode* holder,
 }
 
 
-void GraphParser::ParseDocument(const std::string& document) {
+void GraphParser::ParseDocument(std::string_view document) {
 	using namespace rapidjson;
 
 	// Parse the JSON file.
-	Document doc;
-	doc.Parse(document.c_str());
+	JsonResourceAllocator baseAllocator(m_resource);
+	JsonPoolAllocator poolAllocator(JsonChunkCapacity, &baseAllocator);
+	JsonDocument doc(&poolAllocator, JsonStackCapacity, &baseAllocator);
+	doc.Parse(document.data(), document.size());
 	ParseErrorCode ec = doc.GetParseError();
 	if (ec != ParseErrorCode::kParseErrorNone) {
 		size_t errorCharacter = doc.GetErrorOffset();
-		auto [lineNumber, characterNumber, line] = FindStringErrorLocation(std::string_view{ document }, errorCharacter);
+		auto [lineNumber, characterNumber, line] = FindStringErrorLocation(document, errorCharacter);
 		throw InvalidArgumentException("JSON descripion has syntax errors.", "Check line " + std::to_string(lineNumber) + ":" + std::to_string(characterNumber));
 	}
 	AssertThrow(doc.IsObject(), R"(JSON root must be an object with member arrays "nodes" and "links".)");
 
 	// Extract header.
-	GraphHeader graphHeader{};
+	GraphHeader graphHeader{ std::pmr::string(m_resource) };
 	if (doc.HasMember("header") && doc["header"].IsObject()) {
 		auto& header = doc["header"];
 		AssertThrow(header.HasMember("contentType") && header["contentType"].IsString(), "Header must be a struct: { string contentType; }.");
@@ -271,35 +347,37 @@ void GraphParser::ParseDocument(const std::string& document) {
 
 	auto& nodes = doc["nodes"];
 	auto& links = doc["links"];
-	std::vector<NodeDescription> nodeDescs;
-	std::vector<LinkDescription> linkDescs;
+	std::pmr::vector<NodeDescription> nodeDescs(m_resource);
+	std::pmr::vector<LinkDescription> linkDescs(m_resource);
+	nodeDescs.reserve(nodes.Size());
+	linkDescs.reserve(links.Size());
 
+	// Moved, so the strings stay in the resource.
 	for (SizeType i = 0; i < nodes.Size(); ++i) {
-		NodeDescription info = ParseNode(nodes[i]);
-		nodeDescs.push_back(info);
+		nodeDescs.push_back(ParseNode(nodes[i], m_resource));
 	}
 
 	for (SizeType i = 0; i < links.Size(); ++i) {
-		LinkDescription info = ParseLink(links[i]);
-		linkDescs.push_back(info);
+		linkDescs.push_back(ParseLink(links[i], m_resource));
 	}
 
-	m_header = graphHeader;
-	m_nodeDescs = nodeDescs;
-	m_linkDescs = linkDescs;
+	m_header = std::move(graphHeader);
+	m_nodeDescs = std::move(nodeDescs);
+	m_linkDescs = std::move(linkDescs);
 }
 
 
 void GraphParser::CreateLookupTables() {
-	std::unordered_map<int, size_t> idLookup;
-	std::unordered_map<std::string, size_t> nameLookup;
+	std::pmr::unordered_map<int, size_t> idLookup(m_idLookup.get_allocator());
+	decltype(m_nameLookup) nameLookup(m_nameLookup.get_allocator());
 	for (size_t i = 0; i < m_nodeDescs.size(); ++i) {
+		// Emplaced, so that the keys are created by the map's allocator.
 		if (m_nodeDescs[i].name) {
-			auto ins = nameLookup.insert({ m_nodeDescs[i].name.value(), i });
+			auto ins = nameLookup.emplace(m_nodeDescs[i].name.value(), i);
 			AssertThrow(ins.second == true, "Node names must be unique.");
 		}
 		if (m_nodeDescs[i].id) {
-			auto ins = idLookup.insert({ m_nodeDescs[i].id.value(), i });
+			auto ins = idLookup.emplace(m_nodeDescs[i].id.value(), i);
 			AssertThrow(ins.second == true, "Node ids must be unique.");
 		}
 	}
@@ -368,7 +446,7 @@ std::string GraphParser::MakeJson(std::vector<NodeDescription> nodeDescs, std::v
 	}
 
 	// Add links to doc.
-	auto AddLinkMember = [&alloc](Value& v, const char* member, std::optional<int> num, std::optional<std::string> str) {
+	auto AddLinkMember = [&alloc](Value& v, const char* member, const std::optional<int>& num, const std::optional<std::pmr::string>& str) {
 		if (num) {
 			v.AddMember(GenericStringRef<char>(member), num.value(), alloc);
 		}
@@ -408,17 +486,17 @@ void AssertThrow(bool condition, const std::string& text) {
 }
 
 
-NodeDescription ParseNode(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj) {
+NodeDescription ParseNode(const JsonValue& obj, std::pmr::memory_resource* resource) {
 	using namespace rapidjson;
 
-	NodeDescription info;
+	NodeDescription info(resource);
 	if (obj.HasMember("id")) {
 		AssertThrow(obj["id"].IsInt(), "Node's id member must be an integer.");
 		info.id = obj["id"].GetInt();
 	}
 	if (obj.HasMember("name")) {
 		AssertThrow(obj["name"].IsString(), "Node's name member must be a string.");
-		info.name = obj["name"].GetString();
+		info.name.emplace(obj["name"].GetString(), resource);
 	}
 	AssertThrow(info.id || info.name, "Node must have either id or name.");
 	AssertThrow(obj.HasMember("class") && obj["class"].IsString(), "Node must have a class.");
@@ -428,17 +506,18 @@ NodeDescription ParseNode(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 		AssertThrow(obj["inputs"].IsArray(), "Default inputs must be specified in an array, undefined inputs as {}.");
 		auto& inputs = obj["inputs"];
 		for (SizeType i = 0; i < inputs.Size(); ++i) {
+			// Optionals are not allocator-aware, the strings are given the resource explicitly.
 			if (inputs[i].IsObject() && inputs[i].ObjectEmpty()) {
 				info.defaultInputs.push_back({});
 			}
 			else if (inputs[i].IsString()) {
-				info.defaultInputs.push_back(inputs[i].GetString());
+				info.defaultInputs.emplace_back(std::in_place, inputs[i].GetString(), resource);
 			}
 			else if (inputs[i].IsInt64()) {
-				info.defaultInputs.push_back(std::to_string(inputs[i].GetInt64()));
+				info.defaultInputs.emplace_back(std::in_place, std::to_string(inputs[i].GetInt64()), resource);
 			}
 			else if (inputs[i].IsDouble()) {
-				info.defaultInputs.push_back(std::to_string(inputs[i].GetDouble()));
+				info.defaultInputs.emplace_back(std::in_place, std::to_string(inputs[i].GetDouble()), resource);
 			}
 			else {
 				assert(false);
@@ -448,9 +527,8 @@ NodeDescription ParseNode(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 
 	if (obj.HasMember("meta_pos")) {
 		AssertThrow(obj["meta_pos"].IsString(), "Meta pos must a string of format [123, -456].");
-		std::string vecStr = obj["meta_pos"].GetString();
 		const char* endPtr;
-		Vec2u pos = strtovec<Vec2u>(vecStr.c_str(), &endPtr);
+		Vec2u pos = strtovec<Vec2u>(obj["meta_pos"].GetString(), &endPtr);
 		info.metaData.placement = pos;
 	}
 
@@ -458,7 +536,7 @@ NodeDescription ParseNode(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 };
 
 
-LinkDescription ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj) {
+LinkDescription ParseLink(const JsonValue& obj, std::pmr::memory_resource* resource) {
 	LinkDescription info;
 
 	AssertThrow(obj.HasMember("src")
@@ -468,7 +546,7 @@ LinkDescription ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 				"Link must have members src, dst, srcp and dstp.");
 
 	if (obj["src"].IsString()) {
-		info.srcname = obj["src"].GetString();
+		info.srcname.emplace(obj["src"].GetString(), resource);
 	}
 	else if (obj["src"].IsInt()) {
 		info.srcid = obj["src"].GetInt();
@@ -478,7 +556,7 @@ LinkDescription ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 	}
 
 	if (obj["dst"].IsString()) {
-		info.dstname = obj["dst"].GetString();
+		info.dstname.emplace(obj["dst"].GetString(), resource);
 	}
 	else if (obj["dst"].IsInt()) {
 		info.dstid = obj["dst"].GetInt();
@@ -488,7 +566,7 @@ LinkDescription ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 	}
 
 	if (obj["srcp"].IsString()) {
-		info.srcpname = obj["srcp"].GetString();
+		info.srcpname.emplace(obj["srcp"].GetString(), resource);
 	}
 	else if (obj["srcp"].IsInt()) {
 		info.srcpidx = obj["srcp"].GetInt();
@@ -498,7 +576,7 @@ LinkDescription ParseLink(const rapidjson::GenericValue<rapidjson::UTF8<>>& obj)
 	}
 
 	if (obj["dstp"].IsString()) {
-		info.dstpname = obj["dstp"].GetString();
+		info.dstpname.emplace(obj["dstp"].GetString(), resource);
 	}
 	else if (obj["dstp"].IsInt()) {
 		info.dstpidx = obj["dstp"].GetInt();
@@ -0,0 +1,719 @@
+#include <InlineLib/JobSystem/AsyncFile.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/ThreadName.hpp>
+
+#include <moodycamel/blockingconcurrentqueue.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+
+namespace inl::jobs {
+
+
+//------------------------------------------------------------------------------
+// Platform file operations.
+//------------------------------------------------------------------------------
+
+namespace {
+	constexpr intptr_t invalidHandle = -1;
+
+#ifdef _WIN32
+	std::string ErrorString(int64_t error) {
+		return "Windows error " + std::to_string(error);
+	}
+
+	intptr_t OpenFile(const std::string& path, eFileAccess access) {
+		DWORD desiredAccess = 0;
+		DWORD creation = 0;
+		switch (access) {
+			case eFileAccess::READ:
+				desiredAccess = GENERIC_READ;
+				creation = OPEN_EXISTING;
+				break;
+			case eFileAccess::WRITE:
+				desiredAccess = GENERIC_WRITE;
+				creation = CREATE_ALWAYS;
+				break;
+			case eFileAccess::READ_WRITE:
+				desiredAccess = GENERIC_READ | GENERIC_WRITE;
+				creation = OPEN_ALWAYS;
+				break;
+		}
+		HANDLE handle = CreateFileA(path.c_str(), desiredAccess, FILE_SHARE_READ, nullptr, creation, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			DWORD error = GetLastError();
+			if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) {
+				throw FileNotFoundException("Could not open file.", path);
+			}
+			throw RuntimeException("Could not open file.", path + ": " + ErrorString(error));
+		}
+		return reinterpret_cast<intptr_t>(handle);
+	}
+
+	void CloseFile(intptr_t handle) {
+		CloseHandle(reinterpret_cast<HANDLE>(handle));
+	}
+
+	uint64_t FileSize(intptr_t handle) {
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(reinterpret_cast<HANDLE>(handle), &size)) {
+			throw RuntimeException("Could not query file size.", ErrorString(GetLastError()));
+		}
+		return size.QuadPart;
+	}
+
+	// Windows has no positional scatter/gather for buffered files, the buffers are transferred one by one.
+	int64_t ExecuteBlocking(const impl::IoRequest& request) {
+		int64_t total = 0;
+		for (unsigned i = 0; i < request.bufferCount; ++i) {
+			const IoBuffer& buffer = request.buffers[i];
+			OVERLAPPED overlapped = {};
+			uint64_t offset = request.offset + total;
+			overlapped.Offset = DWORD(offset);
+			overlapped.OffsetHigh = DWORD(offset >> 32);
+			DWORD transferred = 0;
+			BOOL success = request.operation == impl::eIoOperation::READ
+							   ? ReadFile(reinterpret_cast<HANDLE>(request.fileHandle), buffer.data, DWORD(buffer.size), &transferred, &overlapped)
+							   : WriteFile(reinterpret_cast<HANDLE>(request.fileHandle), buffer.data, DWORD(buffer.size), &transferred, &overlapped);
+			if (!success) {
+				DWORD error = GetLastError();
+				if (error == ERROR_HANDLE_EOF) {
+					break;
+				}
+				return -int64_t(error);
+			}
+			total += transferred;
+			if (transferred < buffer.size) {
+				break;
+			}
+		}
+		return total;
+	}
+#else
+	static_assert(sizeof(IoBuffer) == sizeof(iovec) && offsetof(IoBuffer, size) == offsetof(iovec, iov_len), "IoBuffer must be layout compatible with iovec.");
+
+	std::string ErrorString(int64_t error) {
+		return std::strerror(int(error));
+	}
+
+	intptr_t OpenFile(const std::string& path, eFileAccess access) {
+		int flags = O_CLOEXEC;
+		switch (access) {
+			case eFileAccess::READ: flags |= O_RDONLY; break;
+			case eFileAccess::WRITE: flags |= O_WRONLY | O_CREAT | O_TRUNC; break;
+			case eFileAccess::READ_WRITE: flags |= O_RDWR | O_CREAT; break;
+		}
+		int fd = open(path.c_str(), flags, 0644);
+		if (fd < 0) {
+			if (errno == ENOENT) {
+				throw FileNotFoundException("Could not open file.", path);
+			}
+			throw RuntimeException("Could not open file.", path + ": " + ErrorString(errno));
+		}
+		return fd;
+	}
+
+	void CloseFile(intptr_t handle) {
+		close(int(handle));
+	}
+
+	uint64_t FileSize(intptr_t handle) {
+		struct stat info;
+		if (fstat(int(handle), &info) != 0) {
+			throw RuntimeException("Could not query file size.", ErrorString(errno));
+		}
+		return info.st_size;
+	}
+
+	int64_t ExecuteBlocking(const impl::IoRequest& request) {
+		const iovec* buffers = reinterpret_cast<const iovec*>(request.buffers);
+		ssize_t result;
+		do {
+			result = request.operation == impl::eIoOperation::READ
+						 ? preadv(int(request.fileHandle), buffers, int(request.bufferCount), off_t(request.offset))
+						 : pwritev(int(request.fileHandle), buffers, int(request.bufferCount), off_t(request.offset));
+		} while (result < 0 && errno == EINTR);
+		return result < 0 ? -int64_t(errno) : int64_t(result);
+	}
+#endif
+} // namespace
+
+
+//------------------------------------------------------------------------------
+// Backends.
+//------------------------------------------------------------------------------
+
+namespace impl {
+
+	class IoBackend {
+	public:
+		virtual ~IoBackend() = default;
+		virtual void Submit(IoRequest* const* requests, size_t count) = 0;
+	};
+
+
+	void CompleteRequest(IoRequest* request) noexcept {
+		IoCompletion* completion = request->completion;
+		if (completion->remaining.fetch_sub(1) == 1) {
+			if (completion->scheduler) {
+				completion->scheduler->Resume(completion->handle);
+			}
+			else {
+				completion->handle.resume();
+			}
+		}
+	}
+
+
+	size_t GetRequestResult(const IoRequest& request) {
+		if (request.result < 0) {
+			throw RuntimeException(request.operation == eIoOperation::READ ? "Could not read file." : "Could not write file.",
+								   ErrorString(-request.result));
+		}
+		return size_t(request.result);
+	}
+
+
+	// Executes requests as blocking calls on dedicated threads, so that pool workers are not blocked.
+	class ThreadPoolBackend : public IoBackend {
+	public:
+		ThreadPoolBackend(int threadCount) {
+			m_threads.resize(std::max(threadCount, 1));
+			int threadIndex = 0;
+			for (auto& thread : m_threads) {
+				thread = std::thread([this](int threadIndex) {
+					std::stringstream ss;
+					ss << "Jobsys IO #" << threadIndex;
+					SetCurrentThreadName(ss.str().c_str());
+					ThreadFunc();
+				},
+									 threadIndex);
+				++threadIndex;
+			}
+		}
+
+		~ThreadPoolBackend() {
+			for (size_t i = 0; i < m_threads.size(); ++i) {
+				m_requests.enqueue(nullptr);
+			}
+			for (auto& thread : m_threads) {
+				thread.join();
+			}
+		}
+
+		void Submit(IoRequest* const* requests, size_t count) override {
+			m_requests.enqueue_bulk(requests, count);
+		}
+
+	private:
+		void ThreadFunc() {
+			IoRequest* request;
+			do {
+				m_requests.wait_dequeue(request);
+				if (request) {
+					request->result = ExecuteBlocking(*request);
+					CompleteRequest(request);
+				}
+			} while (request);
+		}
+
+	private:
+		std::vector<std::thread> m_threads;
+		moodycamel::BlockingConcurrentQueue<IoRequest*> m_requests;
+	};
+
+
+#ifdef __linux__
+	// Submits requests to an io_uring instance and reaps completions on a single thread.
+	// The raw system calls are used so that liburing is not needed.
+	class UringBackend : public IoBackend {
+	public:
+		// Returns null if the kernel does not support io_uring.
+		static std::unique_ptr<UringBackend> Create(unsigned entries) {
+			std::unique_ptr<UringBackend> backend(new UringBackend());
+			if (!backend->Setup(entries)) {
+				return nullptr;
+			}
+			backend->m_completionThread = std::thread([backend = backend.get()] {
+				SetCurrentThreadName("Jobsys IO completion");
+				backend->CompletionThreadFunc();
+			});
+			return backend;
+		}
+
+		~UringBackend() {
+			if (m_completionThread.joinable()) {
+				// A no-op with null user data stops the completion thread.
+				IoRequest* stop = nullptr;
+				Submit(&stop, 1);
+				m_completionThread.join();
+			}
+			if (m_sqes) {
+				munmap(m_sqes, m_sqesSize);
+			}
+			if (m_cqRing && m_cqRing != m_sqRing) {
+				munmap(m_cqRing, m_cqRingSize);
+			}
+			if (m_sqRing) {
+				munmap(m_sqRing, m_sqRingSize);
+			}
+			if (m_ringFd >= 0) {
+				close(m_ringFd);
+			}
+		}
+
+		void Submit(IoRequest* const* requests, size_t count) override {
+			std::lock_guard<std::mutex> lk(m_submitMtx);
+
+			unsigned tail = *m_sqTail;
+			for (size_t i = 0; i < count; ++i) {
+				// Keep the completion queue from overflowing, and make room in the submission queue.
+				while (m_inFlight.load(std::memory_order_acquire) >= m_cqEntries
+					   || tail - std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire) >= m_sqEntries) {
+					std::atomic_ref<unsigned>(*m_sqTail).store(tail, std::memory_order_release);
+					Enter(tail);
+					std::this_thread::yield();
+				}
+
+				const IoRequest* request = requests[i];
+				unsigned index = tail & m_sqMask;
+				io_uring_sqe& sqe = m_sqes[index];
+				std::memset(&sqe, 0, sizeof(sqe));
+				if (request) {
+					sqe.opcode = request->operation == eIoOperation::READ ? IORING_OP_READV : IORING_OP_WRITEV;
+					sqe.fd = int(request->fileHandle);
+					sqe.off = request->offset;
+					sqe.addr = reinterpret_cast<uintptr_t>(request->buffers);
+					sqe.len = request->bufferCount;
+				}
+				else {
+					sqe.opcode = IORING_OP_NOP;
+				}
+				sqe.user_data = reinterpret_cast<uintptr_t>(request);
+				m_sqArray[index] = index;
+				m_inFlight.fetch_add(1, std::memory_order_relaxed);
+				++tail;
+			}
+
+			// The whole batch goes to the kernel with a single system call.
+			std::atomic_ref<unsigned>(*m_sqTail).store(tail, std::memory_order_release);
+			Enter(tail);
+		}
+
+	private:
+		UringBackend() = default;
+
+		bool Setup(unsigned entries) {
+			io_uring_params params = {};
+			m_ringFd = int(syscall(__NR_io_uring_setup, entries, &params));
+			if (m_ringFd < 0) {
+				return false;
+			}
+
+			m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (singleMap) {
+				m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+			}
+
+			void* sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+			if (sqRing == MAP_FAILED) {
+				return false;
+			}
+			m_sqRing = sqRing;
+			if (singleMap) {
+				m_cqRing = m_sqRing;
+			}
+			else {
+				void* cqRing = mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+				if (cqRing == MAP_FAILED) {
+					return false;
+				}
+				m_cqRing = cqRing;
+			}
+			m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			void* sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+			if (sqes == MAP_FAILED) {
+				return false;
+			}
+			m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+			auto sqBase = static_cast<char*>(m_sqRing);
+			m_sqHead = reinterpret_cast<unsigned*>(sqBase + params.sq_off.head);
+			m_sqTail = reinterpret_cast<unsigned*>(sqBase + params.sq_off.tail);
+			m_sqMask = *reinterpret_cast<unsigned*>(sqBase + params.sq_off.ring_mask);
+			m_sqArray = reinterpret_cast<unsigned*>(sqBase + params.sq_off.array);
+			m_sqEntries = params.sq_entries;
+
+			auto cqBase = static_cast<char*>(m_cqRing);
+			m_cqHead = reinterpret_cast<unsigned*>(cqBase + params.cq_off.head);
+			m_cqTail = reinterpret_cast<unsigned*>(cqBase + params.cq_off.tail);
+			m_cqMask = *reinterpret_cast<unsigned*>(cqBase + params.cq_off.ring_mask);
+			m_cqes = reinterpret_cast<io_uring_cqe*>(cqBase + params.cq_off.cqes);
+			m_cqEntries = params.cq_entries;
+
+			return true;
+		}
+
+		// Hands all entries up to tail over to the kernel.
+		void Enter(unsigned tail) {
+			unsigned pending = tail - std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire);
+			while (pending > 0) {
+				int result = int(syscall(__NR_io_uring_enter, m_ringFd, pending, 0, 0, nullptr, 0));
+				if (result >= 0) {
+					pending -= std::min(pending, unsigned(result));
+				}
+				else if (errno == EAGAIN || errno == EBUSY) {
+					// The kernel is out of resources or wants completions reaped first. The completion thread
+					// keeps reaping, so retry: if this was the last batch, nothing else would submit the entries.
+					std::this_thread::yield();
+				}
+				else if (errno != EINTR) {
+					break;
+				}
+			}
+		}
+
+		void CompletionThreadFunc() {
+			bool stopSeen = false;
+			while (!stopSeen) {
+				unsigned head = *m_cqHead;
+				unsigned tail = std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire);
+				if (head == tail) {
+					syscall(__NR_io_uring_enter, m_ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+					continue;
+				}
+				for (; head != tail; ++head) {
+					const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+					IoRequest* request = reinterpret_cast<IoRequest*>(uintptr_t(cqe.user_data));
+					int result = cqe.res;
+					// Release the entry before resuming anything, the resumed coroutine might run for long.
+					std::atomic_ref<unsigned>(*m_cqHead).store(head + 1, std::memory_order_release);
+					m_inFlight.fetch_sub(1, std::memory_order_release);
+					if (request) {
+						request->result = result;
+						CompleteRequest(request);
+					}
+					else {
+						stopSeen = true;
+					}
+				}
+			}
+		}
+
+	private:
+		int m_ringFd = -1;
+		void* m_sqRing = nullptr;
+		void* m_cqRing = nullptr;
+		size_t m_sqRingSize = 0;
+		size_t m_cqRingSize = 0;
+		size_t m_sqesSize = 0;
+
+		unsigned* m_sqHead = nullptr;
+		unsigned* m_sqTail = nullptr;
+		unsigned* m_sqArray = nullptr;
+		unsigned m_sqMask = 0;
+		unsigned m_sqEntries = 0;
+		io_uring_sqe* m_sqes = nullptr;
+
+		unsigned* m_cqHead = nullptr;
+		unsigned* m_cqTail = nullptr;
+		unsigned m_cqMask = 0;
+		unsigned m_cqEntries = 0;
+		io_uring_cqe* m_cqes = nullptr;
+
+		std::mutex m_submitMtx;
+		std::atomic_uint m_inFlight = 0;
+		std::thread m_completionThread;
+	};
+#endif
+
+} // namespace impl
+
+
+//------------------------------------------------------------------------------
+// IoService.
+//------------------------------------------------------------------------------
+
+IoService::IoService(eIoBackend backend, int threadCount) {
+#ifdef __linux__
+	if (backend == eIoBackend::AUTOMATIC || backend == eIoBackend::IO_URING) {
+		m_backend = impl::UringBackend::Create(256);
+		m_backendType = eIoBackend::IO_URING;
+	}
+#endif
+	if (!m_backend && backend == eIoBackend::IO_URING) {
+		throw NotSupportedException(nullptr, "io_uring is not available.");
+	}
+	if (!m_backend) {
+		m_backend = std::make_unique<impl::ThreadPoolBackend>(threadCount);
+		m_backendType = eIoBackend::THREAD_POOL;
+	}
+}
+
+
+IoService::~IoService() = default;
+
+
+eIoBackend IoService::GetBackend() const noexcept {
+	return m_backendType;
+}
+
+
+void IoService::Submit(impl::IoRequest* const* requests, size_t count) {
+	m_backend->Submit(requests, count);
+}
+
+
+IoService& IoService::Default() {
+	static IoService service;
+	return service;
+}
+
+
+//------------------------------------------------------------------------------
+// AsyncFile.
+//------------------------------------------------------------------------------
+
+AsyncFile::AsyncFile(IoService& service) noexcept
+	: m_service(&service), m_handle(invalidHandle) {}
+
+
+AsyncFile::AsyncFile(const std::string& path, eFileAccess access, IoService& service)
+	: AsyncFile(service) {
+	Open(path, access);
+}
+
+
+AsyncFile::AsyncFile(AsyncFile&& rhs) noexcept
+	: m_service(rhs.m_service), m_handle(rhs.m_handle) {
+	rhs.m_handle = invalidHandle;
+}
+
+
+AsyncFile& AsyncFile::operator=(AsyncFile&& rhs) noexcept {
+	if (this != &rhs) {
+		Close();
+		m_service = rhs.m_service;
+		m_handle = rhs.m_handle;
+		rhs.m_handle = invalidHandle;
+	}
+	return *this;
+}
+
+
+AsyncFile::~AsyncFile() {
+	Close();
+}
+
+
+void AsyncFile::Open(const std::string& path, eFileAccess access) {
+	Close();
+	m_handle = OpenFile(path, access);
+}
+
+
+void AsyncFile::Close() noexcept {
+	if (m_handle != invalidHandle) {
+		CloseFile(m_handle);
+		m_handle = invalidHandle;
+	}
+}
+
+
+bool AsyncFile::IsOpen() const noexcept {
+	return m_handle != invalidHandle;
+}
+
+
+uint64_t AsyncFile::Size() const {
+	CheckOpen();
+	return FileSize(m_handle);
+}
+
+
+auto AsyncFile::Read(uint64_t offset, std::span<std::byte> buffer) -> IoAwaiter {
+	CheckOpen();
+	IoBuffer ioBuffer{ buffer.data(), buffer.size() };
+	return IoAwaiter(*m_service, impl::eIoOperation::READ, m_handle, offset, &ioBuffer, 1);
+}
+
+
+auto AsyncFile::Write(uint64_t offset, std::span<const std::byte> data) -> IoAwaiter {
+	CheckOpen();
+	IoBuffer ioBuffer{ const_cast<std::byte*>(data.data()), data.size() };
+	return IoAwaiter(*m_service, impl::eIoOperation::WRITE, m_handle, offset, &ioBuffer, 1);
+}
+
+
+auto AsyncFile::ReadScatter(uint64_t offset, std::span<const std::span<std::byte>> buffers) -> IoAwaiter {
+	CheckOpen();
+	std::vector<IoBuffer> ioBuffers;
+	ioBuffers.reserve(buffers.size());
+	for (auto& buffer : buffers) {
+		ioBuffers.push_back({ buffer.data(), buffer.size() });
+	}
+	return IoAwaiter(*m_service, impl::eIoOperation::READ, m_handle, offset, ioBuffers.data(), ioBuffers.size());
+}
+
+
+auto AsyncFile::WriteGather(uint64_t offset, std::span<const std::span<const std::byte>> buffers) -> IoAwaiter {
+	CheckOpen();
+	std::vector<IoBuffer> ioBuffers;
+	ioBuffers.reserve(buffers.size());
+	for (auto& buffer : buffers) {
+		ioBuffers.push_back({ const_cast<std::byte*>(buffer.data()), buffer.size() });
+	}
+	return IoAwaiter(*m_service, impl::eIoOperation::WRITE, m_handle, offset, ioBuffers.data(), ioBuffers.size());
+}
+
+
+void AsyncFile::CheckOpen() const {
+	if (!IsOpen()) {
+		throw InvalidStateException(nullptr, "File is not open.");
+	}
+}
+
+
+AsyncFile::IoAwaiter::IoAwaiter(IoService& service, impl::eIoOperation operation, intptr_t fileHandle, uint64_t offset, const IoBuffer* buffers, size_t count)
+	: m_service(service) {
+	m_request.operation = operation;
+	m_request.fileHandle = fileHandle;
+	m_request.offset = offset;
+	m_request.bufferCount = unsigned(count);
+	m_request.result = 0;
+	if (count == 1) {
+		m_singleBuffer = buffers[0];
+	}
+	else {
+		m_buffers.assign(buffers, buffers + count);
+	}
+}
+
+
+bool AsyncFile::IoAwaiter::await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler) {
+	// Pointers are only set up now, when the awaiter has its final place in the coroutine frame.
+	m_completion.remaining = 1;
+	m_completion.handle = awaitingCoroutine;
+	m_completion.scheduler = scheduler;
+	m_request.completion = &m_completion;
+	m_request.buffers = m_request.bufferCount == 1 ? &m_singleBuffer : m_buffers.data();
+
+	impl::IoRequest* request = &m_request;
+	m_service.Submit(&request, 1);
+	return true;
+}
+
+
+size_t AsyncFile::IoAwaiter::await_resume() {
+	return impl::GetRequestResult(m_request);
+}
+
+
+//------------------------------------------------------------------------------
+// IoBatch.
+//------------------------------------------------------------------------------
+
+IoBatch::IoBatch(IoService& service) noexcept
+	: m_service(&service) {}
+
+
+size_t IoBatch::Read(const AsyncFile& file, uint64_t offset, std::span<std::byte> buffer) {
+	return Add(file, impl::eIoOperation::READ, offset, buffer.data(), buffer.size());
+}
+
+
+size_t IoBatch::Write(const AsyncFile& file, uint64_t offset, std::span<const std::byte> data) {
+	return Add(file, impl::eIoOperation::WRITE, offset, const_cast<std::byte*>(data.data()), data.size());
+}
+
+
+auto IoBatch::Submit() noexcept -> SubmitAwaiter {
+	return SubmitAwaiter(*this);
+}
+
+
+size_t IoBatch::GetResult(size_t index) const {
+	if (index >= m_requests.size()) {
+		throw OutOfRangeException(nullptr, "No operation with given index.");
+	}
+	return impl::GetRequestResult(m_requests[index]);
+}
+
+
+void IoBatch::Clear() noexcept {
+	m_requests.clear();
+	m_buffers.clear();
+	m_submitList.clear();
+}
+
+
+size_t IoBatch::Add(const AsyncFile& file, impl::eIoOperation operation, uint64_t offset, void* data, size_t size) {
+	if (&file.GetService() != m_service) {
+		throw InvalidArgumentException(nullptr, "File belongs to a different IoService.");
+	}
+	if (!file.IsOpen()) {
+		throw InvalidStateException(nullptr, "File is not open.");
+	}
+	impl::IoRequest request;
+	request.operation = operation;
+	request.fileHandle = file.GetNativeHandle();
+	request.offset = offset;
+	request.buffers = nullptr;
+	request.bufferCount = 1;
+	request.result = 0;
+	request.completion = &m_completion;
+	m_requests.push_back(request);
+	m_buffers.push_back({ data, size });
+	return m_requests.size() - 1;
+}
+
+
+bool IoBatch::SubmitAwaiter::await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler) {
+	auto& batch = m_batch;
+	batch.m_completion.remaining = batch.m_requests.size();
+	batch.m_completion.handle = awaitingCoroutine;
+	batch.m_completion.scheduler = scheduler;
+
+	batch.m_submitList.clear();
+	for (size_t i = 0; i < batch.m_requests.size(); ++i) {
+		batch.m_requests[i].buffers = &batch.m_buffers[i];
+		batch.m_submitList.push_back(&batch.m_requests[i]);
+	}
+	batch.m_service->Submit(batch.m_submitList.data(), batch.m_submitList.size());
+	return true;
+}
+
+
+void IoBatch::SubmitAwaiter::await_resume() const {
+	for (auto& request : m_batch.m_requests) {
+		impl::GetRequestResult(request);
+	}
+}
+
+
+} // namespace inl::jobs
@@ -7,32 +7,27 @@
 namespace inl::jobs {
 
 
-ConditionVariable::CvarAwaiter::CvarAwaiter(CvarAwaiter&& rhs)
-	: m_mtx(rhs.m_mtx),
+ConditionVariable::CvarAwaiter::CvarAwaiter(const ConditionVariable& cvar, UniqueLock& lock) noexcept
+	: m_cvar(cvar),
+	  m_lock(lock),
+	  m_mutexAwaiter(lock.m_mutex.Lock()) {}
+
+
+ConditionVariable::CvarAwaiter::CvarAwaiter(CvarAwaiter&& rhs) noexcept
+	: m_next(rhs.m_next),
 	  m_cvar(rhs.m_cvar),
-	  m_pred(std::move(rhs.m_pred)),
-	  m_next(rhs.m_next),
-	  m_awaitingHandle(std::move(rhs.m_awaitingHandle)),
-	  m_mutexAwaiter(std::move(rhs.m_mutexAwaiter)),
-	  m_scheduler(rhs.m_scheduler) {
-	rhs.m_awaitingHandle = {};
+	  m_lock(rhs.m_lock),
+	  m_mutexAwaiter(std::move(rhs.m_mutexAwaiter)) {
 	rhs.m_next = nullptr;
-	rhs.m_scheduler = nullptr;
-}
-
-bool ConditionVariable::CvarAwaiter::await_ready() const noexcept {
-	// Note that predicate does not need to be checked in await_suspend because it's protected by the mutex.
-	if (m_pred) {
-		return m_pred();
-	}
-	return false;
 }
 
 
 bool ConditionVariable::CvarAwaiter::await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler) noexcept {
 	// Coroutine is suspended.
-	m_awaitingHandle = awaitingCoroutine;
-	m_scheduler = scheduler;
+	// The mutex awaiter is never awaited directly, it's handed to the mutex's queue by the notifier.
+	m_mutexAwaiter.m_awaitingHandle = awaitingCoroutine;
+	m_mutexAwaiter.m_scheduler = scheduler;
+	m_mutexAwaiter.m_wasAwaited = true;
 
 	// Add this to the waiting list.
 	bool success;
@@ -43,7 +38,8 @@ bool ConditionVariable::CvarAwaiter::await_suspend(std::experimental::coroutine_
 	} while (!success);
 
 	// Accessing *this is safe as coro cannot be continued while the mutex is being held.
-	m_mtx.Unlock();
+	// The lock stays marked as locked, the mutex will be reacquired before the coro continues.
+	m_lock.m_mutex.Unlock();
 
 	// *this is unsafe to access from here on, it might have been destroyed on another thread.
 
@@ -69,24 +65,16 @@ void ConditionVariable::WaitExplicit(UniqueLock& lock) {
 }
 
 
-void ConditionVariable::AwakeAwaiter(CvarAwaiter* last) {
-	last->m_mutexAwaiter.emplace(last->m_mtx.Lock());
-
-	bool isReady = last->m_mutexAwaiter->await_ready();
-	bool isSuspended = true;
-	if (!isReady) {
-		// Hack it into the mutex's awake queue if mutex could not be acquired immediately.
-		isSuspended = last->m_mutexAwaiter->await_suspend(last->m_awaitingHandle, last->m_scheduler);
-	}
-	if (isReady || !isSuspended) {
-		// Resume coroutine if mutex has been acquired immediately.
-		if (last->m_scheduler) {
-			last->m_scheduler->Resume(last->m_awaitingHandle);
-		}
-		else {
-			last->m_awaitingHandle.resume();
-		}
+void ConditionVariable::AwakeAwaiters(CvarAwaiter* first, CvarAwaiter* last) {
+	// Relink the mutex awaiters in the same order. All of them must belong to the same mutex.
+	Mutex& mutex = first->m_lock.m_mutex;
+	for (CvarAwaiter* iter = first; iter != last; iter = iter->m_next) {
+		iter->m_mutexAwaiter.m_next = &iter->m_next->m_mutexAwaiter;
 	}
+
+	// Wait morphing: instead of waking them all up to fight for the mutex, they are queued
+	// on the mutex directly, and are only resumed by Unlock one by one.
+	mutex.EnqueueAwaiters(&first->m_mutexAwaiter, &last->m_mutexAwaiter);
 }
 
 void ConditionVariable::NotifyOne() {
@@ -115,7 +103,7 @@ void ConditionVariable::NotifyOne() {
 	}
 
 	// Awake the last item:
-	AwakeAwaiter(last);
+	AwakeAwaiters(last, last);
 }
 
 
@@ -127,15 +115,18 @@ void ConditionVariable::NotifyAll() {
 		return;
 	}
 
-	// Iterate over the whole list.
-	CvarAwaiter* iter = waitingList;
-	while (iter) {
-		CvarAwaiter* next = iter->m_next;
-
-		// Awake the item:
-		AwakeAwaiter(iter);
-
-		iter = next;
+	// Split the list into runs that wait on the same mutex, and hand over each run at once.
+	// Usually there is only one mutex, so the whole list goes in one step.
+	CvarAwaiter* runFirst = waitingList;
+	CvarAwaiter* runLast = waitingList;
+	while (runLast) {
+		CvarAwaiter* next = runLast->m_next;
+		if (next == nullptr || &next->m_lock.m_mutex != &runLast->m_lock.m_mutex) {
+			// Items of the run are unsafe to access once handed over.
+			AwakeAwaiters(runFirst, runLast);
+			runFirst = next;
+		}
+		runLast = next;
 	}
 }
 
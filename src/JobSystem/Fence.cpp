@@ -112,9 +112,10 @@ void Fence::Signal(uint64_t value) {
 			// Put remaining in list back.
 			while (list != nullptr) {
 				++putback;
+				FenceAwaiter* next = list->m_next;
 				list->m_next = m_firstAwaiter;
 				m_firstAwaiter = list;
-				list = list->m_next;
+				list = next;
 			}
 			return;
 		}
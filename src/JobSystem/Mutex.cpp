@@ -38,13 +38,9 @@ bool Mutex::MutexAwaiter::await_ready() const noexcept {
 	}
 	m_wasAwaited = true;
 
-	// Null in awaiter list means the mutex is free, so try to lock it.
-	MutexAwaiter* expected = nullptr;
-	bool success = m_mtx.m_firstAwaiter.compare_exchange_strong(expected, const_cast<MutexAwaiter*>(this));
-	if (success) {
-		m_mtx.m_holder = const_cast<MutexAwaiter*>(this);
-	}
-	return success;
+	// Try to lock it if the mutex is free.
+	MutexAwaiter* expected = notLockedTag;
+	return m_mtx.m_state.compare_exchange_strong(expected, nullptr);
 }
 
 
@@ -56,25 +52,23 @@ bool Mutex::MutexAwaiter::await_suspend(std::experimental::coroutine_handle<> aw
 	m_awaitingHandle = awaitingCoroutine;
 	m_scheduler = scheduler;
 
-	// Add this to the waiting list.
-	bool success;
-	MutexAwaiter* first;
-	do {
-		first = m_mtx.m_firstAwaiter;
-		m_next = first;
-		success = m_mtx.m_firstAwaiter.compare_exchange_weak(first, this);
-	} while (!success);
-
-	// If first is null, nobody was owning the mutex previously.
-	// In this case, no Unlock should start running this coro, so accessing *this is safe.
-	if (first == nullptr) {
-		// We locked the mutex and don't want to suspend the coro.
-		// Unlock() will remove this from the queue.
-		m_mtx.m_holder = const_cast<MutexAwaiter*>(this);
-		return false;
+	// Add this to the arrivals, unless the mutex has been released meanwhile.
+	MutexAwaiter* state = m_mtx.m_state;
+	while (true) {
+		if (state == notLockedTag) {
+			// We locked the mutex and don't want to suspend the coro.
+			if (m_mtx.m_state.compare_exchange_weak(state, nullptr)) {
+				return false;
+			}
+		}
+		else {
+			m_next = state;
+			if (m_mtx.m_state.compare_exchange_weak(state, this)) {
+				// *this is unsafe to access from here on, Unlock might have resumed it on another thread.
+				return true;
+			}
+		}
 	}
-
-	return true;
 }
 
 
@@ -83,14 +77,14 @@ bool Mutex::MutexAwaiter::await_suspend(std::experimental::coroutine_handle<> aw
 // Mutex
 //------------------------------------------------------------------------------
 
-Mutex::Mutex() noexcept {
-	m_firstAwaiter = nullptr;
-	m_holder = nullptr;
+Mutex::Mutex(eMutexPolicy policy, unsigned maxBarges) noexcept
+	: m_policy(policy), m_maxBarges(maxBarges) {
+	m_state = notLockedTag;
 }
 
 
 Mutex::~Mutex() {
-	if (m_firstAwaiter != nullptr) {
+	if (m_state != notLockedTag) {
 		std::terminate(); // Mutex cannot be destroyed before being unlocked.
 	}
 }
@@ -106,64 +100,110 @@ void Mutex::LockExplicit() {
 
 
 bool Mutex::TryLock() {
-	// Null in awaiter list means the mutex is free, so try to lock it.
-	MutexAwaiter* expected = nullptr;
-	bool success = m_firstAwaiter.compare_exchange_strong(expected, tryLockTag);
-	if (success) {
-		m_holder = tryLockTag;
-	}
-	return success;
+	MutexAwaiter* expected = notLockedTag;
+	return m_state.compare_exchange_strong(expected, nullptr);
 }
 
 
 void Mutex::Unlock() {
-	// Peek into the list.
-	MutexAwaiter* list = m_firstAwaiter;
-	assert(list != nullptr); // Null means no one is owning the lock, thus no one should call unlock.
-
-	// Iterate to the end of list to find the last and before last elements.
-	MutexAwaiter *prev = nullptr, *last = list;
-	while (last != m_holder) {
-		prev = last;
-		last = last->m_next;
-	}
-
-	// Remove last from the chain and awake prev.
-	if (prev) {
-		m_holder = prev;
-		prev->m_next = nullptr;
-		if (prev->m_scheduler) {
-			prev->m_scheduler->Resume(prev->m_awaitingHandle);
+	assert(m_state != notLockedTag); // No one is owning the lock, thus no one should call unlock.
+
+	// Ownership is handed over directly, the next owner needs no further synchronization.
+	MutexAwaiter* next = PopWaiter();
+	if (next) {
+		ResumeAwaiter(next);
+	}
+}
+
+
+void Mutex::EnqueueAwaiters(MutexAwaiter* first, MutexAwaiter* last) noexcept {
+	// Push the whole chain on the arrivals, same as a single awaiter would be pushed.
+	MutexAwaiter* state = m_state;
+	while (true) {
+		if (state == notLockedTag) {
+			// Pushing onto a free mutex locks it, so we act as the holder and pass it on right away.
+			last->m_next = nullptr;
+			if (m_state.compare_exchange_weak(state, first)) {
+				Unlock();
+				return;
+			}
 		}
 		else {
-			prev->m_awaitingHandle.resume();
+			last->m_next = state;
+			if (m_state.compare_exchange_weak(state, first)) {
+				return;
+			}
 		}
 	}
-	// If there was no previous, somebody might have added one since we obtained the list.
-	else {
-		MutexAwaiter* expected = last;
-		bool success = m_firstAwaiter.compare_exchange_strong(expected, nullptr);
-		if (!success) {
-			// Go to the end of expected, and remove last item.
-			prev = nullptr;
-			last = expected;
-			while (last != m_holder) {
-				prev = last;
-				last = last->m_next;
-			}
-			assert(prev != nullptr); // There must be at least 2 elements in there.
-			prev->m_next = nullptr;
+}
 
-			// Awake that prev.
-			m_holder = prev;
-			if (prev->m_scheduler) {
-				prev->m_scheduler->Resume(prev->m_awaitingHandle);
-			}
-			else {
-				prev->m_awaitingHandle.resume();
+
+Mutex::MutexAwaiter* Mutex::PopWaiter() noexcept {
+	// Let the newest arrival overtake the queue unless we've done that too many times in a row.
+	if (m_policy == eMutexPolicy::BARGING && m_barges < m_maxBarges) {
+		MutexAwaiter* arrivals = m_state;
+		if (arrivals != nullptr) {
+			arrivals = m_state.exchange(nullptr);
+			AppendToQueue(arrivals->m_next);
+			if (m_waitersFirst) {
+				++m_barges;
 			}
+			return arrivals;
 		}
 	}
+
+	// Refill the queue from the arrivals, or release the mutex if there are none.
+	if (!m_waitersFirst) {
+		MutexAwaiter* expected = nullptr;
+		if (m_state.compare_exchange_strong(expected, notLockedTag)) {
+			return nullptr;
+		}
+		AppendToQueue(m_state.exchange(nullptr));
+	}
+
+	// Serve the oldest waiter.
+	MutexAwaiter* oldest = m_waitersFirst;
+	m_waitersFirst = oldest->m_next;
+	if (!m_waitersFirst) {
+		m_waitersLast = nullptr;
+	}
+	m_barges = 0;
+	return oldest;
+}
+
+
+void Mutex::AppendToQueue(MutexAwaiter* arrivals) noexcept {
+	if (!arrivals) {
+		return;
+	}
+
+	// Arrivals are newest first, reverse them.
+	MutexAwaiter* reversedFirst = nullptr;
+	MutexAwaiter* reversedLast = arrivals;
+	while (arrivals) {
+		MutexAwaiter* next = arrivals->m_next;
+		arrivals->m_next = reversedFirst;
+		reversedFirst = arrivals;
+		arrivals = next;
+	}
+
+	if (m_waitersLast) {
+		m_waitersLast->m_next = reversedFirst;
+	}
+	else {
+		m_waitersFirst = reversedFirst;
+	}
+	m_waitersLast = reversedLast;
+}
+
+
+void Mutex::ResumeAwaiter(MutexAwaiter* awaiter) noexcept {
+	if (awaiter->m_scheduler) {
+		awaiter->m_scheduler->Resume(awaiter->m_awaitingHandle);
+	}
+	else {
+		awaiter->m_awaitingHandle.resume();
+	}
 }
 
 
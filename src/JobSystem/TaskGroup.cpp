@@ -0,0 +1,90 @@
+#include <InlineLib/JobSystem/TaskGroup.hpp>
+
+
+namespace inl::jobs {
+
+
+bool TaskGroup::JoinAwaiter::await_ready() const noexcept {
+	return m_group.m_outstanding == 1;
+}
+
+
+bool TaskGroup::JoinAwaiter::await_suspend(std::experimental::coroutine_handle<> awaitingCoroutine, Scheduler* scheduler) noexcept {
+	m_group.m_joiningHandle = awaitingCoroutine;
+	m_group.m_joiningScheduler = scheduler;
+
+	// Release the joiner's reference. If it was the last, all children are done and there is no need to suspend.
+	// Otherwise the last child resumes the coro, *this is unsafe to access from here on.
+	return m_group.m_outstanding.fetch_sub(1) != 1;
+}
+
+
+void TaskGroup::JoinAwaiter::await_resume() {
+	// All children are done, the group can be reset for reuse.
+	m_group.m_outstanding = 1;
+	m_group.m_joiningHandle = {};
+	m_group.m_joiningScheduler = nullptr;
+	m_group.m_cancelled = false;
+
+	if (m_group.m_exception) {
+		std::exception_ptr ex = std::move(m_group.m_exception);
+		m_group.m_exception = nullptr;
+		m_group.m_hasException.clear();
+		std::rethrow_exception(ex);
+	}
+}
+
+
+TaskGroup::TaskGroup(bool cancelOnFailure) noexcept
+	: m_outstanding(1), m_cancelled(false), m_cancelOnFailure(cancelOnFailure) {
+	m_hasException.clear();
+}
+
+
+TaskGroup::~TaskGroup() {
+	if (m_outstanding != 1) {
+		std::terminate(); // TaskGroup must be joined before being destroyed.
+	}
+}
+
+
+TaskGroup::JoinAwaiter TaskGroup::Join() noexcept {
+	return JoinAwaiter{ *this };
+}
+
+
+void TaskGroup::Cancel() noexcept {
+	m_cancelled = true;
+}
+
+
+bool TaskGroup::IsCancelled() const noexcept {
+	return m_cancelled;
+}
+
+
+void TaskGroup::OnChildFinished() noexcept {
+	// Last one out resumes the joiner, which has already released its reference.
+	if (m_outstanding.fetch_sub(1) == 1) {
+		if (m_joiningScheduler) {
+			m_joiningScheduler->Resume(m_joiningHandle);
+		}
+		else {
+			m_joiningHandle.resume();
+		}
+	}
+}
+
+
+void TaskGroup::SetException(std::exception_ptr ex) noexcept {
+	// Only the first one is kept.
+	if (!m_hasException.test_and_set()) {
+		m_exception = std::move(ex);
+	}
+	if (m_cancelOnFailure) {
+		Cancel();
+	}
+}
+
+
+} // namespace inl::jobs
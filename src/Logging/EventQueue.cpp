@@ -0,0 +1,171 @@
+#include <InlineLib/Logging/EventQueue.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <bit>
+#include <new>
+#include <thread>
+
+
+namespace inl {
+
+
+EventQueue::EventQueue(size_t capacity, eLogOverflowPolicy policy, std::pmr::memory_resource* resource)
+	: m_policy(policy), m_resource(resource) {
+	if (capacity == 0) {
+		throw InvalidArgumentException("Event queue capacity must be at least one.");
+	}
+	m_pushSegment = m_popSegment = NewSegment(std::bit_ceil(capacity));
+}
+
+
+EventQueue::~EventQueue() {
+	while (m_popSegment) {
+		while (TryPop(*m_popSegment, nullptr)) {
+		}
+		Segment* next = m_popSegment->next.load(std::memory_order_acquire);
+		DeleteSegment(m_popSegment);
+		m_popSegment = next;
+	}
+}
+
+
+bool EventQueue::TryPush(EventEntry& entry) {
+	while (!TryPush(*m_pushSegment, entry)) {
+		switch (m_policy) {
+			case eLogOverflowPolicy::BLOCK:
+				return false;
+			case eLogOverflowPolicy::DROP_NEWEST:
+				m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+				return true;
+			case eLogOverflowPolicy::DROP_OLDEST:
+				// There is only one segment unless growing, so the push segment is the pop segment.
+				if (TryPop(*m_pushSegment, nullptr)) {
+					m_popCount.fetch_add(1, std::memory_order_relaxed);
+					m_droppedCount.fetch_add(1, std::memory_order_relaxed);
+				}
+				break;
+			case eLogOverflowPolicy::GROW: {
+				Segment* next = NewSegment(2 * (m_pushSegment->mask + 1));
+				m_pushSegment->next.store(next, std::memory_order_release);
+				m_pushSegment = next;
+				break;
+			}
+		}
+	}
+	m_pushCount.store(m_pushCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	return true;
+}
+
+
+bool EventQueue::TryPop(EventEntry& entry) {
+	while (true) {
+		if (TryPop(*m_popSegment, &entry)) {
+			m_popCount.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		Segment* next = m_popSegment->next.load(std::memory_order_acquire);
+		if (!next) {
+			return false;
+		}
+		// The producer finished with this segment before linking the next, but the last
+		// events may have been pushed after the failed pop above.
+		if (TryPop(*m_popSegment, &entry)) {
+			m_popCount.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+		DeleteSegment(m_popSegment);
+		m_popSegment = next;
+	}
+}
+
+
+size_t EventQueue::Size() const {
+	uint64_t popped = m_popCount.load(std::memory_order_relaxed);
+	uint64_t pushed = m_pushCount.load(std::memory_order_relaxed);
+	return pushed > popped ? size_t(pushed - popped) : 0;
+}
+
+
+uint64_t EventQueue::GetDroppedCount() const {
+	return m_droppedCount.load(std::memory_order_relaxed);
+}
+
+
+EventQueue::Segment* EventQueue::NewSegment(size_t capacity) {
+	auto slots = static_cast<Slot*>(m_resource->allocate(capacity * sizeof(Slot), alignof(Slot)));
+	for (size_t i = 0; i < capacity; ++i) {
+		new (&slots[i]) Slot;
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+	try {
+		auto segment = new (m_resource->allocate(sizeof(Segment), alignof(Segment))) Segment;
+		segment->slots = slots;
+		segment->mask = capacity - 1;
+		return segment;
+	}
+	catch (...) {
+		m_resource->deallocate(slots, capacity * sizeof(Slot), alignof(Slot));
+		throw;
+	}
+}
+
+
+void EventQueue::DeleteSegment(Segment* segment) {
+	size_t capacity = segment->mask + 1;
+	m_resource->deallocate(segment->slots, capacity * sizeof(Slot), alignof(Slot));
+	segment->~Segment();
+	m_resource->deallocate(segment, sizeof(Segment), alignof(Segment));
+}
+
+
+bool EventQueue::TryPush(Segment& segment, EventEntry& entry) {
+	size_t position = segment.pushPosition;
+	Slot& slot = segment.slots[position & segment.mask];
+	size_t sequence = slot.sequence.load(std::memory_order_acquire);
+	if (sequence != position) {
+		// The slot still holds the event from the previous round. If that one has been claimed by a pop,
+		// the slot is being read and will be free in a moment. Otherwise the segment is full.
+		size_t capacity = segment.mask + 1;
+		if (segment.popPosition.load(std::memory_order_relaxed) <= position - capacity) {
+			return false;
+		}
+		while ((sequence = slot.sequence.load(std::memory_order_acquire)) != position) {
+			std::this_thread::yield();
+		}
+	}
+	new (slot.storage) EventEntry(std::move(entry));
+	slot.sequence.store(position + 1, std::memory_order_release);
+	segment.pushPosition = position + 1;
+	return true;
+}
+
+
+bool EventQueue::TryPop(Segment& segment, EventEntry* entry) {
+	size_t position = segment.popPosition.load(std::memory_order_relaxed);
+	while (true) {
+		Slot& slot = segment.slots[position & segment.mask];
+		size_t sequence = slot.sequence.load(std::memory_order_acquire);
+		ptrdiff_t difference = ptrdiff_t(sequence) - ptrdiff_t(position + 1);
+		if (difference == 0) {
+			if (segment.popPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+				auto stored = std::launder(reinterpret_cast<EventEntry*>(slot.storage));
+				if (entry) {
+					*entry = std::move(*stored);
+				}
+				stored->~EventEntry();
+				slot.sequence.store(position + segment.mask + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (difference < 0) {
+			return false;
+		}
+		else {
+			position = segment.popPosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+
+} // namespace inl
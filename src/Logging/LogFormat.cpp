@@ -0,0 +1,359 @@
+#include <InlineLib/Logging/LogFormat.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <bit>
+#include <charconv>
+#include <limits>
+#include <numeric>
+
+
+namespace inl {
+
+
+namespace {
+	constexpr const char* BinaryLogHeader = "InlineLib binary log 1\n";
+	constexpr size_t WriteBatchSize = 64 * 1024;
+
+	// Sanity limits for the decoder, so that a corrupt length doesn't make it allocate the world.
+	constexpr uint64_t MaxStreamId = uint64_t(1) << 24;
+	constexpr uint64_t MaxParameterCount = uint64_t(1) << 16;
+	constexpr uint64_t MaxByteCount = uint64_t(1) << 30;
+
+	enum class eRecord : uint8_t {
+		STRING = 1,
+		STREAM = 2,
+		EVENT = 3,
+	};
+
+
+	void AppendVarint(std::string& buffer, uint64_t value) {
+		while (value >= 0x80) {
+			buffer += char(uint8_t(value) | 0x80);
+			value >>= 7;
+		}
+		buffer += char(uint8_t(value));
+	}
+
+	void AppendZigZag(std::string& buffer, int64_t value) {
+		AppendVarint(buffer, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+	}
+
+	void AppendBytes(std::string& buffer, const void* data, size_t size) {
+		AppendVarint(buffer, size);
+		buffer.append(static_cast<const char*>(data), size);
+	}
+
+	void AppendStringRef(std::string& buffer, uint64_t id, const std::string& str) {
+		AppendVarint(buffer, id);
+		if (id == 0) {
+			AppendBytes(buffer, str.data(), str.size());
+		}
+	}
+
+
+	/// <summary> Parameter of a type the decoder doesn't know, printed as it was when encoded. </summary>
+	struct EventParameterText : public EventParameter {
+		EventParameterText(std::string name, std::string value) : EventParameter(std::move(name)), value(std::move(value)) {}
+		std::string value;
+		std::string ToString() const override { return value; }
+		void AppendValue(std::string& text) const override { text += value; }
+		EventParameter* Clone() const override { return new EventParameterText{ *this }; }
+	};
+
+
+	class BinaryLogReader {
+	public:
+		explicit BinaryLogReader(std::istream& input) : m_buffer(input.rdbuf()) {}
+
+		bool AtEnd() {
+			return m_buffer->sgetc() == std::char_traits<char>::eof();
+		}
+
+		uint8_t Byte() {
+			auto c = m_buffer->sbumpc();
+			if (c == std::char_traits<char>::eof()) {
+				throw InvalidArgumentException("Binary log ends in the middle of a record.");
+			}
+			return uint8_t(c);
+		}
+
+		uint64_t Varint() {
+			uint64_t value = 0;
+			for (int shift = 0; shift < 64; shift += 7) {
+				uint8_t byte = Byte();
+				value |= uint64_t(byte & 0x7F) << shift;
+				if ((byte & 0x80) == 0) {
+					return value;
+				}
+			}
+			throw InvalidArgumentException("Malformed binary log, variable-length integer is too long.");
+		}
+
+		int64_t ZigZag() {
+			uint64_t value = Varint();
+			return int64_t(value >> 1) ^ -int64_t(value & 1);
+		}
+
+		std::string Bytes() {
+			uint64_t size = Varint();
+			if (size > MaxByteCount) {
+				throw InvalidArgumentException("Malformed binary log, string is too long.");
+			}
+			std::string bytes(size, '\0');
+			if (m_buffer->sgetn(bytes.data(), std::streamsize(size)) != std::streamsize(size)) {
+				throw InvalidArgumentException("Binary log ends in the middle of a record.");
+			}
+			return bytes;
+		}
+
+	private:
+		std::streambuf* m_buffer;
+	};
+} // namespace
+
+
+void AppendTextLogEvent(std::string& text, double seconds, const std::string& stream, const LogEvent& evt) {
+	// same as streaming the double with default precision
+	char number[32];
+	auto result = std::to_chars(number, number + sizeof(number), seconds, std::chars_format::general, 6);
+
+	text += '[';
+	text.append(number, result.ptr);
+	text += "][";
+	text += stream;
+	text += "] ";
+	text += evt.GetMessage();
+	text += '\n';
+	for (size_t i = 0; i < evt.GetNumParameters(); i++) {
+		text += "   ";
+		text += evt[i].name;
+		text += " = ";
+		evt[i].AppendValue(text);
+		text += '\n';
+	}
+}
+
+
+void BinaryLogEncoder::Begin(std::string& buffer, std::chrono::high_resolution_clock::time_point startTime) {
+	using Period = std::chrono::high_resolution_clock::period;
+
+	m_stringIds.clear();
+	m_streamsWritten.clear();
+	m_lastTimestamp = int64_t(startTime.time_since_epoch().count());
+
+	buffer += BinaryLogHeader;
+	AppendVarint(buffer, uint64_t(Period::num));
+	AppendVarint(buffer, uint64_t(Period::den));
+	AppendZigZag(buffer, m_lastTimestamp);
+}
+
+
+void BinaryLogEncoder::Encode(std::string& buffer, const EventEntry& entry, const std::vector<std::string>& streamNames) {
+	const LogEvent& evt = entry.event;
+
+	// Records for what is new, before the event refers to it.
+	if (entry.stream >= m_streamsWritten.size()) {
+		m_streamsWritten.resize(entry.stream + 1, false);
+	}
+	if (!m_streamsWritten[entry.stream]) {
+		const std::string& name = streamNames[entry.stream];
+		uint64_t nameId = Intern(buffer, name);
+		buffer += char(eRecord::STREAM);
+		AppendVarint(buffer, entry.stream);
+		AppendStringRef(buffer, nameId, name);
+		m_streamsWritten[entry.stream] = true;
+	}
+	uint64_t messageId = Intern(buffer, evt.GetMessage());
+	m_parameterNameIds.clear();
+	for (size_t i = 0; i < evt.GetNumParameters(); ++i) {
+		m_parameterNameIds.push_back(Intern(buffer, evt[i].name));
+	}
+
+	int64_t timestamp = int64_t(entry.timestamp.time_since_epoch().count());
+	buffer += char(eRecord::EVENT);
+	AppendVarint(buffer, entry.stream);
+	AppendZigZag(buffer, timestamp - m_lastTimestamp);
+	m_lastTimestamp = timestamp;
+	AppendStringRef(buffer, messageId, evt.GetMessage());
+	AppendVarint(buffer, evt.GetNumParameters());
+
+	for (size_t i = 0; i < evt.GetNumParameters(); ++i) {
+		const EventParameter& parameter = evt[i];
+		AppendStringRef(buffer, m_parameterNameIds[i], parameter.name);
+
+		// Types are checked by cast too, Type() may be overridden by user parameters.
+		eEventParameterType type = parameter.Type();
+		auto asFloat = dynamic_cast<const EventParameterFloat*>(&parameter);
+		auto asInt = dynamic_cast<const EventParameterInt*>(&parameter);
+		auto asString = dynamic_cast<const EventParameterString*>(&parameter);
+		auto asRaw = dynamic_cast<const EventParameterRaw*>(&parameter);
+		if (type == eEventParameterType::FLOAT && asFloat) {
+			buffer += char(type);
+			uint32_t bits = std::bit_cast<uint32_t>(asFloat->value);
+			for (int byte = 0; byte < 4; ++byte) {
+				buffer += char(uint8_t(bits >> (8 * byte)));
+			}
+		}
+		else if (type == eEventParameterType::INT && asInt) {
+			buffer += char(type);
+			AppendZigZag(buffer, asInt->value);
+		}
+		else if (type == eEventParameterType::STRING && asString) {
+			buffer += char(type);
+			AppendBytes(buffer, asString->value.data(), asString->value.size());
+		}
+		else if (type == eEventParameterType::RAW && asRaw) {
+			buffer += char(type);
+			AppendBytes(buffer, asRaw->data.data(), asRaw->data.size());
+		}
+		else {
+			std::string value = parameter.ToString();
+			buffer += char(eEventParameterType::DEFAULT);
+			AppendBytes(buffer, value.data(), value.size());
+		}
+	}
+}
+
+
+uint64_t BinaryLogEncoder::Intern(std::string& buffer, const std::string& str) {
+	auto it = m_stringIds.find(str);
+	if (it != m_stringIds.end()) {
+		return it->second;
+	}
+	if (m_stringIds.size() >= MaxStringCount) {
+		return 0;
+	}
+	uint64_t id = m_stringIds.size() + 1;
+	m_stringIds.insert({ str, id });
+	buffer += char(eRecord::STRING);
+	AppendVarint(buffer, id);
+	AppendBytes(buffer, str.data(), str.size());
+	return id;
+}
+
+
+void DecodeBinaryLog(std::istream& input, std::ostream& output) {
+	BinaryLogReader reader(input);
+	for (const char* c = BinaryLogHeader; *c != '\0'; ++c) {
+		if (reader.AtEnd() || reader.Byte() != uint8_t(*c)) {
+			throw InvalidArgumentException("Stream does not contain a binary log.");
+		}
+	}
+
+	// Ticks to microseconds, truncated like duration_cast does.
+	uint64_t periodNum = reader.Varint();
+	uint64_t periodDen = reader.Varint();
+	if (periodNum == 0 || periodDen == 0 || periodNum > std::numeric_limits<uint64_t>::max() / 1000000) {
+		throw InvalidArgumentException("Malformed binary log, invalid clock period.");
+	}
+	uint64_t gcd = std::gcd(periodNum * 1000000, periodDen);
+	int64_t microNum = int64_t((periodNum * 1000000) / gcd);
+	int64_t microDen = int64_t(periodDen / gcd);
+	int64_t startTime = reader.ZigZag();
+	int64_t lastTimestamp = startTime;
+
+	std::vector<std::string> strings;
+	std::vector<std::string> streamNames;
+	std::vector<bool> streamsDefined;
+	auto readStringRef = [&]() -> std::string {
+		uint64_t id = reader.Varint();
+		if (id == 0) {
+			return reader.Bytes();
+		}
+		if (id > strings.size()) {
+			throw InvalidArgumentException("Malformed binary log, reference to an undefined string.");
+		}
+		return strings[id - 1];
+	};
+
+	std::string text;
+	try {
+		while (!reader.AtEnd()) {
+			auto record = eRecord(reader.Byte());
+			if (record == eRecord::STRING) {
+				uint64_t id = reader.Varint();
+				if (id != strings.size() + 1) {
+					throw InvalidArgumentException("Malformed binary log, strings are not numbered in order.");
+				}
+				strings.push_back(reader.Bytes());
+			}
+			else if (record == eRecord::STREAM) {
+				uint64_t stream = reader.Varint();
+				if (stream >= MaxStreamId) {
+					throw InvalidArgumentException("Malformed binary log, stream index is too large.");
+				}
+				if (stream >= streamNames.size()) {
+					streamNames.resize(stream + 1);
+					streamsDefined.resize(stream + 1, false);
+				}
+				streamNames[stream] = readStringRef();
+				streamsDefined[stream] = true;
+			}
+			else if (record == eRecord::EVENT) {
+				uint64_t stream = reader.Varint();
+				if (stream >= streamsDefined.size() || !streamsDefined[stream]) {
+					throw InvalidArgumentException("Malformed binary log, event of an undefined stream.");
+				}
+				lastTimestamp += reader.ZigZag();
+				LogEvent evt(readStringRef());
+
+				uint64_t parameterCount = reader.Varint();
+				if (parameterCount > MaxParameterCount) {
+					throw InvalidArgumentException("Malformed binary log, too many parameters.");
+				}
+				for (uint64_t i = 0; i < parameterCount; ++i) {
+					std::string name = readStringRef();
+					auto type = eEventParameterType(reader.Byte());
+					switch (type) {
+						case eEventParameterType::FLOAT: {
+							uint32_t bits = 0;
+							for (int byte = 0; byte < 4; ++byte) {
+								bits |= uint32_t(reader.Byte()) << (8 * byte);
+							}
+							evt.PutParameter(EventParameterFloat(name, std::bit_cast<float>(bits)));
+							break;
+						}
+						case eEventParameterType::INT:
+							evt.PutParameter(EventParameterInt(name, int(reader.ZigZag())));
+							break;
+						case eEventParameterType::STRING:
+							evt.PutParameter(EventParameterString(name, reader.Bytes()));
+							break;
+						case eEventParameterType::RAW: {
+							std::string bytes = reader.Bytes();
+							EventParameterRaw parameter;
+							parameter.name = name;
+							parameter.data.assign(bytes.begin(), bytes.end());
+							evt.PutParameter(parameter);
+							break;
+						}
+						case eEventParameterType::DEFAULT:
+							evt.PutParameter(EventParameterText(name, reader.Bytes()));
+							break;
+						default:
+							throw InvalidArgumentException("Malformed binary log, unknown parameter type.");
+					}
+				}
+
+				int64_t microseconds = (lastTimestamp - startTime) * microNum / microDen;
+				AppendTextLogEvent(text, microseconds / 1.e6, streamNames[stream], evt);
+				if (text.size() >= WriteBatchSize) {
+					output.write(text.data(), std::streamsize(text.size()));
+					text.clear();
+				}
+			}
+			else {
+				throw InvalidArgumentException("Malformed binary log, unknown record.");
+			}
+		}
+	}
+	catch (...) {
+		output.write(text.data(), std::streamsize(text.size()));
+		throw;
+	}
+	output.write(text.data(), std::streamsize(text.size()));
+}
+
+
+} // namespace inl
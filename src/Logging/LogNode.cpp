@@ -2,6 +2,7 @@
 
 #include <InlineLib/Logging/LogPipe.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <iostream>
@@ -10,140 +11,250 @@
 namespace inl {
 
 
-LogNode::LogNode() {
-	prohibitPipes = false;
+LogNode::LogNode(eLogOverflowPolicy overflowPolicy, size_t queueCapacity, std::pmr::memory_resource* resource)
+	: queues(nullptr),
+	  overflowPolicy(overflowPolicy),
+	  queueCapacity(queueCapacity),
+	  queueFlushThreshold(std::min(flushThreshold, queueCapacity)),
+	  resource(resource) {
+	wakeRequested = false;
 	startTime = std::chrono::high_resolution_clock::now();
 	outputStream = nullptr;
-	pendingEvents = 0;
 }
 
 LogNode::~LogNode() {
-	// this code is probably not necessery since i replaced all shit with shared and weak ptrs
+	// The writer writes the remaining events before it exits.
+	{
+		std::lock_guard<std::mutex> lk(writerMtx);
+		stopWriter = true;
+	}
+	writerWake.notify_one();
+	if (writer.joinable()) {
+		writer.join();
+	}
 
-	//prohibitPipes = true;
-	//mtx.lock();
-	//prohibitPipes = false;
+	// Threads that exit from now on must not mark the queues deleted below.
+	threadQueue.Clear();
+	ThreadQueue* queue = queues.load(std::memory_order_acquire);
+	while (queue) {
+		ThreadQueue* next = queue->next;
+		delete queue;
+		queue = next;
+	}
+}
+
+
+void LogNode::Flush() {
+	{
+		std::lock_guard<std::mutex> lk(mtx);
+		if (!writer.joinable()) {
+			// No streams yet, nothing to wait for.
+			FlushLocked();
+			return;
+		}
+	}
 
-	//for (auto& pipeInfo : pipes) {
-	//	// check if a LogStream keeps any pipe open.
-	//	if (pipeInfo.pipe.use_count() != 1) {
-	//		// if so then...
+	std::unique_lock<std::mutex> lk(writerMtx);
+	uint64_t ticket = ++flushRequested;
+	writerWake.notify_one();
+	writerDone.wait(lk, [this, ticket] { return flushCompleted >= ticket; });
+}
 
-	//		// write that fact to logfile
-	//		if (outputStream && outputStream->good()) {
-	//			*outputStream << "[ERROR] The program will now terminate because you haven't closed all LogStreams before closing the Logger. Dumfuck...\n";
-	//			outputStream->flush();
-	//		}
 
-	//		// terminate program, we would have dangling pointers
-	//		std::terminate();
-	//	}
-	//}
+void LogNode::WriterLoop() {
+	std::unique_lock<std::mutex> lk(writerMtx);
+	while (true) {
+		writerWake.wait_for(lk, flushInterval, [this] {
+			return stopWriter || flushRequested != flushCompleted || wakeRequested.load(std::memory_order_relaxed);
+		});
+		uint64_t ticket = flushRequested;
+		bool stopping = stopWriter;
+		wakeRequested.store(false, std::memory_order_relaxed);
+		lk.unlock();
+
+		{
+			std::lock_guard<std::mutex> flushLock(mtx);
+			FlushLocked();
+		}
 
-	//mtx.unlock();
+		lk.lock();
+		flushCompleted = ticket;
+		writerDone.notify_all();
+		if (stopping) {
+			return;
+		}
+	}
 }
 
 
-void LogNode::Flush() {
-	// Exclude all action by pipes.
-	prohibitPipes = true;
-	mtx.lock();
-	prohibitPipes = false;
-
-	// promote all pipes to shared_ptr
-	std::vector<PipeInfoShared> promotedPipes;
-	bool dirty = false;
-	for (auto& pipeInfo : pipes) {
-		std::shared_ptr<LogPipe> locked = pipeInfo.pipe.lock();
-		if (locked) {
-			promotedPipes.push_back({ locked, pipeInfo.name });
+void LogNode::FlushLocked() {
+	// drain the queues, events of each thread are already in order
+	size_t bufferCount = 0;
+	ThreadQueue* previous = nullptr;
+	for (ThreadQueue* queue = queues.load(std::memory_order_acquire); queue;) {
+		// checked before draining, so that the events pushed before the thread exited are all seen
+		bool exited = queue->exited.load(std::memory_order_acquire);
+		if (bufferCount == drainedEvents.size()) {
+			drainedEvents.emplace_back();
+		}
+		auto& buffer = drainedEvents[bufferCount++];
+		EventEntry entry;
+		while (queue->queue.TryPop(entry)) {
+			buffer.push_back(std::move(entry));
+		}
+
+		ThreadQueue* next = queue->next;
+		if (exited) {
+			RetireQueue(queue, previous);
 		}
 		else {
-			dirty = true;
+			previous = queue;
 		}
+		queue = next;
 	}
-	if (dirty) {
-		pipes.clear();
-		for (auto& pipeInfo : promotedPipes) {
-			pipes.push_back({ pipeInfo.pipe, pipeInfo.name });
+
+	if (!outputStream || !outputStream->good()) {
+		for (auto& buffer : drainedEvents) {
+			buffer.clear();
 		}
+		return;
 	}
 
-
-	// pop events from pipes
-	while (true) {
-		EventBuffer* oldestBuffer = nullptr;
-		std::string* oldestPipeName = nullptr;
-		std::chrono::high_resolution_clock::time_point oldestTimestamp = std::chrono::high_resolution_clock::time_point::max();
-		for (auto& pipeInfo : promotedPipes) {
-			if (!pipeInfo.pipe->buffer.empty()
-				&& pipeInfo.pipe->buffer[0].timestamp < oldestTimestamp) {
-				oldestTimestamp = pipeInfo.pipe->buffer[0].timestamp;
-				oldestBuffer = &pipeInfo.pipe->buffer;
-				oldestPipeName = &pipeInfo.name;
-			}
+	// merge the buffers by always taking the oldest head
+	auto later = [](const MergeHead& lhs, const MergeHead& rhs) { return lhs.timestamp > rhs.timestamp; };
+	mergeHeap.clear();
+	for (size_t i = 0; i < bufferCount; ++i) {
+		if (!drainedEvents[i].empty()) {
+			mergeHeap.push_back({ drainedEvents[i][0].timestamp, i, 0 });
 		}
-		if (oldestBuffer) {
-			LogEvent& evt = (*oldestBuffer)[0].event;
-
-			// write event to file
-			if (outputStream && outputStream->good()) {
-				*outputStream
-					<< "[" << std::chrono::duration_cast<std::chrono::microseconds>(oldestTimestamp - startTime).count() / 1.e6 << "]"
-					<< "[" << *oldestPipeName << "] "
-					<< evt.GetMessage() << "\n";
-				for (size_t i = 0; i < evt.GetNumParameters(); i++) {
-					*outputStream << "   " << evt[i].name << " = " << evt[i].ToString() << "\n";
-				}
-			}
-
-			// pop event
-			oldestBuffer->pop_front();
-			pendingEvents--;
+	}
+	if (mergeHeap.empty()) {
+		return;
+	}
+	std::make_heap(mergeHeap.begin(), mergeHeap.end(), later);
+
+	while (!mergeHeap.empty()) {
+		std::pop_heap(mergeHeap.begin(), mergeHeap.end(), later);
+		MergeHead& head = mergeHeap.back();
+		auto& buffer = drainedEvents[head.buffer];
+		FormatEvent(buffer[head.position]);
+		if (++head.position < buffer.size()) {
+			head.timestamp = buffer[head.position].timestamp;
+			std::push_heap(mergeHeap.begin(), mergeHeap.end(), later);
 		}
 		else {
-			// flush file
-			if (outputStream && outputStream->good()) {
-				outputStream->flush();
-			}
+			buffer.clear();
+			mergeHeap.pop_back();
+		}
 
-			break;
+		if (writeBuffer.size() >= writeBatchSize) {
+			WriteBuffer();
 		}
 	}
 
-	mtx.unlock();
+	WriteBuffer();
+	outputStream->flush();
+}
+
+
+void LogNode::FormatEvent(const EventEntry& entry) {
+	if (outputFormat == eLogFormat::BINARY) {
+		binaryEncoder.Encode(writeBuffer, entry, streamNames);
+	}
+	else {
+		double seconds = std::chrono::duration_cast<std::chrono::microseconds>(entry.timestamp - startTime).count() / 1.e6;
+		AppendTextLogEvent(writeBuffer, seconds, streamNames[entry.stream], entry.event);
+	}
+}
+
+
+void LogNode::WriteBuffer() {
+	outputStream->write(writeBuffer.data(), std::streamsize(writeBuffer.size()));
+	writeBuffer.clear();
 }
 
 
-void LogNode::NotifyNewEvent() {
-	size_t currentlyPending = ++pendingEvents;
-	if (currentlyPending >= flushThreshold) {
+void LogNode::PutEvent(size_t stream, LogEvent&& evt) {
+	EventQueue& queue = GetThreadQueue();
+	EventEntry entry{ std::chrono::high_resolution_clock::now(), stream, std::move(evt) };
+	while (!queue.TryPush(entry)) {
+		// Only with the blocking policy, wait for the writer to make room.
 		Flush();
 	}
+	if (queue.Size() >= queueFlushThreshold && !wakeRequested.load(std::memory_order_relaxed)) {
+		wakeRequested.store(true, std::memory_order_relaxed);
+		writerWake.notify_one();
+	}
 }
 
 
-void LogNode::AddPipe(std::shared_ptr<LogPipe> pipe, const std::string& name) {
-	// Exclude all action by pipes.
-	// And anyone else for that matter.
-	prohibitPipes = true;
-	mtx.lock();
-	prohibitPipes = false;
+EventQueue& LogNode::GetThreadQueue() {
+	ThreadQueue*& queue = threadQueue.GetRef().queue;
+	if (!queue) {
+		queue = new ThreadQueue(queueCapacity, overflowPolicy, resource);
+		queue->next = queues.load(std::memory_order_relaxed);
+		while (!queues.compare_exchange_weak(queue->next, queue, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+	return queue->queue;
+}
 
-	pipes.push_back({ pipe, name });
 
-	mtx.unlock();
+void LogNode::RetireQueue(ThreadQueue* queue, ThreadQueue* previous) {
+	// Producers only ever push in front of the first queue, the links behind it belong to the writer.
+	if (previous) {
+		previous->next = queue->next;
+	}
+	else {
+		ThreadQueue* first = queue;
+		if (!queues.compare_exchange_strong(first, queue->next, std::memory_order_acquire)) {
+			// New queues have been pushed in front of it since.
+			previous = first;
+			while (previous->next != queue) {
+				previous = previous->next;
+			}
+			previous->next = queue->next;
+		}
+	}
+	retiredDroppedCount += queue->queue.GetDroppedCount();
+	delete queue;
 }
 
 
-void LogNode::SetOutputStream(std::ostream* outputStream) {
-	prohibitPipes = true;
-	mtx.lock();
-	prohibitPipes = false;
+size_t LogNode::AddStream(const std::string& name) {
+	std::lock_guard<std::mutex> lk(mtx);
+	streamNames.push_back(name);
+	if (!writer.joinable()) {
+		writer = std::thread(&LogNode::WriterLoop, this);
+	}
+	return streamNames.size() - 1;
+}
+
 
+void LogNode::SetOutputStream(std::ostream* outputStream, eLogFormat format) {
+	std::lock_guard<std::mutex> lk(mtx);
 	this->outputStream = outputStream;
+	outputFormat = format;
+	if (outputStream && format == eLogFormat::BINARY) {
+		binaryEncoder.Begin(writeBuffer, startTime);
+		WriteBuffer();
+	}
+}
+
+
+void LogNode::SetFlushInterval(std::chrono::milliseconds interval) {
+	std::lock_guard<std::mutex> lk(writerMtx);
+	flushInterval = interval;
+}
+
 
-	mtx.unlock();
+uint64_t LogNode::GetDroppedEventCount() const {
+	std::lock_guard<std::mutex> lk(mtx);
+	uint64_t count = retiredDroppedCount;
+	for (ThreadQueue* queue = queues.load(std::memory_order_acquire); queue; queue = queue->next) {
+		count += queue->queue.GetDroppedCount();
+	}
+	return count;
 }
 
 
@@ -2,15 +2,11 @@
 
 #include <InlineLib/Logging/LogNode.hpp>
 
-#include <iostream>
-#include <thread>
-
 namespace inl {
 
 
-LogPipe::LogPipe(std::shared_ptr<LogNode> node) {
-	this->node = node;
-}
+LogPipe::LogPipe(std::shared_ptr<LogNode> node, size_t stream)
+	: node(std::move(node)), stream(stream) {}
 
 LogPipe::~LogPipe() {}
 
@@ -18,48 +14,14 @@ void LogPipe::PutEvent(const LogEvent& evt) {
 	if (!node) {
 		return;
 	}
-
-	// Spin until we're allowed to even try to lock.
-	// This is to avoid starvation of LogNode.
-	while (node->prohibitPipes) {
-		std::this_thread::yield();
-	}
-
-	// Deny action while Node does its stuff.
-	node->mtx.lock_shared();
-	// Deny action while other thread uses this pipe.
-	pipeLock.lock();
-
-	buffer.push_back({ std::chrono::high_resolution_clock::now(), evt });
-
-	pipeLock.unlock();
-	node->mtx.unlock_shared();
-
-	node->NotifyNewEvent();
+	node->PutEvent(stream, LogEvent(evt));
 }
 
 void LogPipe::PutEvent(LogEvent&& evt) {
 	if (!node) {
 		return;
 	}
-
-	// Spin until we're allowed to even try to lock.
-	// This is to avoid starvation of LogNode.
-	while (node->prohibitPipes) {
-		std::this_thread::yield();
-	}
-
-	// Deny action while Node does its stuff.
-	node->mtx.lock_shared();
-	// Deny action while other thread uses this pipe.
-	pipeLock.lock();
-
-	buffer.push_back({ std::chrono::high_resolution_clock::now(), std::move(evt) });
-
-	pipeLock.unlock();
-	node->mtx.unlock_shared();
-
-	node->NotifyNewEvent();
+	node->PutEvent(stream, std::move(evt));
 }
 
 
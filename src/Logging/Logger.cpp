@@ -9,13 +9,19 @@
 namespace inl {
 
 
-Logger::Logger() {
-	myNode = std::make_shared<LogNode>();
+Logger::Logger(std::pmr::memory_resource* resource, eLogOverflowPolicy overflowPolicy, size_t queueCapacity) {
+	myNode = std::make_shared<LogNode>(overflowPolicy, queueCapacity, resource);
 	outputFile = std::make_unique<std::ofstream>();
 }
 
-bool Logger::OpenFile(const std::string& path) {
-	std::ofstream newStream(path, std::ios::out | std::ios::trunc);
+Logger::~Logger() {
+	myNode->Flush();
+	myNode->SetOutputStream(nullptr);
+}
+
+bool Logger::OpenFile(const std::string& path, eLogFormat format) {
+	auto mode = std::ios::out | std::ios::trunc | (format == eLogFormat::BINARY ? std::ios::binary : std::ios::openmode{});
+	std::ofstream newStream(path, mode);
 	if (!newStream.is_open()) {
 		myNode->SetOutputStream(nullptr);
 		return false;
@@ -24,13 +30,13 @@ bool Logger::OpenFile(const std::string& path) {
 		myNode->SetOutputStream(nullptr);
 		outputFile->close();
 		*outputFile = std::move(newStream);
-		myNode->SetOutputStream(outputFile.get());
+		myNode->SetOutputStream(outputFile.get(), format);
 		return true;
 	}
 }
 
-void Logger::OpenStream(std::ostream* stream) {
-	myNode->SetOutputStream(stream);
+void Logger::OpenStream(std::ostream* stream, eLogFormat format) {
+	myNode->SetOutputStream(stream, format);
 	outputFile->close();
 }
 
@@ -40,8 +46,8 @@ void Logger::CloseStream() {
 }
 
 LogStream Logger::CreateLogStream(const std::string& name) {
-	std::shared_ptr<LogPipe> pipe(new LogPipe(myNode));
-	myNode->AddPipe(pipe, name);
+	size_t stream = myNode->AddStream(name);
+	std::shared_ptr<LogPipe> pipe(new LogPipe(myNode, stream));
 	return LoggerInterface::Construct(pipe);
 }
 
@@ -49,6 +55,14 @@ void Logger::Flush() {
 	myNode->Flush();
 }
 
+void Logger::SetFlushInterval(std::chrono::milliseconds interval) {
+	myNode->SetFlushInterval(interval);
+}
+
+uint64_t Logger::GetDroppedEventCount() const {
+	return myNode->GetDroppedEventCount();
+}
+
 
 Logger g_logger;
 
@@ -0,0 +1,284 @@
+#include <InlineLib/MappedFile.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace inl {
+
+
+namespace {
+#ifdef _WIN32
+	std::string ErrorString(DWORD error) {
+		return "Windows error " + std::to_string(error);
+	}
+#else
+	std::string ErrorString(int error) {
+		return std::strerror(error);
+	}
+
+	size_t PageSize() {
+		static const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+		return pageSize;
+	}
+#endif
+} // namespace
+
+
+MappedFile::MappedFile(const std::string& path, eMapAccess access, size_t size) {
+	Open(path, access, size);
+}
+
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+	: m_fileHandle(std::exchange(rhs.m_fileHandle, InvalidHandle)),
+	  m_mappingHandle(std::exchange(rhs.m_mappingHandle, InvalidHandle)),
+	  m_data(std::exchange(rhs.m_data, nullptr)),
+	  m_size(std::exchange(rhs.m_size, 0)),
+	  m_access(rhs.m_access) {}
+
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept {
+	if (this != &rhs) {
+		Close();
+		m_fileHandle = std::exchange(rhs.m_fileHandle, InvalidHandle);
+		m_mappingHandle = std::exchange(rhs.m_mappingHandle, InvalidHandle);
+		m_data = std::exchange(rhs.m_data, nullptr);
+		m_size = std::exchange(rhs.m_size, 0);
+		m_access = rhs.m_access;
+	}
+	return *this;
+}
+
+
+MappedFile::~MappedFile() {
+	Close();
+}
+
+
+#ifdef _WIN32
+
+void MappedFile::Open(const std::string& path, eMapAccess access, size_t size) {
+	Close();
+
+	DWORD desiredAccess = access == eMapAccess::READ_WRITE ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ;
+	DWORD creation = access == eMapAccess::READ_WRITE ? OPEN_ALWAYS : OPEN_EXISTING;
+	HANDLE file = CreateFileA(path.c_str(), desiredAccess, FILE_SHARE_READ, nullptr, creation, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		DWORD error = GetLastError();
+		if (error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND) {
+			throw FileNotFoundException("Could not open file.", path);
+		}
+		throw RuntimeException("Could not open file.", path + ": " + ErrorString(error));
+	}
+	m_fileHandle = reinterpret_cast<intptr_t>(file);
+	m_access = access;
+
+	LARGE_INTEGER fileSize;
+	if (access == eMapAccess::READ_WRITE && size != 0) {
+		fileSize.QuadPart = LONGLONG(size);
+		if (!SetFilePointerEx(file, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(file)) {
+			DWORD error = GetLastError();
+			Close();
+			throw RuntimeException("Could not resize file.", path + ": " + ErrorString(error));
+		}
+	}
+	if (!GetFileSizeEx(file, &fileSize)) {
+		DWORD error = GetLastError();
+		Close();
+		throw RuntimeException("Could not query file size.", path + ": " + ErrorString(error));
+	}
+	m_size = size_t(fileSize.QuadPart);
+	if (m_size == 0) {
+		return;
+	}
+
+	DWORD protection = access == eMapAccess::READ_ONLY ? PAGE_READONLY : access == eMapAccess::COPY_ON_WRITE ? PAGE_WRITECOPY : PAGE_READWRITE;
+	DWORD viewAccess = access == eMapAccess::READ_ONLY ? FILE_MAP_READ : access == eMapAccess::COPY_ON_WRITE ? FILE_MAP_COPY : FILE_MAP_WRITE;
+	HANDLE mapping = CreateFileMappingA(file, nullptr, protection, 0, 0, nullptr);
+	if (mapping) {
+		m_mappingHandle = reinterpret_cast<intptr_t>(mapping);
+		m_data = static_cast<std::byte*>(MapViewOfFile(mapping, viewAccess, 0, 0, m_size));
+	}
+	if (!m_data) {
+		DWORD error = GetLastError();
+		Close();
+		throw RuntimeException("Could not map file.", path + ": " + ErrorString(error));
+	}
+}
+
+
+void MappedFile::Close() noexcept {
+	if (m_data) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle != InvalidHandle) {
+		CloseHandle(reinterpret_cast<HANDLE>(m_mappingHandle));
+	}
+	if (m_fileHandle != InvalidHandle) {
+		CloseHandle(reinterpret_cast<HANDLE>(m_fileHandle));
+	}
+	m_fileHandle = m_mappingHandle = InvalidHandle;
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+bool MappedFile::Advise(eMapHint hint, size_t offset, size_t length) noexcept {
+	if (!m_data || offset >= m_size) {
+		return false;
+	}
+	length = std::min(length, m_size - offset);
+
+	// Windows only has an equivalent for prefetching.
+	if (hint == eMapHint::WILL_NEED) {
+		WIN32_MEMORY_RANGE_ENTRY range = { m_data + offset, length };
+		return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0) != FALSE;
+	}
+	return hint == eMapHint::NORMAL;
+}
+
+
+void MappedFile::Flush(bool wait) {
+	if (!m_data || m_access != eMapAccess::READ_WRITE) {
+		return;
+	}
+	if (!FlushViewOfFile(m_data, 0) || (wait && !FlushFileBuffers(reinterpret_cast<HANDLE>(m_fileHandle)))) {
+		throw RuntimeException("Could not flush mapped file.", ErrorString(GetLastError()));
+	}
+}
+
+#else
+
+void MappedFile::Open(const std::string& path, eMapAccess access, size_t size) {
+	Close();
+
+	int flags = O_CLOEXEC | (access == eMapAccess::READ_WRITE ? O_RDWR | O_CREAT : O_RDONLY);
+	int fd = open(path.c_str(), flags, 0644);
+	if (fd < 0) {
+		if (errno == ENOENT) {
+			throw FileNotFoundException("Could not open file.", path);
+		}
+		throw RuntimeException("Could not open file.", path + ": " + ErrorString(errno));
+	}
+	m_fileHandle = fd;
+	m_access = access;
+
+	if (access == eMapAccess::READ_WRITE && size != 0 && ftruncate(fd, off_t(size)) != 0) {
+		int error = errno;
+		Close();
+		throw RuntimeException("Could not resize file.", path + ": " + ErrorString(error));
+	}
+	struct stat status;
+	if (fstat(fd, &status) != 0) {
+		int error = errno;
+		Close();
+		throw RuntimeException("Could not query file size.", path + ": " + ErrorString(error));
+	}
+	m_size = size_t(status.st_size);
+	if (m_size == 0) {
+		return;
+	}
+
+	int protection = access == eMapAccess::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+	int mapFlags = access == eMapAccess::READ_WRITE ? MAP_SHARED : MAP_PRIVATE;
+	void* data = mmap(nullptr, m_size, protection, mapFlags, fd, 0);
+	if (data == MAP_FAILED) {
+		int error = errno;
+		Close();
+		throw RuntimeException("Could not map file.", path + ": " + ErrorString(error));
+	}
+	m_data = static_cast<std::byte*>(data);
+}
+
+
+void MappedFile::Close() noexcept {
+	if (m_data) {
+		munmap(m_data, m_size);
+	}
+	if (m_fileHandle != InvalidHandle) {
+		close(int(m_fileHandle));
+	}
+	m_fileHandle = InvalidHandle;
+	m_data = nullptr;
+	m_size = 0;
+}
+
+
+bool MappedFile::Advise(eMapHint hint, size_t offset, size_t length) noexcept {
+	if (!m_data || offset >= m_size) {
+		return false;
+	}
+	length = std::min(length, m_size - offset);
+
+	int advice;
+	switch (hint) {
+		case eMapHint::NORMAL: advice = MADV_NORMAL; break;
+		case eMapHint::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+		case eMapHint::RANDOM: advice = MADV_RANDOM; break;
+		case eMapHint::WILL_NEED: advice = MADV_WILLNEED; break;
+		case eMapHint::DONT_NEED: advice = MADV_DONTNEED; break;
+#ifdef MADV_HUGEPAGE
+		case eMapHint::HUGE_PAGES: advice = MADV_HUGEPAGE; break;
+#endif
+		default: return false;
+	}
+
+	// madvise wants a page aligned start.
+	size_t alignedOffset = offset & ~(PageSize() - 1);
+	return madvise(m_data + alignedOffset, length + (offset - alignedOffset), advice) == 0;
+}
+
+
+void MappedFile::Flush(bool wait) {
+	if (!m_data || m_access != eMapAccess::READ_WRITE) {
+		return;
+	}
+	if (msync(m_data, m_size, wait ? MS_SYNC : MS_ASYNC) != 0) {
+		throw RuntimeException("Could not flush mapped file.", ErrorString(errno));
+	}
+}
+
+#endif
+
+
+std::byte* MappedFile::MutableData() {
+	if (m_access == eMapAccess::READ_ONLY && IsOpen()) {
+		throw InvalidCallException("File is mapped read-only.");
+	}
+	return m_data;
+}
+
+
+size_t MappedFile::CheckedCount(size_t offset, size_t count, size_t stride, size_t elementSize, size_t alignment) const {
+	if (offset % alignment != 0 || stride % alignment != 0 || stride < elementSize) {
+		throw InvalidArgumentException("Offset and stride must be aligned for the element type, and stride must not be less than its size.");
+	}
+	if (offset > m_size) {
+		throw OutOfRangeException("Offset is past the end of the file.");
+	}
+	size_t available = m_size - offset >= elementSize ? (m_size - offset - elementSize) / stride + 1 : 0;
+	if (count == SIZE_MAX) {
+		return available;
+	}
+	if (count > available) {
+		throw OutOfRangeException("View extends past the end of the file.");
+	}
+	return count;
+}
+
+
+} // namespace inl
@@ -0,0 +1,181 @@
+#include <InlineLib/Memory/AllocationTrace.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+
+
+namespace inl {
+
+
+namespace {
+	constexpr const char* TraceHeader = "InlineLib allocation trace 1";
+
+	struct RawEvent {
+		void* ptr;
+		uint64_t size;
+		uint32_t thread;
+		eAllocationOp op;
+		std::atomic_bool committed; // Set once the other fields are written.
+	};
+
+	// Not a unique_ptr, operator new may record, and the trace may be written by an atexit handler, after static destructors.
+	RawEvent* events = nullptr;
+	size_t capacity = 0;
+	std::atomic_size_t nextEvent = 0;
+	std::atomic_uint64_t droppedEvents = 0;
+	std::atomic_uint32_t nextThread = 0;
+	std::atomic_uint64_t generation = 0; // Incremented by Start, so that threads get new indices.
+
+	// Plain thread_locals, they are accessed from inside operator new.
+	thread_local uint32_t t_threadIndex = 0;
+	thread_local uint64_t t_generation = 0;
+
+	uint32_t ThreadIndex() noexcept {
+		uint64_t currentGeneration = generation.load(std::memory_order_relaxed);
+		if (t_generation != currentGeneration) {
+			t_threadIndex = nextThread.fetch_add(1, std::memory_order_relaxed);
+			t_generation = currentGeneration;
+		}
+		return t_threadIndex;
+	}
+} // namespace
+
+
+size_t AllocationTrace::AllocationCount() const {
+	return size_t(std::count_if(events.begin(), events.end(), [](const AllocationTraceEvent& event) {
+		return event.op == eAllocationOp::ALLOCATE;
+	}));
+}
+
+
+void AllocationTrace::Write(std::ostream& os) const {
+	os << TraceHeader << '\n';
+	for (const auto& event : events) {
+		os << (event.op == eAllocationOp::ALLOCATE ? 'a' : 'f') << ' ' << event.thread << ' ' << event.id << ' ' << event.size << '\n';
+	}
+}
+
+
+AllocationTrace AllocationTrace::Read(std::istream& is) {
+	std::string line;
+	if (!std::getline(is, line) || line != TraceHeader) {
+		throw InvalidArgumentException("Stream does not contain an allocation trace.");
+	}
+
+	AllocationTrace trace;
+	uint64_t nextId = 0;
+	while (std::getline(is, line)) {
+		if (line.empty()) {
+			continue;
+		}
+		std::istringstream fields(line);
+		char op;
+		AllocationTraceEvent event;
+		if (!(fields >> op >> event.thread >> event.id >> event.size) || (op != 'a' && op != 'f')) {
+			throw InvalidArgumentException("Malformed allocation trace event.", line);
+		}
+		event.op = op == 'a' ? eAllocationOp::ALLOCATE : eAllocationOp::DEALLOCATE;
+		if (event.op == eAllocationOp::ALLOCATE ? event.id != nextId : event.id >= nextId) {
+			throw InvalidArgumentException("Allocation trace event refers to an unexpected allocation id.", line);
+		}
+		nextId += event.op == eAllocationOp::ALLOCATE ? 1 : 0;
+		trace.events.push_back(event);
+	}
+	return trace;
+}
+
+
+void AllocationTraceRecorder::Start(size_t bufferCapacity) {
+	if (s_running.load()) {
+		throw InvalidCallException("Allocation trace recorder is already running.");
+	}
+	if (capacity != bufferCapacity) {
+		delete[] events;
+		events = new RawEvent[bufferCapacity];
+		capacity = bufferCapacity;
+	}
+	else {
+		for (size_t i = 0; i < capacity; ++i) {
+			events[i].committed.store(false, std::memory_order_relaxed);
+		}
+	}
+	nextEvent = 0;
+	droppedEvents = 0;
+	nextThread = 0;
+	generation.fetch_add(1);
+	s_running.store(true);
+}
+
+
+void AllocationTraceRecorder::Stop() {
+	s_running.store(false);
+}
+
+
+bool AllocationTraceRecorder::IsRunning() {
+	return s_running.load(std::memory_order_relaxed);
+}
+
+
+uint64_t AllocationTraceRecorder::GetDroppedEventCount() {
+	return droppedEvents.load(std::memory_order_relaxed);
+}
+
+
+AllocationTrace AllocationTraceRecorder::GetTrace() {
+	if (s_running.load()) {
+		throw InvalidCallException("Stop the allocation trace recorder before getting the trace.");
+	}
+
+	struct LiveAllocation {
+		uint64_t id;
+		uint64_t size;
+	};
+	std::unordered_map<void*, LiveAllocation> live;
+	uint64_t nextId = 0;
+
+	AllocationTrace trace;
+	size_t count = std::min(nextEvent.load(), capacity);
+	trace.events.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		const RawEvent& event = events[i];
+		if (!event.committed.load(std::memory_order_acquire)) {
+			continue; // The thread was interrupted by Stop.
+		}
+		if (event.op == eAllocationOp::ALLOCATE) {
+			live[event.ptr] = { nextId, event.size };
+			trace.events.push_back({ eAllocationOp::ALLOCATE, event.thread, nextId, event.size });
+			++nextId;
+		}
+		else {
+			auto it = live.find(event.ptr);
+			if (it != live.end()) {
+				trace.events.push_back({ eAllocationOp::DEALLOCATE, event.thread, it->second.id, it->second.size });
+				live.erase(it);
+			}
+		}
+	}
+	return trace;
+}
+
+
+void AllocationTraceRecorder::Record(eAllocationOp op, void* ptr, size_t size) noexcept {
+	size_t index = nextEvent.fetch_add(1, std::memory_order_relaxed);
+	if (index >= capacity) {
+		droppedEvents.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	RawEvent& event = events[index];
+	event.ptr = ptr;
+	event.size = size;
+	event.thread = ThreadIndex();
+	event.op = op;
+	event.committed.store(true, std::memory_order_release);
+}
+
+
+} // namespace inl
@@ -0,0 +1,100 @@
+#include <InlineLib/Memory/ArenaResource.hpp>
+
+#include <InlineLib/Memory/HugePageResource.hpp>
+
+#include <algorithm>
+#include <cstdint>
+
+
+namespace inl {
+
+
+namespace {
+	inline std::byte* AlignUp(std::byte* ptr, size_t alignment) {
+		uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+		return ptr + ((alignment - address % alignment) % alignment);
+	}
+} // namespace
+
+
+MonotonicArenaResource::MonotonicArenaResource(size_t initialChunkSize, std::pmr::memory_resource* upstream)
+	: m_upstream(upstream), m_chunkGranularity(HugePageResource::GetGranularity(upstream)), m_nextChunkSize(std::max(initialChunkSize, sizeof(ChunkHeader) * 2)) {}
+
+
+MonotonicArenaResource::~MonotonicArenaResource() {
+	Release();
+}
+
+
+void MonotonicArenaResource::Release() noexcept {
+	while (m_currentChunk) {
+		ChunkHeader* previous = m_currentChunk->previous;
+		m_upstream->deallocate(m_currentChunk, m_currentChunk->size, alignof(std::max_align_t));
+		m_currentChunk = previous;
+	}
+	m_top = m_end = nullptr;
+	m_capacity = 0;
+}
+
+
+void* MonotonicArenaResource::do_allocate(size_t bytes, size_t alignment) {
+	if (m_currentChunk) {
+		std::byte* ptr = AlignUp(m_top, alignment);
+		if (ptr <= m_end && bytes <= size_t(m_end - ptr)) {
+			m_top = ptr + bytes;
+			return ptr;
+		}
+	}
+	AddChunk(bytes, alignment);
+	std::byte* ptr = AlignUp(m_top, alignment);
+	m_top = ptr + bytes;
+	return ptr;
+}
+
+
+void MonotonicArenaResource::Rewind() noexcept {
+	if (m_currentChunk) {
+		m_top = reinterpret_cast<std::byte*>(m_currentChunk + 1);
+	}
+}
+
+
+size_t MonotonicArenaResource::GetChunkCount() const noexcept {
+	size_t count = 0;
+	for (ChunkHeader* chunk = m_currentChunk; chunk; chunk = chunk->previous) {
+		++count;
+	}
+	return count;
+}
+
+
+void MonotonicArenaResource::AddChunk(size_t minimumSize, size_t alignment) {
+	size_t requiredSize = sizeof(ChunkHeader) + minimumSize + alignment;
+	size_t chunkSize = std::max(m_nextChunkSize, requiredSize);
+	chunkSize = (chunkSize + m_chunkGranularity - 1) / m_chunkGranularity * m_chunkGranularity;
+
+	auto chunk = static_cast<ChunkHeader*>(m_upstream->allocate(chunkSize, alignof(std::max_align_t)));
+	chunk->previous = m_currentChunk;
+	chunk->size = chunkSize;
+
+	m_currentChunk = chunk;
+	m_top = reinterpret_cast<std::byte*>(chunk + 1);
+	m_end = reinterpret_cast<std::byte*>(chunk) + chunkSize;
+	m_capacity += chunkSize;
+	m_nextChunkSize = chunkSize * 2;
+}
+
+
+void ScratchArenaResource::Reset() {
+	if (GetChunkCount() > 1) {
+		size_t capacity = GetCapacity();
+		Release();
+		AddChunk(capacity, alignof(std::max_align_t));
+	}
+	else {
+		Rewind();
+	}
+}
+
+
+} // namespace inl
@@ -0,0 +1,246 @@
+#include <InlineLib/Memory/BuddyAllocationEngine.hpp>
+
+#include <InlineLib/BitOperations.hpp>
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+
+namespace inl {
+
+
+namespace {
+	unsigned FloorLog2(size_t value) {
+		return unsigned(63 - CountLeadingZeros(uint64_t(value)));
+	}
+
+	unsigned CeilLog2(size_t value) {
+		return value <= 1 ? 0 : unsigned(64 - CountLeadingZeros(uint64_t(value - 1)));
+	}
+} // namespace
+
+
+BuddyAllocationEngine::BuddyAllocationEngine() {
+}
+
+
+BuddyAllocationEngine::BuddyAllocationEngine(size_t poolSize) {
+	Initialize(poolSize);
+}
+
+
+size_t BuddyAllocationEngine::Allocate(size_t allocationSize) {
+	if (allocationSize == 0) {
+		throw InvalidArgumentException("Allocation size should be non-zero.");
+	}
+	if (m_tree.empty() || allocationSize > LeafCount()) {
+		throw std::bad_alloc();
+	}
+	unsigned order = CeilLog2(allocationSize);
+	uint8_t needed = uint8_t(order + 1);
+	if (m_tree[0] < needed) {
+		throw std::bad_alloc();
+	}
+
+	// Descend to a block of the requested order. Of two children that both fit, take the one
+	// whose largest free block is smaller, to leave large blocks intact.
+	size_t node = 0;
+	for (unsigned nodeOrder = m_height; nodeOrder > order; --nodeOrder) {
+		if (!IsSplit(node)) {
+			Split(node, nodeOrder);
+		}
+		size_t left = 2 * node + 1;
+		uint8_t leftValue = m_tree[left];
+		uint8_t rightValue = m_tree[left + 1];
+		node = leftValue >= needed && (rightValue < needed || leftValue <= rightValue) ? left : left + 1;
+	}
+	assert(!IsSplit(node) && m_tree[node] == needed);
+
+	m_tree[node] = 0;
+	UpdateAncestors(node, order);
+	m_allocatedSize += size_t(1) << order;
+	++m_allocationCount;
+
+	size_t firstNodeOfLevel = (size_t(1) << (m_height - order)) - 1;
+	return (node - firstNodeOfLevel) << order;
+}
+
+
+void BuddyAllocationEngine::Deallocate(size_t index) {
+	if (index >= m_poolSize) {
+		throw OutOfRangeException("Given index is greater than the highest index in the pool");
+	}
+	auto [node, order] = FindAllocation(index);
+
+	m_tree[node] = uint8_t(order + 1);
+	UpdateAncestors(node, order);
+	m_allocatedSize -= size_t(1) << order;
+	--m_allocationCount;
+}
+
+
+size_t BuddyAllocationEngine::AllocationSize(size_t index) const {
+	if (index >= m_poolSize) {
+		throw OutOfRangeException("Given index is greater than the highest index in the pool");
+	}
+	return size_t(1) << FindAllocation(index).second;
+}
+
+
+void BuddyAllocationEngine::Resize(size_t newPoolSize) {
+	std::vector<std::pair<size_t, unsigned>> allocations;
+	allocations.reserve(m_allocationCount);
+	VisitBlocks([&](size_t index, unsigned order, bool free) {
+		// Blocks past the pool size are the ones covering the rest of the tree.
+		if (!free && index < m_poolSize) {
+			allocations.emplace_back(index, order);
+		}
+	});
+
+	Initialize(newPoolSize);
+	for (auto [index, order] : allocations) {
+		if (index + (size_t(1) << order) <= newPoolSize) {
+			MarkAllocated(index, order);
+			m_allocatedSize += size_t(1) << order;
+			++m_allocationCount;
+		}
+	}
+}
+
+
+void BuddyAllocationEngine::Reset() {
+	Initialize(m_poolSize);
+}
+
+
+size_t BuddyAllocationEngine::LargestFreeBlock() const {
+	return m_tree.empty() || m_tree[0] == 0 ? 0 : size_t(1) << (m_tree[0] - 1);
+}
+
+
+BuddyAllocationStats BuddyAllocationEngine::GetStats() const {
+	BuddyAllocationStats stats = {};
+	stats.poolSize = m_poolSize;
+	stats.allocatedSize = m_allocatedSize;
+	stats.allocationCount = m_allocationCount;
+	stats.freeSize = m_poolSize - m_allocatedSize;
+	stats.largestFreeBlock = LargestFreeBlock();
+	VisitBlocks([&](size_t, unsigned, bool free) {
+		stats.freeBlockCount += free ? 1 : 0;
+	});
+	return stats;
+}
+
+
+void BuddyAllocationEngine::Initialize(size_t poolSize) {
+	m_poolSize = poolSize;
+	m_allocatedSize = 0;
+	m_allocationCount = 0;
+	if (poolSize == 0) {
+		m_height = 0;
+		m_tree.clear();
+		m_split.clear();
+		return;
+	}
+
+	m_height = CeilLog2(poolSize);
+	size_t nodeCount = 2 * LeafCount() - 1;
+	m_tree.assign(nodeCount, 0);
+	m_split.assign((nodeCount + 63) / 64, 0);
+	m_tree[0] = uint8_t(m_height + 1);
+
+	// Cover the rest of the tree with the largest aligned blocks that fit.
+	for (size_t index = poolSize; index < LeafCount();) {
+		unsigned order = std::min(unsigned(CountTrailingZeros(uint64_t(index))), FloorLog2(LeafCount() - index));
+		MarkAllocated(index, order);
+		index += size_t(1) << order;
+	}
+}
+
+
+void BuddyAllocationEngine::MarkAllocated(size_t index, unsigned order) {
+	size_t node = 0;
+	for (unsigned nodeOrder = m_height; nodeOrder > order; --nodeOrder) {
+		if (!IsSplit(node)) {
+			Split(node, nodeOrder);
+		}
+		bool right = (index >> (nodeOrder - 1)) & 1;
+		node = 2 * node + 1 + (right ? 1 : 0);
+	}
+	assert(!IsSplit(node) && m_tree[node] == order + 1);
+	m_tree[node] = 0;
+	UpdateAncestors(node, order);
+}
+
+
+void BuddyAllocationEngine::Split(size_t node, unsigned order) {
+	m_split[node / 64] |= uint64_t(1) << (node % 64);
+	m_tree[2 * node + 1] = uint8_t(order); // Children are entirely free blocks of one order lower.
+	m_tree[2 * node + 2] = uint8_t(order);
+}
+
+
+void BuddyAllocationEngine::UpdateAncestors(size_t node, unsigned order) {
+	while (node != 0) {
+		size_t parent = (node - 1) / 2;
+		++order;
+		uint8_t left = m_tree[2 * parent + 1];
+		uint8_t right = m_tree[2 * parent + 2];
+		uint8_t value;
+		if (left == order && right == order) {
+			// Both halves are free, merge them.
+			m_split[parent / 64] &= ~(uint64_t(1) << (parent % 64));
+			value = uint8_t(order + 1);
+		}
+		else {
+			value = std::max(left, right);
+		}
+		if (m_tree[parent] == value) {
+			break; // Levels above know this already.
+		}
+		m_tree[parent] = value;
+		node = parent;
+	}
+}
+
+
+std::pair<size_t, unsigned> BuddyAllocationEngine::FindAllocation(size_t index) const {
+	// The block containing the slot is the first node upwards whose parent is split.
+	size_t node = LeafCount() - 1 + index;
+	unsigned order = 0;
+	while (node != 0 && !IsSplit((node - 1) / 2)) {
+		node = (node - 1) / 2;
+		++order;
+	}
+	if (m_tree[node] != 0 || (index & ((size_t(1) << order) - 1)) != 0) {
+		throw InvalidArgumentException("No allocation starts at the given index.");
+	}
+	return { node, order };
+}
+
+
+/// <summary> Calls func(index, order, free) for each block that is not split. </summary>
+template <class Func>
+void BuddyAllocationEngine::VisitBlocks(Func&& func) const {
+	if (m_tree.empty()) {
+		return;
+	}
+	std::vector<std::pair<size_t, unsigned>> stack = { { 0, m_height } };
+	while (!stack.empty()) {
+		auto [node, order] = stack.back();
+		stack.pop_back();
+		if (IsSplit(node)) {
+			stack.emplace_back(2 * node + 2, order - 1);
+			stack.emplace_back(2 * node + 1, order - 1);
+		}
+		else {
+			size_t firstNodeOfLevel = (size_t(1) << (m_height - order)) - 1;
+			func((node - firstNodeOfLevel) << order, order, m_tree[node] != 0);
+		}
+	}
+}
+
+
+} // namespace inl
\ No newline at end of file
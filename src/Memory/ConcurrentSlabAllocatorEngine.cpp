@@ -0,0 +1,248 @@
+#include <InlineLib/Memory/ConcurrentSlabAllocatorEngine.hpp>
+
+#include <InlineLib/BitOperations.hpp>
+
+#include <cassert>
+#include <new>
+
+
+namespace inl {
+
+
+namespace {
+	std::atomic_uint32_t nextThreadCache = 0;
+
+	// Segment k holds 2^k blocks, starting at block index 2^k - 1.
+	inline unsigned SegmentOf(uint32_t blockIndex) {
+		return 31 - CountLeadingZeros(uint32_t(blockIndex + 1));
+	}
+} // namespace
+
+
+ConcurrentSlabAllocatorEngine::ConcurrentSlabAllocatorEngine(size_t poolSize)
+	: m_poolSize(0), m_freeHead(NoBlock) {
+	Resize(poolSize);
+}
+
+
+ConcurrentSlabAllocatorEngine::~ConcurrentSlabAllocatorEngine() {
+	for (auto& segment : m_segments) {
+		delete[] segment.load();
+	}
+}
+
+
+size_t ConcurrentSlabAllocatorEngine::Allocate() {
+	CacheSlot& cache = GetThreadCache();
+	uint32_t blockIndex = cache.blockIndex.exchange(NoBlock, std::memory_order_acquire);
+
+	while (true) {
+		if (blockIndex == NoBlock) {
+			blockIndex = PopFreeBlock();
+		}
+		if (blockIndex == NoBlock) {
+			// Other threads' caches may still have free slots.
+			blockIndex = StealCachedBlock();
+		}
+		if (blockIndex == NoBlock) {
+			throw std::bad_alloc();
+		}
+
+		Block& block = GetBlock(blockIndex);
+		uint64_t occupancy = block.occupancy.load(std::memory_order_acquire);
+		if (occupancy != FullMask) {
+			// Only the owner sets bits, so the slot can't be taken in the meantime.
+			int index = CountTrailingZeros(~occupancy);
+			uint64_t slotMask = uint64_t(1) << index;
+			block.occupancy.fetch_or(slotMask, std::memory_order_acq_rel);
+
+			if ((occupancy | slotMask) == FullMask) {
+				ReleaseBlock(blockIndex);
+			}
+			else {
+				uint32_t previous = cache.blockIndex.exchange(blockIndex, std::memory_order_acq_rel);
+				if (previous != NoBlock) {
+					// Another thread sharing the cache slot left a block there.
+					PushFreeBlocks(previous, previous);
+				}
+			}
+			return size_t(blockIndex) * SlotsPerBlock + index;
+		}
+
+		ReleaseBlock(blockIndex);
+		blockIndex = NoBlock;
+	}
+}
+
+
+void ConcurrentSlabAllocatorEngine::Deallocate(size_t index) {
+	assert(index < Size());
+	uint32_t blockIndex = uint32_t(index / SlotsPerBlock);
+	uint64_t slotMask = uint64_t(1) << (index % SlotsPerBlock);
+
+	uint64_t previousOccupancy = GetBlock(blockIndex).occupancy.fetch_and(~slotMask);
+	assert(previousOccupancy & slotMask);
+	OnSlotsFreed(blockIndex, previousOccupancy);
+}
+
+
+void ConcurrentSlabAllocatorEngine::Resize(size_t newPoolSize) {
+	std::lock_guard<std::mutex> lk(m_resizeMtx);
+
+	size_t oldPoolSize = m_poolSize.load(std::memory_order_relaxed);
+	if (newPoolSize <= oldPoolSize) {
+		return;
+	}
+	size_t newBlockCount = (newPoolSize + SlotsPerBlock - 1) / SlotsPerBlock;
+	if (newBlockCount >= NoBlock) {
+		throw std::bad_alloc();
+	}
+	uint32_t oldBlockCount = uint32_t((oldPoolSize + SlotsPerBlock - 1) / SlotsPerBlock);
+
+	// Allocate missing segments. Blocks outside the pool are full and not listed.
+	for (uint32_t blockIndex = oldBlockCount; blockIndex < newBlockCount;) {
+		unsigned segment = SegmentOf(blockIndex);
+		if (!m_segments[segment].load(std::memory_order_relaxed)) {
+			size_t segmentSize = size_t(1) << segment;
+			Block* blocks = new Block[segmentSize];
+			for (size_t i = 0; i < segmentSize; ++i) {
+				blocks[i].occupancy.store(FullMask, std::memory_order_relaxed);
+				blocks[i].nextBlockIndex.store(NoBlock, std::memory_order_relaxed);
+				blocks[i].listed.store(false, std::memory_order_relaxed);
+			}
+			m_segments[segment].store(blocks, std::memory_order_release);
+		}
+		blockIndex = (uint32_t(2) << segment) - 1;
+	}
+	m_poolSize.store(newPoolSize, std::memory_order_release);
+
+	// The old last block may be in use, its new slots are unlocked like deallocations.
+	if (oldPoolSize % SlotsPerBlock != 0) {
+		uint32_t lastIndex = oldBlockCount - 1;
+		uint64_t newSlots = ValidSlotMask(newPoolSize, lastIndex) & ~ValidSlotMask(oldPoolSize, lastIndex);
+		uint64_t previousOccupancy = GetBlock(lastIndex).occupancy.fetch_and(~newSlots);
+		OnSlotsFreed(lastIndex, previousOccupancy);
+	}
+
+	// New blocks are not visible to anyone yet, they are chained and pushed at once.
+	if (oldBlockCount < newBlockCount) {
+		for (uint32_t blockIndex = oldBlockCount; blockIndex < newBlockCount; ++blockIndex) {
+			Block& block = GetBlock(blockIndex);
+			block.occupancy.store(~ValidSlotMask(newPoolSize, blockIndex), std::memory_order_relaxed);
+			block.nextBlockIndex.store(blockIndex + 1, std::memory_order_relaxed);
+			block.listed.store(true, std::memory_order_relaxed);
+		}
+		PushFreeBlocks(oldBlockCount, uint32_t(newBlockCount - 1));
+	}
+}
+
+
+void ConcurrentSlabAllocatorEngine::Reset() {
+	for (auto& cache : m_caches) {
+		cache.blockIndex.store(NoBlock);
+	}
+	m_freeHead.store(NoBlock);
+
+	size_t poolSize = Size();
+	uint32_t blockCount = uint32_t((poolSize + SlotsPerBlock - 1) / SlotsPerBlock);
+	for (uint32_t blockIndex = 0; blockIndex < blockCount; ++blockIndex) {
+		Block& block = GetBlock(blockIndex);
+		block.occupancy.store(~ValidSlotMask(poolSize, blockIndex));
+		block.nextBlockIndex.store(blockIndex + 1);
+		block.listed.store(true);
+	}
+	if (blockCount > 0) {
+		PushFreeBlocks(0, blockCount - 1);
+	}
+}
+
+
+auto ConcurrentSlabAllocatorEngine::GetBlock(uint32_t blockIndex) const -> Block& {
+	unsigned segment = SegmentOf(blockIndex);
+	uint32_t segmentStart = (uint32_t(1) << segment) - 1;
+	return m_segments[segment].load(std::memory_order_acquire)[blockIndex - segmentStart];
+}
+
+
+auto ConcurrentSlabAllocatorEngine::GetThreadCache() -> CacheSlot& {
+	thread_local const uint32_t threadCache = nextThreadCache.fetch_add(1, std::memory_order_relaxed) % CacheCount;
+	return m_caches[threadCache];
+}
+
+
+void ConcurrentSlabAllocatorEngine::PushFreeBlocks(uint32_t first, uint32_t last) {
+	Block& lastBlock = GetBlock(last);
+	uint64_t head = m_freeHead.load(std::memory_order_relaxed);
+	uint64_t newHead;
+	do {
+		lastBlock.nextBlockIndex.store(uint32_t(head), std::memory_order_relaxed);
+		newHead = ((head >> 32) + 1) << 32 | first;
+	} while (!m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_release, std::memory_order_relaxed));
+}
+
+
+uint32_t ConcurrentSlabAllocatorEngine::PopFreeBlock() {
+	uint64_t head = m_freeHead.load(std::memory_order_acquire);
+	while (uint32_t(head) != NoBlock) {
+		// Blocks are never freed, so reading a stale next index is harmless, the tag makes the CAS fail.
+		uint32_t next = GetBlock(uint32_t(head)).nextBlockIndex.load(std::memory_order_relaxed);
+		uint64_t newHead = ((head >> 32) + 1) << 32 | next;
+		if (m_freeHead.compare_exchange_weak(head, newHead, std::memory_order_acquire, std::memory_order_acquire)) {
+			return uint32_t(head);
+		}
+	}
+	return NoBlock;
+}
+
+
+uint32_t ConcurrentSlabAllocatorEngine::StealCachedBlock() {
+	for (auto& cache : m_caches) {
+		if (cache.blockIndex.load(std::memory_order_relaxed) != NoBlock) {
+			uint32_t blockIndex = cache.blockIndex.exchange(NoBlock, std::memory_order_acquire);
+			if (blockIndex != NoBlock) {
+				return blockIndex;
+			}
+		}
+	}
+	return NoBlock;
+}
+
+
+void ConcurrentSlabAllocatorEngine::ReleaseBlock(uint32_t blockIndex) {
+	// A slot freed between the two steps is caught either here or by OnSlotsFreed.
+	Block& block = GetBlock(blockIndex);
+	block.listed.store(false);
+	if (block.occupancy.load() != FullMask) {
+		bool expected = false;
+		if (block.listed.compare_exchange_strong(expected, true)) {
+			PushFreeBlocks(blockIndex, blockIndex);
+		}
+	}
+}
+
+
+void ConcurrentSlabAllocatorEngine::OnSlotsFreed(uint32_t blockIndex, uint64_t previousOccupancy) {
+	// Blocks that still had free slots are listed already.
+	if (previousOccupancy == FullMask) {
+		Block& block = GetBlock(blockIndex);
+		bool expected = false;
+		if (block.listed.compare_exchange_strong(expected, true)) {
+			PushFreeBlocks(blockIndex, blockIndex);
+		}
+	}
+}
+
+
+uint64_t ConcurrentSlabAllocatorEngine::ValidSlotMask(size_t poolSize, uint32_t blockIndex) {
+	size_t blockStart = size_t(blockIndex) * SlotsPerBlock;
+	if (poolSize >= blockStart + SlotsPerBlock) {
+		return FullMask;
+	}
+	if (poolSize <= blockStart) {
+		return 0;
+	}
+	return (uint64_t(1) << (poolSize - blockStart)) - 1;
+}
+
+
+} // namespace inl
@@ -0,0 +1,57 @@
+#include <InlineLib/Memory/FrameRingAllocator.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <algorithm>
+
+
+namespace inl {
+
+
+FrameRingAllocator::FrameRingAllocator(size_t size, const jobs::Fence& fence, size_t granularity, std::pmr::memory_resource* upstream)
+	: m_engine(granularity > 0 ? size / granularity : 0),
+	  m_buffer(nullptr, BufferDeleter{ upstream, m_engine.Size() * granularity, granularity }),
+	  m_fence(fence),
+	  m_granularity(granularity),
+	  m_allocations(m_engine.Size()) {
+	if (granularity == 0 || (granularity & (granularity - 1)) != 0) {
+		throw InvalidArgumentException("Granularity must be a power of two.");
+	}
+	m_buffer.reset(static_cast<std::byte*>(upstream->allocate(m_engine.Size() * granularity, granularity)));
+}
+
+
+void* FrameRingAllocator::Allocate(size_t size, size_t alignment, uint64_t fenceValue) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		throw InvalidArgumentException("Alignment must be a power of two.");
+	}
+
+	// cells are aligned to the granularity, larger alignments need some padding
+	size_t padding = alignment > m_granularity ? alignment - m_granularity : 0;
+	size_t cellCount = std::max((size + padding + m_granularity - 1) / m_granularity, size_t(1));
+
+	// reclaiming up front is cheap, it's one look at the fence when the oldest allocation is still in use
+	Reclaim();
+	size_t cellIndex = m_engine.Allocate(cellCount);
+
+	size_t slot = (m_firstAllocation + m_allocationCount) % m_allocations.size();
+	m_allocations[slot] = { cellIndex, fenceValue };
+	++m_allocationCount;
+
+	uintptr_t address = reinterpret_cast<uintptr_t>(m_buffer.get() + cellIndex * m_granularity);
+	address = (address + alignment - 1) & ~uintptr_t(alignment - 1);
+	return reinterpret_cast<void*>(address);
+}
+
+
+void FrameRingAllocator::Reclaim() {
+	uint64_t completedValue = m_fence.GetValue();
+	while (m_allocationCount > 0 && m_allocations[m_firstAllocation].fenceValue <= completedValue) {
+		m_engine.Deallocate(m_allocations[m_firstAllocation].cellIndex);
+		m_firstAllocation = (m_firstAllocation + 1) % m_allocations.size();
+		--m_allocationCount;
+	}
+}
+
+
+} // namespace inl
@@ -0,0 +1,345 @@
+#include <InlineLib/Memory/HeapProfiler.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/StackTrace.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+
+namespace inl {
+
+
+namespace {
+	constexpr size_t StackTableSize = 4096; // Power of two.
+	constexpr size_t OverflowStack = StackTableSize; // Extra record for samples whose stack didn't fit.
+	constexpr size_t MaxStackProbes = 64;
+
+	struct StackRecord {
+		std::atomic_uint64_t hash; // Zero while the record is free.
+		std::atomic_bool ready; // Set once the frames are written.
+		uint32_t depth;
+		void* frames[HeapProfiler::MaxStackDepth];
+		std::atomic_uint64_t samples;
+		std::atomic_uint64_t allocations;
+		std::atomic_uint64_t allocatedBytes;
+		std::atomic_int64_t liveAllocations;
+		std::atomic_int64_t liveBytes;
+	};
+
+	// Sampled pointers are kept in buckets that fit a cache line, so that checking whether a
+	// freed pointer was sampled touches a single line and there are no probe chains to maintain.
+	constexpr size_t LiveBucketCount = 8192; // Power of two.
+	constexpr size_t LiveBucketWays = 8;
+	constexpr uintptr_t EmptySlot = 0;
+	constexpr uintptr_t ReservedSlot = 1; // Claimed by an inserting thread that hasn't published the address yet.
+
+	struct alignas(64) LiveBucket {
+		std::atomic<uintptr_t> addresses[LiveBucketWays];
+	};
+
+	struct LiveSample {
+		uint32_t stack;
+		uint64_t allocations;
+		uint64_t bytes;
+	};
+
+	StackRecord stackTable[StackTableSize + 1];
+	LiveBucket liveBuckets[LiveBucketCount];
+	std::atomic_uint8_t liveBucketFill[LiveBucketCount]; // Small enough to stay in cache, most frees only look here.
+	LiveSample liveSamples[LiveBucketCount * LiveBucketWays];
+
+	std::atomic_size_t currentSamplingInterval = HeapProfiler::DefaultSamplingInterval;
+	std::atomic_uint64_t sampleCount = 0;
+	std::atomic_uint64_t droppedStacks = 0;
+	std::atomic_uint64_t droppedLiveSamples = 0;
+
+	// Plain thread_locals, they are accessed from inside operator new.
+	thread_local uint64_t t_randomState = 0;
+	thread_local bool t_inProfiler = false;
+
+
+	uint64_t NextRandom() noexcept {
+		// xorshift64*
+		t_randomState ^= t_randomState >> 12;
+		t_randomState ^= t_randomState << 25;
+		t_randomState ^= t_randomState >> 27;
+		return t_randomState * 0x2545F4914F6CDD1Dull;
+	}
+
+	void SeedRandom() noexcept {
+		uint64_t seed = uint64_t(std::chrono::steady_clock::now().time_since_epoch().count())
+						^ uint64_t(reinterpret_cast<uintptr_t>(&t_randomState));
+		// splitmix64 finalizer, so that similar seeds give different sequences.
+		seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ull;
+		seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBull;
+		t_randomState = (seed ^ (seed >> 31)) | 1;
+	}
+
+	// Distance to the next sample, exponentially distributed with the sampling interval as mean.
+	int64_t DrawSampleDistance(size_t interval) noexcept {
+		double uniform = double((NextRandom() >> 11) + 1) * 0x1.0p-53; // (0, 1]
+		return int64_t(-std::log(uniform) * double(interval)) + 1;
+	}
+
+	uint64_t HashFrames(void* const* frames, size_t depth) noexcept {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (size_t i = 0; i < depth; ++i) {
+			hash = (hash ^ uint64_t(reinterpret_cast<uintptr_t>(frames[i]))) * 0x100000001B3ull;
+		}
+		hash ^= hash >> 29;
+		return hash != 0 ? hash : 1;
+	}
+
+	size_t LiveBucketOf(uintptr_t address) noexcept {
+		return size_t((uint64_t(address) * 0x9E3779B97F4A7C15ull) >> 32) & (LiveBucketCount - 1);
+	}
+
+	// Finds the record of the stack, or claims a free one for it.
+	// Two different stacks with the same 64-bit hash are counted together.
+	size_t FindOrInsertStack(void* const* frames, size_t depth) noexcept {
+		uint64_t hash = HashFrames(frames, depth);
+		size_t index = size_t(hash) & (StackTableSize - 1);
+		for (size_t probe = 0; probe < MaxStackProbes; ++probe) {
+			StackRecord& record = stackTable[index];
+			uint64_t current = record.hash.load(std::memory_order_acquire);
+			if (current == 0 && record.hash.compare_exchange_strong(current, hash, std::memory_order_acq_rel)) {
+				record.depth = uint32_t(depth);
+				std::copy(frames, frames + depth, record.frames);
+				record.ready.store(true, std::memory_order_release);
+				return index;
+			}
+			if (current == hash) {
+				return index;
+			}
+			index = (index + 1) & (StackTableSize - 1);
+		}
+		droppedStacks.fetch_add(1, std::memory_order_relaxed);
+		return OverflowStack;
+	}
+
+	bool InsertLiveSample(uintptr_t address, const LiveSample& sample) noexcept {
+		size_t bucket = LiveBucketOf(address);
+		for (size_t way = 0; way < LiveBucketWays; ++way) {
+			auto& slot = liveBuckets[bucket].addresses[way];
+			uintptr_t current = slot.load(std::memory_order_relaxed);
+			if (current == EmptySlot && slot.compare_exchange_strong(current, ReservedSlot, std::memory_order_acquire)) {
+				liveBucketFill[bucket].fetch_add(1, std::memory_order_relaxed);
+				liveSamples[bucket * LiveBucketWays + way] = sample;
+				slot.store(address, std::memory_order_release);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	HeapProfileEntry MakeEntry(size_t index) {
+		const StackRecord& record = stackTable[index];
+		HeapProfileEntry entry;
+		if (index != OverflowStack) {
+			entry.frames.assign(record.frames, record.frames + record.depth);
+		}
+		entry.samples = record.samples.load(std::memory_order_relaxed);
+		entry.allocations = record.allocations.load(std::memory_order_relaxed);
+		entry.allocatedBytes = record.allocatedBytes.load(std::memory_order_relaxed);
+		entry.liveAllocations = uint64_t(std::max(int64_t(0), record.liveAllocations.load(std::memory_order_relaxed)));
+		entry.liveBytes = uint64_t(std::max(int64_t(0), record.liveBytes.load(std::memory_order_relaxed)));
+		return entry;
+	}
+
+	template <class Filter, class Key>
+	std::vector<HeapProfileEntry> CollectEntries(size_t count, Filter filter, Key key) {
+		std::vector<HeapProfileEntry> entries;
+		for (size_t index = 0; index <= StackTableSize; ++index) {
+			if (index == OverflowStack || stackTable[index].ready.load(std::memory_order_acquire)) {
+				HeapProfileEntry entry = MakeEntry(index);
+				if (filter(entry)) {
+					entries.push_back(std::move(entry));
+				}
+			}
+		}
+		auto compare = [&key](const HeapProfileEntry& lhs, const HeapProfileEntry& rhs) { return key(lhs) > key(rhs); };
+		count = std::min(count, entries.size());
+		std::partial_sort(entries.begin(), entries.begin() + count, entries.end(), compare);
+		entries.resize(count);
+		return entries;
+	}
+
+	void DumpEntries(std::ostream& os, const std::vector<HeapProfileEntry>& entries) {
+		for (size_t i = 0; i < entries.size(); ++i) {
+			const HeapProfileEntry& entry = entries[i];
+			os << "#" << i + 1 << ": " << entry.allocatedBytes << " bytes in " << entry.allocations << " allocations ("
+			   << entry.samples << " samples), " << entry.liveBytes << " bytes live in " << entry.liveAllocations << " allocations\n";
+			if (entry.frames.empty()) {
+				os << "\t<stacks that didn't fit the table>\n";
+			}
+			for (void* address : entry.frames) {
+				os << "\t" << ResolveStackFrame(address) << "\n";
+			}
+		}
+	}
+} // namespace
+
+
+void HeapProfiler::Start(size_t samplingInterval) {
+	if (samplingInterval == 0) {
+		throw InvalidArgumentException("Sampling interval must be at least one byte.");
+	}
+	// The unwinder may allocate when first used, get that over with outside of operator new.
+	t_inProfiler = true;
+	void* frames[MaxStackDepth];
+	CaptureStackAddresses(frames, MaxStackDepth);
+	t_inProfiler = false;
+
+	currentSamplingInterval.store(samplingInterval, std::memory_order_relaxed);
+	s_running.store(true, std::memory_order_release);
+}
+
+
+void HeapProfiler::Stop() {
+	s_running.store(false, std::memory_order_release);
+}
+
+
+bool HeapProfiler::IsRunning() {
+	return s_running.load(std::memory_order_acquire);
+}
+
+
+size_t HeapProfiler::GetSamplingInterval() {
+	return currentSamplingInterval.load(std::memory_order_relaxed);
+}
+
+
+void HeapProfiler::Reset() {
+	for (auto& record : stackTable) {
+		record.samples.store(0, std::memory_order_relaxed);
+		record.allocations.store(0, std::memory_order_relaxed);
+		record.allocatedBytes.store(0, std::memory_order_relaxed);
+	}
+	sampleCount.store(0, std::memory_order_relaxed);
+	droppedStacks.store(0, std::memory_order_relaxed);
+	droppedLiveSamples.store(0, std::memory_order_relaxed);
+}
+
+
+std::vector<HeapProfileEntry> HeapProfiler::GetTopAllocators(size_t count) {
+	return CollectEntries(
+		count,
+		[](const HeapProfileEntry& entry) { return entry.samples > 0; },
+		[](const HeapProfileEntry& entry) { return entry.allocatedBytes; });
+}
+
+
+std::vector<HeapProfileEntry> HeapProfiler::GetLiveHeap(size_t count) {
+	return CollectEntries(
+		count,
+		[](const HeapProfileEntry& entry) { return entry.liveAllocations > 0; },
+		[](const HeapProfileEntry& entry) { return entry.liveBytes; });
+}
+
+
+HeapProfilerStats HeapProfiler::GetStats() {
+	HeapProfilerStats stats;
+	stats.samples = sampleCount.load(std::memory_order_relaxed);
+	stats.liveSamples = s_liveSamples.load(std::memory_order_relaxed);
+	stats.droppedStacks = droppedStacks.load(std::memory_order_relaxed);
+	stats.droppedLiveSamples = droppedLiveSamples.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
+void HeapProfiler::DumpTopAllocators(std::ostream& os, size_t count) {
+	auto entries = GetTopAllocators(count);
+	os << "Top " << entries.size() << " allocating stacks, sampling interval " << GetSamplingInterval() << " bytes\n";
+	DumpEntries(os, entries);
+}
+
+
+void HeapProfiler::DumpLiveHeap(std::ostream& os, size_t count) {
+	auto entries = GetLiveHeap(count);
+	uint64_t totalBytes = 0;
+	for (const auto& entry : GetLiveHeap()) {
+		totalBytes += entry.liveBytes;
+	}
+	os << "Live heap: " << totalBytes << " bytes, top " << entries.size() << " stacks, sampling interval " << GetSamplingInterval() << " bytes\n";
+	DumpEntries(os, entries);
+}
+
+
+void HeapProfiler::SampleAllocation(void* ptr, size_t size) noexcept {
+	size_t interval = currentSamplingInterval.load(std::memory_order_relaxed);
+	if (t_randomState == 0) {
+		// First time the countdown ran out on this thread, it wasn't started yet.
+		SeedRandom();
+		t_bytesUntilSample += DrawSampleDistance(interval);
+		if (t_bytesUntilSample >= 0) {
+			return;
+		}
+	}
+	// A large allocation may span several sampling points, but it's sampled only once, with a matching weight.
+	t_bytesUntilSample = DrawSampleDistance(interval);
+
+	// Allocations made while taking a sample are not sampled themselves.
+	if (t_inProfiler || !ptr) {
+		return;
+	}
+	t_inProfiler = true;
+
+	void* frames[MaxStackDepth];
+	size_t depth = CaptureStackAddresses(frames, MaxStackDepth, 1);
+	size_t stack = FindOrInsertStack(frames, depth);
+
+	// The allocation is sampled with probability 1 - e^(-size/interval), it stands for 1/probability allocations like it.
+	double probability = -std::expm1(-double(std::max(size, size_t(1))) / double(interval));
+	uint64_t allocations = uint64_t(std::llround(1.0 / probability));
+	uint64_t bytes = uint64_t(std::llround(double(size) / probability));
+
+	StackRecord& record = stackTable[stack];
+	record.samples.fetch_add(1, std::memory_order_relaxed);
+	record.allocations.fetch_add(allocations, std::memory_order_relaxed);
+	record.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+	sampleCount.fetch_add(1, std::memory_order_relaxed);
+
+	record.liveAllocations.fetch_add(int64_t(allocations), std::memory_order_relaxed);
+	record.liveBytes.fetch_add(int64_t(bytes), std::memory_order_relaxed);
+	if (InsertLiveSample(reinterpret_cast<uintptr_t>(ptr), LiveSample{ uint32_t(stack), allocations, bytes })) {
+		s_liveSamples.fetch_add(1, std::memory_order_relaxed);
+	}
+	else {
+		// Can't tell when it's freed, so it doesn't count as live.
+		record.liveAllocations.fetch_sub(int64_t(allocations), std::memory_order_relaxed);
+		record.liveBytes.fetch_sub(int64_t(bytes), std::memory_order_relaxed);
+		droppedLiveSamples.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	t_inProfiler = false;
+}
+
+
+void HeapProfiler::ReleaseSample(void* ptr) noexcept {
+	uintptr_t address = reinterpret_cast<uintptr_t>(ptr);
+	size_t bucket = LiveBucketOf(address);
+	if (liveBucketFill[bucket].load(std::memory_order_relaxed) == 0) {
+		return;
+	}
+	for (size_t way = 0; way < LiveBucketWays; ++way) {
+		auto& slot = liveBuckets[bucket].addresses[way];
+		if (slot.load(std::memory_order_acquire) == address) {
+			// Only the thread freeing the pointer can get here, so the sample can be read before giving up the slot.
+			LiveSample sample = liveSamples[bucket * LiveBucketWays + way];
+			slot.store(EmptySlot, std::memory_order_release);
+			liveBucketFill[bucket].fetch_sub(1, std::memory_order_relaxed);
+			s_liveSamples.fetch_sub(1, std::memory_order_relaxed);
+
+			StackRecord& record = stackTable[sample.stack];
+			record.liveAllocations.fetch_sub(int64_t(sample.allocations), std::memory_order_relaxed);
+			record.liveBytes.fetch_sub(int64_t(sample.bytes), std::memory_order_relaxed);
+			return;
+		}
+	}
+}
+
+
+} // namespace inl
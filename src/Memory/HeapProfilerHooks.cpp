@@ -0,0 +1,130 @@
+// Replaces global operator new and delete with versions that report to the HeapProfiler and the AllocationTraceRecorder.
+// Built as a separate object library, see INL_USE_HEAP_PROFILER.
+
+#include <InlineLib/Memory/AllocationTrace.hpp>
+#include <InlineLib/Memory/HeapProfiler.hpp>
+
+#ifdef INL_HEAP_PROFILER_USE_LTALLOC
+#include <InlineLib/GlobalAlloc/ltalloc.h>
+#endif
+
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+
+using inl::AllocationTraceRecorder;
+using inl::HeapProfiler;
+
+
+namespace {
+	constexpr size_t DefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+	void* RawAllocate(size_t size, size_t alignment) noexcept {
+		size = size != 0 ? size : 1;
+#if defined(INL_HEAP_PROFILER_USE_LTALLOC)
+		return alignment <= DefaultAlignment ? ltmalloc(size) : ltmemalign(alignment, size);
+#elif defined(_WIN32)
+		return alignment <= DefaultAlignment ? std::malloc(size) : _aligned_malloc(size, alignment);
+#else
+		return alignment <= DefaultAlignment ? std::malloc(size) : std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+	}
+
+	void RawFree(void* ptr, [[maybe_unused]] size_t alignment) noexcept {
+#if defined(INL_HEAP_PROFILER_USE_LTALLOC)
+		ltfree(ptr);
+#elif defined(_WIN32)
+		alignment <= DefaultAlignment ? std::free(ptr) : _aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+
+	void* Allocate(size_t size, size_t alignment) {
+		void* ptr;
+		while (!(ptr = RawAllocate(size, alignment))) {
+			std::new_handler handler = std::get_new_handler();
+			if (!handler) {
+				throw std::bad_alloc();
+			}
+			handler();
+		}
+		HeapProfiler::OnAllocation(ptr, size);
+		AllocationTraceRecorder::OnAllocation(ptr, size);
+		return ptr;
+	}
+
+	void* AllocateNothrow(size_t size, size_t alignment) noexcept {
+		try {
+			return Allocate(size, alignment);
+		}
+		catch (...) {
+			return nullptr;
+		}
+	}
+
+	void Deallocate(void* ptr, size_t alignment) noexcept {
+		if (ptr) {
+			HeapProfiler::OnDeallocation(ptr);
+			AllocationTraceRecorder::OnDeallocation(ptr);
+			RawFree(ptr, alignment);
+		}
+	}
+
+	// Setting INL_HEAP_PROFILE_INTERVAL to a number of bytes starts the profiler before main.
+	const bool autoStart = [] {
+		if (const char* interval = std::getenv("INL_HEAP_PROFILE_INTERVAL")) {
+			size_t bytes = std::strtoull(interval, nullptr, 10);
+			HeapProfiler::Start(bytes != 0 ? bytes : HeapProfiler::DefaultSamplingInterval);
+			return true;
+		}
+		return false;
+	}();
+
+	// Setting INL_ALLOCATION_TRACE to a file path records all allocations and writes the trace at exit.
+	const char* tracePath = std::getenv("INL_ALLOCATION_TRACE");
+
+	void WriteAllocationTrace() {
+		AllocationTraceRecorder::Stop();
+		std::ofstream file(tracePath, std::ios::out | std::ios::trunc);
+		AllocationTraceRecorder::GetTrace().Write(file);
+	}
+
+	const bool autoRecord = [] {
+		if (tracePath && *tracePath) {
+			AllocationTraceRecorder::Start();
+			std::atexit(&WriteAllocationTrace);
+			return true;
+		}
+		return false;
+	}();
+} // namespace
+
+
+void* operator new(size_t size) { return Allocate(size, DefaultAlignment); }
+void* operator new[](size_t size) { return Allocate(size, DefaultAlignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return AllocateNothrow(size, DefaultAlignment); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return AllocateNothrow(size, DefaultAlignment); }
+void* operator new(size_t size, std::align_val_t alignment) { return Allocate(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return Allocate(size, size_t(alignment)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateNothrow(size, size_t(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateNothrow(size, size_t(alignment)); }
+
+void operator delete(void* ptr) noexcept { Deallocate(ptr, DefaultAlignment); }
+void operator delete[](void* ptr) noexcept { Deallocate(ptr, DefaultAlignment); }
+void operator delete(void* ptr, size_t) noexcept { Deallocate(ptr, DefaultAlignment); }
+void operator delete[](void* ptr, size_t) noexcept { Deallocate(ptr, DefaultAlignment); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { Deallocate(ptr, DefaultAlignment); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { Deallocate(ptr, DefaultAlignment); }
+void operator delete(void* ptr, std::align_val_t alignment) noexcept { Deallocate(ptr, size_t(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept { Deallocate(ptr, size_t(alignment)); }
+void operator delete(void* ptr, size_t, std::align_val_t alignment) noexcept { Deallocate(ptr, size_t(alignment)); }
+void operator delete[](void* ptr, size_t, std::align_val_t alignment) noexcept { Deallocate(ptr, size_t(alignment)); }
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { Deallocate(ptr, size_t(alignment)); }
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept { Deallocate(ptr, size_t(alignment)); }
@@ -0,0 +1,233 @@
+#include <InlineLib/Memory/HugePageResource.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+
+namespace inl {
+
+
+namespace {
+	constexpr size_t Size2MB = size_t(2) << 20;
+	constexpr size_t Size1GB = size_t(1) << 30;
+
+	size_t SystemPageSize() noexcept {
+#ifdef _WIN32
+		static const size_t pageSize = [] {
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return size_t(info.dwPageSize);
+		}();
+#else
+		static const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+#endif
+		return pageSize;
+	}
+
+	size_t RoundUp(size_t value, size_t multiple) noexcept {
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+#ifdef __linux__
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+	// Without libnuma, the constants of <numaif.h> are not available.
+	constexpr int MemoryPolicyBind = 2;
+
+	void BindToNode(void* memory, size_t size, int numaNode) noexcept {
+		constexpr size_t maskBits = 1024;
+		unsigned long mask[maskBits / (8 * sizeof(unsigned long))] = {};
+		if (numaNode < 0 || size_t(numaNode) >= maskBits) {
+			return;
+		}
+		mask[numaNode / (8 * sizeof(unsigned long))] |= 1ul << (numaNode % (8 * sizeof(unsigned long)));
+		// Fails on kernels without NUMA support, the memory is just not bound then.
+		syscall(SYS_mbind, memory, size, MemoryPolicyBind, mask, maskBits, 0);
+	}
+#endif
+} // namespace
+
+
+HugePageResource::HugePageResource(ePageSize pageSize, bool prefault, int numaNode)
+	: m_pageSizeType(pageSize), m_prefault(prefault), m_numaNode(numaNode) {
+	switch (pageSize) {
+		case ePageSize::NORMAL: m_pageSize = SystemPageSize(); break;
+		case ePageSize::HUGE_2MB: m_pageSize = Size2MB; break;
+		case ePageSize::HUGE_1GB: m_pageSize = Size1GB; break;
+	}
+}
+
+
+HugePageStats HugePageResource::GetStats() const noexcept {
+	return { m_explicitBytes.load(std::memory_order_relaxed),
+			 m_transparentBytes.load(std::memory_order_relaxed),
+			 m_normalBytes.load(std::memory_order_relaxed) };
+}
+
+
+size_t HugePageResource::GetGranularity(const std::pmr::memory_resource* resource) noexcept {
+	auto pageResource = dynamic_cast<const HugePageResource*>(resource);
+	return pageResource ? pageResource->GetPageSize() : 1;
+}
+
+
+size_t HugePageResource::MappingSize(size_t bytes) const noexcept {
+	return RoundUp(std::max(bytes, size_t(1)), m_pageSize);
+}
+
+
+void HugePageResource::Prefault(void* memory, size_t size) const noexcept {
+#ifdef MADV_POPULATE_WRITE
+	if (madvise(memory, size, MADV_POPULATE_WRITE) == 0) {
+		return;
+	}
+#endif
+	// Fresh pages are zero, writing zeros faults them in without changing anything.
+	auto bytes = static_cast<volatile std::byte*>(memory);
+	for (size_t offset = 0; offset < size; offset += SystemPageSize()) {
+		bytes[offset] = std::byte(0);
+	}
+}
+
+
+#ifdef _WIN32
+
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment) {
+	size_t size = MappingSize(bytes);
+	HANDLE process = GetCurrentProcess();
+	DWORD node = m_numaNode >= 0 ? DWORD(m_numaNode) : NUMA_NO_PREFERRED_NODE;
+	void* memory = nullptr;
+
+	// Large pages need the SeLockMemoryPrivilege, without it this fails and normal pages are used.
+	size_t largePageSize = GetLargePageMinimum();
+	if (m_pageSizeType != ePageSize::NORMAL && largePageSize != 0 && alignment <= largePageSize) {
+		size_t largeSize = RoundUp(size, largePageSize);
+		memory = VirtualAllocExNuma(process, nullptr, largeSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+		if (memory) {
+			m_explicitBytes.fetch_add(largeSize, std::memory_order_relaxed);
+			return memory; // Large pages are always resident.
+		}
+	}
+
+	// Normal pages, aligned to the huge page size like on other platforms.
+	// VirtualAlloc aligns to the allocation granularity, 64 KiB, and nothing more. For more, a larger range
+	// is reserved to find an aligned address in it, then released and mapped again at that address.
+	// Another thread may take the range in between, so it's retried a few times.
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	size_t alignTo = std::max(alignment, m_pageSize);
+	if (alignTo <= info.dwAllocationGranularity) {
+		memory = VirtualAllocExNuma(process, nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+	}
+	else {
+		constexpr int maxAttempts = 8;
+		for (int attempt = 0; attempt < maxAttempts && !memory; ++attempt) {
+			void* reservation = VirtualAllocExNuma(process, nullptr, size + alignTo, MEM_RESERVE, PAGE_NOACCESS, node);
+			if (!reservation) {
+				break;
+			}
+			auto aligned = reinterpret_cast<void*>(RoundUp(reinterpret_cast<uintptr_t>(reservation), alignTo));
+			VirtualFree(reservation, 0, MEM_RELEASE);
+			memory = VirtualAllocExNuma(process, aligned, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+		}
+	}
+	if (!memory) {
+		throw std::bad_alloc();
+	}
+	m_normalBytes.fetch_add(size, std::memory_order_relaxed);
+	if (m_prefault) {
+		Prefault(memory, size);
+	}
+	return memory;
+}
+
+
+void HugePageResource::do_deallocate(void* p, size_t, size_t) {
+	VirtualFree(p, 0, MEM_RELEASE);
+}
+
+#else
+
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment) {
+	size_t size = MappingSize(bytes);
+	void* memory = nullptr;
+
+#ifdef MAP_HUGETLB
+	// Reserved huge pages, 1 GiB pages fall back to 2 MiB ones. Fails right away if there aren't enough reserved.
+	if (m_pageSizeType != ePageSize::NORMAL) {
+		for (size_t hugePageSize : { Size1GB, Size2MB }) {
+			if (hugePageSize > m_pageSize || alignment > hugePageSize) {
+				continue;
+			}
+			int sizeFlag = (hugePageSize == Size1GB ? 30 : 21) << MAP_HUGE_SHIFT;
+			void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | sizeFlag, -1, 0);
+			if (mapping != MAP_FAILED) {
+				memory = mapping;
+				m_explicitBytes.fetch_add(size, std::memory_order_relaxed);
+				break;
+			}
+		}
+	}
+#endif
+
+	if (!memory) {
+		// Normal pages, aligned to the huge page size so that THP can back them fully.
+		// Map more than needed, then cut off the unaligned head and the tail.
+		size_t alignTo = std::max(alignment, m_pageSize);
+		size_t mappedSize = size + alignTo - SystemPageSize();
+		void* mapping = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED) {
+			throw std::bad_alloc();
+		}
+		auto begin = static_cast<std::byte*>(mapping);
+		auto aligned = begin + (alignTo - reinterpret_cast<uintptr_t>(begin) % alignTo) % alignTo;
+		if (aligned != begin) {
+			munmap(begin, aligned - begin);
+		}
+		if (aligned + size != begin + mappedSize) {
+			munmap(aligned + size, begin + mappedSize - (aligned + size));
+		}
+		memory = aligned;
+
+		bool transparent = false;
+#ifdef MADV_HUGEPAGE
+		transparent = m_pageSizeType != ePageSize::NORMAL && madvise(memory, size, MADV_HUGEPAGE) == 0;
+#endif
+		(transparent ? m_transparentBytes : m_normalBytes).fetch_add(size, std::memory_order_relaxed);
+	}
+
+#ifdef __linux__
+	// Before the first touch, pages are placed when they're faulted in.
+	BindToNode(memory, size, m_numaNode);
+#endif
+	if (m_prefault) {
+		Prefault(memory, size);
+	}
+	return memory;
+}
+
+
+void HugePageResource::do_deallocate(void* p, size_t bytes, size_t) {
+	munmap(p, MappingSize(bytes));
+}
+
+#endif
+
+
+} // namespace inl
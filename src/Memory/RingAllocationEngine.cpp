@@ -1,44 +1,91 @@
 #include <InlineLib/Memory/RingAllocationEngine.hpp>
 
+#include <InlineLib/BitOperations.hpp>
 #include <InlineLib/Exception/Exception.hpp>
 
+#include <algorithm>
 #include <cassert>
 
 namespace inl {
 
-RingAllocationEngine::CellContainer::CellContainer(size_t size) : m_bitset(size * CELL_SIZE) {}
+RingAllocationEngine::CellContainer::CellContainer(size_t size)
+	: m_words((size + CELLS_PER_WORD - 1) / CELLS_PER_WORD, 0), m_size(size) {}
 
 
 void RingAllocationEngine::CellContainer::Set(size_t index, eCellState value) {
-	bool first = (int(value) >> 1) != 0;
-	bool second = (int(value) & 1) != 0;
-	m_bitset[index * CELL_SIZE] = first;
-	m_bitset[index * CELL_SIZE + 1] = second;
+	uint64_t& word = m_words[index / CELLS_PER_WORD];
+	int shift = int(index % CELLS_PER_WORD) * CELL_SIZE;
+	word = (word & ~(uint64_t(3) << shift)) | (uint64_t(value) << shift);
 }
 
 
 RingAllocationEngine::eCellState RingAllocationEngine::CellContainer::At(size_t index) const {
-	uint8_t first = m_bitset[index * CELL_SIZE];
-	uint8_t second = m_bitset[index * CELL_SIZE + 1];
+	uint64_t word = m_words[index / CELLS_PER_WORD];
+	int shift = int(index % CELLS_PER_WORD) * CELL_SIZE;
+	return eCellState((word >> shift) & 3);
+}
+
+
+void RingAllocationEngine::CellContainer::Fill(size_t first, size_t last, eCellState value) {
+	const uint64_t pattern = Pattern(value);
+	while (first < last) {
+		size_t wordIndex = first / CELLS_PER_WORD;
+		size_t begin = first % CELLS_PER_WORD;
+		size_t end = std::min(CELLS_PER_WORD, begin + (last - first));
+		uint64_t mask = (end - begin == CELLS_PER_WORD ? ~uint64_t(0) : ((uint64_t(1) << ((end - begin) * CELL_SIZE)) - 1)) << (begin * CELL_SIZE);
+		m_words[wordIndex] = (m_words[wordIndex] & ~mask) | (pattern & mask);
+		first += end - begin;
+	}
+}
+
+
+template <class MatchFunc>
+size_t RingAllocationEngine::CellContainer::FindIf(size_t first, size_t last, eCellState value, MatchFunc match) const {
+	// x has both bits of a cell cleared where the cell equals value
+	const uint64_t pattern = Pattern(value);
+	while (first < last) {
+		size_t wordIndex = first / CELLS_PER_WORD;
+		size_t begin = first % CELLS_PER_WORD;
+		uint64_t x = m_words[wordIndex] ^ pattern;
+		uint64_t matches = match(x | (x >> 1)) & LOW_BITS;
+		matches &= ~uint64_t(0) << (begin * CELL_SIZE);
+		if (matches != 0) {
+			size_t found = wordIndex * CELLS_PER_WORD + CountTrailingZeros(matches) / CELL_SIZE;
+			return std::min(found, last);
+		}
+		first = (wordIndex + 1) * CELLS_PER_WORD;
+	}
+	return last;
+}
+
 
-	return eCellState((first << 1) + second);
+size_t RingAllocationEngine::CellContainer::Find(size_t first, size_t last, eCellState value) const {
+	return FindIf(first, last, value, [](uint64_t differs) { return ~differs; });
+}
+
+
+size_t RingAllocationEngine::CellContainer::FindNot(size_t first, size_t last, eCellState value) const {
+	return FindIf(first, last, value, [](uint64_t differs) { return differs; });
 }
 
 
 size_t RingAllocationEngine::CellContainer::Size() const {
-	return m_bitset.size() / CELL_SIZE;
+	return m_size;
 }
 
 
 void RingAllocationEngine::CellContainer::Resize(size_t size) {
-	m_bitset.resize(size * CELL_SIZE);
+	if (size < m_size && size % CELLS_PER_WORD != 0) {
+		// cells cut off now must be free if the container grows again
+		Fill(size, std::min(m_size, (size / CELLS_PER_WORD + 1) * CELLS_PER_WORD), eCellState::FREE);
+	}
+	m_words.resize((size + CELLS_PER_WORD - 1) / CELLS_PER_WORD, 0);
+	m_size = size;
 }
 
 
 void RingAllocationEngine::CellContainer::Reset() {
-	size_t size = m_bitset.size();
-	m_bitset.clear();
-	m_bitset.resize(size);
+	std::fill(m_words.begin(), m_words.end(), 0);
 }
 
 
@@ -61,23 +108,22 @@ size_t RingAllocationEngine::Allocate(size_t allocationSize) {
 		allocStartIndex = 0;
 	}
 
-	// check if first and last cell of allocation is free
-	// if they are, then the whole range of the allocation is free
+	// check if the whole range is free
+	// checking the first and last cells is not enough: after wrapping around, the free space
+	// is split in two, and the range could span over the oldest allocations
 	{
-		bool lastFree = m_container.At(allocStartIndex + allocationSize - 1) == eCellState::FREE;
+		size_t allocEndIndex = allocStartIndex + allocationSize;
 		bool firstFree = m_container.At(allocStartIndex) == eCellState::FREE;
-		if (!lastFree || !firstFree) {
+		if (!firstFree || m_container.FindNot(allocStartIndex, allocEndIndex, eCellState::FREE) != allocEndIndex) {
 			throw std::bad_alloc();
 		}
 	}
 
 	// mark allocated area
 	{
-		size_t end = allocationSize - 1;
-		for (size_t i = 0; i < end; i++) {
-			m_container.Set(allocStartIndex + i, eCellState::INSIDE);
-		}
-		m_container.Set(allocStartIndex + end, eCellState::END);
+		size_t end = allocStartIndex + allocationSize - 1;
+		m_container.Fill(allocStartIndex, end, eCellState::INSIDE);
+		m_container.Set(end, eCellState::END);
 	}
 
 
@@ -98,41 +144,28 @@ void RingAllocationEngine::Deallocate(size_t index) {
 	bool isPreviousInUse = m_container.At(prevIndex) != eCellState::FREE;
 	bool previousIsNotFront = index != m_nextIndex;
 
+	// allocations never wrap around the end of the pool
+	size_t end = m_container.Find(index, m_container.Size(), eCellState::END) + 1;
+	assert(end <= m_container.Size());
+
 	if (previousIsNotFront && isPreviousInUse) {
 		// there are still allocated blocks before this one
-
 		// mark all cells unused inside this allocation
-		size_t current = index;
-		bool isEnd;
-		do {
-			isEnd = m_container.At(current) == eCellState::END;
-			m_container.Set(current, eCellState::PREVIOUS_IN_USE);
-			current = (current + 1) % m_container.Size();
-		} while (!isEnd);
+		m_container.Fill(index, end, eCellState::PREVIOUS_IN_USE);
 	}
 	else {
 		// if it has no allocated space befor this one
 		// in other words if this is the last allocated range, it is time to deallocate
-
-		size_t current = index;
-
-		// lets free this allocation first
-		{
-			bool isEnd;
-			do {
-				isEnd = m_container.At(current) == eCellState::END;
-				m_container.Set(current, eCellState::FREE);
-				current = (current + 1) % m_container.Size();
-			} while (!isEnd);
-		}
+		m_container.Fill(index, end, eCellState::FREE);
 
 		// go forward, and free every cell in a contigous range starting at this cell
 		// that is in the state of "previous in use"
-		{
-			while (m_container.At(current) == eCellState::PREVIOUS_IN_USE) {
-				m_container.Set(current, eCellState::FREE);
-				current = (current + 1) % m_container.Size();
-			}
+		// with strict FIFO deallocation, the first cell is not such, and nothing more is touched
+		size_t current = end % m_container.Size();
+		while (m_container.At(current) == eCellState::PREVIOUS_IN_USE) {
+			size_t runEnd = m_container.FindNot(current, m_container.Size(), eCellState::PREVIOUS_IN_USE);
+			m_container.Fill(current, runEnd, eCellState::FREE);
+			current = runEnd % m_container.Size();
 		}
 	}
 }
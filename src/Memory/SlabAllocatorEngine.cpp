@@ -4,171 +4,204 @@
 
 #include <algorithm>
 #include <cassert>
+#include <new>
 
 
 namespace inl {
 
-SlabAllocatorEngine::SlabAllocatorEngine() : m_poolSize(0), m_blocks(), m_first(nullptr) {
+SlabAllocatorEngine::SlabAllocatorEngine() : m_poolSize(0) {
 }
 
 
 SlabAllocatorEngine::SlabAllocatorEngine(size_t poolSize)
-	: m_poolSize(poolSize), m_blocks((poolSize + SlotsPerBlock - 1) / SlotsPerBlock) {
+	: m_poolSize(poolSize), m_occupancy((poolSize + SlotsPerBlock - 1) / SlotsPerBlock) {
 	Reset();
 }
 
 
-SlabAllocatorEngine::SlabAllocatorEngine(const SlabAllocatorEngine& rhs) {
-	size_t indexOfFirst = rhs.IndexOf(rhs.m_first);
-	m_blocks = rhs.m_blocks;
-	m_first = m_blocks.data() + indexOfFirst;
-	m_poolSize = rhs.m_poolSize;
-}
+size_t SlabAllocatorEngine::Allocate() {
+	// check if not full
+	if (m_summary.empty() || m_summary.back()[0] == 0) {
+		throw std::bad_alloc();
+	}
 
-SlabAllocatorEngine::SlabAllocatorEngine(SlabAllocatorEngine&& rhs) {
-	size_t indexOfFirst = rhs.IndexOf(rhs.m_first);
-	m_blocks = std::move(rhs.m_blocks); // move blocks, not copy
-	m_first = m_blocks.data() + indexOfFirst;
-	m_poolSize = rhs.m_poolSize;
-}
+	// descend to the lowest block with a free slot
+	size_t blockIndex = 0;
+	for (auto level = m_summary.rbegin(); level != m_summary.rend(); ++level) {
+		blockIndex = blockIndex * SlotsPerBlock + CountTrailingZeros((*level)[blockIndex]);
+	}
 
-SlabAllocatorEngine& SlabAllocatorEngine::operator=(const SlabAllocatorEngine& rhs) {
-	size_t indexOfFirst = rhs.IndexOf(rhs.m_first);
-	m_blocks = rhs.m_blocks;
-	m_first = m_blocks.data() + indexOfFirst;
-	m_poolSize = rhs.m_poolSize;
+	uint64_t& occupancy = m_occupancy[blockIndex];
+	int index = CountTrailingZeros(~occupancy);
+	assert(index >= 0);
 
-	return *this;
+	bool correct = !BitTestAndSet(occupancy, index);
+	assert(correct);
+
+	if (occupancy == ~uint64_t(0)) {
+		MarkBlockFull(blockIndex);
+	}
+	return blockIndex * SlotsPerBlock + index;
 }
 
-SlabAllocatorEngine& SlabAllocatorEngine::operator=(SlabAllocatorEngine&& rhs) {
-	size_t indexOfFirst = rhs.IndexOf(rhs.m_first);
-	m_blocks = std::move(rhs.m_blocks); // move blocks, not copy
-	m_first = m_blocks.data() + indexOfFirst;
-	m_poolSize = rhs.m_poolSize;
 
-	return *this;
-}
+void SlabAllocatorEngine::Deallocate(size_t index) {
+	assert(index < m_poolSize);
+	size_t blockIndex = index / SlotsPerBlock;
+	unsigned inBlockIndex = unsigned(index % SlotsPerBlock);
 
+	uint64_t& occupancy = m_occupancy[blockIndex];
+	bool wasFull = occupancy == ~uint64_t(0);
+	bool correct = BitTestAndClear(occupancy, inBlockIndex);
+	assert(correct);
+	if (wasFull) {
+		MarkBlockFree(blockIndex);
+	}
+}
 
-size_t SlabAllocatorEngine::Allocate() {
-	// check if not full
-	if (m_first != nullptr) {
-		size_t mask = m_first->slotOccupancy;
-		mask = ~mask;
-		int index = CountTrailingZeros(mask);
 
-		assert(index >= 0);
+void SlabAllocatorEngine::Resize(size_t newPoolSize) {
+	size_t oldPoolSize = m_poolSize;
+	size_t oldBlockCount = m_occupancy.size();
+	size_t newBlockCount = (newPoolSize + SlotsPerBlock - 1) / SlotsPerBlock;
 
-		bool correct = !BitTestAndSet(m_first->slotOccupancy, index);
-		assert(correct);
+	if (newPoolSize < oldPoolSize) {
+		m_occupancy.resize(newBlockCount);
+		m_poolSize = newPoolSize;
+		if (newBlockCount > 0) {
+			m_occupancy.back() |= LockedSlotMask(newPoolSize, newBlockCount - 1);
+		}
+		RebuildSummary();
+		return;
+	}
 
-		size_t allocatedIdx = IndexOf(m_first) * SlotsPerBlock + index;
-		if (m_first->slotOccupancy == ~size_t(0)) {
-			m_first = m_first->nextBlockIndex < m_blocks.size() ? &m_blocks[m_first->nextBlockIndex] : nullptr;
+	// unlock slots of the OLD last block
+	m_poolSize = newPoolSize;
+	if (oldBlockCount > 0 && oldPoolSize % SlotsPerBlock != 0) {
+		uint64_t& last = m_occupancy.back();
+		last &= ~LockedSlotMask(oldPoolSize, oldBlockCount - 1) | LockedSlotMask(newPoolSize, oldBlockCount - 1);
+		if (last != ~uint64_t(0)) {
+			MarkBlockFree(oldBlockCount - 1);
 		}
-		return allocatedIdx;
 	}
-	else {
-		throw std::bad_alloc();
+
+	// append new blocks, existing ones are left as they are
+	if (newBlockCount > oldBlockCount) {
+		m_occupancy.resize(newBlockCount, 0);
+		m_occupancy.back() = LockedSlotMask(newPoolSize, newBlockCount - 1);
+		ExtendSummary();
+		for (size_t blockIndex = oldBlockCount; blockIndex < newBlockCount; ++blockIndex) {
+			MarkBlockFree(blockIndex);
+		}
 	}
 }
 
 
-void SlabAllocatorEngine::Deallocate(size_t index) {
-	Block* block;
-	int inBlockIndex;
-	BlockOf(index, block, inBlockIndex);
-
-	size_t prevMask = block->slotOccupancy;
-	bool correct = BitTestAndClear(block->slotOccupancy, inBlockIndex);
-	assert(correct);
-	if (prevMask == ~size_t(0) && block != m_first) {
-		block->nextBlockIndex = (m_first != nullptr ? IndexOf(m_first) : std::numeric_limits<intptr_t>::max());
-		m_first = block;
+void SlabAllocatorEngine::Reset() {
+	std::fill(m_occupancy.begin(), m_occupancy.end(), 0);
+	if (!m_occupancy.empty()) {
+		// mask out unused part of last block
+		m_occupancy.back() = LockedSlotMask(m_poolSize, m_occupancy.size() - 1);
 	}
+	RebuildSummary();
 }
 
 
-void SlabAllocatorEngine::Resize(size_t newPoolSize) {
-	if (newPoolSize > 0) {
-		// allocate space for new block list
-		std::vector<Block> newBlocks((newPoolSize + SlotsPerBlock - 1) / SlotsPerBlock);
-
-		// copy old elements
-		intptr_t indexOfLastFree = -1;
-		for (size_t i = 0; i < m_blocks.size() && i < newBlocks.size(); ++i) {
-			newBlocks[i].slotOccupancy = m_blocks[i].slotOccupancy;
-		}
-		// clear new elements
-		for (size_t i = m_blocks.size(); i < newBlocks.size(); ++i) {
-			newBlocks[i].slotOccupancy = 0;
+size_t SlabAllocatorEngine::AllocatedExtent() const {
+	for (size_t blockIndex = m_occupancy.size(); blockIndex > 0; --blockIndex) {
+		uint64_t occupancy = m_occupancy[blockIndex - 1] & ~LockedSlotMask(m_poolSize, blockIndex - 1);
+		if (occupancy != 0) {
+			return (blockIndex - 1) * SlotsPerBlock + SlotsPerBlock - CountLeadingZeros(occupancy);
 		}
+	}
+	return 0;
+}
 
-		// unlock slots of the OLD last block
-		if (m_blocks.size() > 0 && newPoolSize > m_poolSize) {
-			auto last = &newBlocks[m_blocks.size() - 1];
-			int numLastSlots = (m_poolSize % SlotsPerBlock);
-			last->slotOccupancy &= ~size_t(0) >> (sizeof(size_t) * 8 - numLastSlots);
-		}
 
-		// lock last slots of the NEW last block
-		{
-			auto last = &newBlocks[newBlocks.size() - 1];
-			int numLastSlots = newPoolSize % SlotsPerBlock;
-			last->slotOccupancy |= numLastSlots > 0 ? (~size_t(0) << numLastSlots) : 0;
+void SlabAllocatorEngine::MarkBlockFree(size_t blockIndex) {
+	// stop at the first level where the word already had a bit set, levels above know it's not empty
+	size_t index = blockIndex;
+	for (auto& level : m_summary) {
+		uint64_t& word = level[index / SlotsPerBlock];
+		bool wasEmpty = word == 0;
+		word |= uint64_t(1) << (index % SlotsPerBlock);
+		if (!wasEmpty) {
+			break;
 		}
+		index /= SlotsPerBlock;
+	}
+}
 
-		// create free blocks chain
-		intptr_t prevFree = std::numeric_limits<intptr_t>::max();
-		for (intptr_t i = newBlocks.size() - 1; i >= 0; --i) {
-			if (newBlocks[i].slotOccupancy < ~size_t(0)) {
-				newBlocks[i].nextBlockIndex = prevFree;
-				prevFree = i;
-			}
-			else {
-				newBlocks[i].nextBlockIndex = std::numeric_limits<intptr_t>::max();
-			}
-		}
 
-		// commit new storage space
-		m_blocks = std::move(newBlocks);
-		m_first = prevFree < (intptr_t)m_blocks.size() ? m_blocks.data() + prevFree : nullptr;
-		m_poolSize = newPoolSize;
-	}
-	else {
-		m_blocks.clear();
-		m_first = nullptr;
-		m_poolSize = 0;
+void SlabAllocatorEngine::MarkBlockFull(size_t blockIndex) {
+	// stop at the first level where the word still has bits set
+	size_t index = blockIndex;
+	for (auto& level : m_summary) {
+		uint64_t& word = level[index / SlotsPerBlock];
+		word &= ~(uint64_t(1) << (index % SlotsPerBlock));
+		if (word != 0) {
+			break;
+		}
+		index /= SlotsPerBlock;
 	}
 }
 
 
-void SlabAllocatorEngine::Reset() {
-	// chain all blocks into free list and reset occupancy
-	for (size_t idx = 0; idx < m_blocks.size(); ++idx) {
-		m_blocks[idx].nextBlockIndex = idx + 1;
-		m_blocks[idx].slotOccupancy = 0;
+void SlabAllocatorEngine::RebuildSummary() {
+	m_summary.clear();
+	if (m_occupancy.empty()) {
+		return;
 	}
-	if (!m_blocks.empty()) {
-		m_blocks.back().nextBlockIndex = std::numeric_limits<intptr_t>::max();
+
+	std::vector<uint64_t> level((m_occupancy.size() + SlotsPerBlock - 1) / SlotsPerBlock, 0);
+	for (size_t blockIndex = 0; blockIndex < m_occupancy.size(); ++blockIndex) {
+		if (m_occupancy[blockIndex] != ~uint64_t(0)) {
+			level[blockIndex / SlotsPerBlock] |= uint64_t(1) << (blockIndex % SlotsPerBlock);
+		}
 	}
+	m_summary.push_back(std::move(level));
+	ExtendSummary();
+}
 
-	// get first and last blocks
-	if (m_blocks.size() > 0) {
-		m_first = &m_blocks[0];
-		auto last = &m_blocks[m_blocks.size() - 1];
 
-		// mask out unused part of last block
-		int numLastSlots = (m_poolSize % SlotsPerBlock);
-		if (numLastSlots != 0) {
-			last->slotOccupancy = ~size_t(0) << numLastSlots;
+void SlabAllocatorEngine::ExtendSummary() {
+	// grow existing levels with empty words, they get filled as new blocks are marked free
+	size_t count = m_occupancy.size();
+	size_t levelIndex = 0;
+	do {
+		count = (count + SlotsPerBlock - 1) / SlotsPerBlock;
+		if (levelIndex < m_summary.size()) {
+			m_summary[levelIndex].resize(count, 0);
 		}
+		else if (m_summary.empty()) {
+			m_summary.emplace_back(count, 0);
+		}
+		else {
+			// a new top level is computed from the level below it
+			const auto& below = m_summary.back();
+			std::vector<uint64_t> level(count, 0);
+			for (size_t i = 0; i < below.size(); ++i) {
+				if (below[i] != 0) {
+					level[i / SlotsPerBlock] |= uint64_t(1) << (i % SlotsPerBlock);
+				}
+			}
+			m_summary.push_back(std::move(level));
+		}
+		++levelIndex;
+	} while (count > 1);
+}
+
+
+uint64_t SlabAllocatorEngine::LockedSlotMask(size_t poolSize, size_t blockIndex) {
+	size_t blockStart = blockIndex * SlotsPerBlock;
+	if (poolSize >= blockStart + SlotsPerBlock) {
+		return 0;
 	}
-	else {
-		m_first = nullptr;
+	if (poolSize <= blockStart) {
+		return ~uint64_t(0);
 	}
+	return ~uint64_t(0) << (poolSize - blockStart);
 }
 
 
-} // namespace inl
\ No newline at end of file
+} // namespace inl
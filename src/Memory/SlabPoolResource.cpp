@@ -0,0 +1,116 @@
+#include <InlineLib/Memory/SlabPoolResource.hpp>
+
+#include <InlineLib/BitOperations.hpp>
+#include <InlineLib/Memory/HugePageResource.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+
+namespace inl {
+
+
+SlabPoolResource::SlabPoolResource(size_t maxBlockSize, std::pmr::memory_resource* upstream)
+	: m_upstream(upstream), m_chunkGranularity(HugePageResource::GetGranularity(upstream)) {
+	do {
+		m_sizeClasses.emplace_back();
+	} while (BlockSize(m_sizeClasses.size() - 1) < maxBlockSize);
+}
+
+
+SlabPoolResource::~SlabPoolResource() {
+	Release();
+}
+
+
+void SlabPoolResource::Release() noexcept {
+	for (size_t classIndex = 0; classIndex < m_sizeClasses.size(); ++classIndex) {
+		SizeClass& sizeClass = m_sizeClasses[classIndex];
+		size_t blockSize = BlockSize(classIndex);
+		for (size_t chunkIndex = 0; chunkIndex < sizeClass.chunks.size(); ++chunkIndex) {
+			size_t slotCount = (chunkIndex + 1 < sizeClass.chunks.size() ? sizeClass.firstSlots[chunkIndex + 1] : sizeClass.engine.Size())
+							   - sizeClass.firstSlots[chunkIndex];
+			m_upstream->deallocate(sizeClass.chunks[chunkIndex], slotCount * blockSize, blockSize);
+		}
+		sizeClass = SizeClass{};
+	}
+}
+
+
+void* SlabPoolResource::do_allocate(size_t bytes, size_t alignment) {
+	size_t classIndex = SizeClassIndex(bytes, alignment);
+	if (classIndex >= m_sizeClasses.size()) {
+		return m_upstream->allocate(bytes, alignment);
+	}
+
+	SizeClass& sizeClass = m_sizeClasses[classIndex];
+	size_t slot;
+	try {
+		slot = sizeClass.engine.Allocate();
+	}
+	catch (std::bad_alloc&) {
+		AddChunk(classIndex);
+		slot = sizeClass.engine.Allocate();
+	}
+
+	auto chunkIt = std::upper_bound(sizeClass.firstSlots.begin(), sizeClass.firstSlots.end(), slot) - 1;
+	size_t chunkIndex = chunkIt - sizeClass.firstSlots.begin();
+	return sizeClass.chunks[chunkIndex] + (slot - *chunkIt) * BlockSize(classIndex);
+}
+
+
+void SlabPoolResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+	size_t classIndex = SizeClassIndex(bytes, alignment);
+	if (classIndex >= m_sizeClasses.size()) {
+		m_upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+
+	// chunks double in size, so there are only a few of them to look through
+	SizeClass& sizeClass = m_sizeClasses[classIndex];
+	size_t blockSize = BlockSize(classIndex);
+	auto ptr = static_cast<std::byte*>(p);
+	for (size_t chunkIndex = sizeClass.chunks.size(); chunkIndex-- > 0;) {
+		std::byte* chunk = sizeClass.chunks[chunkIndex];
+		if (chunk <= ptr) {
+			size_t slotInChunk = (ptr - chunk) / blockSize;
+			size_t slotCount = (chunkIndex + 1 < sizeClass.chunks.size() ? sizeClass.firstSlots[chunkIndex + 1] : sizeClass.engine.Size())
+							   - sizeClass.firstSlots[chunkIndex];
+			if (slotInChunk < slotCount) {
+				sizeClass.engine.Deallocate(sizeClass.firstSlots[chunkIndex] + slotInChunk);
+				return;
+			}
+		}
+	}
+	assert(false && "Pointer was not allocated from this resource.");
+}
+
+
+size_t SlabPoolResource::SizeClassIndex(size_t bytes, size_t alignment) const noexcept {
+	size_t size = std::max({ bytes, alignment, MinBlockSize });
+	if (size > BlockSize(m_sizeClasses.size() - 1)) {
+		return m_sizeClasses.size();
+	}
+	// index of the smallest power of two that is not less than size, relative to MinBlockSize
+	int log2 = 64 - CountLeadingZeros(uint64_t(size - 1));
+	return size_t(log2 - CountTrailingZeros(uint64_t(MinBlockSize)));
+}
+
+
+void SlabPoolResource::AddChunk(size_t sizeClassIndex) {
+	SizeClass& sizeClass = m_sizeClasses[sizeClassIndex];
+	size_t blockSize = BlockSize(sizeClassIndex);
+	size_t slotCount = std::max(MinChunkSlots, sizeClass.engine.Size());
+	if (m_chunkGranularity > blockSize) {
+		slotCount = (slotCount * blockSize + m_chunkGranularity - 1) / m_chunkGranularity * m_chunkGranularity / blockSize;
+	}
+
+	auto chunk = static_cast<std::byte*>(m_upstream->allocate(slotCount * blockSize, blockSize));
+	sizeClass.chunks.push_back(chunk);
+	sizeClass.firstSlots.push_back(sizeClass.engine.Size());
+	sizeClass.engine.Resize(sizeClass.engine.Size() + slotCount);
+}
+
+
+} // namespace inl
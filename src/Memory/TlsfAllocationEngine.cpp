@@ -0,0 +1,298 @@
+#include <InlineLib/Memory/TlsfAllocationEngine.hpp>
+
+#include <InlineLib/BitOperations.hpp>
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+
+namespace inl {
+
+
+struct TlsfAllocationEngine::BlockHeader {
+	BlockHeader* previousPhysical; // Null for the first block.
+	size_t sizeAndFlags; // Size of the payload, which follows the header. The lowest bit is set if the block is free.
+	// Only valid in free blocks, they take the place of the payload.
+	BlockHeader* nextFree;
+	BlockHeader* previousFree;
+
+	static constexpr size_t FreeFlag = 1;
+
+	size_t Size() const { return sizeAndFlags & ~FreeFlag; }
+	void SetSize(size_t size) { sizeAndFlags = size | (sizeAndFlags & FreeFlag); }
+	bool IsFree() const { return (sizeAndFlags & FreeFlag) != 0; }
+	void SetFree(bool free) { sizeAndFlags = free ? sizeAndFlags | FreeFlag : sizeAndFlags & ~FreeFlag; }
+
+	std::byte* Payload() { return reinterpret_cast<std::byte*>(this) + HeaderSize; }
+	BlockHeader* NextPhysical() { return reinterpret_cast<BlockHeader*>(Payload() + Size()); }
+	static BlockHeader* FromPayload(const void* ptr) {
+		return reinterpret_cast<BlockHeader*>(const_cast<std::byte*>(static_cast<const std::byte*>(ptr)) - HeaderSize);
+	}
+
+	static constexpr size_t HeaderSize = 2 * sizeof(void*); // The free list links are not part of the overhead.
+	static constexpr size_t MinPayload = 2 * sizeof(void*);
+};
+
+
+namespace {
+	int FloorLog2(size_t value) {
+		return 63 - CountLeadingZeros(uint64_t(value));
+	}
+
+	size_t AlignUp(size_t value, size_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	std::byte* AlignUp(std::byte* ptr, size_t alignment) {
+		return reinterpret_cast<std::byte*>(AlignUp(reinterpret_cast<uintptr_t>(ptr), alignment));
+	}
+} // namespace
+
+
+TlsfAllocationEngine::TlsfAllocationEngine() {
+}
+
+
+TlsfAllocationEngine::TlsfAllocationEngine(void* memory, size_t size) {
+	Reset(memory, size);
+}
+
+
+void* TlsfAllocationEngine::Allocate(size_t size, size_t alignment) {
+	constexpr size_t HeaderSize = BlockHeader::HeaderSize;
+	constexpr size_t MinPayload = BlockHeader::MinPayload;
+
+	if (size == 0) {
+		throw InvalidArgumentException("Allocation size should be non-zero.");
+	}
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		throw InvalidArgumentException("Alignment must be a power of two.");
+	}
+	if (size >= MaxBlockSize || alignment >= MaxBlockSize) {
+		throw std::bad_alloc();
+	}
+
+	size_t payload = AlignUp(std::max(size, MinPayload), MinAlignment);
+	// With a larger alignment, the head of the block may have to be cut off. The head must be able
+	// to hold a free block, so in the worst case, alignment + a minimal block is wasted.
+	size_t gapMinimum = HeaderSize + MinPayload;
+	size_t searchSize = alignment > MinAlignment ? payload + alignment + gapMinimum : payload;
+
+	BlockHeader* block = FindFree(searchSize);
+	if (!block) {
+		throw std::bad_alloc();
+	}
+	RemoveFree(block);
+
+	if (alignment > MinAlignment) {
+		std::byte* data = block->Payload();
+		std::byte* aligned = AlignUp(data, alignment);
+		if (aligned != data && size_t(aligned - data) < gapMinimum) {
+			aligned = AlignUp(data + gapMinimum, alignment);
+		}
+		if (aligned != data) {
+			BlockHeader* head = block;
+			block = SplitBlock(head, size_t(aligned - data) - HeaderSize);
+			InsertFree(head);
+		}
+	}
+
+	if (block->Size() >= payload + HeaderSize + MinPayload) {
+		InsertFree(SplitBlock(block, payload));
+	}
+	block->SetFree(false);
+
+	m_allocatedSize += block->Size();
+	++m_allocationCount;
+	return block->Payload();
+}
+
+
+void TlsfAllocationEngine::Deallocate(void* ptr) {
+	if (!Owns(ptr) || reinterpret_cast<uintptr_t>(ptr) % MinAlignment != 0) {
+		throw InvalidArgumentException("Pointer was not allocated from this engine.");
+	}
+	BlockHeader* block = BlockHeader::FromPayload(ptr);
+	if (block->IsFree()) {
+		throw InvalidArgumentException("Block is already free.");
+	}
+
+	m_allocatedSize -= block->Size();
+	--m_allocationCount;
+	block->SetFree(true);
+
+	BlockHeader* next = block->NextPhysical();
+	if (next->IsFree()) {
+		RemoveFree(next);
+		block = Merge(block, next);
+	}
+	BlockHeader* previous = block->previousPhysical;
+	if (previous && previous->IsFree()) {
+		RemoveFree(previous);
+		block = Merge(previous, block);
+	}
+	InsertFree(block);
+}
+
+
+size_t TlsfAllocationEngine::AllocationSize(const void* ptr) noexcept {
+	return BlockHeader::FromPayload(ptr)->Size();
+}
+
+
+void TlsfAllocationEngine::Reset(void* memory, size_t size) {
+	constexpr size_t HeaderSize = BlockHeader::HeaderSize;
+
+	if (!memory) {
+		throw InvalidArgumentException("Memory region must not be null.");
+	}
+	std::byte* begin = AlignUp(static_cast<std::byte*>(memory), MinAlignment);
+	std::byte* end = reinterpret_cast<std::byte*>(reinterpret_cast<uintptr_t>(static_cast<std::byte*>(memory) + size) & ~(MinAlignment - 1));
+	if (end <= begin || size_t(end - begin) < 2 * HeaderSize + BlockHeader::MinPayload) {
+		throw InvalidArgumentException("Memory region is too small to hold a block.");
+	}
+	size_t capacity = size_t(end - begin) - 2 * HeaderSize;
+	if (capacity >= MaxBlockSize) {
+		throw InvalidArgumentException("Memory region is larger than the largest block.");
+	}
+
+	m_begin = begin;
+	m_end = end;
+	m_capacity = capacity;
+	m_allocatedSize = 0;
+	m_allocationCount = 0;
+	m_firstLevelBitmap = 0;
+	std::fill(std::begin(m_secondLevelBitmaps), std::end(m_secondLevelBitmaps), 0u);
+	std::fill(&m_freeLists[0][0], &m_freeLists[0][0] + FirstLevelCount * SecondLevelCount, nullptr);
+
+	// One free block covering the region, and a zero sized allocated block at the end,
+	// so that every block has a physical successor.
+	auto block = reinterpret_cast<BlockHeader*>(begin);
+	block->previousPhysical = nullptr;
+	block->sizeAndFlags = capacity | BlockHeader::FreeFlag;
+	BlockHeader* sentinel = block->NextPhysical();
+	sentinel->previousPhysical = block;
+	sentinel->sizeAndFlags = 0;
+	InsertFree(block);
+}
+
+
+void TlsfAllocationEngine::Reset() {
+	if (m_begin) {
+		Reset(m_begin, size_t(m_end - m_begin));
+	}
+}
+
+
+void TlsfAllocationEngine::Mapping(size_t size, int& firstLevel, int& secondLevel) noexcept {
+	if (size < SmallBlockSize) {
+		firstLevel = 0;
+		secondLevel = int(size / MinAlignment);
+	}
+	else {
+		int log2 = FloorLog2(size);
+		firstLevel = log2 - FirstLevelShift + 1;
+		secondLevel = int((size >> (log2 - SecondLevelLog2)) ^ SecondLevelCount);
+	}
+	assert(firstLevel < FirstLevelCount && secondLevel < SecondLevelCount);
+}
+
+
+TlsfAllocationEngine::BlockHeader* TlsfAllocationEngine::FindFree(size_t size) noexcept {
+	// A list holds sizes from its class up to the next class. Rounding up to the next class
+	// ensures every block in the list found fits, so no list has to be searched.
+	if (size >= MaxBlockSize) {
+		return nullptr;
+	}
+	int exactFirstLevel, exactSecondLevel;
+	Mapping(size, exactFirstLevel, exactSecondLevel);
+	size_t roundedSize = size;
+	if (size >= SmallBlockSize) {
+		roundedSize += (size_t(1) << (FloorLog2(size) - SecondLevelLog2)) - 1;
+	}
+	int firstLevel = FirstLevelCount, secondLevel = 0;
+	if (roundedSize < MaxBlockSize) {
+		Mapping(roundedSize, firstLevel, secondLevel);
+	}
+
+	uint32_t secondLevelMap = firstLevel < FirstLevelCount ? m_secondLevelBitmaps[firstLevel] & (~0u << secondLevel) : 0;
+	if (secondLevelMap == 0) {
+		uint32_t firstLevelMap = firstLevel + 1 < FirstLevelCount ? m_firstLevelBitmap & (~0u << (firstLevel + 1)) : 0;
+		if (firstLevelMap == 0) {
+			// Nothing is surely large enough, but the first block of the request's own class may be.
+			// Without this, the largest block of the region could never be allocated.
+			BlockHeader* block = m_freeLists[exactFirstLevel][exactSecondLevel];
+			return block && block->Size() >= size ? block : nullptr;
+		}
+		firstLevel = CountTrailingZeros(firstLevelMap);
+		secondLevelMap = m_secondLevelBitmaps[firstLevel];
+	}
+	secondLevel = CountTrailingZeros(secondLevelMap);
+	return m_freeLists[firstLevel][secondLevel];
+}
+
+
+void TlsfAllocationEngine::InsertFree(BlockHeader* block) noexcept {
+	int firstLevel, secondLevel;
+	Mapping(block->Size(), firstLevel, secondLevel);
+
+	BlockHeader*& head = m_freeLists[firstLevel][secondLevel];
+	block->SetFree(true);
+	block->previousFree = nullptr;
+	block->nextFree = head;
+	if (head) {
+		head->previousFree = block;
+	}
+	head = block;
+	m_secondLevelBitmaps[firstLevel] |= 1u << secondLevel;
+	m_firstLevelBitmap |= 1u << firstLevel;
+}
+
+
+void TlsfAllocationEngine::RemoveFree(BlockHeader* block) noexcept {
+	int firstLevel, secondLevel;
+	Mapping(block->Size(), firstLevel, secondLevel);
+
+	if (block->nextFree) {
+		block->nextFree->previousFree = block->previousFree;
+	}
+	if (block->previousFree) {
+		block->previousFree->nextFree = block->nextFree;
+	}
+	else {
+		BlockHeader*& head = m_freeLists[firstLevel][secondLevel];
+		head = block->nextFree;
+		if (!head) {
+			m_secondLevelBitmaps[firstLevel] &= ~(1u << secondLevel);
+			if (m_secondLevelBitmaps[firstLevel] == 0) {
+				m_firstLevelBitmap &= ~(1u << firstLevel);
+			}
+		}
+	}
+}
+
+
+TlsfAllocationEngine::BlockHeader* TlsfAllocationEngine::SplitBlock(BlockHeader* block, size_t size) noexcept {
+	assert(block->Size() >= size + BlockHeader::HeaderSize + BlockHeader::MinPayload);
+
+	auto remainder = reinterpret_cast<BlockHeader*>(block->Payload() + size);
+	remainder->previousPhysical = block;
+	remainder->sizeAndFlags = (block->Size() - size - BlockHeader::HeaderSize) | BlockHeader::FreeFlag;
+	remainder->NextPhysical()->previousPhysical = remainder;
+	block->SetSize(size);
+	return remainder;
+}
+
+
+TlsfAllocationEngine::BlockHeader* TlsfAllocationEngine::Merge(BlockHeader* previous, BlockHeader* block) noexcept {
+	assert(previous->NextPhysical() == block);
+
+	previous->SetSize(previous->Size() + BlockHeader::HeaderSize + block->Size());
+	previous->NextPhysical()->previousPhysical = previous;
+	return previous;
+}
+
+
+} // namespace inl
@@ -0,0 +1,100 @@
+#include <InlineLib/Memory/TlsfResource.hpp>
+
+#include <InlineLib/Exception/Exception.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+
+
+namespace inl {
+
+
+void* TlsfResource::do_allocate(size_t bytes, size_t alignment) {
+	return m_engine.Allocate(std::max(bytes, size_t(1)), alignment);
+}
+
+
+void TlsfResource::do_deallocate(void* p, size_t, size_t) {
+	m_engine.Deallocate(p);
+}
+
+
+ThreadLocalTlsfResource::ThreadLocalTlsfResource(void* memory, size_t size, size_t heapSize)
+	: m_memory(static_cast<std::byte*>(memory)),
+	  m_heapSize(heapSize),
+	  m_heapCount(heapSize == 0 ? 0 : size / heapSize),
+	  m_threadHeap(nullptr) {
+	if (m_heapCount == 0) {
+		throw InvalidArgumentException("Memory region must hold at least one heap.");
+	}
+	m_heaps = std::make_unique<Heap[]>(m_heapCount);
+	for (size_t i = 0; i < m_heapCount; ++i) {
+		m_heaps[i].engine.Reset(m_memory + i * m_heapSize, m_heapSize);
+	}
+}
+
+
+void* ThreadLocalTlsfResource::do_allocate(size_t bytes, size_t alignment) {
+	Heap& heap = GetThreadHeap();
+	FreePending(heap, MaxFreesPerAllocation);
+	try {
+		return heap.engine.Allocate(std::max(bytes, size_t(1)), alignment);
+	}
+	catch (std::bad_alloc&) {
+		// The blocks freed by other threads may be enough.
+		FreePending(heap, SIZE_MAX);
+		return heap.engine.Allocate(std::max(bytes, size_t(1)), alignment);
+	}
+}
+
+
+void ThreadLocalTlsfResource::do_deallocate(void* p, size_t, size_t) {
+	size_t heapIndex = size_t(static_cast<std::byte*>(p) - m_memory) / m_heapSize;
+	assert(heapIndex < m_heapCount && "Pointer was not allocated from this resource.");
+	Heap& owner = m_heaps[heapIndex];
+
+	// Threads that only free have no heap, looking it up must not create a value for them.
+	Heap* const* threadHeap = m_threadHeap.TryGet();
+	if (threadHeap && *threadHeap == &owner) {
+		owner.engine.Deallocate(p);
+	}
+	else {
+		auto block = static_cast<RemoteBlock*>(p); // Every block has room for at least two pointers.
+		block->next = owner.remoteFrees.load(std::memory_order_relaxed);
+		while (!owner.remoteFrees.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+		}
+	}
+}
+
+
+ThreadLocalTlsfResource::Heap& ThreadLocalTlsfResource::GetThreadHeap() {
+	Heap*& heap = m_threadHeap.GetRef();
+	if (!heap) {
+		size_t index = m_claimedHeapCount.fetch_add(1, std::memory_order_relaxed);
+		if (index >= m_heapCount) {
+			throw std::bad_alloc();
+		}
+		heap = &m_heaps[index];
+	}
+	return *heap;
+}
+
+
+void ThreadLocalTlsfResource::FreePending(Heap& heap, size_t maxCount) {
+	for (size_t count = 0; count < maxCount; ++count) {
+		if (!heap.pendingFrees) {
+			if (!heap.remoteFrees.load(std::memory_order_relaxed)) {
+				return;
+			}
+			heap.pendingFrees = heap.remoteFrees.exchange(nullptr, std::memory_order_acquire);
+		}
+		RemoteBlock* block = heap.pendingFrees;
+		heap.pendingFrees = block->next;
+		heap.engine.Deallocate(block);
+	}
+}
+
+
+} // namespace inl
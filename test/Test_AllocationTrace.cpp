@@ -0,0 +1,76 @@
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/Memory/AllocationTrace.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <sstream>
+#include <thread>
+
+using namespace inl;
+
+
+TEST_CASE("Allocation trace write and read", "[AllocationTrace]") {
+	AllocationTrace trace;
+	trace.events = {
+		{ eAllocationOp::ALLOCATE, 0, 0, 64 },
+		{ eAllocationOp::ALLOCATE, 1, 1, 1000 },
+		{ eAllocationOp::DEALLOCATE, 1, 0, 64 },
+	};
+	REQUIRE(trace.AllocationCount() == 2);
+
+	std::stringstream ss;
+	trace.Write(ss);
+	AllocationTrace read = AllocationTrace::Read(ss);
+	REQUIRE(read.events.size() == 3);
+	REQUIRE(read.events[1].thread == 1);
+	REQUIRE(read.events[1].size == 1000);
+	REQUIRE(read.events[2].op == eAllocationOp::DEALLOCATE);
+	REQUIRE(read.events[2].id == 0);
+
+	std::stringstream noHeader("a 0 0 64\n");
+	REQUIRE_THROWS_AS(AllocationTrace::Read(noHeader), InvalidArgumentException);
+
+	std::stringstream unknownId;
+	AllocationTrace{ { { eAllocationOp::DEALLOCATE, 0, 5, 64 } } }.Write(unknownId);
+	REQUIRE_THROWS_AS(AllocationTrace::Read(unknownId), InvalidArgumentException);
+}
+
+
+TEST_CASE("Allocation trace recorder", "[AllocationTrace]") {
+	// The hooks are not linked into the tests, the calls are made by hand.
+	int a, b;
+	AllocationTraceRecorder::OnAllocation(&a, 4); // Not running, ignored.
+	AllocationTraceRecorder::Start(6);
+	REQUIRE(AllocationTraceRecorder::IsRunning());
+	REQUIRE_THROWS_AS(AllocationTraceRecorder::Start(), InvalidCallException);
+	REQUIRE_THROWS_AS(AllocationTraceRecorder::GetTrace(), InvalidCallException);
+
+	AllocationTraceRecorder::OnDeallocation(&a); // Allocated before the recording, left out.
+	AllocationTraceRecorder::OnAllocation(&a, 4);
+	std::thread([&] {
+		AllocationTraceRecorder::OnAllocation(&b, 8);
+		AllocationTraceRecorder::OnDeallocation(&a);
+	}).join();
+	AllocationTraceRecorder::OnAllocation(&a, 16); // Same address, new allocation.
+	AllocationTraceRecorder::OnDeallocation(&b);
+	AllocationTraceRecorder::OnDeallocation(&a); // Doesn't fit the buffer.
+	AllocationTraceRecorder::Stop();
+
+	REQUIRE(AllocationTraceRecorder::GetDroppedEventCount() == 1);
+	AllocationTrace trace = AllocationTraceRecorder::GetTrace();
+	REQUIRE(trace.events.size() == 5);
+	REQUIRE(trace.AllocationCount() == 3);
+
+	REQUIRE(trace.events[0].op == eAllocationOp::ALLOCATE);
+	REQUIRE(trace.events[0].id == 0);
+	REQUIRE(trace.events[1].id == 1);
+	REQUIRE(trace.events[1].size == 8);
+	REQUIRE(trace.events[1].thread != trace.events[0].thread);
+	REQUIRE(trace.events[2].op == eAllocationOp::DEALLOCATE);
+	REQUIRE(trace.events[2].id == 0);
+	REQUIRE(trace.events[2].size == 4);
+	REQUIRE(trace.events[3].id == 2);
+	REQUIRE(trace.events[3].size == 16);
+	REQUIRE(trace.events[4].op == eAllocationOp::DEALLOCATE);
+	REQUIRE(trace.events[4].id == 1);
+}
@@ -0,0 +1,145 @@
+#include <InlineLib/Container/BucketedPolymorphicVector.hpp>
+
+#include <Catch2/catch.hpp>
+#include <array>
+#include <memory_resource>
+#include <typeindex>
+#include <vector>
+
+using namespace inl;
+
+
+class Base {
+public:
+	virtual ~Base() = default;
+	virtual std::type_index Type() const { return typeid(Base); }
+	int value = 0;
+};
+
+class DerivedA final : public Base {
+public:
+	std::type_index Type() const override { return typeid(DerivedA); }
+};
+
+class DerivedB final : public Base {
+public:
+	std::type_index Type() const override { return typeid(DerivedB); }
+	double payload[3] = {};
+};
+
+class DerivedC : public Base {
+public:
+	std::type_index Type() const override { return typeid(DerivedC); }
+};
+
+
+template <class Vector>
+static void FillMixed(Vector& v) {
+	for (int i = 0; i < 9; ++i) {
+		Base& element = i % 3 == 0 ? v.emplace_back(std::in_place_type<DerivedA>)
+						: i % 3 == 1 ? v.emplace_back(std::in_place_type<DerivedB>)
+									 : v.emplace_back(std::in_place_type<DerivedC>);
+		element.value = i;
+	}
+}
+
+
+TEST_CASE("Bucketed polymorphic vector relaxed order", "[BaseLibrary:BucketedPolymorphicVector]") {
+	BucketedPolymorphicVector<Base> v;
+	FillMixed(v);
+	REQUIRE(v.size() == 9);
+	REQUIRE(v.bucket_count() == 3);
+
+	// Grouped by type, insertion order within the buckets.
+	std::array<int, 9> expected = { 0, 3, 6, 1, 4, 7, 2, 5, 8 };
+	size_t index = 0;
+	for (auto& element : v) {
+		REQUIRE(element.value == expected[index]);
+		REQUIRE(v[index].value == expected[index]);
+		++index;
+	}
+	REQUIRE(index == 9);
+
+	v.erase(1);
+	REQUIRE(v.size() == 8);
+	REQUIRE(v[1].value == 6);
+	REQUIRE(v[2].value == 1);
+	REQUIRE_THROWS(v.at(8));
+
+	v.clear();
+	REQUIRE(v.empty());
+	REQUIRE(v.begin() == v.end());
+}
+
+
+TEST_CASE("Bucketed polymorphic vector insertion order", "[BaseLibrary:BucketedPolymorphicVector]") {
+	BucketedPolymorphicVector<Base> v(eBucketOrder::INSERTION);
+	FillMixed(v);
+
+	int expected = 0;
+	v.ForEach([&](const Base& element) {
+		REQUIRE(element.value == expected++);
+	});
+	REQUIRE(expected == 9);
+
+	v.erase(3);
+	v.erase(0);
+	std::array<int, 7> remaining = { 1, 2, 4, 5, 6, 7, 8 };
+	for (size_t i = 0; i < v.size(); ++i) {
+		REQUIRE(v[i].value == remaining[i]);
+	}
+	REQUIRE(v[4].Type() == typeid(DerivedA));
+}
+
+
+TEST_CASE("Bucketed polymorphic vector visit by type", "[BaseLibrary:BucketedPolymorphicVector]") {
+	BucketedPolymorphicVector<Base> v;
+	FillMixed(v);
+
+	int countA = 0, countB = 0;
+	std::vector<int> others;
+	v.ForEachByType<DerivedA, DerivedB>([&](auto& element) {
+		using Element = std::decay_t<decltype(element)>;
+		if constexpr (std::is_same_v<Element, DerivedA>) {
+			++countA;
+		}
+		else if constexpr (std::is_same_v<Element, DerivedB>) {
+			++countB;
+			element.payload[0] = 1.0;
+		}
+		else {
+			static_assert(std::is_same_v<Element, Base>);
+			REQUIRE(element.Type() == typeid(DerivedC));
+			others.push_back(element.value);
+		}
+	});
+	REQUIRE(countA == 3);
+	REQUIRE(countB == 3);
+	REQUIRE(others == std::vector<int>{ 2, 5, 8 });
+
+	const auto& constV = v;
+	double sum = 0.0;
+	constV.ForEachByType<DerivedB>([&](auto& element) {
+		if constexpr (std::is_same_v<std::decay_t<decltype(element)>, DerivedB>) {
+			static_assert(std::is_const_v<std::remove_reference_t<decltype(element)>>);
+			sum += element.payload[0];
+		}
+	});
+	REQUIRE(sum == 3.0);
+}
+
+
+TEST_CASE("Bucketed polymorphic vector memory resource", "[BaseLibrary:BucketedPolymorphicVector]") {
+	std::array<std::byte, 4096> buffer;
+	std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+
+	BucketedPolymorphicVector<Base, std::pmr::polymorphic_allocator> v(eBucketOrder::INSERTION, &resource);
+	v.reserve<DerivedA>(4);
+	FillMixed(v);
+	for (auto& element : v) {
+		auto address = reinterpret_cast<const std::byte*>(&element);
+		REQUIRE(address >= buffer.data());
+		REQUIRE(address < buffer.data() + buffer.size());
+	}
+	REQUIRE(v.get_allocator().resource() == &resource);
+}
\ No newline at end of file
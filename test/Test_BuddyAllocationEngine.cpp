@@ -0,0 +1,145 @@
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/Memory/BuddyAllocationEngine.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace inl;
+
+
+TEST_CASE("Buddy allocate and merge", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(64);
+	REQUIRE(engine.LargestFreeBlock() == 64);
+
+	size_t a = engine.Allocate(3);
+	size_t b = engine.Allocate(1);
+	size_t c = engine.Allocate(16);
+	REQUIRE(engine.AllocationSize(a) == 4);
+	REQUIRE(engine.AllocationSize(b) == 1);
+	REQUIRE(a % 4 == 0);
+	REQUIRE(c % 16 == 0);
+	REQUIRE(engine.LargestFreeBlock() == 32);
+
+	auto stats = engine.GetStats();
+	REQUIRE(stats.allocatedSize == 21);
+	REQUIRE(stats.allocationCount == 3);
+	REQUIRE(stats.freeSize == 43);
+	REQUIRE(stats.ExternalFragmentation() > 0.0);
+
+	REQUIRE_THROWS_AS(engine.Deallocate(a + 1), InvalidArgumentException);
+	REQUIRE_THROWS_AS(engine.Deallocate(64), OutOfRangeException);
+	REQUIRE_THROWS_AS(engine.Allocate(0), InvalidArgumentException);
+	REQUIRE_THROWS_AS(engine.Allocate(33), std::bad_alloc);
+
+	engine.Deallocate(b);
+	engine.Deallocate(a);
+	engine.Deallocate(c);
+	REQUIRE(engine.LargestFreeBlock() == 64);
+	stats = engine.GetStats();
+	REQUIRE(stats.freeBlockCount == 1);
+	REQUIRE(stats.ExternalFragmentation() == 0.0);
+	REQUIRE(engine.Allocate(64) == 0);
+}
+
+
+TEST_CASE("Buddy non power of two pool", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(100);
+	REQUIRE(engine.LargestFreeBlock() == 64);
+
+	std::vector<size_t> indices;
+	for (int i = 0; i < 100; ++i) {
+		indices.push_back(engine.Allocate());
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+	std::sort(indices.begin(), indices.end());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		REQUIRE(indices[i] == i);
+	}
+
+	for (size_t index : indices) {
+		engine.Deallocate(index);
+	}
+	REQUIRE(engine.GetStats().freeSize == 100);
+	REQUIRE(engine.Allocate(64) == 0);
+	REQUIRE(engine.Allocate(32) == 64);
+	REQUIRE_THROWS_AS(engine.Allocate(8), std::bad_alloc);
+	REQUIRE(engine.Allocate(4) == 96);
+}
+
+
+TEST_CASE("Buddy random churn", "[BuddyAllocationEngine]") {
+	constexpr size_t poolSize = 1000;
+	BuddyAllocationEngine engine(poolSize);
+	std::vector<int> owner(poolSize, -1);
+	std::vector<size_t> live;
+	std::mt19937 rne(1234);
+
+	for (int i = 0; i < 20000; ++i) {
+		if (live.empty() || rne() % 2 == 0) {
+			size_t size = 1 + rne() % 40;
+			try {
+				size_t index = engine.Allocate(size);
+				size_t blockSize = engine.AllocationSize(index);
+				REQUIRE(blockSize >= size);
+				REQUIRE(index + blockSize <= poolSize);
+				for (size_t slot = index; slot < index + blockSize; ++slot) {
+					REQUIRE(owner[slot] == -1);
+					owner[slot] = int(index);
+				}
+				live.push_back(index);
+			}
+			catch (std::bad_alloc&) {
+				REQUIRE(engine.LargestFreeBlock() < size);
+			}
+		}
+		else {
+			size_t pick = rne() % live.size();
+			size_t index = live[pick];
+			size_t blockSize = engine.AllocationSize(index);
+			std::fill(owner.begin() + index, owner.begin() + index + blockSize, -1);
+			engine.Deallocate(index);
+			live[pick] = live.back();
+			live.pop_back();
+		}
+	}
+
+	auto stats = engine.GetStats();
+	REQUIRE(stats.allocationCount == live.size());
+	REQUIRE(stats.allocatedSize == size_t(std::count_if(owner.begin(), owner.end(), [](int o) { return o != -1; })));
+
+	for (size_t index : live) {
+		engine.Deallocate(index);
+	}
+	stats = engine.GetStats();
+	REQUIRE(stats.freeSize == poolSize);
+	REQUIRE(stats.freeBlockCount == 6); // 512 + 256 + 128 + 64 + 32 + 8 = 1000
+}
+
+
+TEST_CASE("Buddy resize", "[BuddyAllocationEngine]") {
+	BuddyAllocationEngine engine(16);
+	size_t a = engine.Allocate(8);
+	size_t b = engine.Allocate(4);
+	REQUIRE_THROWS_AS(engine.Allocate(8), std::bad_alloc);
+
+	engine.Resize(40);
+	REQUIRE(engine.Size() == 40);
+	REQUIRE(engine.AllocationSize(a) == 8);
+	REQUIRE(engine.AllocationSize(b) == 4);
+	REQUIRE(engine.Allocate(16) == 16);
+	REQUIRE(engine.Allocate(8) == 32);
+	REQUIRE(engine.GetStats().allocationCount == 4);
+
+	// Allocations past the new end are dropped.
+	engine.Resize(16);
+	auto stats = engine.GetStats();
+	REQUIRE(stats.allocationCount == 2);
+	REQUIRE(stats.allocatedSize == 12);
+
+	engine.Reset();
+	REQUIRE(engine.GetStats().allocationCount == 0);
+	REQUIRE(engine.LargestFreeBlock() == 16);
+}
\ No newline at end of file
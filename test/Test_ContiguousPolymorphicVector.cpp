@@ -0,0 +1,198 @@
+#include <InlineLib/Container/ContiguousPolymorphicVector.hpp>
+
+#include <Catch2/catch.hpp>
+#include <array>
+#include <memory>
+#include <memory_resource>
+#include <typeindex>
+
+using namespace inl;
+
+
+class Base {
+public:
+	virtual ~Base() = default;
+	virtual std::type_index Type() const { return typeid(Base); }
+	int value = 0;
+};
+
+class DerivedA : public Base {
+public:
+	std::type_index Type() const override { return typeid(DerivedA); }
+};
+
+class alignas(16) DerivedB : public Base {
+public:
+	std::type_index Type() const override { return typeid(DerivedB); }
+	double payload[3] = {};
+};
+
+class Counted : public Base {
+public:
+	Counted(int* counter) : counter(counter) { ++*counter; }
+	Counted(const Counted& other) noexcept : Base(other), counter(other.counter) { ++*counter; }
+	~Counted() { --*counter; }
+	std::type_index Type() const override { return typeid(Counted); }
+	int* counter;
+	std::byte padding[100];
+};
+
+class MoveOnly : public Base {
+public:
+	MoveOnly(int v) : owned(std::make_unique<int>(v)) {}
+	std::type_index Type() const override { return typeid(MoveOnly); }
+	std::unique_ptr<int> owned;
+};
+
+
+TEST_CASE("Contiguous polymorphic vector layout", "[BaseLibrary:ContiguousPolymorphicVector]") {
+	ContiguousPolymorphicVector<Base> v = {
+		Base{},
+		DerivedA{},
+		DerivedB{},
+	};
+	v.push_back(DerivedA{});
+
+	std::array<std::type_index, 4> expected = {
+		typeid(Base),
+		typeid(DerivedA),
+		typeid(DerivedB),
+		typeid(DerivedA),
+	};
+	REQUIRE(v.size() == expected.size());
+
+	auto expectedIt = expected.begin();
+	const std::byte* previous = nullptr;
+	for (auto it = v.begin(); it != v.end(); ++it, ++expectedIt) {
+		REQUIRE(it->Type() == *expectedIt);
+		auto address = reinterpret_cast<const std::byte*>(&*it);
+		REQUIRE(address > previous);
+		previous = address;
+	}
+	REQUIRE(reinterpret_cast<uintptr_t>(&v[2]) % alignof(DerivedB) == 0);
+	REQUIRE(v.size_bytes() <= v.capacity_bytes());
+	REQUIRE(v.rbegin()->Type() == typeid(DerivedA));
+	REQUIRE_THROWS(v.at(4));
+}
+
+
+TEST_CASE("Contiguous polymorphic vector growth", "[BaseLibrary:ContiguousPolymorphicVector]") {
+	int counter = 0;
+	{
+		ContiguousPolymorphicVector<Base> v;
+		for (int i = 0; i < 100; ++i) {
+			Base& element = i % 3 == 0 ? v.emplace_back(std::in_place_type<Counted>, &counter)
+							: i % 3 == 1 ? v.emplace_back(std::in_place_type<DerivedB>)
+										 : v.emplace_back(std::in_place_type<MoveOnly>, i);
+			element.value = i;
+		}
+		REQUIRE(counter == 34);
+		REQUIRE(v.size() == 100);
+
+		for (size_t i = 0; i < v.size(); ++i) {
+			REQUIRE(v[i].value == int(i));
+			if (i % 3 == 2) {
+				REQUIRE(*static_cast<MoveOnly&>(v[i]).owned == int(i));
+			}
+		}
+
+		v.pop_back();
+		v.shrink_to_fit();
+		REQUIRE(v.back().value == 98);
+		REQUIRE(v.capacity_bytes() < v.size_bytes() + 16);
+	}
+	REQUIRE(counter == 0);
+}
+
+
+
+TEST_CASE("Contiguous polymorphic vector push back own element", "[BaseLibrary:ContiguousPolymorphicVector]") {
+	int counter = 0;
+	{
+		ContiguousPolymorphicVector<Base> v;
+		v.emplace_back(std::in_place_type<Counted>, &counter).value = 7;
+		while (v.size_bytes() + sizeof(Counted) <= v.capacity_bytes()) {
+			v.emplace_back(std::in_place_type<DerivedA>);
+		}
+
+		// The arena is full, the copied element is read while the arena grows.
+		v.push_back(static_cast<const Counted&>(v[0]));
+		REQUIRE(v.back().Type() == typeid(Counted));
+		REQUIRE(v.back().value == 7);
+		REQUIRE(static_cast<const Counted&>(v.back()).counter == &counter);
+		REQUIRE(counter == 2);
+	}
+	REQUIRE(counter == 0);
+}
+
+TEST_CASE("Contiguous polymorphic vector erase", "[BaseLibrary:ContiguousPolymorphicVector]") {
+	int counter = 0;
+	{
+		ContiguousPolymorphicVector<Base> v;
+		for (int i = 0; i < 10; ++i) {
+			Base& element = i % 2 == 0 ? v.emplace_back(std::in_place_type<Counted>, &counter)
+									   : v.emplace_back(std::in_place_type<DerivedA>);
+			element.value = i;
+		}
+
+		// A small element is removed before a larger one, the larger one can't move in place.
+		v.erase(v.begin() + 1);
+		REQUIRE(v.size() == 9);
+		REQUIRE(counter == 5);
+		REQUIRE(v[1].value == 2);
+		REQUIRE(v[1].Type() == typeid(Counted));
+
+		// The elements after fit below their old places, the tail moves down in place.
+		v.erase(v.begin() + 1, v.begin() + 3);
+		REQUIRE(v.size() == 7);
+		REQUIRE(counter == 4);
+
+		std::array<int, 7> expected = { 0, 4, 5, 6, 7, 8, 9 };
+		for (size_t i = 0; i < v.size(); ++i) {
+			REQUIRE(v[i].value == expected[i]);
+		}
+
+		v.erase(v.begin(), v.end());
+		REQUIRE(v.empty());
+		REQUIRE(v.size_bytes() == 0);
+		REQUIRE(counter == 0);
+	}
+	REQUIRE(counter == 0);
+}
+
+
+TEST_CASE("Contiguous polymorphic vector memory resource", "[BaseLibrary:ContiguousPolymorphicVector]") {
+	std::array<std::byte, 4096> buffer;
+	std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+	int counter = 0;
+	{
+		ContiguousPolymorphicVector<Base, std::pmr::polymorphic_allocator> v(&resource);
+		v.reserve(8, sizeof(Counted));
+		v.push_back(DerivedA{});
+		v.emplace_back(std::in_place_type<Counted>, &counter);
+		v.push_back(Counted{ &counter });
+		REQUIRE(counter == 2);
+
+		for (auto& element : v) {
+			auto address = reinterpret_cast<const std::byte*>(&element);
+			REQUIRE(address >= buffer.data());
+			REQUIRE(address < buffer.data() + buffer.size());
+		}
+		REQUIRE(v[1].Type() == typeid(Counted));
+		REQUIRE(v.get_allocator().resource() == &resource);
+
+		ContiguousPolymorphicVector<Base, std::pmr::polymorphic_allocator> moved = std::move(v);
+		REQUIRE(v.empty());
+		REQUIRE(moved.size() == 3);
+		REQUIRE(counter == 2);
+
+		// Different resources, the elements are moved one by one.
+		ContiguousPolymorphicVector<Base, std::pmr::polymorphic_allocator> other(std::pmr::new_delete_resource());
+		other.push_back(DerivedB{});
+		other = std::move(moved);
+		REQUIRE(other.size() == 3);
+		REQUIRE(other[2].Type() == typeid(Counted));
+		REQUIRE(counter == 2);
+	}
+	REQUIRE(counter == 0);
+}
\ No newline at end of file
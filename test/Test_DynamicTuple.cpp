@@ -1,6 +1,8 @@
 #include <InlineLib/Container/DynamicTuple.hpp>
 
 #include <Catch2/catch.hpp>
+#include <memory_resource>
+#include <vector>
 
 using namespace inl;
 
@@ -64,4 +66,18 @@ TEST_CASE("Clear", "[DynamicTuple]") {
 
 	REQUIRE(!tuple.Has<float>());
 	REQUIRE(!tuple.Has<int>());
-}
\ No newline at end of file
+}
+
+TEST_CASE("Memory resource", "[DynamicTuple]") {
+	std::pmr::monotonic_buffer_resource resource;
+	DynamicTuple tuple(std::allocator_arg, &resource, float(42.f), int(7));
+	REQUIRE(tuple.get_allocator().resource() == &resource);
+	REQUIRE(tuple.Get<int>() == 7);
+
+	std::pmr::vector<DynamicTuple> tuples(&resource);
+	tuples.push_back(tuple);
+	tuples.emplace_back(std::move(tuple));
+	REQUIRE(tuples[0].get_allocator().resource() == &resource);
+	REQUIRE(tuples[1].Get<float>() == 42.f);
+	REQUIRE(!tuples[0].Has<double>());
+}
@@ -0,0 +1,61 @@
+#include <InlineLib/Memory/FrameRingAllocator.hpp>
+#include <InlineLib/Memory/HugePageResource.hpp>
+
+#include <Catch2/catch.hpp>
+
+using namespace inl;
+
+
+TEST_CASE("Alignment", "[FrameRingAllocator]") {
+	jobs::Fence fence{ 0 };
+	FrameRingAllocator allocator(4096, fence, 16);
+
+	for (size_t alignment : { 1, 4, 16, 64, 256 }) {
+		void* ptr = allocator.Allocate(10, alignment, 1);
+		REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+	}
+	double* values = allocator.Allocate<double>(8, 1);
+	REQUIRE(reinterpret_cast<uintptr_t>(values) % alignof(double) == 0);
+}
+
+
+TEST_CASE("Reclaim by fence", "[FrameRingAllocator]") {
+	jobs::Fence fence{ 0 };
+	FrameRingAllocator allocator(1024, fence, 64);
+
+	// Frame 1 fills half the buffer, frame 2 the other half.
+	for (int i = 0; i < 8; ++i) {
+		allocator.Allocate(64, 1, 1);
+	}
+	for (int i = 0; i < 8; ++i) {
+		allocator.Allocate(64, 1, 2);
+	}
+	REQUIRE_THROWS_AS(allocator.Allocate(64, 1, 3), std::bad_alloc);
+	REQUIRE(allocator.GetAllocationCount() == 16);
+
+	// Frame 1's memory becomes available once the fence passes it.
+	fence.Signal(1);
+	for (int i = 0; i < 8; ++i) {
+		allocator.Allocate(64, 1, 3);
+	}
+	REQUIRE(allocator.GetAllocationCount() == 16);
+	REQUIRE_THROWS_AS(allocator.Allocate(64, 1, 3), std::bad_alloc);
+
+	fence.Signal(3);
+	allocator.Reclaim();
+	REQUIRE(allocator.GetAllocationCount() == 0);
+	REQUIRE(allocator.Allocate(1024, 1, 4) != nullptr);
+}
+
+
+TEST_CASE("Huge page buffer", "[FrameRingAllocator]") {
+	jobs::Fence fence{ 0 };
+	HugePageResource pages(ePageSize::HUGE_2MB);
+	FrameRingAllocator allocator(2 << 20, fence, 256, &pages);
+
+	char* ptr = allocator.Allocate<char>(1 << 20, 1);
+	REQUIRE(reinterpret_cast<uintptr_t>(ptr) % (2 << 20) == 0);
+	ptr[(1 << 20) - 1] = 1;
+	HugePageStats stats = pages.GetStats();
+	REQUIRE(stats.explicitHugePageBytes + stats.transparentHugePageBytes + stats.normalPageBytes == 2 << 20);
+}
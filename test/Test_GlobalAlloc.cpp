@@ -0,0 +1,59 @@
+// Only meaningful when ltalloc replaces the global allocator, see INL_USE_LTALLOC.
+#ifdef INL_USE_LTALLOC
+
+#include <InlineLib/GlobalAlloc/ltalloc.h>
+
+#include <Catch2/catch.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+TEST_CASE("Statistics", "[GlobalAlloc]") {
+	LtallocStats before, after;
+	std::vector<LtallocSizeClassStats> classesBefore(1024), classesAfter(1024);
+	size_t classCount = ltstats(&before, classesBefore.data(), classesBefore.size());
+	if (classCount == 0) {
+		return; // Statistics are not compiled in.
+	}
+
+	std::thread worker([] {
+		std::vector<std::unique_ptr<char[]>> blocks;
+		for (int i = 0; i < 10000; ++i) {
+			blocks.push_back(std::make_unique<char[]>(100));
+		}
+		auto large = std::make_unique<char[]>(1 << 20);
+	});
+	worker.join();
+	ltstats(&after, classesAfter.data(), classesAfter.size());
+
+	unsigned long long allocations = 0, fetches = 0;
+	for (size_t i = 0; i < classCount; ++i) {
+		allocations += classesAfter[i].allocations - classesBefore[i].allocations;
+		fetches += classesAfter[i].centralFetches - classesBefore[i].centralFetches;
+	}
+	REQUIRE(allocations >= 10000);
+	REQUIRE(fetches < allocations / 10); // Most allocations are served by the thread cache.
+	REQUIRE(after.largeAllocations - before.largeAllocations >= 1);
+	REQUIRE(after.largeDeallocations - before.largeDeallocations >= 1);
+}
+
+
+TEST_CASE("Aligned allocation", "[GlobalAlloc]") {
+	for (size_t alignment : { 16, 64, 256, 4096 }) {
+		void* ptr = aligned_alloc(alignment, alignment * 3);
+		REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+		free(ptr);
+	}
+
+	struct alignas(128) Aligned {
+		char data[200];
+	};
+	auto aligned = std::make_unique<Aligned>();
+	REQUIRE(reinterpret_cast<uintptr_t>(aligned.get()) % 128 == 0);
+}
+
+
+#endif
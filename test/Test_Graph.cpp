@@ -1,6 +1,10 @@
 ﻿#include <InlineLib/Graph.hpp>
+#include <InlineLib/Graph/NodeFactory.hpp>
+#include <InlineLib/GraphEditor/GraphParser.hpp>
 
 #include <Catch2/catch.hpp>
+#include <memory>
+#include <memory_resource>
 
 using namespace inl;
 
@@ -358,6 +362,10 @@ public:
 		out << *a + *b;
 	}
 
+	static std::string Info_GetName() {
+		return "TestAddNode:Adds two floats, described at length so that the description doesn't fit inline.";
+	}
+
 private:
 	InputPort<float>& a = inl::GetInput<0>(*this);
 	InputPort<float>& b = inl::GetInput<1>(*this);
@@ -402,3 +410,91 @@ TEST_CASE("Addition node uses port converter", "[Graph]") {
 	GetInput<0>(node).Set(std::any(1));
 	GetInput<1>(node).Set(std::any(2));
 }
+
+
+
+//--------------------------------------
+// Allocation
+//--------------------------------------
+
+namespace {
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+	size_t allocationCount = 0;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		++allocationCount;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+// Anything that falls back to the default resource while this is alive is counted.
+class DefaultResourceScope {
+public:
+	DefaultResourceScope() : previous(std::pmr::set_default_resource(&resource)) {}
+	~DefaultResourceScope() { std::pmr::set_default_resource(previous); }
+	CountingResource resource;
+
+private:
+	std::pmr::memory_resource* previous;
+};
+
+} // namespace
+
+
+TEST_CASE("Node factory allocates from its resource", "[Graph]") {
+	CountingResource resource;
+	DefaultResourceScope defaultResource;
+
+	NodeFactory factory(&resource);
+	REQUIRE(factory.RegisterNodeClass<TestAddNode>("Test nodes/Arithmetic/"));
+
+	const NodeFactory::NodeInfo* info = factory.GetNodeInfo("Test nodes/Arithmetic/TestAddNode");
+	REQUIRE(info);
+	REQUIRE(info->name == "TestAddNode");
+	REQUIRE(info->group == "Test nodes/Arithmetic");
+	REQUIRE(info->description == "Adds two floats, described at length so that the description doesn't fit inline.");
+	std::unique_ptr<NodeBase> node(factory.CreateNode("Test nodes/Arithmetic/TestAddNode"));
+	REQUIRE(dynamic_cast<TestAddNode*>(node.get()));
+
+	REQUIRE(resource.allocationCount > 0);
+	REQUIRE(defaultResource.resource.allocationCount == 0);
+}
+
+
+TEST_CASE("Graph parser allocates from its resource", "[Graph]") {
+	constexpr const char* json = R"({
+		"header": { "contentType": "a content type that doesn't fit inline" },
+		"nodes": [
+			{ "id": 0, "class": "Test nodes/Arithmetic/TestAddNode", "inputs": [ 1, "a default input that doesn't fit inline" ] },
+			{ "name": "a node name that doesn't fit inline", "class": "Test nodes/Arithmetic/TestAddNode", "meta_pos": "[10, 20]" }
+		],
+		"links": [
+			{ "src": 0, "dst": "a node name that doesn't fit inline", "srcp": 0, "dstp": "an input port name that doesn't fit inline" }
+		]
+	})";
+
+	CountingResource resource;
+	DefaultResourceScope defaultResource;
+
+	GraphParser parser(&resource);
+	parser.Parse(json);
+
+	REQUIRE(parser.GetHeader().contentType == "a content type that doesn't fit inline");
+	REQUIRE(parser.GetNodes().size() == 2);
+	REQUIRE(parser.GetNodes()[0].defaultInputs.size() == 2);
+	REQUIRE(parser.GetNodes()[0].defaultInputs[1] == "a default input that doesn't fit inline");
+	REQUIRE(parser.FindNode(0) == 0);
+	REQUIRE(parser.FindNode("a node name that doesn't fit inline") == 1);
+	REQUIRE(parser.GetLinks().size() == 1);
+	REQUIRE(parser.GetLinks()[0].dstpname == "an input port name that doesn't fit inline");
+
+	REQUIRE(resource.allocationCount > 0);
+	REQUIRE(defaultResource.resource.allocationCount == 0);
+}
@@ -0,0 +1,87 @@
+#include <InlineLib/Memory/HeapProfiler.hpp>
+
+#include <Catch2/catch.hpp>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace inl;
+
+
+// The allocations are reported by hand, so the tests work without the operator new hooks.
+// Their sizes are large enough to dominate any real allocations the hooks may sample.
+static void ReportAllocations(const std::vector<char>& storage, size_t size) {
+	for (const char& address : storage) {
+		HeapProfiler::OnAllocation(const_cast<char*>(&address), size);
+	}
+}
+
+static void ReportDeallocations(const std::vector<char>& storage) {
+	for (const char& address : storage) {
+		HeapProfiler::OnDeallocation(const_cast<char*>(&address));
+	}
+}
+
+
+TEST_CASE("Sampling estimate", "[HeapProfiler]") {
+	constexpr size_t count = 100000;
+	constexpr size_t size = 1000;
+	std::vector<char> storage(count);
+
+	HeapProfiler::Start(64 * 1024);
+	HeapProfiler::Reset();
+	ReportAllocations(storage, size);
+
+	auto top = HeapProfiler::GetTopAllocators(1);
+	REQUIRE(top.size() == 1);
+	REQUIRE(!top[0].frames.empty());
+	REQUIRE(top[0].samples > 1000);
+	REQUIRE(top[0].samples < 2000);
+	double expectedBytes = double(count * size);
+	REQUIRE(std::abs(double(top[0].allocatedBytes) - expectedBytes) < 0.15 * expectedBytes);
+	REQUIRE(std::abs(double(top[0].allocations) - double(count)) < 0.15 * double(count));
+	REQUIRE(top[0].liveBytes == top[0].allocatedBytes);
+
+	ReportDeallocations(storage);
+	HeapProfiler::Stop();
+
+	auto live = HeapProfiler::GetLiveHeap();
+	REQUIRE(std::none_of(live.begin(), live.end(), [&](const HeapProfileEntry& entry) {
+		return entry.frames == top[0].frames;
+	}));
+}
+
+
+TEST_CASE("Large allocations", "[HeapProfiler]") {
+	constexpr size_t size = 1 << 20;
+	std::vector<char> storage(10);
+
+	HeapProfiler::Start(4096);
+	HeapProfiler::Reset();
+	ReportAllocations(storage, size);
+	HeapProfiler::Stop();
+
+	// Allocations much larger than the interval are always sampled, with a weight of one.
+	auto live = HeapProfiler::GetLiveHeap(1);
+	REQUIRE(live.size() == 1);
+	REQUIRE(live[0].samples == 10);
+	REQUIRE(live[0].allocations == 10);
+	REQUIRE(live[0].liveBytes == 10 * size);
+
+	std::stringstream ss;
+	HeapProfiler::DumpLiveHeap(ss, 1);
+	REQUIRE(ss.str().find("10485760 bytes live in 10 allocations") != std::string::npos);
+
+	// Frees are tracked even after stopping.
+	ReportDeallocations(std::vector<char>(storage.begin(), storage.end())); // Different addresses, no effect.
+	REQUIRE(HeapProfiler::GetLiveHeap(1)[0].liveBytes == 10 * size);
+	ReportDeallocations(storage);
+	live = HeapProfiler::GetLiveHeap();
+	REQUIRE(std::none_of(live.begin(), live.end(), [](const HeapProfileEntry& entry) { return entry.liveBytes >= 1 << 20; }));
+}
+
+
+TEST_CASE("Invalid interval", "[HeapProfiler]") {
+	REQUIRE_THROWS(HeapProfiler::Start(0));
+	REQUIRE(!HeapProfiler::IsRunning());
+}
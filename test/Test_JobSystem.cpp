@@ -1,11 +1,17 @@
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/JobSystem/AsyncFile.hpp>
 #include <InlineLib/JobSystem/ConditionVariable.hpp>
+#include <InlineLib/JobSystem/JobScratchArena.hpp>
 #include <InlineLib/JobSystem/Mutex.hpp>
 #include <InlineLib/JobSystem/Scheduler.hpp>
 #include <InlineLib/JobSystem/SharedFuture.hpp>
+#include <InlineLib/JobSystem/TaskGroup.hpp>
 #include <InlineLib/JobSystem/ThreadpoolScheduler.hpp>
 #include <InlineLib/JobSystem/Wait.hpp>
 
 #include <Catch2/catch.hpp>
+#include <filesystem>
+#include <vector>
 
 
 using namespace inl::jobs;
@@ -144,6 +150,33 @@ TEST_CASE("JobSystem - Fence signal unordered", "[JobSystem]") {
 }
 
 
+TEST_CASE("JobSystem - Fence signal puts back waiters", "[JobSystem]") {
+	ImmediateScheduler scheduler;
+	Fence fence{ 0 };
+	int resumed = 0;
+
+	auto func = [&fence, &resumed](uint64_t value) -> SharedFuture<void> {
+		co_await fence.Wait(value);
+		++resumed;
+	};
+
+	std::vector<SharedFuture<void>> futs;
+	for (uint64_t value = 2; value <= 5; ++value) {
+		futs.push_back(scheduler.Enqueue(func, value));
+	}
+	REQUIRE(resumed == 0);
+
+	// None of the waiters is satisfied, all of them must go back to the list.
+	fence.Signal(1);
+	REQUIRE(resumed == 0);
+
+	fence.Signal(3);
+	REQUIRE(resumed == 2);
+	fence.Signal(5);
+	REQUIRE(resumed == 4);
+}
+
+
 TEST_CASE("JobSystem - Mutex", "[JobSystem]") {
 	ThreadpoolScheduler scheduler(4);
 	Mutex mutex;
@@ -182,6 +215,57 @@ TEST_CASE("JobSystem - Mutex", "[JobSystem]") {
 }
 
 
+TEST_CASE("JobSystem - Mutex FIFO order", "[JobSystem]") {
+	ImmediateScheduler scheduler;
+	Mutex mutex{ eMutexPolicy::FIFO };
+	std::vector<int> order;
+
+	auto func = [&](int id) -> SharedFuture<void> {
+		co_await mutex.Lock();
+		order.push_back(id);
+		mutex.Unlock();
+	};
+
+	REQUIRE(mutex.TryLock());
+	std::vector<SharedFuture<void>> futs;
+	for (int i = 0; i < 4; ++i) {
+		futs.push_back(scheduler.Enqueue(func, i));
+	}
+	mutex.Unlock();
+
+	for (auto& fut : futs) {
+		REQUIRE_NOTHROW(fut.get());
+	}
+	REQUIRE(order == std::vector<int>{ 0, 1, 2, 3 });
+}
+
+
+TEST_CASE("JobSystem - Mutex barging order", "[JobSystem]") {
+	ImmediateScheduler scheduler;
+	Mutex mutex{ eMutexPolicy::BARGING, 1 };
+	std::vector<int> order;
+
+	auto func = [&](int id) -> SharedFuture<void> {
+		co_await mutex.Lock();
+		order.push_back(id);
+		mutex.Unlock();
+	};
+
+	REQUIRE(mutex.TryLock());
+	std::vector<SharedFuture<void>> futs;
+	for (int i = 0; i < 4; ++i) {
+		futs.push_back(scheduler.Enqueue(func, i));
+	}
+	mutex.Unlock();
+
+	for (auto& fut : futs) {
+		REQUIRE_NOTHROW(fut.get());
+	}
+	// Newest overtakes once, then the rest is served in order.
+	REQUIRE(order == std::vector<int>{ 3, 0, 1, 2 });
+}
+
+
 TEST_CASE("JobSystem - Condvar notify one", "[JobSystem]") {
 	ThreadpoolScheduler scheduler(3);
 	Mutex mutex;
@@ -294,6 +378,187 @@ TEST_CASE("JobSystem - Condvar notify all", "[JobSystem]") {
 }
 
 
+TEST_CASE("JobSystem - Condvar predicate satisfied", "[JobSystem]") {
+	ImmediateScheduler scheduler;
+	Mutex mutex;
+	ConditionVariable cvar;
+	bool flag = true;
+
+	auto func = [&]() -> SharedFuture<void> {
+		UniqueLock lk(mutex);
+		co_await lk.Lock();
+		co_await cvar.Wait(lk, [&flag] { return flag; });
+
+		// Predicate was true, so the lock must have never been released.
+		if (mutex.TryLock()) {
+			throw std::logic_error("Mutex should be locked.");
+		}
+	};
+
+	auto fut = scheduler.Enqueue(func);
+	REQUIRE_NOTHROW(fut.get());
+}
+
+
+TEST_CASE("JobSystem - TaskGroup join", "[JobSystem]") {
+	ThreadpoolScheduler scheduler(4);
+	std::atomic_int counter = 0;
+
+	auto func = [&]() -> SharedFuture<void> {
+		TaskGroup group;
+		for (int i = 0; i < 100; ++i) {
+			group.Spawn(scheduler, [&counter](int value) { counter += value; }, 1);
+		}
+		group.Spawn(scheduler, [&counter]() -> SharedFuture<void> {
+			counter += 1000;
+			co_return;
+		});
+		co_await group.Join();
+	};
+
+	REQUIRE_NOTHROW(scheduler.Enqueue(func).get());
+	REQUIRE(counter == 1100);
+}
+
+
+TEST_CASE("JobSystem - TaskGroup exception", "[JobSystem]") {
+	ThreadpoolScheduler scheduler(4);
+	std::atomic_int executed = 0;
+
+	auto func = [&]() -> SharedFuture<bool> {
+		TaskGroup group{ true };
+		bool thrown = false;
+		group.Spawn(scheduler, [] { throw std::runtime_error("Ooops"); });
+		try {
+			co_await group.Join();
+		}
+		catch (std::runtime_error&) {
+			thrown = true;
+		}
+
+		// Children of a cancelled group are skipped.
+		group.Cancel();
+		group.Spawn(scheduler, [&executed] { ++executed; });
+		group.Spawn(scheduler, [&executed] { ++executed; });
+		co_await group.Join();
+		co_return thrown;
+	};
+
+	REQUIRE(scheduler.Enqueue(func).get());
+	REQUIRE(executed == 0);
+}
+
+
+TEST_CASE("JobSystem - TaskGroup spawn failure", "[JobSystem]") {
+	ImmediateScheduler scheduler;
+
+	// Moving it into the child's frame fails as if the frame couldn't be allocated.
+	struct FailingArgument {
+		FailingArgument() = default;
+		FailingArgument(FailingArgument&&) { throw std::bad_alloc(); }
+	};
+
+	bool joined = false;
+	auto func = [&]() -> SharedFuture<void> {
+		TaskGroup group;
+		REQUIRE_THROWS_AS(group.Spawn(scheduler, [](FailingArgument) {}, FailingArgument{}), std::bad_alloc);
+		group.Spawn(scheduler, [] {});
+		co_await group.Join();
+		joined = true;
+	};
+
+	auto fut = scheduler.Enqueue(func);
+	REQUIRE(joined);
+	REQUIRE_NOTHROW(fut.get());
+}
+
+
+TEST_CASE("JobSystem - AsyncFile", "[JobSystem]") {
+	std::string path = (std::filesystem::temp_directory_path() / "InlineLib_Test_AsyncFile.bin").string();
+	ThreadpoolScheduler scheduler(2);
+
+	for (eIoBackend backend : { eIoBackend::AUTOMATIC, eIoBackend::THREAD_POOL }) {
+		IoService service(backend);
+
+		auto func = [&]() -> SharedFuture<void> {
+			std::vector<std::byte> data(1000);
+			for (size_t i = 0; i < data.size(); ++i) {
+				data[i] = std::byte(i % 251);
+			}
+
+			AsyncFile file(path, eFileAccess::WRITE, service);
+			size_t written = co_await file.Write(0, { data.data(), 600 });
+			std::span<const std::byte> rest[] = { { data.data() + 600, 100 }, { data.data() + 700, 300 } };
+			written += co_await file.WriteGather(600, rest);
+			REQUIRE(written == data.size());
+			file.Open(path, eFileAccess::READ);
+			REQUIRE(file.Size() == data.size());
+
+			std::vector<std::byte> whole(2000);
+			size_t read = co_await file.Read(0, whole);
+			REQUIRE(read == data.size());
+			REQUIRE(std::equal(data.begin(), data.end(), whole.begin()));
+
+			std::vector<std::byte> first(10), second(20);
+			std::span<std::byte> parts[] = { first, second };
+			read = co_await file.ReadScatter(100, parts);
+			REQUIRE(read == 30);
+			REQUIRE(std::equal(first.begin(), first.end(), data.begin() + 100));
+			REQUIRE(std::equal(second.begin(), second.end(), data.begin() + 110));
+
+			IoBatch batch(service);
+			std::vector<std::byte> chunks[4];
+			for (int i = 0; i < 4; ++i) {
+				chunks[i].resize(250);
+				batch.Read(file, i * 250, chunks[i]);
+			}
+			co_await batch.Submit();
+			for (int i = 0; i < 4; ++i) {
+				REQUIRE(batch.GetResult(i) == 250);
+				REQUIRE(std::equal(chunks[i].begin(), chunks[i].end(), data.begin() + i * 250));
+			}
+		};
+
+		scheduler.Enqueue(func).get();
+	}
+
+	REQUIRE_THROWS_AS(AsyncFile(path + ".missing", eFileAccess::READ), inl::FileNotFoundException);
+	std::filesystem::remove(path);
+}
+
+
+TEST_CASE("JobSystem - JobScratchArena", "[JobSystem]") {
+	ThreadpoolScheduler scheduler(2);
+	JobScratchArena arena(1024);
+
+	auto job = [&arena]() -> SharedFuture<int> {
+		std::pmr::vector<int> values(&arena);
+		for (int i = 0; i < 1000; ++i) {
+			values.push_back(i);
+		}
+		co_return values.back();
+	};
+	auto throwingJob = [&arena]() -> SharedFuture<int> {
+		arena.allocate(64);
+		throw std::runtime_error("Ooops");
+		co_return 0;
+	};
+
+	SharedFuture<int> fut = arena.ResetWhenComplete(scheduler.Enqueue(job));
+	REQUIRE(fut.get() == 999);
+
+	// The arena was reset into a single chunk: the next allocation starts at its beginning.
+	void* first = arena.allocate(8);
+	arena.Reset();
+	REQUIRE(arena.allocate(8) == first);
+	arena.Reset();
+
+	SharedFuture<int> throwingFut = arena.ResetWhenComplete(scheduler.Enqueue(throwingJob));
+	REQUIRE_THROWS(throwingFut.get());
+	REQUIRE(arena.allocate(8) == first);
+}
+
+
 TEST_CASE("JobSystem - WaitAny", "[JobSystem]") {
 	ThreadpoolScheduler scheduler(4);
 	Fence fence;
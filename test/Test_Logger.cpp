@@ -0,0 +1,457 @@
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/Logging/EventQueue.hpp>
+#include <InlineLib/Logging/LogFormat.hpp>
+#include <InlineLib/Logging/Logger.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory_resource>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace inl;
+
+
+namespace {
+
+EventEntry MakeEntry(int index) {
+	return { std::chrono::high_resolution_clock::now(), 0, LogEvent(std::to_string(index)) };
+}
+
+std::vector<int> PopAll(EventQueue& queue) {
+	std::vector<int> indices;
+	EventEntry entry;
+	while (queue.TryPop(entry)) {
+		indices.push_back(std::stoi(entry.event.GetMessage()));
+	}
+	return indices;
+}
+
+std::vector<int> Range(int first, int last) {
+	std::vector<int> indices;
+	for (int i = first; i < last; ++i) {
+		indices.push_back(i);
+	}
+	return indices;
+}
+
+// Counts the bytes written, can be polled while the writer thread is writing.
+class CountingBuffer : public std::streambuf {
+public:
+	std::atomic_size_t size = 0;
+
+protected:
+	int overflow(int c) override {
+		++size;
+		return c;
+	}
+	std::streamsize xsputn(const char*, std::streamsize count) override {
+		size += size_t(count);
+		return count;
+	}
+};
+
+// Tracks the bytes held by the event queues.
+class CountingResource : public std::pmr::memory_resource {
+public:
+	std::atomic_size_t allocated = 0;
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override {
+		allocated += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+		allocated -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+struct ParsedLine {
+	double time;
+	std::string stream;
+	int index;
+};
+
+std::vector<ParsedLine> ParseLog(std::istream& is) {
+	std::vector<ParsedLine> lines;
+	std::string line;
+	while (std::getline(is, line)) {
+		if (line.rfind("   ", 0) == 0) {
+			continue; // Parameter
+		}
+		std::istringstream fields(line);
+		char bracket;
+		ParsedLine parsed;
+		REQUIRE((fields >> bracket >> parsed.time >> bracket));
+		REQUIRE(std::getline(fields, parsed.stream, ']'));
+		parsed.stream.erase(0, 1);
+		REQUIRE((fields >> parsed.index));
+		lines.push_back(parsed);
+	}
+	return lines;
+}
+
+} // namespace
+
+
+TEST_CASE("Event queue overflow policies", "[Logger]") {
+	REQUIRE_THROWS_AS(EventQueue(0, eLogOverflowPolicy::GROW), InvalidArgumentException);
+
+	SECTION("Block") {
+		EventQueue queue(4, eLogOverflowPolicy::BLOCK);
+		for (int i = 0; i < 4; ++i) {
+			EventEntry entry = MakeEntry(i);
+			REQUIRE(queue.TryPush(entry));
+		}
+		EventEntry entry = MakeEntry(4);
+		REQUIRE(!queue.TryPush(entry));
+		REQUIRE(entry.event.GetMessage() == "4");
+		REQUIRE(queue.Size() == 4);
+		REQUIRE(PopAll(queue) == Range(0, 4));
+		REQUIRE(queue.TryPush(entry));
+		REQUIRE(PopAll(queue) == Range(4, 5));
+	}
+	SECTION("Drop newest") {
+		EventQueue queue(4, eLogOverflowPolicy::DROP_NEWEST);
+		for (int i = 0; i < 10; ++i) {
+			EventEntry entry = MakeEntry(i);
+			REQUIRE(queue.TryPush(entry));
+		}
+		REQUIRE(queue.GetDroppedCount() == 6);
+		REQUIRE(PopAll(queue) == Range(0, 4));
+	}
+	SECTION("Drop oldest") {
+		EventQueue queue(4, eLogOverflowPolicy::DROP_OLDEST);
+		for (int i = 0; i < 10; ++i) {
+			EventEntry entry = MakeEntry(i);
+			REQUIRE(queue.TryPush(entry));
+		}
+		REQUIRE(queue.GetDroppedCount() == 6);
+		REQUIRE(queue.Size() == 4);
+		REQUIRE(PopAll(queue) == Range(6, 10));
+	}
+	SECTION("Grow") {
+		EventQueue queue(3, eLogOverflowPolicy::GROW);
+		for (int i = 0; i < 100; ++i) {
+			EventEntry entry = MakeEntry(i);
+			REQUIRE(queue.TryPush(entry));
+			if (i == 50) {
+				REQUIRE(PopAll(queue) == Range(0, 51));
+			}
+		}
+		REQUIRE(queue.GetDroppedCount() == 0);
+		REQUIRE(queue.Size() == 49);
+		REQUIRE(PopAll(queue) == Range(51, 100));
+	}
+}
+
+
+TEST_CASE("Event queue producer and consumer threads", "[Logger]") {
+	constexpr int count = 50000;
+	for (eLogOverflowPolicy policy : { eLogOverflowPolicy::BLOCK, eLogOverflowPolicy::DROP_OLDEST, eLogOverflowPolicy::GROW }) {
+		EventQueue queue(16, policy);
+		std::atomic_bool done = false;
+		std::thread producer([&] {
+			for (int i = 0; i < count; ++i) {
+				EventEntry entry = MakeEntry(i);
+				while (!queue.TryPush(entry)) {
+					std::this_thread::yield();
+				}
+			}
+			done = true;
+		});
+
+		std::vector<int> popped;
+		EventEntry entry;
+		while (!done || queue.Size() > 0) {
+			while (queue.TryPop(entry)) {
+				popped.push_back(std::stoi(entry.event.GetMessage()));
+			}
+			std::this_thread::yield();
+		}
+		producer.join();
+
+		// In order, nothing duplicated, the last one always kept.
+		REQUIRE(!popped.empty());
+		REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+		REQUIRE(std::adjacent_find(popped.begin(), popped.end()) == popped.end());
+		REQUIRE(popped.back() == count - 1);
+		REQUIRE(popped.size() + queue.GetDroppedCount() == count);
+	}
+}
+
+
+TEST_CASE("Logger merges threads by timestamp", "[Logger]") {
+	constexpr int threadCount = 4;
+	constexpr int eventCount = 200; // Below the flush threshold.
+	std::stringstream output;
+	Logger logger;
+	logger.SetFlushInterval(std::chrono::hours(1)); // Flush only once, events are ordered only within a flush.
+	logger.OpenStream(&output);
+
+	std::vector<LogStream> streams;
+	for (int t = 0; t < threadCount; ++t) {
+		streams.push_back(logger.CreateLogStream("stream" + std::to_string(t)));
+	}
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t) {
+		threads.emplace_back([&streams, t] {
+			for (int i = 0; i < eventCount; ++i) {
+				streams[t].Event(LogEvent(std::to_string(i), EventParameterInt("i", i)));
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	logger.Flush();
+
+	std::vector<ParsedLine> lines = ParseLog(output);
+	REQUIRE(lines.size() == threadCount * eventCount);
+	REQUIRE(std::is_sorted(lines.begin(), lines.end(), [](const ParsedLine& lhs, const ParsedLine& rhs) { return lhs.time < rhs.time; }));
+	std::map<std::string, int> next;
+	for (auto& line : lines) {
+		REQUIRE(line.index == next[line.stream]++);
+	}
+	REQUIRE(next.size() == threadCount);
+	streams.clear();
+}
+
+
+TEST_CASE("Logger frees the queues of exited threads", "[Logger]") {
+	constexpr int threadCount = 100;
+	CountingResource resource;
+	std::stringstream output;
+	{
+		Logger logger(&resource, eLogOverflowPolicy::GROW, 16);
+		logger.SetFlushInterval(std::chrono::hours(1));
+		logger.OpenStream(&output);
+		LogStream stream = logger.CreateLogStream("stream");
+
+		for (int t = 0; t < threadCount; ++t) {
+			std::thread thread([&stream, t] {
+				stream.Event(LogEvent(std::to_string(t)));
+			});
+			thread.join();
+		}
+		REQUIRE(resource.allocated > 0);
+
+		// The writer drains the queues of the exited threads, then frees them.
+		logger.Flush();
+		REQUIRE(resource.allocated == 0);
+
+		// A thread that keeps running keeps its queue.
+		std::atomic_bool stop = false;
+		std::thread thread([&] {
+			stream.Event(LogEvent(std::to_string(threadCount)));
+			while (!stop) {
+				std::this_thread::yield();
+			}
+		});
+		while (resource.allocated == 0) {
+			std::this_thread::yield();
+		}
+		logger.Flush();
+		REQUIRE(resource.allocated > 0);
+		stop = true;
+		thread.join();
+		logger.Flush();
+		REQUIRE(resource.allocated == 0);
+	}
+
+	std::vector<ParsedLine> lines = ParseLog(output);
+	REQUIRE(lines.size() == threadCount + 1);
+	for (int i = 0; i <= threadCount; ++i) {
+		REQUIRE(lines[i].index == i);
+	}
+}
+
+
+TEST_CASE("Logger text format", "[Logger]") {
+	for (float value : { 0.0f, 1.5f, -0.1f, 1e-7f, 123456789.0f }) {
+		EventParameterFloat parameter("f", value);
+		std::string text;
+		parameter.AppendValue(text);
+		REQUIRE(text == parameter.ToString());
+	}
+
+	std::stringstream output;
+	Logger logger;
+	logger.OpenStream(&output);
+	LogStream stream = logger.CreateLogStream("stream");
+	stream.Event(LogEvent("message",
+						  EventParameterFloat("f", 1.5f),
+						  EventParameterInt("i", -3),
+						  EventParameterString("s", "text"),
+						  EventParameterRaw{}));
+	logger.Flush();
+
+	std::string line;
+	REQUIRE(std::getline(output, line));
+	REQUIRE(line.substr(line.find("][")) == "][stream] message");
+	REQUIRE(std::getline(output, line));
+	REQUIRE(line == "   f = 1.5");
+	REQUIRE(std::getline(output, line));
+	REQUIRE(line == "   i = -3");
+	REQUIRE(std::getline(output, line));
+	REQUIRE(line == "   s = \"text\"");
+	REQUIRE(std::getline(output, line));
+	REQUIRE(line == "    = binary data");
+	REQUIRE(!std::getline(output, line));
+}
+
+
+TEST_CASE("Logger overflow policies under load", "[Logger]") {
+	constexpr int threadCount = 4;
+	constexpr int eventCount = 3000;
+	std::stringstream output;
+
+	for (eLogOverflowPolicy policy : { eLogOverflowPolicy::BLOCK, eLogOverflowPolicy::DROP_NEWEST, eLogOverflowPolicy::DROP_OLDEST, eLogOverflowPolicy::GROW }) {
+		output.clear();
+		output.str({});
+		Logger logger(std::pmr::get_default_resource(), policy, 64);
+		logger.OpenStream(&output);
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; ++t) {
+			threads.emplace_back([&logger, t] {
+				LogStream first = logger.CreateLogStream("first" + std::to_string(t));
+				LogStream second = logger.CreateLogStream("second" + std::to_string(t));
+				for (int i = 0; i < eventCount; ++i) {
+					(i % 2 ? first : second).Event(LogEvent(std::to_string(i), EventParameterInt("i", i)));
+				}
+			});
+		}
+		for (auto& thread : threads) {
+			thread.join();
+		}
+		logger.Flush();
+
+		std::map<std::string, std::vector<int>> streams;
+		std::vector<ParsedLine> lines = ParseLog(output);
+		for (auto& line : lines) {
+			streams[line.stream].push_back(line.index);
+		}
+		REQUIRE(lines.size() + logger.GetDroppedEventCount() == threadCount * eventCount);
+		for (auto& [name, indices] : streams) {
+			REQUIRE(std::is_sorted(indices.begin(), indices.end()));
+		}
+		if (policy == eLogOverflowPolicy::BLOCK || policy == eLogOverflowPolicy::GROW) {
+			REQUIRE(logger.GetDroppedEventCount() == 0);
+			REQUIRE(streams.size() == 2 * threadCount);
+		}
+	}
+}
+
+
+TEST_CASE("Logger writes in the background", "[Logger]") {
+	CountingBuffer buffer;
+	std::ostream output(&buffer);
+	Logger logger;
+	logger.OpenStream(&output);
+	logger.SetFlushInterval(std::chrono::milliseconds(10));
+	LogStream stream = logger.CreateLogStream("stream");
+
+	// Below the threshold, written when the interval passes.
+	stream.Event(LogEvent("first"));
+	auto start = std::chrono::steady_clock::now();
+	while (buffer.size == 0 && std::chrono::steady_clock::now() - start < std::chrono::seconds(10)) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	REQUIRE(buffer.size > 0);
+
+	// Flush returns once the writer is done.
+	logger.SetFlushInterval(std::chrono::hours(1));
+	size_t size = buffer.size;
+	stream.Event(LogEvent("second"));
+	logger.Flush();
+	REQUIRE(buffer.size > size);
+}
+
+
+TEST_CASE("Binary log renders like the text log", "[Logger]") {
+	auto startTime = std::chrono::high_resolution_clock::now();
+	std::vector<std::string> streamNames = { "first", "second" };
+	std::vector<EventEntry> entries;
+	for (int i = 0; i < 100; ++i) {
+		EventParameterRaw raw;
+		raw.name = "raw";
+		raw.data = { 1, 2, 3 };
+		entries.push_back({ startTime + std::chrono::microseconds(i * 1537),
+							size_t(i % 2),
+							LogEvent(i % 3 ? "repeated" : "message " + std::to_string(i),
+									 EventParameterInt("int", -i * 1000),
+									 EventParameterFloat("float", i / 7.0f),
+									 EventParameterString("string", "value " + std::to_string(i)),
+									 std::move(raw),
+									 EventParameter("default")) });
+	}
+
+	std::string text;
+	std::string binary;
+	BinaryLogEncoder encoder;
+	encoder.Begin(binary, startTime);
+	for (auto& entry : entries) {
+		double seconds = std::chrono::duration_cast<std::chrono::microseconds>(entry.timestamp - startTime).count() / 1.e6;
+		AppendTextLogEvent(text, seconds, streamNames[entry.stream], entry.event);
+		encoder.Encode(binary, entry, streamNames);
+	}
+	REQUIRE(binary.size() < text.size() / 2);
+
+	std::stringstream input(binary);
+	std::stringstream output;
+	DecodeBinaryLog(input, output);
+	REQUIRE(output.str() == text);
+
+	std::stringstream notLog("[0][stream] message\n");
+	REQUIRE_THROWS_AS(DecodeBinaryLog(notLog, output), InvalidArgumentException);
+
+	// A truncated log throws, but the complete events are still written.
+	std::stringstream truncated(binary.substr(0, binary.size() - 3));
+	std::stringstream partial;
+	REQUIRE_THROWS_AS(DecodeBinaryLog(truncated, partial), InvalidArgumentException);
+	REQUIRE(text.rfind(partial.str(), 0) == 0);
+	REQUIRE(partial.str().size() > text.size() / 2);
+}
+
+
+TEST_CASE("Logger binary output", "[Logger]") {
+	std::stringstream binary;
+	{
+		Logger logger;
+		logger.OpenStream(&binary, eLogFormat::BINARY);
+		LogStream first = logger.CreateLogStream("first");
+		LogStream second = logger.CreateLogStream("second");
+		for (int i = 0; i < 3000; ++i) {
+			(i % 2 ? first : second).Event(LogEvent(std::to_string(i), EventParameterInt("i", i)));
+		}
+		logger.Flush();
+		// Switching the output starts a new log with its own string table.
+		std::stringstream other;
+		logger.OpenStream(&other, eLogFormat::BINARY);
+		first.Event(LogEvent("other"));
+		logger.Flush();
+		std::stringstream otherText;
+		DecodeBinaryLog(other, otherText);
+		REQUIRE(otherText.str().substr(otherText.str().find("][")) == "][first] other\n");
+		logger.CloseStream();
+	}
+
+	std::stringstream text;
+	DecodeBinaryLog(binary, text);
+	std::vector<ParsedLine> lines = ParseLog(text);
+	REQUIRE(lines.size() == 3000);
+	std::map<std::string, int> next = { { "first", 1 }, { "second", 0 } };
+	for (auto& line : lines) {
+		REQUIRE(line.index == next[line.stream]);
+		next[line.stream] += 2;
+	}
+}
@@ -0,0 +1,93 @@
+#include <InlineLib/MappedFile.hpp>
+
+#include <Catch2/catch.hpp>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <vector>
+
+using namespace inl;
+
+
+static std::string WriteTestFile(const std::vector<uint32_t>& values) {
+	auto path = (std::filesystem::temp_directory_path() / "InlineLib_Test_MappedFile.bin").string();
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint32_t));
+	return path;
+}
+
+
+TEST_CASE("Read only view", "[MappedFile]") {
+	std::vector<uint32_t> values(1000);
+	std::iota(values.begin(), values.end(), 0);
+	auto path = WriteTestFile(values);
+
+	MappedFile file(path);
+	REQUIRE(file.IsOpen());
+	REQUIRE(file.Size() == values.size() * sizeof(uint32_t));
+	file.Advise(eMapHint::SEQUENTIAL);
+	file.Advise(eMapHint::WILL_NEED, 100, 200);
+
+	auto view = file.View<uint32_t>();
+	REQUIRE(view.Size() == values.size());
+	REQUIRE(std::equal(view.begin(), view.end(), values.begin()));
+
+	auto strided = file.View<uint32_t>(4, 10, 8);
+	REQUIRE(strided.Size() == 10);
+	REQUIRE(strided[3] == 7);
+
+	REQUIRE_THROWS_AS(file.View<uint32_t>(0, 1001), OutOfRangeException);
+	REQUIRE_THROWS_AS(file.View<uint32_t>(2), InvalidArgumentException);
+	REQUIRE_THROWS_AS(file.MutableData(), InvalidCallException);
+
+	file.Close();
+	std::filesystem::remove(path);
+}
+
+
+TEST_CASE("Copy on write", "[MappedFile]") {
+	auto path = WriteTestFile({ 1, 2, 3, 4 });
+
+	{
+		MappedFile file(path, eMapAccess::COPY_ON_WRITE);
+		auto view = file.MutableView<uint32_t>();
+		view[0] = 100;
+		REQUIRE(file.View<uint32_t>()[0] == 100);
+	}
+	MappedFile file(path);
+	REQUIRE(file.View<uint32_t>()[0] == 1);
+
+	file.Close();
+	std::filesystem::remove(path);
+}
+
+
+TEST_CASE("Read write", "[MappedFile]") {
+	auto path = (std::filesystem::temp_directory_path() / "InlineLib_Test_MappedFile_rw.bin").string();
+	std::filesystem::remove(path);
+
+	{
+		MappedFile file(path, eMapAccess::READ_WRITE, 64 * sizeof(uint64_t));
+		auto view = file.MutableView<uint64_t>();
+		REQUIRE(view.Size() == 64);
+		for (size_t i = 0; i < view.Size(); ++i) {
+			view[i] = i * i;
+		}
+		file.Flush();
+	}
+	MappedFile file(path);
+	REQUIRE(file.View<uint64_t>()[63] == 63 * 63);
+
+	MappedFile moved = std::move(file);
+	REQUIRE(!file.IsOpen());
+	REQUIRE(moved.View<uint64_t>()[10] == 100);
+
+	moved.Close();
+	std::filesystem::remove(path);
+}
+
+
+TEST_CASE("Missing file", "[MappedFile]") {
+	REQUIRE_THROWS_AS(MappedFile("InlineLib_this_file_does_not_exist.bin"), FileNotFoundException);
+}
@@ -0,0 +1,172 @@
+#include <InlineLib/Memory/ArenaResource.hpp>
+#include <InlineLib/Memory/HugePageResource.hpp>
+#include <InlineLib/Memory/SlabPoolResource.hpp>
+
+#include <Catch2/catch.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+using namespace inl;
+
+
+TEST_CASE("Monotonic alignment", "[MemoryResource]") {
+	MonotonicArenaResource arena(256);
+
+	for (size_t alignment : { 1, 2, 8, 16, 64 }) {
+		void* ptr = arena.allocate(3, alignment);
+		REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+	}
+}
+
+
+TEST_CASE("Monotonic chaining", "[MemoryResource]") {
+	MonotonicArenaResource arena(256);
+
+	std::vector<char*> pointers;
+	for (int i = 0; i < 100; ++i) {
+		auto ptr = static_cast<char*>(arena.allocate(32, 8));
+		std::fill_n(ptr, 32, char(i));
+		pointers.push_back(ptr);
+	}
+	REQUIRE(arena.GetCapacity() >= 100 * 32);
+
+	for (int i = 0; i < 100; ++i) {
+		REQUIRE(std::all_of(pointers[i], pointers[i] + 32, [i](char c) { return c == char(i); }));
+	}
+
+	// Larger than a chunk.
+	void* large = arena.allocate(100000, 16);
+	REQUIRE(large != nullptr);
+
+	arena.Release();
+	REQUIRE(arena.GetCapacity() == 0);
+}
+
+
+TEST_CASE("Scratch reset", "[MemoryResource]") {
+	ScratchArenaResource arena(256);
+
+	void* first = arena.allocate(16);
+	arena.Reset();
+	REQUIRE(arena.allocate(16) == first);
+
+	// Spill into multiple chunks, then reset into one that fits everything.
+	for (int i = 0; i < 100; ++i) {
+		(void)arena.allocate(64);
+	}
+	size_t capacity = arena.GetCapacity();
+	arena.Reset();
+	REQUIRE(arena.GetCapacity() >= capacity);
+
+	first = arena.allocate(16);
+	for (int i = 0; i < 99; ++i) {
+		(void)arena.allocate(64);
+	}
+	REQUIRE(arena.GetCapacity() >= capacity);
+	arena.Reset();
+	REQUIRE(arena.allocate(16) == first);
+}
+
+
+TEST_CASE("Scratch pmr container", "[MemoryResource]") {
+	ScratchArenaResource arena;
+
+	for (int round = 0; round < 3; ++round) {
+		std::pmr::vector<int> values(&arena);
+		for (int i = 0; i < 1000; ++i) {
+			values.push_back(i);
+		}
+		REQUIRE(values[999] == 999);
+		values = {};
+		arena.Reset();
+	}
+}
+
+
+TEST_CASE("Pool reuse", "[MemoryResource]") {
+	SlabPoolResource pool(256);
+
+	std::vector<void*> pointers;
+	for (int i = 0; i < 200; ++i) {
+		pointers.push_back(pool.allocate(24, 8));
+	}
+	REQUIRE(std::set<void*>(pointers.begin(), pointers.end()).size() == pointers.size());
+	for (void* ptr : pointers) {
+		REQUIRE(reinterpret_cast<uintptr_t>(ptr) % 8 == 0);
+	}
+
+	void* freed = pointers[57];
+	pool.deallocate(freed, 24, 8);
+	REQUIRE(pool.allocate(24, 8) == freed);
+
+	for (void* ptr : pointers) {
+		pool.deallocate(ptr, 24, 8);
+	}
+	REQUIRE(pool.allocate(24, 8) == pointers[0]);
+}
+
+
+TEST_CASE("Pool size classes", "[MemoryResource]") {
+	SlabPoolResource pool(256);
+
+	for (size_t size : { 1, 8, 9, 100, 256, 257, 5000 }) {
+		void* ptr = pool.allocate(size, 1);
+		std::fill_n(static_cast<char*>(ptr), size, char(1));
+		pool.deallocate(ptr, size, 1);
+	}
+
+	void* aligned = pool.allocate(8, 64);
+	REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+	pool.deallocate(aligned, 8, 64);
+}
+
+
+TEST_CASE("Pool pmr container", "[MemoryResource]") {
+	SlabPoolResource pool;
+	std::pmr::vector<std::pmr::vector<int>> nested(&pool);
+
+	for (int i = 0; i < 100; ++i) {
+		nested.emplace_back(std::pmr::vector<int>(i, i));
+	}
+	for (int i = 0; i < 100; ++i) {
+		REQUIRE(nested[i].size() == size_t(i));
+		REQUIRE(nested[i].get_allocator().resource() == &pool);
+	}
+}
+
+
+TEST_CASE("Huge page fallback", "[MemoryResource]") {
+	// Whether huge pages are available depends on the machine, the allocation must succeed either way.
+	HugePageResource pages(ePageSize::HUGE_2MB, true, 0);
+	REQUIRE(pages.GetPageSize() == 2 << 20);
+
+	void* ptr = pages.allocate(3 << 20, 64);
+	REQUIRE(reinterpret_cast<uintptr_t>(ptr) % (2 << 20) == 0);
+	std::fill_n(static_cast<char*>(ptr), 3 << 20, char(1));
+
+	HugePageStats stats = pages.GetStats();
+	REQUIRE(stats.explicitHugePageBytes + stats.transparentHugePageBytes + stats.normalPageBytes == 4 << 20);
+	pages.deallocate(ptr, 3 << 20, 64);
+}
+
+
+TEST_CASE("Pools on huge pages", "[MemoryResource]") {
+	HugePageResource pages(ePageSize::HUGE_2MB);
+
+	MonotonicArenaResource arena(4096, &pages);
+	(void)arena.allocate(100);
+	REQUIRE(arena.GetCapacity() == 2 << 20);
+
+	SlabPoolResource pool(256, &pages);
+	std::vector<void*> pointers;
+	for (int i = 0; i < 1000; ++i) {
+		pointers.push_back(pool.allocate(64, 8));
+	}
+	for (void* ptr : pointers) {
+		pool.deallocate(ptr, 64, 8);
+	}
+	HugePageStats stats = pages.GetStats();
+	REQUIRE(stats.explicitHugePageBytes + stats.transparentHugePageBytes + stats.normalPageBytes == 4 << 20);
+}
@@ -0,0 +1,171 @@
+#include <InlineLib/Memory/MultiInstanceTLS.hpp>
+
+#include <Catch2/catch.hpp>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace inl;
+
+
+TEST_CASE("Thread values", "[MultiInstanceTLS]") {
+	mi_tls<int> value(7);
+	int& mine = value;
+	REQUIRE(mine == 7);
+	mine = 8;
+
+	int theirs = 0;
+	std::thread thread([&] {
+		theirs = value;
+		value = 9;
+	});
+	thread.join();
+
+	REQUIRE(theirs == 7);
+	REQUIRE(static_cast<int&>(value) == 8);
+}
+
+
+
+TEST_CASE("Lookup without creating", "[MultiInstanceTLS]") {
+	mi_tls<int> value(7);
+	REQUIRE(value.TryGet() == nullptr);
+	value = 8;
+	REQUIRE(value.TryGet() == &value.GetRef());
+
+	bool theirsMissing = false;
+	std::thread thread([&] {
+		theirsMissing = value.TryGet() == nullptr;
+	});
+	thread.join();
+	REQUIRE(theirsMissing);
+
+	int count = 0;
+	value.ForEach([&count](int&) { ++count; });
+	REQUIRE(count == 1);
+
+	value.Clear();
+	REQUIRE(value.TryGet() == nullptr);
+}
+
+TEST_CASE("Many instances", "[MultiInstanceTLS]") {
+	std::vector<std::unique_ptr<mi_tls<int>>> instances;
+	for (int i = 0; i < 200; ++i) {
+		instances.push_back(std::make_unique<mi_tls<int>>(i));
+	}
+	for (int i = 0; i < 200; ++i) {
+		REQUIRE(instances[i]->GetRef() == i);
+		instances[i]->GetRef() += 1000;
+	}
+	for (int i = 0; i < 200; ++i) {
+		REQUIRE(instances[i]->GetRef() == i + 1000);
+	}
+
+	// Slots of destroyed instances are reused, but their values are not.
+	instances.clear();
+	for (int i = 0; i < 200; ++i) {
+		instances.push_back(std::make_unique<mi_tls<int>>(-1));
+	}
+	for (int i = 0; i < 200; ++i) {
+		REQUIRE(instances[i]->GetRef() == -1);
+	}
+}
+
+
+TEST_CASE("Combine and ForEach", "[MultiInstanceTLS]") {
+	constexpr int threadCount = 8;
+	constexpr int iterations = 10000;
+	mi_tls<long long> counter(0);
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < threadCount; ++i) {
+		threads.emplace_back([&] {
+			for (int j = 0; j < iterations; ++j) {
+				++counter.GetRef();
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	// Values outlive the threads.
+	REQUIRE(counter.Combine([](long long a, long long b) { return a + b; }) == threadCount * iterations);
+
+	int count = 0;
+	counter.ForEach([&](long long& value) {
+		REQUIRE(value == iterations);
+		++count;
+	});
+	REQUIRE(count == threadCount);
+
+	counter.Clear();
+	REQUIRE(counter.Combine([](long long a, long long b) { return a + b; }) == 0);
+	REQUIRE(counter.GetRef() == 0);
+}
+
+
+namespace {
+
+struct LiveCounted {
+	static inline std::atomic_int liveCount = 0;
+	LiveCounted() { ++liveCount; }
+	LiveCounted(const LiveCounted&) { ++liveCount; }
+	~LiveCounted() { --liveCount; }
+};
+
+} // namespace
+
+
+TEST_CASE("Values destroyed at thread exit", "[MultiInstanceTLS]") {
+	{
+		mi_tls<LiveCounted, eMiTlsLifetime::THREAD> value;
+		value.GetRef();
+		REQUIRE(LiveCounted::liveCount == 2); // Initial value and the main thread's.
+
+		for (int i = 0; i < 100; ++i) {
+			std::thread thread([&] {
+				value.GetRef();
+				REQUIRE(LiveCounted::liveCount == 3);
+			});
+			thread.join();
+		}
+		REQUIRE(LiveCounted::liveCount == 2);
+
+		int count = 0;
+		value.ForEach([&](LiveCounted&) { ++count; });
+		REQUIRE(count == 1);
+	}
+	REQUIRE(LiveCounted::liveCount == 0);
+}
+
+
+TEST_CASE("Thread exits after instance", "[MultiInstanceTLS]") {
+	std::atomic_int step = 0;
+	auto value = std::make_unique<mi_tls<LiveCounted, eMiTlsLifetime::THREAD>>();
+	auto cleared = std::make_unique<mi_tls<LiveCounted, eMiTlsLifetime::THREAD>>();
+
+	std::thread thread([&] {
+		value->GetRef();
+		cleared->GetRef();
+		step = 1;
+		while (step != 2) {
+			std::this_thread::yield();
+		}
+	});
+	while (step != 1) {
+		std::this_thread::yield();
+	}
+
+	// The thread's exit hooks must skip the destroyed instance and the cleared value.
+	value.reset();
+	cleared->Clear();
+	REQUIRE(LiveCounted::liveCount == 1);
+	step = 2;
+	thread.join();
+
+	REQUIRE(LiveCounted::liveCount == 1);
+	cleared.reset();
+	REQUIRE(LiveCounted::liveCount == 0);
+}
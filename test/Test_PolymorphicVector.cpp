@@ -2,6 +2,7 @@
 
 #include <Catch2/catch.hpp>
 #include <array>
+#include <memory_resource>
 #include <typeindex>
 
 using namespace inl;
@@ -40,4 +41,74 @@ TEST_CASE("Polymorphic vector I can't be arsed", "[BaseLibrary:PolymorphicVector
 	for (auto it = v.begin(); it != v.end(); ++it, ++expectedIt) {
 		REQUIRE(it->Type() == *expectedIt);
 	}
-}
\ No newline at end of file
+}
+
+class Counted : public Base {
+public:
+	Counted(int* counter) : counter(counter) { ++*counter; }
+	Counted(const Counted& other) : counter(other.counter) { ++*counter; }
+	~Counted() { --*counter; }
+	std::type_index Type() const override { return typeid(Counted); }
+	int* counter;
+	std::byte padding[100];
+};
+
+
+
+TEST_CASE("Polymorphic vector insert", "[BaseLibrary:PolymorphicVector]") {
+	int counter = 0;
+	{
+		PolymorphicVector<Base> v = { Base{}, Base{} };
+
+		auto it = v.insert(v.cbegin() + 1, 3, Counted{ &counter });
+		REQUIRE(&*it == &v[1]);
+		REQUIRE(counter == 3);
+
+		std::array<DerivedA, 2> range;
+		it = v.insert(v.cbegin() + 4, range.begin(), range.end());
+		REQUIRE(&*it == &v[4]);
+
+		it = v.insert(v.cend(), { DerivedB{}, DerivedB{} });
+		REQUIRE(&*it == &v[7]);
+
+		std::array<std::type_index, 9> expected = {
+			typeid(Base),
+			typeid(Counted),
+			typeid(Counted),
+			typeid(Counted),
+			typeid(DerivedA),
+			typeid(DerivedA),
+			typeid(Base),
+			typeid(DerivedB),
+			typeid(DerivedB),
+		};
+		REQUIRE(v.size() == expected.size());
+		for (size_t i = 0; i < expected.size(); ++i) {
+			REQUIRE(v[i].Type() == expected[i]);
+		}
+	}
+	REQUIRE(counter == 0);
+}
+
+TEST_CASE("Polymorphic vector memory resource", "[BaseLibrary:PolymorphicVector]") {
+	std::array<std::byte, 4096> buffer;
+	std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
+	int counter = 0;
+	{
+		PolymorphicVector<Base, std::pmr::polymorphic_allocator> v(&resource);
+		v.reserve(8);
+		v.push_back(DerivedA{});
+		v.emplace_back(std::in_place_type<Counted>, &counter);
+		v.push_back(Counted{ &counter });
+		REQUIRE(counter == 2);
+
+		for (auto& element : v) {
+			auto address = reinterpret_cast<const std::byte*>(&element);
+			REQUIRE(address >= buffer.data());
+			REQUIRE(address < buffer.data() + buffer.size());
+		}
+		REQUIRE(v[1].Type() == typeid(Counted));
+		REQUIRE(v.get_allocator().resource() == &resource);
+	}
+	REQUIRE(counter == 0);
+}
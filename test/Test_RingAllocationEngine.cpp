@@ -0,0 +1,53 @@
+#include <InlineLib/Memory/RingAllocationEngine.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <deque>
+
+using namespace inl;
+
+
+TEST_CASE("FIFO", "[RingAllocationEngine]") {
+	RingAllocationEngine engine(1000);
+	std::deque<std::pair<size_t, size_t>> allocations;
+	size_t next = 0;
+
+	// Sizes are chosen so that allocations straddle word boundaries and wrap around.
+	for (int i = 0; i < 5000; ++i) {
+		size_t size = 1 + (i * 37) % 90;
+		if (next + size > engine.Size()) {
+			next = 0;
+		}
+		while (true) {
+			try {
+				size_t index = engine.Allocate(size);
+				REQUIRE(index == next);
+				allocations.push_back({ index, size });
+				next = index + size;
+				break;
+			}
+			catch (std::bad_alloc&) {
+				REQUIRE(!allocations.empty());
+				engine.Deallocate(allocations.front().first);
+				allocations.pop_front();
+			}
+		}
+	}
+}
+
+
+TEST_CASE("Out of order", "[RingAllocationEngine]") {
+	RingAllocationEngine engine(100);
+	size_t a = engine.Allocate(40);
+	size_t b = engine.Allocate(40);
+	size_t c = engine.Allocate(15);
+	REQUIRE_THROWS_AS(engine.Allocate(10), std::bad_alloc);
+
+	// Freeing a newer range does not release space until all older ones are freed.
+	engine.Deallocate(b);
+	engine.Deallocate(c);
+	REQUIRE_THROWS_AS(engine.Allocate(10), std::bad_alloc);
+
+	engine.Deallocate(a);
+	REQUIRE(engine.Allocate(100) == 0);
+}
@@ -0,0 +1,151 @@
+#include <InlineLib/Memory/ConcurrentSlabAllocatorEngine.hpp>
+#include <InlineLib/Memory/SlabAllocatorEngine.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace inl;
+
+
+TEST_CASE("Allocate all", "[SlabAllocatorEngine]") {
+	SlabAllocatorEngine engine(100);
+	std::vector<size_t> indices;
+	for (int i = 0; i < 100; ++i) {
+		indices.push_back(engine.Allocate());
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+
+	std::sort(indices.begin(), indices.end());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		REQUIRE(indices[i] == i);
+	}
+
+	engine.Deallocate(42);
+	REQUIRE(engine.Allocate() == 42);
+}
+
+
+TEST_CASE("Concurrent allocate all", "[SlabAllocatorEngine]") {
+	ConcurrentSlabAllocatorEngine engine(100);
+	std::vector<size_t> indices;
+	for (int i = 0; i < 100; ++i) {
+		indices.push_back(engine.Allocate());
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+
+	std::sort(indices.begin(), indices.end());
+	for (size_t i = 0; i < indices.size(); ++i) {
+		REQUIRE(indices[i] == i);
+	}
+
+	engine.Deallocate(42);
+	REQUIRE(engine.Allocate() == 42);
+
+	engine.Resize(150);
+	for (int i = 0; i < 50; ++i) {
+		REQUIRE(engine.Allocate() >= 100);
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+}
+
+
+TEST_CASE("Concurrent multithreaded", "[SlabAllocatorEngine]") {
+	constexpr int threadCount = 8;
+	constexpr int iterations = 20000;
+	constexpr size_t poolSize = 4096;
+
+	ConcurrentSlabAllocatorEngine engine(poolSize);
+	std::vector<std::atomic_bool> taken(poolSize);
+	std::atomic_bool failed = false;
+
+	auto threadFunc = [&](int seed) {
+		std::vector<size_t> owned;
+		unsigned state = seed;
+		for (int i = 0; i < iterations; ++i) {
+			state = state * 1664525u + 1013904223u;
+			if (owned.size() < 300 && (owned.empty() || state % 3 != 0)) {
+				size_t index = engine.Allocate();
+				if (index >= poolSize || taken[index].exchange(true)) {
+					failed = true;
+				}
+				owned.push_back(index);
+			}
+			else {
+				size_t pick = state % owned.size();
+				taken[owned[pick]] = false;
+				engine.Deallocate(owned[pick]);
+				owned[pick] = owned.back();
+				owned.pop_back();
+			}
+		}
+		for (auto index : owned) {
+			taken[index] = false;
+			engine.Deallocate(index);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < threadCount; ++i) {
+		threads.emplace_back(threadFunc, i);
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	REQUIRE(!failed);
+
+	// Everything was returned, so the whole pool is available again.
+	for (size_t i = 0; i < poolSize; ++i) {
+		engine.Allocate();
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+}
+
+
+TEST_CASE("Lowest free slot", "[SlabAllocatorEngine]") {
+	// Large enough for three summary levels.
+	constexpr size_t poolSize = 64 * 64 * 64 + 100;
+	SlabAllocatorEngine engine(poolSize);
+	for (size_t i = 0; i < poolSize; ++i) {
+		REQUIRE(engine.Allocate() == i);
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+
+	engine.Deallocate(200000);
+	engine.Deallocate(70000);
+	engine.Deallocate(5);
+	REQUIRE(engine.Allocate() == 5);
+	REQUIRE(engine.Allocate() == 70000);
+	REQUIRE(engine.Allocate() == 200000);
+}
+
+
+TEST_CASE("Resize", "[SlabAllocatorEngine]") {
+	SlabAllocatorEngine engine;
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+
+	size_t size = 0;
+	size_t allocated = 0;
+	for (size_t newSize : { 10, 64, 65, 1000, 5000, 300000 }) {
+		engine.Resize(newSize);
+		for (; allocated < newSize; ++allocated) {
+			REQUIRE(engine.Allocate() == allocated);
+		}
+		REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+		size = newSize;
+	}
+
+	for (size_t i = 100; i < size; ++i) {
+		engine.Deallocate(i);
+	}
+	REQUIRE(engine.AllocatedExtent() == 100);
+	engine.Resize(engine.AllocatedExtent() + 10);
+	REQUIRE(engine.Size() == 110);
+	for (size_t i = 100; i < 110; ++i) {
+		REQUIRE(engine.Allocate() == i);
+	}
+	REQUIRE_THROWS_AS(engine.Allocate(), std::bad_alloc);
+}
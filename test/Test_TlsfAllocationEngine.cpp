@@ -0,0 +1,191 @@
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/Memory/TlsfAllocationEngine.hpp>
+#include <InlineLib/Memory/TlsfResource.hpp>
+
+#include <Catch2/catch.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace inl;
+
+
+TEST_CASE("TLSF allocate and coalesce", "[TlsfAllocationEngine]") {
+	alignas(16) static std::byte buffer[4096];
+	TlsfAllocationEngine engine(buffer, sizeof(buffer));
+	size_t capacity = engine.Size();
+	REQUIRE(capacity == sizeof(buffer) - 32);
+
+	void* a = engine.Allocate(1);
+	void* b = engine.Allocate(100);
+	void* c = engine.Allocate(1000);
+	REQUIRE(engine.Owns(a));
+	REQUIRE(reinterpret_cast<uintptr_t>(b) % TlsfAllocationEngine::MinAlignment == 0);
+	REQUIRE(TlsfAllocationEngine::AllocationSize(a) >= 1);
+	REQUIRE(TlsfAllocationEngine::AllocationSize(b) >= 100);
+	REQUIRE(TlsfAllocationEngine::AllocationSize(c) >= 1000);
+	REQUIRE(engine.AllocationCount() == 3);
+
+	REQUIRE_THROWS_AS(engine.Allocate(0), InvalidArgumentException);
+	REQUIRE_THROWS_AS(engine.Allocate(8, 24), InvalidArgumentException);
+	REQUIRE_THROWS_AS(engine.Allocate(capacity), std::bad_alloc);
+	REQUIRE_THROWS_AS(engine.Deallocate(buffer + sizeof(buffer) + 16), InvalidArgumentException);
+
+	// Free the middle one last, so that it merges with both neighbours.
+	engine.Deallocate(a);
+	engine.Deallocate(c);
+	REQUIRE_THROWS_AS(engine.Deallocate(c), InvalidArgumentException);
+	engine.Deallocate(b);
+	REQUIRE(engine.AllocatedSize() == 0);
+
+	// Everything merged back into a single block.
+	void* all = engine.Allocate(capacity);
+	REQUIRE(TlsfAllocationEngine::AllocationSize(all) == capacity);
+	engine.Deallocate(all);
+}
+
+
+TEST_CASE("TLSF aligned allocation", "[TlsfAllocationEngine]") {
+	std::vector<std::byte> buffer(1 << 20);
+	TlsfAllocationEngine engine(buffer.data() + 3, buffer.size() - 3);
+
+	std::vector<void*> pointers;
+	for (size_t alignment = 16; alignment <= 4096; alignment *= 2) {
+		void* ptr = engine.Allocate(24, alignment);
+		REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+		pointers.push_back(ptr);
+	}
+	for (void* ptr : pointers) {
+		engine.Deallocate(ptr);
+	}
+	REQUIRE(engine.AllocationCount() == 0);
+	void* all = engine.Allocate(engine.Size());
+	engine.Deallocate(all);
+}
+
+
+TEST_CASE("TLSF random churn", "[TlsfAllocationEngine]") {
+	std::vector<std::byte> buffer(256 * 1024);
+	TlsfAllocationEngine engine(buffer.data(), buffer.size());
+	std::mt19937 rne(4321);
+
+	struct Allocation {
+		unsigned char* ptr;
+		size_t size;
+		unsigned char pattern;
+	};
+	std::vector<Allocation> live;
+
+	for (int i = 0; i < 20000; ++i) {
+		if (live.empty() || rne() % 2 == 0) {
+			size_t size = 1 + rne() % (rne() % 8 == 0 ? 8192 : 128);
+			size_t alignment = size_t(16) << (rne() % 4);
+			try {
+				auto ptr = static_cast<unsigned char*>(engine.Allocate(size, alignment));
+				REQUIRE(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+				REQUIRE(ptr >= reinterpret_cast<unsigned char*>(buffer.data()));
+				REQUIRE(ptr + size <= reinterpret_cast<unsigned char*>(buffer.data() + buffer.size()));
+				unsigned char pattern = (unsigned char)(i);
+				std::memset(ptr, pattern, size);
+				live.push_back({ ptr, size, pattern });
+			}
+			catch (std::bad_alloc&) {
+				REQUIRE(engine.AllocatedSize() + size > engine.Size() / 4);
+			}
+		}
+		else {
+			size_t pick = rne() % live.size();
+			Allocation allocation = live[pick];
+			// Other allocations must not have overwritten this one, nor the headers.
+			REQUIRE(std::all_of(allocation.ptr, allocation.ptr + allocation.size, [&](unsigned char v) { return v == allocation.pattern; }));
+			engine.Deallocate(allocation.ptr);
+			live[pick] = live.back();
+			live.pop_back();
+		}
+	}
+
+	REQUIRE(engine.AllocationCount() == live.size());
+	for (auto& allocation : live) {
+		engine.Deallocate(allocation.ptr);
+	}
+	REQUIRE(engine.AllocatedSize() == 0);
+	void* all = engine.Allocate(engine.Size());
+	engine.Deallocate(all);
+}
+
+
+TEST_CASE("TLSF memory resource", "[TlsfAllocationEngine]") {
+	std::vector<std::byte> buffer(64 * 1024);
+	TlsfResource resource(buffer.data(), buffer.size());
+
+	{
+		std::pmr::vector<int> v(&resource);
+		for (int i = 0; i < 1000; ++i) {
+			v.push_back(i);
+		}
+		REQUIRE(resource.GetEngine().Owns(v.data()));
+		REQUIRE(resource.GetEngine().AllocationCount() == 1);
+	}
+	REQUIRE(resource.GetEngine().AllocationCount() == 0);
+	REQUIRE_THROWS_AS((void)resource.allocate(buffer.size()), std::bad_alloc);
+}
+
+
+TEST_CASE("TLSF thread-local heaps", "[TlsfAllocationEngine]") {
+	constexpr int threadCount = 4;
+	constexpr size_t heapSize = 64 * 1024;
+	std::vector<std::byte> buffer(threadCount * heapSize);
+	ThreadLocalTlsfResource resource(buffer.data(), buffer.size(), heapSize);
+	REQUIRE(resource.GetHeapCount() == threadCount);
+
+	// Each thread allocates, then frees the blocks of its neighbour, then allocates more than
+	// its heap could hold without the blocks the neighbour freed.
+	std::vector<std::vector<void*>> blocks(threadCount);
+	std::atomic_int arrived = 0;
+	auto threadFunc = [&](int index) {
+		for (int i = 0; i < 500; ++i) {
+			blocks[index].push_back(resource.allocate(64));
+		}
+		arrived.fetch_add(1);
+		while (arrived.load() < threadCount) {
+		}
+		for (void* ptr : blocks[(index + 1) % threadCount]) {
+			resource.deallocate(ptr, 64);
+		}
+		arrived.fetch_add(1);
+		while (arrived.load() < 2 * threadCount) {
+		}
+		std::vector<void*> more;
+		for (int i = 0; i < 700; ++i) {
+			more.push_back(resource.allocate(64));
+		}
+		for (void* ptr : more) {
+			resource.deallocate(ptr, 64);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int i = 0; i < threadCount; ++i) {
+		threads.emplace_back(threadFunc, i);
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	REQUIRE(resource.GetClaimedHeapCount() == threadCount);
+
+	// No heaps left for another thread.
+	bool failed = false;
+	std::thread([&] {
+		try {
+			(void)resource.allocate(16);
+		}
+		catch (std::bad_alloc&) {
+			failed = true;
+		}
+	}).join();
+	REQUIRE(failed);
+}
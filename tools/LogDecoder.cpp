@@ -0,0 +1,42 @@
+#include <InlineLib/Exception/Exception.hpp>
+#include <InlineLib/Logging/LogFormat.hpp>
+
+#include <fstream>
+#include <iostream>
+#include <string>
+
+
+// Usage: InlineLogDecoder <binary log> [<output file>]
+// Renders a log written with eLogFormat::BINARY in the text format, to stdout if no output file is given.
+int main(int argc, char* argv[]) {
+	if (argc < 2 || argc > 3) {
+		std::cerr << "Usage: InlineLogDecoder <binary log> [<output file>]" << std::endl;
+		return 2;
+	}
+
+	std::ifstream input(argv[1], std::ios::in | std::ios::binary);
+	if (!input.is_open()) {
+		std::cerr << "Cannot open " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::ofstream outputFile;
+	if (argc == 3) {
+		outputFile.open(argv[2], std::ios::out | std::ios::trunc);
+		if (!outputFile.is_open()) {
+			std::cerr << "Cannot open " << argv[2] << std::endl;
+			return 1;
+		}
+	}
+	std::ostream& output = argc == 3 ? outputFile : std::cout;
+
+	try {
+		inl::DecodeBinaryLog(input, output);
+	}
+	catch (inl::Exception& ex) {
+		output.flush();
+		std::cerr << argv[1] << ": " << ex.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}